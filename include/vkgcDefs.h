@@ -233,9 +233,10 @@ enum InternalBinding : unsigned {
   SpecConstInternalBufferBindingIdEnd = SpecConstInternalBufferBindingId + ShaderStageCount,
   ConstantBuffer0Binding = 24, ///< Binding ID of default uniform block
   ConstantBuffer0BindingEnd = ConstantBuffer0Binding + ShaderStageGfxCount,
-  DescHeapBufferBindingId = 32,  ///< Binding ID of internal buffer for buffer descriptor heap.
-  DescHeapImageBindingId = 33,   ///< Binding ID of internal buffer for image descriptor heap.
-  DescHeapSamplerBindingId = 34, ///< Binding ID of internal buffer for sampler descriptor heap.
+  DescHeapBufferBindingId = 32,     ///< Binding ID of internal buffer for buffer descriptor heap.
+  DescHeapImageBindingId = 33,      ///< Binding ID of internal buffer for image descriptor heap.
+  DescHeapSamplerBindingId = 34,    ///< Binding ID of internal buffer for sampler descriptor heap.
+  BlockCounterBufferBindingId = 35, ///< Binding ID of internal buffer for block counters (-lgc-block-counters)
 };
 
 /// Internal vertex attribute location start from 0.
@@ -541,6 +542,9 @@ struct PipelineOptions {
                                  ///  TemporalHintAtmWrite,TemporalHintImageRead, TemporalHintImageWrite,
                                  ///  TemporalHintTessFactorWrite, TemporalHintTessRead, TemporalHintTessWrite
   bool padBufferSizeToNextDword; ///< Vulkan only, set if the driver rounds the buffer size up the next dword
+  unsigned compileTimeBudgetMs;  ///< Compile-time budget in milliseconds, 0 for no budget. If the budget is used up
+                                 ///  before optimization starts, the rest of the compile is done with reduced
+                                 ///  optimization and the build output is marked as such. Not part of the cache hash.
 };
 
 /// Prototype of allocator for output data buffer, used in shader-specific operations.
@@ -693,6 +697,9 @@ struct PipelineDumpOptions {
   uint64_t filterPipelineDumpByHash; ///< Only dump the pipeline with this compiler hash if non-zero
   bool dumpDuplicatePipelines;       ///< If TRUE, duplicate pipelines will be dumped to a file with a
                                      ///  numeric suffix attached
+  bool asyncDump;                    ///< If TRUE, dump files are written, and pipeline binaries disassembled, by a
+                                     ///  background thread instead of the compiling thread
+  bool dumpCapture;                  ///< If TRUE, a binary pipeline capture (.pipecap) is dumped alongside the .pipe
 };
 
 /// Enumerate denormal override modes.
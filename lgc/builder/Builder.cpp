@@ -28,10 +28,10 @@
  * @brief LLPC source file: implementation of lgc::Builder
  ***********************************************************************************************************************
  */
-#include "BuilderRecorder.h"
 #include "lgc/LgcContext.h"
 #include "lgc/LgcDialect.h"
 #include "lgc/builder/BuilderImpl.h"
+#include "lgc/builder/BuilderRecorder.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/ShaderModes.h"
 #include "lgc/state/TargetInfo.h"
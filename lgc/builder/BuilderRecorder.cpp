@@ -28,7 +28,7 @@
  * @brief LLPC source file: BuilderRecorder implementation
  ***********************************************************************************************************************
  */
-#include "BuilderRecorder.h"
+#include "lgc/builder/BuilderRecorder.h"
 #include "lgc/LgcContext.h"
 #include "lgc/state/IntrinsDefs.h"
 #include "lgc/state/PipelineState.h"
@@ -2213,3 +2213,18 @@ BuilderOpcode BuilderRecorder::getOpcodeFromName(StringRef name) {
   assert(bestLength != 0 && "No matching lgc.create.* name found!");
   return static_cast<BuilderOpcode>(bestOpcode);
 }
+
+// =====================================================================================================================
+// Get the recorded call opcode of a function declaration, from its opcode metadata or, without that, from its name.
+//
+// @param func : Function declaration
+// @returns : Opcode, or std::nullopt if the function is not an lgc.create.* declaration
+std::optional<BuilderOpcode> BuilderRecorder::getOpcode(const Function &func) {
+  if (const MDNode *funcMeta = func.getMetadata(BuilderCallOpcodeMetadataName)) {
+    const ConstantAsMetadata *metaConst = cast<ConstantAsMetadata>(funcMeta->getOperand(0));
+    return static_cast<BuilderOpcode>(cast<ConstantInt>(metaConst->getValue())->getZExtValue());
+  }
+  if (!func.getName().starts_with(BuilderCallPrefix))
+    return std::nullopt;
+  return getOpcodeFromName(func.getName());
+}
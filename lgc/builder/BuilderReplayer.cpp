@@ -29,9 +29,9 @@
  ***********************************************************************************************************************
  */
 #include "lgc/builder/BuilderReplayer.h"
-#include "BuilderRecorder.h"
 #include "lgc/LgcContext.h"
 #include "lgc/builder/BuilderImpl.h"
+#include "lgc/builder/BuilderRecorder.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/Internal.h"
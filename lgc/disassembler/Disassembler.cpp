@@ -29,6 +29,7 @@
  ***********************************************************************************************************************
  */
 #include "lgc/Disassembler.h"
+#include "DisassemblerTarget.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
 #include "llvm/MC/MCAsmBackend.h"
 #include "llvm/MC/MCAsmInfo.h"
@@ -96,14 +97,9 @@ struct SymbolPool {
 // Class for the object file disassembler.
 class ObjDisassembler {
   MemoryBufferRef m_data;
-  std::unique_ptr<ELFObjectFileBase> m_objFile;
   raw_ostream &m_ostream;
-  std::string m_tripleName;
-  const Target *m_target = nullptr;
-  std::unique_ptr<MCRegisterInfo> m_mcRegInfo;
-  std::unique_ptr<MCSubtargetInfo> m_subtargetInfo;
+  DisassemblerTarget m_mc;
   std::unique_ptr<MCStreamer> m_streamer;
-  std::unique_ptr<MCDisassembler> m_instDisassembler;
   MCInstPrinter *m_instPrinter = nullptr;
   MCContext *m_context = nullptr;
   std::vector<object::RelocationRef> relocs;
@@ -147,7 +143,7 @@ private:
   size_t decodeNote(StringRef data);
   MCSymbol *getOrCreateSymbol(SymbolPool &symbols, uint64_t offset, Twine name = {}, unsigned type = ELF::STT_NOTYPE);
 
-  endianness endian() { return m_objFile->isLittleEndian() ? endianness::little : endianness::big; }
+  endianness endian() { return m_mc.objFile->isLittleEndian() ? endianness::little : endianness::big; }
 };
 
 } // anonymous namespace
@@ -240,89 +236,32 @@ Error lgc::disassembleSingleSymbol(MemoryBufferRef data, raw_ostream &ostream, S
 // @param symbolName (optional) : symbol to disassemble
 // @returns : Error::success() if no errors occurred, otherwise returns the Error object
 Error ObjDisassembler::run(StringRef symbolName) {
-  // Decode the object file.
-  Expected<std::unique_ptr<ObjectFile>> expectedObjFile = ObjectFile::createELFObjectFile(m_data);
-  if (Error E = expectedObjFile.takeError())
-    return createStringError(Twine("Cannot decode ELF object file: ") + toString(std::move(E)));
-  if (!isa<ELFObjectFileBase>(&*expectedObjFile.get()))
-    return createStringError("Is not ELF object file");
-  m_objFile.reset(cast<ELFObjectFileBase>(expectedObjFile.get().release()));
-
-  // Figure out the target triple from the object file, and get features.
-  Triple triple = m_objFile->makeTriple();
-  Expected<SubtargetFeatures> expectedFeatures = m_objFile->getFeatures();
-  if (!expectedFeatures)
-    return expectedFeatures.takeError();
-  SubtargetFeatures features = *expectedFeatures;
-
-  // Get the target specific parser.
-  std::string error;
-  m_tripleName = triple.getTriple();
-  m_target = TargetRegistry::lookupTarget(m_tripleName, error);
-  if (!m_target)
-    return createStringError("'" + m_tripleName + "': " + error);
-
-  // Get the CPU name.
-  std::optional<StringRef> mcpu = m_objFile->tryGetCPUName();
-  if (!mcpu)
-    return createStringError("Cannot get CPU name");
+  // Decode the object file, and set up the objects required for disassembly.
+  m_mc.targetOptions.AsmVerbose = true;
+  if (Error err = m_mc.setUp(m_data))
+    return err;
 
   // Output the required llvm-mc command as a comment unless we're only disassembling a single symbol.
   if (symbolName.empty())
-    m_ostream << "// llvm-mc -triple=" << m_tripleName << " -mcpu=" << mcpu << "\n";
-
-  // Set up other objects required for disassembly.
-  std::unique_ptr<MCRegisterInfo> regInfo(m_target->createMCRegInfo(m_tripleName));
-  if (!regInfo)
-    return createStringError("No register info for target");
-  MCTargetOptions targetOptions{};
-  targetOptions.AsmVerbose = true;
-  std::unique_ptr<MCAsmInfo> asmInfo(m_target->createMCAsmInfo(*regInfo, m_tripleName, targetOptions));
-  if (!asmInfo)
-    return createStringError("No assembly info for target");
-  m_subtargetInfo.reset(m_target->createMCSubtargetInfo(m_tripleName, *mcpu, features.getString()));
-  if (!m_subtargetInfo)
-    return createStringError("No subtarget info for target");
-  std::unique_ptr<MCInstrInfo> instrInfo(m_target->createMCInstrInfo());
-  if (!instrInfo)
-    return createStringError("No instruction info for target");
-
-  MCContext context(triple, asmInfo.get(), regInfo.get(), m_subtargetInfo.get(), nullptr, &targetOptions);
-  std::unique_ptr<MCObjectFileInfo> objFileInfo(m_target->createMCObjectFileInfo(context, /*PIC=*/false));
-  if (!objFileInfo)
-    return createStringError("No MC object file info");
-  context.setObjectFileInfo(objFileInfo.get());
-  m_context = &context;
-
-  m_instDisassembler.reset(m_target->createMCDisassembler(*m_subtargetInfo, *m_context));
-  if (!m_instDisassembler)
-    return createStringError("No disassembler for target");
-#if LLVM_MAIN_REVISION && LLVM_MAIN_REVISION < 533664
-  MCInstPrinter *instPrinter(
-      m_target->createMCInstPrinter(triple, asmInfo->getAssemblerDialect(), *asmInfo, *instrInfo, *regInfo));
-  m_instPrinter = instPrinter;
-#else
-  std::unique_ptr<MCInstPrinter> instPrinter(
-      m_target->createMCInstPrinter(triple, asmInfo->getAssemblerDialect(), *asmInfo, *instrInfo, *regInfo));
-  // FIXME: solve this a better way?
-  m_instPrinter = instPrinter.get();
-#endif
-  if (!instPrinter)
-    return createStringError("No instruction printer for target");
+    m_ostream << "// llvm-mc -triple=" << m_mc.tripleName << " -mcpu=" << m_mc.cpu << "\n";
 
+  // The streamer takes ownership of the instruction printer.
+  m_context = m_mc.context.get();
+  m_instPrinter = m_mc.instPrinter.get();
   auto fostream = std::make_unique<formatted_raw_ostream>(m_ostream);
 #if LLVM_MAIN_REVISION && LLVM_MAIN_REVISION < 505779
-  m_streamer.reset(
-      m_target->createAsmStreamer(*m_context, std::move(fostream), true, false, instPrinter, nullptr, nullptr, false));
+  m_streamer.reset(m_mc.target->createAsmStreamer(*m_context, std::move(fostream), true, false,
+                                                  m_mc.instPrinter.release(), nullptr, nullptr, false));
 #elif LLVM_MAIN_REVISION && LLVM_MAIN_REVISION < 533664
-  m_streamer.reset(m_target->createAsmStreamer(*m_context, std::move(fostream), instPrinter, nullptr, nullptr));
+  m_streamer.reset(m_mc.target->createAsmStreamer(*m_context, std::move(fostream), m_mc.instPrinter.release(),
+                                                  nullptr, nullptr));
 #else
-  m_streamer.reset(
-      m_target->createAsmStreamer(*m_context, std::move(fostream), std::move(instPrinter), nullptr, nullptr));
+  m_streamer.reset(m_mc.target->createAsmStreamer(*m_context, std::move(fostream), std::move(m_mc.instPrinter),
+                                                  nullptr, nullptr));
 #endif
 
   if (!symbolName.empty()) {
-    for (ELFSymbolRef symbolRef : m_objFile->symbols()) {
+    for (ELFSymbolRef symbolRef : m_mc.objFile->symbols()) {
       Expected<StringRef> expectedCurrSymbolName = symbolRef.getName();
       if (!expectedCurrSymbolName)
         return expectedCurrSymbolName.takeError();
@@ -338,7 +277,7 @@ Error ObjDisassembler::run(StringRef symbolName) {
 
     return createStringError(symbolName + ": Symbol not found!");
   } else {
-    for (ELFSectionRef sectionRef : m_objFile->sections()) {
+    for (ELFSectionRef sectionRef : m_mc.objFile->sections()) {
       Error err = processSection(sectionRef);
       if (err)
         return err;
@@ -397,14 +336,14 @@ Error ObjDisassembler::processSection(ELFSectionRef sectionRef, std::optional<EL
 
     // If AMDGPU, create a symbolizer, giving it the symbols.
     MCSymbolizer *symbolizerPtr = nullptr;
-    if (m_objFile->getArch() == Triple::amdgcn) {
-      std::unique_ptr<MCRelocationInfo> relInfo(m_target->createMCRelocationInfo(m_tripleName, *m_context));
+    if (m_mc.objFile->getArch() == Triple::amdgcn) {
+      std::unique_ptr<MCRelocationInfo> relInfo(m_mc.target->createMCRelocationInfo(m_mc.tripleName, *m_context));
       if (relInfo) {
         std::unique_ptr<MCSymbolizer> symbolizer(
-            m_target->createMCSymbolizer(m_tripleName, /* GetOpInfo= */ nullptr, /* SymbolLookUp= */ nullptr,
-                                         &symbols.symbols, m_context, std::move(relInfo)));
+            m_mc.target->createMCSymbolizer(m_mc.tripleName, /* GetOpInfo= */ nullptr, /* SymbolLookUp= */ nullptr,
+                                            &symbols.symbols, m_context, std::move(relInfo)));
         symbolizerPtr = &*symbolizer;
-        m_instDisassembler->setSymbolizer(std::move(symbolizer));
+        m_mc.instDisassembler->setSymbolizer(std::move(symbolizer));
       }
     }
 
@@ -440,7 +379,7 @@ Error ObjDisassembler::processSection(ELFSectionRef sectionRef, std::optional<EL
 // @param skipDirectiveEmission : True to skip synthesizing endSym label and outputting .type and .size directives
 // @param [out] symbols : Symbols to populate
 Error ObjDisassembler::gatherSectionSymbols(ELFSectionRef sectionRef, bool skipDirectiveEmission, SymbolPool &symbols) {
-  for (ELFSymbolRef symbolRef : m_objFile->symbols()) {
+  for (ELFSymbolRef symbolRef : m_mc.objFile->symbols()) {
     Expected<section_iterator> expectedSection = symbolRef.getSection();
     if (!expectedSection)
       return expectedSection.takeError();
@@ -496,7 +435,7 @@ Error ObjDisassembler::gatherSectionSymbols(ELFSectionRef sectionRef, bool skipD
 // @param sectionRef : The section being disassembled
 // @param [out] relocs : Vector to gather the relocs in
 void ObjDisassembler::gatherRelocs(ELFSectionRef sectionRef, std::vector<object::RelocationRef> &relocs) {
-  for (auto &relSect : m_objFile->sections()) {
+  for (auto &relSect : m_mc.objFile->sections()) {
     auto relocatedSectOr = relSect.getRelocatedSection();
     if (relocatedSectOr && *relocatedSectOr == sectionRef) {
       for (auto &reloc : relSect.relocations())
@@ -829,7 +768,7 @@ InstOrDirective ObjDisassembler::disasmInst(uint64_t offset, StringRef contents)
   bytes = bytes.slice(offset);
   std::string comment;
   raw_string_ostream commentStream(comment);
-  inst.status = m_instDisassembler->getInstruction(inst.mcInst, size, bytes, offset, commentStream);
+  inst.status = m_mc.instDisassembler->getInstruction(inst.mcInst, size, bytes, offset, commentStream);
   inst.bytes = bytes.take_front(size);
 
   if (inst.status == MCDisassembler::Fail)
@@ -837,7 +776,7 @@ InstOrDirective ObjDisassembler::disasmInst(uint64_t offset, StringRef contents)
 
   std::string instStr;
   raw_string_ostream os(instStr);
-  m_instPrinter->printInst(&inst.mcInst, /* Address= */ 0, /* Annot= */ "", *m_subtargetInfo, os);
+  m_instPrinter->printInst(&inst.mcInst, /* Address= */ 0, /* Annot= */ "", *m_mc.subtargetInfo, os);
 
   StringRef s = instStr;
   StringRef mnemonic;
@@ -902,7 +841,7 @@ void ObjDisassembler::outputInst(InstOrDirective inst, unsigned instAlignment, b
   if (const MCExpr *expr = inst.valueDirectiveExpr)
     m_streamer->emitValue(expr, inst.bytes.size());
   else
-    m_streamer->emitInstruction(inst.mcInst, *m_subtargetInfo);
+    m_streamer->emitInstruction(inst.mcInst, *m_mc.subtargetInfo);
 }
 
 // =====================================================================================================================
@@ -998,13 +937,13 @@ Error ObjDisassembler::outputRelocs(bool outputting, uint64_t offset, uint64_t s
       relocs[0].getTypeName(relocName);
       const MCExpr *tgtExpr = nullptr;
       auto symRef = relocs[0].getSymbol();
-      if (symRef != m_objFile->symbol_end()) {
+      if (symRef != m_mc.objFile->symbol_end()) {
         Expected<StringRef> expectedSymbolName = symRef->getName();
         if (!expectedSymbolName)
           return expectedSymbolName.takeError();
         tgtExpr = MCSymbolRefExpr::create(m_context->getOrCreateSymbol(*expectedSymbolName), *m_context);
       }
-      m_streamer->emitRelocDirective(*offsetExpr, relocName, tgtExpr, {}, *m_subtargetInfo);
+      m_streamer->emitRelocDirective(*offsetExpr, relocName, tgtExpr, {}, *m_mc.subtargetInfo);
     }
     relocs = relocs.drop_front(1);
   }
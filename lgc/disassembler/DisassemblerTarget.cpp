@@ -0,0 +1,99 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  DisassemblerTarget.cpp
+ * @brief LGC disassembler library: the MC objects needed to decode the code of an ELF object
+ ***********************************************************************************************************************
+ */
+#include "DisassemblerTarget.h"
+
+using namespace llvm;
+using namespace object;
+using namespace lgc;
+
+// =====================================================================================================================
+// Decode the object file, and set up the MC objects for its target.
+//
+// @param data : The object file contents
+// @returns : Error::success() if no errors occurred, otherwise returns the Error object
+Error DisassemblerTarget::setUp(MemoryBufferRef data) {
+  // Decode the object file.
+  Expected<std::unique_ptr<ObjectFile>> expectedObjFile = ObjectFile::createELFObjectFile(data);
+  if (Error E = expectedObjFile.takeError())
+    return createStringError(Twine("Cannot decode ELF object file: ") + toString(std::move(E)));
+  if (!isa<ELFObjectFileBase>(&*expectedObjFile.get()))
+    return createStringError("Is not ELF object file");
+  objFile.reset(cast<ELFObjectFileBase>(expectedObjFile.get().release()));
+
+  // Figure out the target triple from the object file, and get features.
+  Triple triple = objFile->makeTriple();
+  Expected<SubtargetFeatures> expectedFeatures = objFile->getFeatures();
+  if (!expectedFeatures)
+    return expectedFeatures.takeError();
+
+  // Get the target specific parser.
+  std::string error;
+  tripleName = triple.getTriple();
+  target = TargetRegistry::lookupTarget(tripleName, error);
+  if (!target)
+    return createStringError("'" + tripleName + "': " + error);
+
+  // Get the CPU name.
+  std::optional<StringRef> mcpu = objFile->tryGetCPUName();
+  if (!mcpu)
+    return createStringError("Cannot get CPU name");
+  cpu = mcpu->str();
+
+  // Set up other objects required for disassembly.
+  regInfo.reset(target->createMCRegInfo(tripleName));
+  if (!regInfo)
+    return createStringError("No register info for target");
+  asmInfo.reset(target->createMCAsmInfo(*regInfo, tripleName, targetOptions));
+  if (!asmInfo)
+    return createStringError("No assembly info for target");
+  subtargetInfo.reset(target->createMCSubtargetInfo(tripleName, cpu, expectedFeatures->getString()));
+  if (!subtargetInfo)
+    return createStringError("No subtarget info for target");
+  instrInfo.reset(target->createMCInstrInfo());
+  if (!instrInfo)
+    return createStringError("No instruction info for target");
+
+  context = std::make_unique<MCContext>(triple, asmInfo.get(), regInfo.get(), subtargetInfo.get(), nullptr,
+                                        &targetOptions);
+  objFileInfo.reset(target->createMCObjectFileInfo(*context, /*PIC=*/false));
+  if (!objFileInfo)
+    return createStringError("No MC object file info");
+  context->setObjectFileInfo(objFileInfo.get());
+
+  instDisassembler.reset(target->createMCDisassembler(*subtargetInfo, *context));
+  if (!instDisassembler)
+    return createStringError("No disassembler for target");
+  instPrinter.reset(
+      target->createMCInstPrinter(triple, asmInfo->getAssemblerDialect(), *asmInfo, *instrInfo, *regInfo));
+  if (!instPrinter)
+    return createStringError("No instruction printer for target");
+  return Error::success();
+}
@@ -0,0 +1,69 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  DisassemblerTarget.h
+ * @brief LGC disassembler library: the MC objects needed to decode the code of an ELF object
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include <memory>
+#include <string>
+
+namespace lgc {
+
+// The decoded ELF object, and the MC objects for its target, shared by the disassembler and the performance
+// estimator. targetOptions can be set before calling setUp; the MC context keeps a pointer to it.
+struct DisassemblerTarget {
+  std::unique_ptr<llvm::object::ELFObjectFileBase> objFile; // Decoded object file
+  std::string tripleName;                                   // Target triple
+  std::string cpu;                                          // Target GPU, e.g. "gfx1030"
+  const llvm::Target *target = nullptr;                     // Target
+  llvm::MCTargetOptions targetOptions;                      // Target options
+  std::unique_ptr<llvm::MCRegisterInfo> regInfo;            // Register info
+  std::unique_ptr<llvm::MCAsmInfo> asmInfo;                 // Assembly info
+  std::unique_ptr<llvm::MCSubtargetInfo> subtargetInfo;     // Subtarget info for the GPU and the object's features
+  std::unique_ptr<llvm::MCInstrInfo> instrInfo;             // Instruction info
+  std::unique_ptr<llvm::MCContext> context;                 // MC context
+  std::unique_ptr<llvm::MCObjectFileInfo> objFileInfo;      // MC object file info
+  std::unique_ptr<llvm::MCDisassembler> instDisassembler;   // Instruction disassembler
+  std::unique_ptr<llvm::MCInstPrinter> instPrinter;         // Instruction printer
+
+  llvm::Error setUp(llvm::MemoryBufferRef data);
+};
+
+} // namespace lgc
@@ -0,0 +1,800 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  PerfEstimator.cpp
+ * @brief LGC static performance estimator library
+ *
+ * @details The estimator decodes the functions in the code sections of an ELF, splits them into basic blocks, and
+ * walks each function in layout order with a simple model of one wave: every instruction takes a fixed number of
+ * issue cycles for its kind, every memory instruction completes a fixed latency after it issues, and a wait stalls
+ * until the memory instructions it waits for have completed. The occupancy limits come from the PAL metadata.
+ ***********************************************************************************************************************
+ */
+#include "lgc/PerfEstimator.h"
+#include "DisassemblerTarget.h"
+#include "SIDefines.h"
+#include "lgc/Occupancy.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/MC/MCInstrAnalysis.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/TargetParser/TargetParser.h"
+#include <deque>
+#include <optional>
+#include <set>
+
+using namespace llvm;
+using namespace object;
+using namespace lgc;
+
+namespace {
+
+// Estimated cycles from a memory instruction issuing to its counter being decremented, for each PerfCounter. These
+// are typical latencies of a cache hit under light load, not of any one GPU.
+constexpr unsigned CounterLatencies[] = {
+    300, // VmemLoad
+    100, // VmemStore
+    64,  // Smem
+    64,  // Lds
+    32,  // Export
+};
+static_assert(std::size(CounterLatencies) == unsigned(PerfCounter::Count));
+
+// Represents a decoded instruction.
+struct DecodedInst {
+  uint64_t offset = 0;                     // Offset in the section
+  unsigned size = 0;                       // Size in bytes, or 0 if it could not be decoded
+  MCInst mcInst;                           // Decoded instruction
+  StringRef baseName;                      // Name of the opcode without its encoding suffix, e.g. "S_WAITCNT"
+  PerfInstKind kind = PerfInstKind::Other; // Kind of instruction
+  bool endsBlock = false;                  // Whether it ends a basic block
+  bool fallsThrough = true;                // Whether execution can continue with the next instruction
+  std::optional<uint64_t> target;          // Branch target, if known
+};
+
+// Counts that a wait instruction waits for each counter to come down to, if it waits for it.
+using WaitCounts = std::array<std::optional<unsigned>, unsigned(PerfCounter::Count)>;
+
+// Class for the static performance estimator.
+class PerfEstimator {
+public:
+  PerfEstimator(MemoryBufferRef data) : m_data(data) {}
+
+  Expected<ObjectPerfEstimate> run();
+
+private:
+  Error setUpTarget();
+  Error readPalMetadata();
+  void readPalMetadataNote(StringRef desc);
+  Error estimateSection(ELFSectionRef sectionRef);
+  void estimateFunction(StringRef contents, uint64_t begin, uint64_t end, ShaderPerfEstimate &shader);
+  DecodedInst decodeInst(StringRef contents, uint64_t offset);
+  PerfInstKind classifyInst(const MCInst &mcInst, StringRef baseName) const;
+  std::optional<PerfCounter> getCounter(const DecodedInst &inst) const;
+  unsigned getIssueCycles(const DecodedInst &inst, unsigned waveSize) const;
+  WaitCounts getWaitCounts(const DecodedInst &inst) const;
+  void computeOccupancy(HwStageOccupancy &hwStage, msgpack::MapDocNode &stageMap) const;
+
+  bool isGfx9() const { return m_isaVersion.Major < 10; }
+
+  MemoryBufferRef m_data;
+  DisassemblerTarget m_mc;
+  std::unique_ptr<MCInstrAnalysis> m_instrAnalysis;
+  AMDGPU::IsaVersion m_isaVersion = {};
+  StringMap<unsigned> m_entryPointStages; // Map from entry point symbol to index in m_estimate.hwStages
+  ObjectPerfEstimate m_estimate;
+};
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Get the name of an instruction kind, as used in the output.
+//
+// @param kind : The instruction kind
+// @returns : The name
+const char *lgc::getPerfInstKindName(PerfInstKind kind) {
+  switch (kind) {
+  case PerfInstKind::Salu:
+    return "salu";
+  case PerfInstKind::Valu:
+    return "valu";
+  case PerfInstKind::ValuTrans:
+    return "valu_trans";
+  case PerfInstKind::Smem:
+    return "smem";
+  case PerfInstKind::Vmem:
+    return "vmem";
+  case PerfInstKind::Lds:
+    return "lds";
+  case PerfInstKind::Export:
+    return "export";
+  case PerfInstKind::Branch:
+    return "branch";
+  case PerfInstKind::Wait:
+    return "wait";
+  default:
+    return "other";
+  }
+}
+
+// =====================================================================================================================
+// Get the name of a counter, as used in the output.
+//
+// @param counter : The counter
+// @returns : The name
+const char *lgc::getPerfCounterName(PerfCounter counter) {
+  switch (counter) {
+  case PerfCounter::VmemLoad:
+    return "vmem_load";
+  case PerfCounter::VmemStore:
+    return "vmem_store";
+  case PerfCounter::Smem:
+    return "smem";
+  case PerfCounter::Lds:
+    return "lds";
+  default:
+    return "export";
+  }
+}
+
+// =====================================================================================================================
+// Statically estimate the performance of the code in an ELF object.
+//
+// @param data : The object file contents
+// @returns : The estimate, or the Error if the object could not be decoded
+Expected<ObjectPerfEstimate> lgc::estimateObjectPerf(MemoryBufferRef data) {
+  // Initialize targets and disassemblers.
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllDisassemblers();
+
+  PerfEstimator estimator(data);
+  return estimator.run();
+}
+
+// =====================================================================================================================
+// Run the estimator on the object.
+//
+// @returns : The estimate, or the Error if the object could not be decoded
+Expected<ObjectPerfEstimate> PerfEstimator::run() {
+  if (Error err = setUpTarget())
+    return std::move(err);
+
+  // The PAL metadata is read first, so that each function can be matched with its hardware stage.
+  if (Error err = readPalMetadata())
+    return std::move(err);
+
+  for (ELFSectionRef sectionRef : m_mc.objFile->sections()) {
+    if (!(sectionRef.getFlags() & ELF::SHF_EXECINSTR))
+      continue;
+    if (Error err = estimateSection(sectionRef))
+      return std::move(err);
+  }
+  return std::move(m_estimate);
+}
+
+// =====================================================================================================================
+// Decode the object file, and set up the MC objects for its target.
+//
+// @returns : Error::success() if no errors occurred, otherwise returns the Error object
+Error PerfEstimator::setUpTarget() {
+  if (Error err = m_mc.setUp(m_data))
+    return err;
+  if (m_mc.objFile->getArch() != Triple::amdgcn)
+    return createStringError("Is not an AMDGPU ELF object file");
+
+  m_estimate.cpu = m_mc.cpu;
+  m_isaVersion = AMDGPU::getIsaVersion(m_mc.cpu);
+  m_instrAnalysis.reset(m_mc.target->createMCInstrAnalysis(m_mc.instrInfo.get()));
+  return Error::success();
+}
+
+// =====================================================================================================================
+// Read the hardware stages from the PAL metadata in the .note sections, if any.
+//
+// @returns : Error::success() if no errors occurred, otherwise returns the Error object
+Error PerfEstimator::readPalMetadata() {
+  constexpr unsigned NoteHeaderSize = 12;
+  const endianness endian = m_mc.objFile->isLittleEndian() ? endianness::little : endianness::big;
+  for (ELFSectionRef sectionRef : m_mc.objFile->sections()) {
+    if (sectionRef.getType() != ELF::SHT_NOTE)
+      continue;
+    Expected<StringRef> expectedContents = sectionRef.getContents();
+    if (!expectedContents)
+      return expectedContents.takeError();
+
+    // Walk the note records, in the same way as the disassembler does.
+    StringRef data = *expectedContents;
+    while (data.size() >= NoteHeaderSize) {
+      unsigned nameSize = support::endian::read32(data.data(), endian);
+      unsigned descSize = support::endian::read32(data.data() + 4, endian);
+      unsigned type = support::endian::read32(data.data() + 8, endian);
+      unsigned descOffset = NoteHeaderSize + alignTo<4>(nameSize);
+      unsigned totalSize = descOffset + alignTo<4>(descSize);
+      if (totalSize > data.size())
+        break;
+      StringRef name = data.slice(NoteHeaderSize, NoteHeaderSize + nameSize).rtrim('\0');
+      if (name == "AMDGPU" && type == ELF::NT_AMDGPU_METADATA)
+        readPalMetadataNote(data.slice(descOffset, descOffset + descSize));
+      data = data.drop_front(totalSize);
+    }
+  }
+  return Error::success();
+}
+
+// =====================================================================================================================
+// Read the hardware stages from a PAL metadata note.
+//
+// @param desc : The msgpack blob of the note
+void PerfEstimator::readPalMetadataNote(StringRef desc) {
+  msgpack::Document document;
+  if (!document.readFromBlob(desc, false) || !document.getRoot().isMap())
+    return;
+  auto &root = document.getRoot().getMap();
+  auto pipelinesIt = root.find(StringRef("amdpal.pipelines"));
+  if (pipelinesIt == root.end() || !pipelinesIt->second.isArray() || pipelinesIt->second.getArray().empty() ||
+      !pipelinesIt->second.getArray()[0].isMap())
+    return;
+  auto &pipeline = pipelinesIt->second.getArray()[0].getMap();
+  auto hwStagesIt = pipeline.find(StringRef(".hardware_stages"));
+  if (hwStagesIt == pipeline.end() || !hwStagesIt->second.isMap())
+    return;
+
+  for (auto &entry : hwStagesIt->second.getMap()) {
+    if (!entry.first.isString() || !entry.second.isMap())
+      continue;
+    auto &stageMap = entry.second.getMap();
+    HwStageOccupancy &hwStage = m_estimate.hwStages.emplace_back();
+    hwStage.hwStage = entry.first.getString().str();
+    computeOccupancy(hwStage, stageMap);
+
+    // The entry point is named by .entry_point_symbol in newer metadata, and by .entry_point in older.
+    for (StringRef key : {".entry_point_symbol", ".entry_point"}) {
+      auto it = stageMap.find(key);
+      if (it != stageMap.end() && it->second.isString())
+        m_entryPointStages[it->second.getString()] = m_estimate.hwStages.size() - 1;
+    }
+  }
+}
+
+// =====================================================================================================================
+// Compute the occupancy limits of a hardware stage, in waves per SIMD, from its metadata. This is an estimate: it
+// assumes the register files and LDS of the smallest GPU of the generation, and ignores wave limits per workgroup.
+//
+// @param [in/out] hwStage : The hardware stage to compute the limits of
+// @param stageMap : The metadata of the hardware stage
+void PerfEstimator::computeOccupancy(HwStageOccupancy &hwStage, msgpack::MapDocNode &stageMap) const {
+  auto getUInt = [&](StringRef key, unsigned defaultValue) -> unsigned {
+    auto it = stageMap.find(key);
+    if (it == stageMap.end() || it->second.getKind() != msgpack::Type::UInt)
+      return defaultValue;
+    return it->second.getUInt();
+  };
+  hwStage.waveSize = getUInt(".wavefront_size", 64);
+  hwStage.vgprCount = getUInt(".vgpr_count", 0);
+  hwStage.sgprCount = getUInt(".sgpr_count", 0);
+  hwStage.ldsBytes = getUInt(".lds_size", 0);
+  hwStage.scratchBytes = getUInt(".scratch_memory_size", 0);
+
+  // The VGPR limit is estimated as in the rest of LGC. GFX9 also has 800 SGPRs per SIMD; GFX10+ has enough SGPRs for
+  // every wave.
+  const bool gfx9 = isGfx9();
+  const unsigned waveSize = std::max(hwStage.waveSize, 1u);
+  const unsigned maxWaves = getSimdLimits(m_isaVersion.Major, m_isaVersion.Minor, waveSize).maxWaves;
+  hwStage.vgprLimit = getWavesPerSimd(m_isaVersion.Major, m_isaVersion.Minor, hwStage.vgprCount, waveSize);
+  hwStage.sgprLimit = gfx9 ? std::min(maxWaves, 800 / unsigned(alignTo(std::max(hwStage.sgprCount, 1u), 16)))
+                           : maxWaves;
+
+  // LDS is shared by the workgroups on a CU (WGP on GFX10+), which has four SIMDs. The limit needs the workgroup
+  // size, so it is only known for stages with .threadgroup_dimensions.
+  hwStage.ldsLimit = maxWaves;
+  auto dimsIt = stageMap.find(StringRef(".threadgroup_dimensions"));
+  if (hwStage.ldsBytes != 0 && dimsIt != stageMap.end() && dimsIt->second.isArray()) {
+    unsigned threads = 1;
+    for (auto &dim : dimsIt->second.getArray())
+      threads *= dim.getKind() == msgpack::Type::UInt ? std::max(unsigned(dim.getUInt()), 1u) : 1u;
+    const unsigned ldsBytesPerCu = gfx9 ? 64 * 1024 : 128 * 1024;
+    unsigned workgroups = ldsBytesPerCu / hwStage.ldsBytes;
+    unsigned wavesPerWorkgroup = divideCeil(threads, waveSize);
+    hwStage.ldsLimit = std::min(maxWaves, workgroups * wavesPerWorkgroup / 4);
+  }
+
+  hwStage.occupancy = std::min({hwStage.vgprLimit, hwStage.sgprLimit, hwStage.ldsLimit});
+}
+
+// =====================================================================================================================
+// Estimate the functions in one code section.
+//
+// @param sectionRef : The code section
+// @returns : Error::success() if no errors occurred, otherwise returns the Error object
+Error PerfEstimator::estimateSection(ELFSectionRef sectionRef) {
+  Expected<StringRef> expectedContents = sectionRef.getContents();
+  if (!expectedContents)
+    return expectedContents.takeError();
+  StringRef contents = *expectedContents;
+
+  // Gather the function symbols of the section, sorted by offset.
+  struct FunctionSymbol {
+    uint64_t offset;
+    uint64_t size;
+    StringRef name;
+  };
+  SmallVector<FunctionSymbol> functions;
+  for (ELFSymbolRef symbolRef : m_mc.objFile->symbols()) {
+    if (symbolRef.getELFType() != ELF::STT_FUNC)
+      continue;
+    Expected<section_iterator> expectedSection = symbolRef.getSection();
+    if (!expectedSection)
+      return expectedSection.takeError();
+    if (*expectedSection != sectionRef)
+      continue;
+    Expected<uint64_t> expectedValue = symbolRef.getValue();
+    if (!expectedValue)
+      return expectedValue.takeError();
+    Expected<StringRef> expectedName = symbolRef.getName();
+    if (!expectedName)
+      return expectedName.takeError();
+    // In a linked ELF, the symbol value is an address rather than an offset in the section.
+    uint64_t offset = *expectedValue - sectionRef.getAddress();
+    if (offset < contents.size())
+      functions.push_back({offset, symbolRef.getSize(), *expectedName});
+  }
+  stable_sort(functions, [](const FunctionSymbol &lhs, const FunctionSymbol &rhs) { return lhs.offset < rhs.offset; });
+
+  for (unsigned idx = 0; idx != functions.size(); ++idx) {
+    const FunctionSymbol &function = functions[idx];
+    // A function without a size runs up to the next function, or the end of the section.
+    uint64_t end = idx + 1 != functions.size() ? functions[idx + 1].offset : contents.size();
+    if (function.size != 0)
+      end = std::min(end, function.offset + function.size);
+
+    ShaderPerfEstimate shader;
+    shader.name = function.name.str();
+    auto stageIt = m_entryPointStages.find(function.name);
+    if (stageIt == m_entryPointStages.end() && m_estimate.hwStages.size() == 1)
+      stageIt = m_entryPointStages.begin();
+    if (stageIt != m_entryPointStages.end()) {
+      const HwStageOccupancy &hwStage = m_estimate.hwStages[stageIt->second];
+      shader.hwStage = hwStage.hwStage;
+      shader.waveSize = hwStage.waveSize;
+    }
+    estimateFunction(contents, function.offset, end, shader);
+    m_estimate.shaders.push_back(std::move(shader));
+  }
+  return Error::success();
+}
+
+// =====================================================================================================================
+// Estimate one function. Its instructions are split into basic blocks at branches and branch targets, and walked in
+// layout order. Memory instructions still outstanding at the end of a block are carried into the next block if
+// execution can fall through into it, and are otherwise forgotten.
+//
+// @param contents : The contents of the code section
+// @param begin : Offset of the start of the function
+// @param end : Offset of the end of the function
+// @param [in/out] shader : The estimate of the function
+void PerfEstimator::estimateFunction(StringRef contents, uint64_t begin, uint64_t end, ShaderPerfEstimate &shader) {
+  // Decode the instructions. Anything that does not decode is skipped a dword at a time, and s_code_end padding
+  // is not counted.
+  std::vector<DecodedInst> insts;
+  for (uint64_t offset = begin; offset < end;) {
+    DecodedInst inst = decodeInst(contents.slice(0, end), offset);
+    if (inst.size == 0) {
+      offset += 4;
+      continue;
+    }
+    offset += inst.size;
+    if (inst.baseName != "S_CODE_END")
+      insts.push_back(std::move(inst));
+  }
+
+  // Find the block leaders: the first instruction, branch targets, and instructions after a block end.
+  std::set<uint64_t> leaders = {begin};
+  for (const DecodedInst &inst : insts) {
+    if (inst.target && *inst.target >= begin && *inst.target < end)
+      leaders.insert(*inst.target);
+    if (inst.endsBlock)
+      leaders.insert(inst.offset + inst.size);
+  }
+
+  std::array<std::deque<uint64_t>, unsigned(PerfCounter::Count)> outstanding; // Completion cycles, oldest first
+  uint64_t cycle = 0;
+  bool fallsThrough = false;
+  PerfBlockEstimate *block = nullptr;
+  for (const DecodedInst &inst : insts) {
+    if (!block || leaders.count(inst.offset)) {
+      if (block && !fallsThrough) {
+        for (auto &queue : outstanding)
+          queue.clear();
+      }
+      block = &shader.blocks.emplace_back();
+      block->offset = inst.offset;
+    }
+
+    ++block->instCount;
+    ++shader.instCounts[unsigned(inst.kind)];
+    shader.codeBytes += inst.size;
+
+    if (inst.kind == PerfInstKind::Wait) {
+      // Stall until every counter is down to the count waited for. Each counter completes in order.
+      WaitCounts waitCounts = getWaitCounts(inst);
+      uint64_t readyCycle = cycle;
+      unsigned counterMask = 0;
+      for (unsigned counter = 0; counter != unsigned(PerfCounter::Count); ++counter) {
+        if (!waitCounts[counter])
+          continue;
+        auto &queue = outstanding[counter];
+        while (queue.size() > *waitCounts[counter]) {
+          if (queue.front() > cycle) {
+            readyCycle = std::max(readyCycle, queue.front());
+            counterMask |= 1u << counter;
+          }
+          queue.pop_front();
+        }
+      }
+      if (readyCycle > cycle) {
+        unsigned stall = readyCycle - cycle;
+        shader.stallPoints.push_back({inst.offset, counterMask, stall});
+        block->stallCycles += stall;
+        shader.stallCycles += stall;
+        cycle = readyCycle;
+      }
+    }
+
+    unsigned issue = getIssueCycles(inst, shader.waveSize);
+    block->issueCycles += issue;
+    shader.issueCycles += issue;
+    cycle += issue;
+
+    if (std::optional<PerfCounter> counter = getCounter(inst)) {
+      auto &queue = outstanding[unsigned(*counter)];
+      uint64_t completion = cycle + CounterLatencies[unsigned(*counter)];
+      queue.push_back(queue.empty() ? completion : std::max(completion, queue.back()));
+    }
+    fallsThrough = inst.fallsThrough;
+  }
+}
+
+// =====================================================================================================================
+// Decode and classify the instruction at a given offset.
+//
+// @param contents : The bytes of the section, up to the end of the function
+// @param offset : The offset of the instruction
+// @returns : The instruction, with a size of 0 if it could not be decoded
+DecodedInst PerfEstimator::decodeInst(StringRef contents, uint64_t offset) {
+  DecodedInst inst;
+  inst.offset = offset;
+  uint64_t size = 0;
+  ArrayRef<uint8_t> bytes(reinterpret_cast<const uint8_t *>(contents.data()), contents.size());
+  if (m_mc.instDisassembler->getInstruction(inst.mcInst, size, bytes.slice(offset), offset, nulls()) ==
+          MCDisassembler::Fail ||
+      size == 0)
+    return inst;
+  inst.size = size;
+
+  // The opcodes that the disassembler decodes are the real ones of the encoding, such as S_WAITCNT_gfx11. The suffix
+  // of the encoding is the first part of the name that starts with a lower case letter.
+  StringRef name = m_mc.instrInfo->getName(inst.mcInst.getOpcode());
+  size_t suffixPos = 0;
+  while ((suffixPos = name.find('_', suffixPos + 1)) != StringRef::npos) {
+    if (suffixPos + 1 < name.size() && isLower(name[suffixPos + 1]))
+      break;
+  }
+  inst.baseName = name.take_front(suffixPos);
+  inst.kind = classifyInst(inst.mcInst, inst.baseName);
+
+  if (inst.kind == PerfInstKind::Branch) {
+    // Calls return to the next instruction, so do not end a block.
+    const MCInstrDesc &desc = m_mc.instrInfo->get(inst.mcInst.getOpcode());
+    if (desc.isCall())
+      return inst;
+    inst.endsBlock = true;
+    inst.fallsThrough = !desc.isBarrier();
+    uint64_t target = 0;
+    if (m_instrAnalysis && m_instrAnalysis->evaluateBranch(inst.mcInst, offset, size, target))
+      inst.target = target;
+  }
+  return inst;
+}
+
+// =====================================================================================================================
+// Classify an instruction by the flags of its instruction description.
+//
+// @param mcInst : The instruction
+// @param baseName : The name of its opcode without the encoding suffix
+// @returns : The kind of instruction
+PerfInstKind PerfEstimator::classifyInst(const MCInst &mcInst, StringRef baseName) const {
+  const MCInstrDesc &desc = m_mc.instrInfo->get(mcInst.getOpcode());
+  const uint64_t tsFlags = desc.TSFlags;
+
+  if (baseName.starts_with("S_WAITCNT") || baseName.starts_with("S_WAIT_"))
+    return PerfInstKind::Wait;
+  if (desc.isBranch() || desc.isCall() || desc.isReturn() || desc.isTerminator())
+    return PerfInstKind::Branch;
+  if (tsFlags & SIInstrFlags::SMRD)
+    return PerfInstKind::Smem;
+  if (tsFlags & SIInstrFlags::SOPP)
+    return PerfInstKind::Other;
+  if (tsFlags & SIInstrFlags::SALU)
+    return PerfInstKind::Salu;
+  if (tsFlags & (SIInstrFlags::MUBUF | SIInstrFlags::MTBUF | SIInstrFlags::MIMG | SIInstrFlags::VIMAGE |
+                 SIInstrFlags::VSAMPLE | SIInstrFlags::FLAT))
+    return PerfInstKind::Vmem;
+  if (tsFlags & SIInstrFlags::DS)
+    return PerfInstKind::Lds;
+  if (tsFlags & SIInstrFlags::EXP)
+    return PerfInstKind::Export;
+  if (tsFlags & SIInstrFlags::VALU) {
+    // 64-bit float instructions are the ones with a 64-bit float operand.
+    if ((tsFlags & SIInstrFlags::TRANS) || any_of(desc.operands(), [](const MCOperandInfo &operandInfo) {
+          return operandInfo.OperandType == AMDGPU::OPERAND_REG_IMM_FP64 ||
+                 operandInfo.OperandType == AMDGPU::OPERAND_REG_INLINE_C_FP64;
+        }))
+      return PerfInstKind::ValuTrans;
+    return PerfInstKind::Valu;
+  }
+  return PerfInstKind::Other;
+}
+
+// =====================================================================================================================
+// Get the counter that a memory instruction increments.
+//
+// @param inst : The instruction
+// @returns : The counter, or std::nullopt if it does not increment one that is modeled
+std::optional<PerfCounter> PerfEstimator::getCounter(const DecodedInst &inst) const {
+  switch (inst.kind) {
+  case PerfInstKind::Smem:
+    return PerfCounter::Smem;
+  case PerfInstKind::Vmem: {
+    // GFX9 counts stores with loads in vmcnt. GFX10+ counts stores and atomics without return in vscnt.
+    const MCInstrDesc &desc = m_mc.instrInfo->get(inst.mcInst.getOpcode());
+    if (!isGfx9() && desc.mayStore() && (!desc.mayLoad() || (desc.TSFlags & SIInstrFlags::IsAtomicNoRet)))
+      return PerfCounter::VmemStore;
+    return PerfCounter::VmemLoad;
+  }
+  case PerfInstKind::Lds:
+    return PerfCounter::Lds;
+  case PerfInstKind::Export:
+    return PerfCounter::Export;
+  default:
+    return std::nullopt;
+  }
+}
+
+// =====================================================================================================================
+// Get the estimated cycles to issue an instruction for one wave. A GFX9 SIMD is 16 lanes wide, so takes four cycles
+// over a wave64 VALU instruction; a GFX10+ SIMD is 32 lanes wide, so takes one cycle in wave32 and two in wave64.
+// Transcendental and 64-bit float instructions are modeled as quarter rate.
+//
+// @param inst : The instruction
+// @param waveSize : The wave size
+// @returns : The issue cycles
+unsigned PerfEstimator::getIssueCycles(const DecodedInst &inst, unsigned waveSize) const {
+  const unsigned vectorCycles = isGfx9() ? 4 : std::max(waveSize / 32, 1u);
+  switch (inst.kind) {
+  case PerfInstKind::Valu:
+  case PerfInstKind::Vmem:
+  case PerfInstKind::Lds:
+    return vectorCycles;
+  case PerfInstKind::ValuTrans:
+    return 4 * vectorCycles;
+  case PerfInstKind::Other: {
+    const MCInst &mcInst = inst.mcInst;
+    if (inst.baseName == "S_NOP" && mcInst.getNumOperands() != 0 && mcInst.getOperand(0).isImm())
+      return mcInst.getOperand(0).getImm() + 1;
+    return 1;
+  }
+  default:
+    return 1;
+  }
+}
+
+// =====================================================================================================================
+// Get the counts that a wait instruction waits for each counter to come down to, from its immediate operand. This
+// understands the combined s_waitcnt of all generations, the separate s_waitcnt_<counter> of GFX10+, and the
+// s_wait_<counter> of GFX12.
+//
+// @param inst : The wait instruction
+// @returns : The count waited for on each counter that it waits on
+WaitCounts PerfEstimator::getWaitCounts(const DecodedInst &inst) const {
+  WaitCounts waitCounts;
+  auto setCount = [&](PerfCounter counter, unsigned count) {
+    std::optional<unsigned> &waitCount = waitCounts[unsigned(counter)];
+    waitCount = waitCount ? std::min(*waitCount, count) : count;
+  };
+
+  // The count is the last immediate operand, after a null SGPR for s_waitcnt_<counter>.
+  const MCInst &mcInst = inst.mcInst;
+  std::optional<unsigned> imm;
+  for (unsigned opIdx = mcInst.getNumOperands(); opIdx-- != 0 && !imm;) {
+    if (mcInst.getOperand(opIdx).isImm())
+      imm = mcInst.getOperand(opIdx).getImm();
+  }
+  if (!imm)
+    return waitCounts;
+  const unsigned count = *imm;
+
+  StringRef name = inst.baseName;
+  if (name == "S_WAITCNT") {
+    // The combined count has a field for each counter, at positions that depend on the generation.
+    unsigned vmCount = 0;
+    unsigned expCount = 0;
+    unsigned lgkmCount = 0;
+    if (m_isaVersion.Major >= 11) {
+      vmCount = (count >> 10) & 0x3F;
+      expCount = count & 0x7;
+      lgkmCount = (count >> 4) & 0x3F;
+    } else {
+      vmCount = (count & 0xF) | (m_isaVersion.Major >= 9 ? ((count >> 14) & 0x3) << 4 : 0);
+      expCount = (count >> 4) & 0x7;
+      lgkmCount = (count >> 8) & (m_isaVersion.Major >= 10 ? 0x3F : 0xF);
+    }
+    setCount(PerfCounter::VmemLoad, vmCount);
+    setCount(PerfCounter::Export, expCount);
+    setCount(PerfCounter::Smem, lgkmCount);
+    setCount(PerfCounter::Lds, lgkmCount);
+    return waitCounts;
+  }
+
+  if (name == "S_WAIT_IDLE") {
+    for (unsigned counter = 0; counter != unsigned(PerfCounter::Count); ++counter)
+      setCount(PerfCounter(counter), 0);
+    return waitCounts;
+  }
+
+  if (!name.consume_front("S_WAITCNT_"))
+    name.consume_front("S_WAIT_");
+
+  // Combined waits have the DS count in bits [5:0] and the other count in bits [13:8].
+  unsigned otherCount = count;
+  if (name != "DSCNT" && name.consume_back("_DSCNT")) {
+    setCount(PerfCounter::Lds, count & 0x3F);
+    otherCount = (count >> 8) & 0x3F;
+  }
+
+  // The counters that the remaining counter name refers to.
+  const unsigned VmemLoadMask = 1u << unsigned(PerfCounter::VmemLoad);
+  const unsigned VmemStoreMask = 1u << unsigned(PerfCounter::VmemStore);
+  const unsigned SmemMask = 1u << unsigned(PerfCounter::Smem);
+  const unsigned LdsMask = 1u << unsigned(PerfCounter::Lds);
+  unsigned counterMask = StringSwitch<unsigned>(name)
+                             .Case("VMCNT", VmemLoadMask)
+                             .Case("LOADCNT", VmemLoadMask)
+                             .Case("SAMPLECNT", VmemLoadMask)
+                             .Case("BVHCNT", VmemLoadMask)
+                             .Case("VSCNT", VmemStoreMask)
+                             .Case("STORECNT", VmemStoreMask)
+                             .Case("LGKMCNT", SmemMask | LdsMask)
+                             .Case("KMCNT", SmemMask)
+                             .Case("DSCNT", LdsMask)
+                             .Case("EXPCNT", 1u << unsigned(PerfCounter::Export))
+                             .Default(0);
+  for (unsigned counter = 0; counter != unsigned(PerfCounter::Count); ++counter) {
+    if (counterMask & (1u << counter))
+      setCount(PerfCounter(counter), otherCount);
+  }
+  return waitCounts;
+}
+
+// =====================================================================================================================
+// Output a performance estimate, as text or as JSON.
+//
+// @param estimate : The estimate to output
+// @param ostream : The stream to output into
+// @param json : True to output JSON, false to output text
+void lgc::printObjectPerfEstimate(const ObjectPerfEstimate &estimate, raw_ostream &ostream, bool json) {
+  auto getCounterNames = [](unsigned counterMask) {
+    SmallVector<StringRef> names;
+    for (unsigned counter = 0; counter != unsigned(PerfCounter::Count); ++counter) {
+      if (counterMask & (1u << counter))
+        names.push_back(getPerfCounterName(PerfCounter(counter)));
+    }
+    return names;
+  };
+
+  if (json) {
+    json::Array shaders;
+    for (const ShaderPerfEstimate &shader : estimate.shaders) {
+      json::Object instCounts;
+      for (unsigned kind = 0; kind != unsigned(PerfInstKind::Count); ++kind)
+        instCounts[getPerfInstKindName(PerfInstKind(kind))] = shader.instCounts[kind];
+      json::Array blocks;
+      for (const PerfBlockEstimate &block : shader.blocks) {
+        blocks.push_back(json::Object{{"offset", block.offset},
+                                      {"instructions", block.instCount},
+                                      {"issueCycles", block.issueCycles},
+                                      {"stallCycles", block.stallCycles}});
+      }
+      json::Array stallPoints;
+      for (const PerfStallPoint &stallPoint : shader.stallPoints) {
+        json::Array counters;
+        for (StringRef name : getCounterNames(stallPoint.counterMask))
+          counters.push_back(name);
+        stallPoints.push_back(json::Object{{"offset", stallPoint.offset},
+                                           {"counters", std::move(counters)},
+                                           {"stallCycles", stallPoint.stallCycles}});
+      }
+      shaders.push_back(json::Object{{"name", shader.name},
+                                     {"hwStage", shader.hwStage},
+                                     {"waveSize", shader.waveSize},
+                                     {"codeBytes", shader.codeBytes},
+                                     {"instructions", std::move(instCounts)},
+                                     {"issueCycles", shader.issueCycles},
+                                     {"stallCycles", shader.stallCycles},
+                                     {"blocks", std::move(blocks)},
+                                     {"stallPoints", std::move(stallPoints)}});
+    }
+    json::Array hwStages;
+    for (const HwStageOccupancy &hwStage : estimate.hwStages) {
+      hwStages.push_back(json::Object{{"hwStage", hwStage.hwStage},
+                                      {"waveSize", hwStage.waveSize},
+                                      {"vgprCount", hwStage.vgprCount},
+                                      {"sgprCount", hwStage.sgprCount},
+                                      {"ldsBytes", hwStage.ldsBytes},
+                                      {"scratchBytes", hwStage.scratchBytes},
+                                      {"vgprLimit", hwStage.vgprLimit},
+                                      {"sgprLimit", hwStage.sgprLimit},
+                                      {"ldsLimit", hwStage.ldsLimit},
+                                      {"occupancy", hwStage.occupancy}});
+    }
+    json::Object root{{"cpu", estimate.cpu}, {"shaders", std::move(shaders)}, {"hwStages", std::move(hwStages)}};
+    ostream << formatv("{0:2}", json::Value(std::move(root))) << "\n";
+    return;
+  }
+
+  ostream << "// Performance estimate for " << estimate.cpu << "\n";
+  for (const ShaderPerfEstimate &shader : estimate.shaders) {
+    ostream << shader.name << ": stage " << (shader.hwStage.empty() ? "unknown" : shader.hwStage) << ", wave"
+            << shader.waveSize << ", " << shader.codeBytes << " bytes\n";
+    ostream << "  instructions:";
+    for (unsigned kind = 0; kind != unsigned(PerfInstKind::Count); ++kind)
+      ostream << (kind == 0 ? " " : ", ") << getPerfInstKindName(PerfInstKind(kind)) << " " << shader.instCounts[kind];
+    ostream << "\n  cycles: issue " << shader.issueCycles << ", stall " << shader.stallCycles << "\n";
+    for (const PerfBlockEstimate &block : shader.blocks) {
+      ostream << "  block " << format_hex(block.offset, 6) << ": instructions " << block.instCount << ", issue "
+              << block.issueCycles << ", stall " << block.stallCycles << "\n";
+    }
+    for (const PerfStallPoint &stallPoint : shader.stallPoints) {
+      ostream << "  stall " << format_hex(stallPoint.offset, 6) << ": " << stallPoint.stallCycles << " cycles on "
+              << join(getCounterNames(stallPoint.counterMask), ", ") << "\n";
+    }
+  }
+  for (const HwStageOccupancy &hwStage : estimate.hwStages) {
+    ostream << "hardware stage " << hwStage.hwStage << ": wave" << hwStage.waveSize << ", vgprs " << hwStage.vgprCount
+            << ", sgprs " << hwStage.sgprCount << ", lds " << hwStage.ldsBytes << " bytes, scratch "
+            << hwStage.scratchBytes << " bytes, occupancy " << hwStage.occupancy << " (vgpr limit "
+            << hwStage.vgprLimit << ", sgpr limit " << hwStage.sgprLimit << ", lds limit " << hwStage.ldsLimit
+            << ")\n";
+  }
+}
@@ -162,9 +162,9 @@ Module *ColorExportShader::generate() {
   // Set pipeline hash.
   auto internalPipelineHash =
       palMetadata.getPipelineNode()[Util::Abi::PipelineMetadataKey::InternalPipelineHash].getArray(true);
-  const auto &options = m_pipelineState->getOptions();
-  internalPipelineHash[0] = options.hash[0];
-  internalPipelineHash[1] = options.hash[1];
+  auto [hashLow, hashHigh] = getInternalPipelineHash();
+  internalPipelineHash[0] = hashLow;
+  internalPipelineHash[1] = hashHigh;
 
   palMetadata.updateDbShaderControl();
   palMetadata.record(colorExportFunc->getParent());
@@ -215,7 +215,7 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
     return false;
 
   // Initialize symbol table and string table
-  m_symbols.push_back({});
+  addSymbol({});
   m_strings = std::string("", 1);
   m_stringMap[""] = 0;
   // Pre-create four fixed sections at the start:
@@ -237,17 +237,25 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
   bool relSectionCreated = false;
   bool relaSectionCreated = false;
 
+  // Map from output section name to index, so same-named input sections can be put together without a scan of
+  // the output sections for each one. The first output section of a given name wins, as with a linear search.
+  StringMap<unsigned> outputSectionMap;
+  for (unsigned idx = 1; idx != m_outputSections.size(); ++idx)
+    outputSectionMap.try_emplace(m_outputSections[idx].getName(), idx);
+
   // Allocate input sections to output sections.
   for (auto &elfInput : m_elfInputs) {
     for (const object::SectionRef &section : elfInput.objectFile->sections()) {
       unsigned sectType = object::ELFSectionRef(section).getType();
       if (sectType == ELF::SHT_REL) {
         if (!relSectionCreated && !section.relocations().empty()) {
+          outputSectionMap.try_emplace(".rel.text", m_outputSections.size());
           m_outputSections.push_back(OutputSection(this, ".rel.text", ELF::SHT_REL));
           relSectionCreated = true;
         }
       } else if (sectType == ELF::SHT_RELA) {
         if (!relaSectionCreated && !section.relocations().empty()) {
+          outputSectionMap.try_emplace(".rela.text", m_outputSections.size());
           m_outputSections.push_back(OutputSection(this, ".rela.text", ELF::SHT_RELA));
           relaSectionCreated = true;
         }
@@ -257,17 +265,11 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
         bool reduceAlign = false;
         if (elfInput.reduceAlign != "")
           reduceAlign = name == elfInput.reduceAlign;
-        for (unsigned idx = 1;; ++idx) {
-          if (idx == m_outputSections.size()) {
-            m_outputSections.push_back(OutputSection(this));
-            m_outputSections[idx].addInputSection(elfInput, section, reduceAlign);
-            break;
-          }
-          if (name == m_outputSections[idx].getName()) {
-            m_outputSections[idx].addInputSection(elfInput, section, reduceAlign);
-            break;
-          }
-        }
+        auto outputSectionIt = outputSectionMap.try_emplace(name, m_outputSections.size()).first;
+        unsigned idx = outputSectionIt->second;
+        if (idx == m_outputSections.size())
+          m_outputSections.push_back(OutputSection(this));
+        m_outputSections[idx].addInputSection(elfInput, section, reduceAlign);
       }
     }
   }
@@ -356,6 +358,16 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
     }
   }
 
+  // Reserve space in the output for everything whose size is now known, so that streaming the sections into an
+  // in-memory output does not keep reallocating it. This is only a hint: the .note section is not yet written, and
+  // the end padding of .text is approximated by the section alignment.
+  uint64_t expectedSize = m_strings.size() + m_symbols.size() * sizeof(ELF::Elf64_Sym) +
+                          m_relocations.size() * sizeof(ELF::Elf64_Rel) +
+                          m_relocationsA.size() * sizeof(ELF::Elf64_Rela);
+  for (const OutputSection &outputSection : m_outputSections)
+    expectedSize += outputSection.getSize() + outputSection.getAlignment().value();
+  outStream.reserveExtraSpace(expectedSize);
+
   // Output each section, and let it set its section table entry.
   // Ensure each section is aligned in the file by the minimum of 4 and its address alignment requirement.
   // I am not sure if that is actually required by the ELF standard, but vkgcPipelineDumper.cpp relies on
@@ -415,17 +427,26 @@ unsigned ElfLinkerImpl::findStringIndex(StringRef string) {
   return m_stringMap.lookup(string);
 }
 
+// =====================================================================================================================
+// Add symbol to output ELF. The symbol is indexed by its name so that findSymbol does not need to scan the
+// symbol table; if there is already a symbol of the same name, findSymbol continues to return the first one.
+//
+// @param sym : Symbol to add, with st_name already set to its string table index
+// @returns : Index of the new symbol in the symbol table
+unsigned ElfLinkerImpl::addSymbol(const ELF::Elf64_Sym &sym) {
+  unsigned symIdx = m_symbols.size();
+  m_symbols.push_back(sym);
+  m_symbolMap.try_emplace(sym.st_name, symIdx);
+  return symIdx;
+}
+
 // =====================================================================================================================
 // Find symbol in output ELF
 //
 // @param nameIndex : Index of symbol name in string table
 // @returns : Index in symbol table, or 0 if not found
 unsigned ElfLinkerImpl::findSymbol(unsigned nameIndex) {
-  for (auto &sym : getSymbols()) {
-    if (sym.st_name == nameIndex)
-      return &sym - getSymbols().data();
-  }
-  return 0;
+  return m_symbolMap.lookup(nameIndex);
 }
 
 // =====================================================================================================================
@@ -710,6 +731,7 @@ void OutputSection::layout() {
     // Add on the size for this section.
     size += inputSection.size;
   }
+  m_size = size;
   if (m_type == ELF::SHT_NOTE)
     m_alignment = Align(4);
 }
@@ -745,7 +767,7 @@ void OutputSection::addSymbol(const object::ELFSymbolRef &elfSymRef, unsigned in
   newSym.st_size = elfSymRef.getSize();
   if (m_linker->findSymbol(newSym.st_name) != 0)
     report_fatal_error("Duplicate symbol '" + name + "'");
-  m_linker->getSymbols().push_back(newSym);
+  m_linker->addSymbol(newSym);
 }
 
 // Add a relocation to the output elf
@@ -766,8 +788,7 @@ void OutputSection::addRelocation(object::ELFRelocationRef relocRef, StringRef i
     newSym.st_shndx = getIndex();
     newSym.st_value = relocSectionOffset + cantFail(relocSymRef.getValue());
     newSym.st_size = relocSymRef.getSize();
-    rodataSymIdx = m_linker->getSymbols().size();
-    m_linker->getSymbols().push_back(newSym);
+    rodataSymIdx = m_linker->addSymbol(newSym);
   }
 
   auto newOffset = relocRef.getOffset();
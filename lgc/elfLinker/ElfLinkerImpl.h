@@ -32,6 +32,7 @@
 
 #include "GlueShader.h"
 #include "lgc/ElfLinker.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include <unordered_map>
@@ -93,6 +94,9 @@ public:
   // Get the overall alignment requirement, after calling layout().
   llvm::Align getAlignment() const { return m_alignment; }
 
+  // Get the size of the contributions from input sections, after calling layout(). This excludes end padding.
+  uint64_t getSize() const { return m_size; }
+
   // Write the output section
   void write(llvm::raw_pwrite_stream &outStream, llvm::ELF::Elf64_Shdr *shdr);
 
@@ -114,6 +118,7 @@ private:
   llvm::StringRef m_name;                             // Section name
   unsigned m_type;                                    // Section type (SHT_* value)
   uint64_t m_offset = 0;                              // File offset of this output section
+  uint64_t m_size = 0;                                // Size of input section contributions, set by layout()
   llvm::SmallVector<InputSection, 4> m_inputSections; // Input sections contributing to this output section
   llvm::Align m_alignment;                            // Overall alignment required for the section
   unsigned m_reduceAlign = 0;                         // Bitmap of input sections to reduce alignment for
@@ -166,7 +171,7 @@ public:
   lgc::PipelineState *getPipelineState() const { return m_pipelineState; }
   llvm::ArrayRef<OutputSection> getOutputSections() { return m_outputSections; }
   llvm::StringRef getStrings() { return m_strings; }
-  llvm::SmallVectorImpl<llvm::ELF::Elf64_Sym> &getSymbols() { return m_symbols; }
+  llvm::ArrayRef<llvm::ELF::Elf64_Sym> getSymbols() { return m_symbols; }
   llvm::SmallVectorImpl<llvm::ELF::Elf64_Rel> &getRelocations() { return m_relocations; }
   llvm::SmallVectorImpl<llvm::ELF::Elf64_Rela> &getRelocationsA() { return m_relocationsA; }
   void setStringTableIndex(unsigned index) { m_ehdr.e_shstrndx = index; }
@@ -178,6 +183,9 @@ public:
   // Get string index in output ELF.  Returns 0 if not found.
   unsigned findStringIndex(llvm::StringRef string);
 
+  // Add symbol to output ELF, returning its index in the symbol table.
+  unsigned addSymbol(const llvm::ELF::Elf64_Sym &sym);
+
   // Find symbol in output ELF. Returns 0 if not found.
   unsigned findSymbol(unsigned nameIndex);
   unsigned findSymbol(llvm::StringRef name);
@@ -220,7 +228,7 @@ private:
   llvm::SmallVector<llvm::ELF::Elf64_Sym, 8> m_symbols;                 // Symbol table
   llvm::SmallVector<llvm::ELF::Elf64_Rel, 8> m_relocations;             // Relocations
   llvm::SmallVector<llvm::ELF::Elf64_Rela, 8> m_relocationsA;           // Relocations with explicit addend
-  llvm::StringMap<unsigned> m_symbolMap;                                // Map from name to symbol index
+  llvm::DenseMap<unsigned, unsigned> m_symbolMap;                       // Map from name string index to symbol index
   std::string m_strings;                                                // Strings for string table
   llvm::StringMap<unsigned> m_stringMap;                                // Map from string to string table index
   std::string m_notes;                                                  // Notes to go in .note section
@@ -32,17 +32,130 @@
 #include "GlueShader.h"
 #include "ColorExportShader.h"
 #include "NullFragmentShader.h"
+#include "lgc/Debug.h"
+#include "lgc/state/AbiMetadata.h"
+#include "lgc/state/GlueShaderTemplateCache.h"
 #include "lgc/state/PassManagerCache.h"
 #include "llvm-dialects/Dialect/Dialect.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELF.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Target/TargetMachine.h"
+
+#define DEBUG_TYPE "lgc-glue-shader"
 
 using namespace lgc;
 using namespace llvm;
 
+// -glue-shader-templates: instantiate glue shaders from templates instead of compiling each one
+static cl::opt<bool> UseGlueShaderTemplates("glue-shader-templates",
+                                            cl::desc("Instantiate glue shaders from previously compiled templates "
+                                                     "instead of running code generation for each one"),
+                                            cl::init(true));
+
+namespace {
+
+// Placeholder internal pipeline hash recorded in the PAL metadata of a template. Both words have the top bit set, so
+// MsgPack encodes each of them as a uint64 (0xcf followed by 8 big-endian bytes), and they can be replaced in place.
+constexpr uint64_t PlaceholderPipelineHash[] = {0xF1E2D3C4B5A69788, 0x8897A6B5C4D3E2F1};
+
+// =====================================================================================================================
+// Find where the placeholder internal pipeline hash words are in the PAL metadata note of a template just compiled.
+// This is done once per template, so that instantiating it only needs to patch those offsets.
+//
+// @param elf : ELF of the template
+// @returns : {offset in the ELF, hash word index} of each placeholder hash word
+SmallVector<std::pair<size_t, unsigned>, 2> findPlaceholderHashWords(StringRef elf) {
+  SmallVector<std::pair<size_t, unsigned>, 2> hashWordOffsets;
+  auto elfFile = object::ELFFile<object::ELF64LE>::create(elf);
+  if (!elfFile) {
+    consumeError(elfFile.takeError());
+    return hashWordOffsets;
+  }
+  auto sections = elfFile->sections();
+  if (!sections) {
+    consumeError(sections.takeError());
+    return hashWordOffsets;
+  }
+  for (const auto &shdr : *sections) {
+    if (shdr.sh_type != ELF::SHT_NOTE)
+      continue;
+    Error err = Error::success();
+    for (auto note : elfFile->notes(shdr, err)) {
+      if (note.getName() != Util::Abi::AmdGpuArchName || note.getType() != ELF::NT_AMDGPU_METADATA)
+        continue;
+      ArrayRef<uint8_t> desc = note.getDesc(shdr.sh_addralign);
+      StringRef metadata(reinterpret_cast<const char *>(desc.data()), desc.size());
+      size_t metadataOffset = metadata.data() - elf.data();
+      for (unsigned idx = 0; idx != std::size(PlaceholderPipelineHash); ++idx) {
+        char placeholder[9] = {'\xcf'};
+        support::endian::write64be(&placeholder[1], PlaceholderPipelineHash[idx]);
+        size_t pos = metadata.find(StringRef(placeholder, sizeof(placeholder)));
+        if (pos != StringRef::npos)
+          hashWordOffsets.push_back({metadataOffset + pos + 1, idx});
+      }
+    }
+    consumeError(std::move(err));
+  }
+  return hashWordOffsets;
+}
+
+} // anonymous namespace
+
 // =====================================================================================================================
-// Compile the glue shader
+// Compile the glue shader, instantiating it from the LgcContext's template cache if possible. A glue shader missing
+// from the cache is compiled as a template, which is added to the cache and then instantiated.
 //
 // @param [in/out] outStream : Stream to write ELF to
 void GlueShader::compile(raw_pwrite_stream &outStream) {
+  if (!UseGlueShaderTemplates) {
+    compileWithCodegen(outStream);
+    return;
+  }
+
+  // The glue shader's string identifies it on a given target, but it does not include everything that the code depends
+  // on: the GPU, the fragment shader wave size that the glue shader is compiled with, and the codegen optimization
+  // level, which is reduced for pipelines compiled with reduced optimization.
+  GlueShaderTemplateCache *templateCache = m_lgcContext->getGlueShaderTemplateCache();
+  TargetMachine *targetMachine = m_lgcContext->getTargetMachine();
+  std::string key;
+  raw_string_ostream keyStream(key);
+  keyStream << getName() << '\0' << getString() << '\0' << targetMachine->getTargetCPU() << '\0'
+            << m_pipelineState->getShaderWaveSize(ShaderStage::Fragment) << '\0'
+            << static_cast<unsigned>(targetMachine->getOptLevel());
+  keyStream.flush();
+  GlueShaderTemplate newTemplate;
+  const GlueShaderTemplate *glueShaderTemplate = templateCache->find(key);
+  if (glueShaderTemplate) {
+    LLPC_OUTS("Instantiating " << getName() << " from a template\n");
+  } else {
+    raw_string_ostream templateStream(newTemplate.elf);
+    m_compilingTemplate = true;
+    compileWithCodegen(templateStream);
+    m_compilingTemplate = false;
+    templateStream.flush();
+    newTemplate.hashWordOffsets = findPlaceholderHashWords(newTemplate.elf);
+    glueShaderTemplate = &newTemplate;
+  }
+
+  // Patch the placeholder internal pipeline hash with the one of the pipeline being linked.
+  std::string instance = glueShaderTemplate->elf;
+  auto [hashLow, hashHigh] = getInternalPipelineHash();
+  const uint64_t hashWords[] = {hashLow, hashHigh};
+  for (auto [offset, wordIdx] : glueShaderTemplate->hashWordOffsets)
+    support::endian::write64be(&instance[offset], hashWords[wordIdx]);
+  outStream << instance;
+
+  if (glueShaderTemplate == &newTemplate && !newTemplate.elf.empty())
+    templateCache->insert(key, std::move(newTemplate));
+}
+
+// =====================================================================================================================
+// Compile the glue shader through the LLVM backend
+//
+// @param [in/out] outStream : Stream to write ELF to
+void GlueShader::compileWithCodegen(raw_pwrite_stream &outStream) {
   // Generate the glue shader IR module.
   std::unique_ptr<Module> module(generate());
 
@@ -60,6 +173,16 @@ void GlueShader::compile(raw_pwrite_stream &outStream) {
   m_lgcContext->getPassManagerCache()->resetStream();
 }
 
+// =====================================================================================================================
+// Get the internal pipeline hash to record in the PAL metadata of the glue shader. While the glue shader is compiled
+// as a template, this is a placeholder that is patched with the pipeline's hash when the template is instantiated.
+std::pair<uint64_t, uint64_t> GlueShader::getInternalPipelineHash() const {
+  if (m_compilingTemplate)
+    return {PlaceholderPipelineHash[0], PlaceholderPipelineHash[1]};
+  const auto &options = m_pipelineState->getOptions();
+  return {options.hash[0], options.hash[1]};
+}
+
 // =====================================================================================================================
 // Create a color export shader object
 std::unique_ptr<GlueShader> GlueShader::createColorExportShader(PipelineState *pipelineState,
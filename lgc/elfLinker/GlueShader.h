@@ -94,13 +94,20 @@ protected:
   // Generate the IR module for the glue shader
   virtual llvm::Module *generate() = 0;
 
+  // Get the internal pipeline hash to record in the PAL metadata of the glue shader
+  std::pair<uint64_t, uint64_t> getInternalPipelineHash() const;
+
   llvm::LLVMContext &getContext() const { return m_lgcContext->getContext(); }
 
   LgcContext *m_lgcContext;
   PipelineState *m_pipelineState;
 
 private:
+  // Compile the glue shader through the LLVM backend
+  void compileWithCodegen(llvm::raw_pwrite_stream &outStream);
+
   llvm::SmallString<0> m_elfBlob;
+  bool m_compilingTemplate = false; // Whether the glue shader is being compiled as a template
 };
 
 } // namespace lgc
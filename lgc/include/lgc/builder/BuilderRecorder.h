@@ -197,8 +197,8 @@ enum BuilderOpcode : unsigned {
 };
 
 // =====================================================================================================================
-// Builder recorder/replay utility class containing just a couple of static methods used both in BuilderRecorder.cpp
-// and in BuilderReplayer.cpp.
+// Builder recorder/replay utility class containing just a few static methods used in BuilderRecorder.cpp,
+// BuilderReplayer.cpp, and the passes that look at recorded calls before they are replayed.
 class BuilderRecorder {
 public:
   // Given an opcode, get the call name (without the "lgc.create." prefix)
@@ -206,6 +206,9 @@ public:
 
   // Get the recorded call opcode from the function name. Asserts if not found.
   static BuilderOpcode getOpcodeFromName(llvm::StringRef name);
+
+  // Get the recorded call opcode of a function declaration, or std::nullopt if it is not an lgc.create.* declaration
+  static std::optional<BuilderOpcode> getOpcode(const llvm::Function &func);
 };
 
 } // namespace lgc
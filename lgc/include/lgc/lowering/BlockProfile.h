@@ -0,0 +1,76 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  BlockProfile.h
+ * @brief LLPC header file: contains declaration of classes lgc::InstrumentBlockCounters and lgc::ApplyBlockProfile.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "lgc/state/PipelineState.h"
+#include "llvm/IR/PassManager.h"
+
+namespace lgc {
+
+// Metadata kind names of the counter indices attached to block terminators by InstrumentBlockCounters
+static constexpr char BlockCounterMetadataName[] = "lgc.block.counter";
+static constexpr char BranchCounterMetadataName[] = "lgc.branch.counter";
+
+// =====================================================================================================================
+// Pass to number the basic blocks and conditional branches of each shader with counter indices, and, with
+// -lgc-block-counters, to instrument them with execution counters in the block counter buffer. See
+// lgc/docs/BlockProfile.md.
+class InstrumentBlockCounters : public llvm::PassInfoMixin<InstrumentBlockCounters> {
+public:
+  llvm::PreservedAnalyses run(llvm::Module &module, llvm::ModuleAnalysisManager &analysisManager);
+
+  static llvm::StringRef name() { return "Instrument block counters"; }
+
+  static bool isEnabled();
+
+private:
+  unsigned numberShader(llvm::ArrayRef<llvm::Function *> funcs, unsigned firstCounter, bool instrument);
+
+  PipelineState *m_pipelineState = nullptr;
+  const ResourceNode *m_topNode = nullptr; // Root user data node of the block counter buffer, or null
+};
+
+// =====================================================================================================================
+// Pass to apply the block profile given by -lgc-block-profile to the blocks numbered by InstrumentBlockCounters, as
+// branch weights and loop trip counts. See lgc/docs/BlockProfile.md.
+class ApplyBlockProfile : public llvm::PassInfoMixin<ApplyBlockProfile> {
+public:
+  llvm::PreservedAnalyses run(llvm::Module &module, llvm::ModuleAnalysisManager &analysisManager);
+
+  static llvm::StringRef name() { return "Apply block profile"; }
+
+  static bool isEnabled();
+
+private:
+  void applyToFunction(llvm::Function &func, llvm::ArrayRef<uint64_t> counts, llvm::FunctionAnalysisManager &fam);
+};
+
+} // namespace lgc
@@ -72,6 +72,7 @@ private:
 
   bool isVertexReuseDisabled();
   void checkRayQueryLdsStackUsage(llvm::Module *module);
+  void setLdsSpillLimits(llvm::Module *module);
 
   void clearInactiveBuiltInInput();
   void clearInactiveBuiltInOutput();
@@ -0,0 +1,50 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  HoistDescLoads.h
+ * @brief LLPC header file: contains declaration of class lgc::HoistDescLoads.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/IR/PassManager.h"
+
+namespace lgc {
+
+// =====================================================================================================================
+// Pass to combine the buffer descriptor loads of a function that load the same descriptor into one, placed where it
+// dominates all of them without speculating a load at a dynamic index, as long as the descriptors kept live across
+// blocks fit in an SGPR budget.
+class HoistDescLoads : public llvm::PassInfoMixin<HoistDescLoads> {
+public:
+  llvm::PreservedAnalyses run(llvm::Function &function, llvm::FunctionAnalysisManager &analysisManager);
+
+  static llvm::StringRef name() { return "Combine and hoist descriptor loads"; }
+
+  static bool isEnabled();
+};
+
+} // namespace lgc
@@ -65,6 +65,7 @@ public:
 
 protected:
   static void addOptimizationPasses(lgc::PassManager &passMgr, uint32_t optLevel);
+  static void addReducedOptimizationPasses(lgc::PassManager &passMgr);
 
   void init(llvm::Module *module);
 
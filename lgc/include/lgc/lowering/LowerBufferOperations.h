@@ -85,6 +85,8 @@ public:
 
   static void registerVisitors(llvm_dialects::VisitorBuilder<BufferOpLowering> &builder);
 
+  static bool isScalarLoadSizeAllowed(const PipelineState &pipelineState, unsigned accessSize);
+
   void finish();
 
 private:
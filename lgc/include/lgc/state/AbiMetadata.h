@@ -120,6 +120,7 @@ namespace PalCodeObjectMetadataKey {
 static constexpr char Version[] = "amdpal.version";
 static constexpr char Pipelines[] = "amdpal.pipelines";
 static constexpr char PrintfStrings[] = "amdpal.format_strings";
+static constexpr char BlockCounters[] = "amdpal.block_counters";
 }; // namespace PalCodeObjectMetadataKey
 
 namespace PipelineMetadataKey {
@@ -0,0 +1,75 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  GlueShaderTemplateCache.h
+ * @brief LGC header file: Cache of glue shader templates, owned by the LgcContext
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <string>
+
+namespace lgc {
+
+// =====================================================================================================================
+// A glue shader compiled with a placeholder internal pipeline hash in its PAL metadata, and where that placeholder is.
+struct GlueShaderTemplate {
+  // ELF of the glue shader.
+  std::string elf;
+  // {offset in the ELF, hash word index} of each placeholder hash word, found in the PAL metadata note when the
+  // template was compiled.
+  llvm::SmallVector<std::pair<size_t, unsigned>, 2> hashWordOffsets;
+};
+
+// =====================================================================================================================
+// Cache of glue shader templates, owned by the LgcContext, so that it is only used by one compile at a time and lives
+// as long as the context is pooled. It is keyed by the glue shader name and string, the same identifier the front-end
+// client caches the glue shader ELF by, together with the GPU, fragment shader wave size and codegen optimization
+// level that the glue shader is compiled with.
+class GlueShaderTemplateCache {
+public:
+  // Maximum number of templates kept in the cache.
+  static constexpr unsigned MaxTemplates = 1024;
+
+  // Look up a template, returning nullptr if it is not in the cache.
+  const GlueShaderTemplate *find(llvm::StringRef key) const {
+    auto it = m_templates.find(key);
+    return it == m_templates.end() ? nullptr : &it->second;
+  }
+
+  // Add a template to the cache, unless the cache is full.
+  void insert(llvm::StringRef key, GlueShaderTemplate glueShaderTemplate) {
+    if (m_templates.size() < MaxTemplates)
+      m_templates.try_emplace(key, std::move(glueShaderTemplate));
+  }
+
+private:
+  llvm::StringMap<GlueShaderTemplate> m_templates; // Templates by key
+};
+
+} // namespace lgc
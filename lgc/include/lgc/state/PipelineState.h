@@ -198,6 +198,12 @@ public:
   // Set the client-defined metadata to be stored inside the ELF
   void setClientMetadata(llvm::StringRef clientMetadata) override final;
 
+  // Request reduced optimization from generate()
+  void setReducedOptimization(bool reduced) override final { m_reducedOptimization = reduced; }
+
+  // Get whether generate() uses reduced optimization
+  bool isReducedOptimization() const { return m_reducedOptimization; }
+
   // Set default tessellation inner/outer level from driver API
   void setTessLevel(const float *tessLevelInner, const float *tessLevelOuter) override final {
     m_tessLevel.inner[0] = tessLevelInner[0];
@@ -568,6 +574,7 @@ private:
   void recordWaveSize(llvm::Module *module);
   void readWaveSize(llvm::Module *module);
   void determineShaderWaveSize(llvm::Module *module);
+  void runWaveSizeCostModel(llvm::ArrayRef<llvm::Module *> modules);
 
   // ABI Shader Map
   void buildAbiHwShaderMap();
@@ -577,8 +584,9 @@ private:
   // Set the default wave size for all shader stages.
   void setAllShadersDefaultWaveSize();
 
-  std::string m_lastError; // Error to be reported by getLastError()
-  bool m_emitLgc = false;  // Whether -emit-lgc is on
+  std::string m_lastError;            // Error to be reported by getLastError()
+  bool m_emitLgc = false;             // Whether -emit-lgc is on
+  bool m_reducedOptimization = false; // Whether generate() runs reduced optimization to save compile time
   // Whether generating pipeline or unlinked part-pipeline
   PipelineLink m_pipelineLink = PipelineLink::WholePipeline;
   ShaderStageMask m_stageMask;                          // Mask of active shader stages
@@ -610,6 +618,7 @@ private:
   PalMetadata *m_palMetadata = nullptr;                             // PAL metadata object
   unsigned m_waveSize[ShaderStage::Count] = {};                     // Per-shader wave size
   unsigned m_subgroupSize[ShaderStage::Count] = {};                 // Per-shader subgroup size
+  ShaderStageMap<unsigned> m_preferredWaveSize;                     // Per-shader wave size chosen by the cost model
   ShaderStageMap<bool> m_inputPackState;                            // The input packable state per shader stage
   ShaderStageMap<bool> m_outputPackState;                           // The output packable state per shader stage
   XfbStateMetadata m_xfbStateMetadata = {};                         // Transform feedback state metadata
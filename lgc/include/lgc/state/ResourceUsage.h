@@ -167,6 +167,8 @@ struct ResourceUsage {
   bool useImages = false;                  // Whether images are used
   bool useImageOp = false;                 // Whether image instruction is called (for GFX11+, pixel wait sync+)
   bool useRayQueryLdsStack = false;        // Whether ray query uses LDS stack
+  unsigned ldsSpillLimitDwords = 0;        // LDS that the backend may use to spill VGPRs before scratch, in dwords
+  unsigned ldsReservedBytes = 0;           // LDS to allocate including a reserved spill area, or 0 if none reserved
 
   // Usage of built-ins
   struct {
@@ -59,6 +59,8 @@ struct GpuProperty {
   unsigned numComputeUnitsPerShaderEngine;    // Number of compute units per shader engine
   unsigned waveSize;                          // Wavefront size
   unsigned ldsSizePerThreadGroup;             // LDS size per thread group in dwords
+  unsigned ldsSizePerCu;                      // LDS size per compute unit (in CU mode) in dwords
+  unsigned maxWavesPerCu;                     // Number of wave slots per compute unit (in CU mode)
   unsigned gsOnChipDefaultPrimsPerSubgroup;   // Default target number of primitives per subgroup for GS on-chip mode.
   unsigned gsOnChipDefaultLdsSizePerSubgroup; // Default value for the maximum LDS size per subgroup for
   unsigned gsOnChipMaxLdsSize;                // Max LDS size used by GS on-chip mode (in dwords)
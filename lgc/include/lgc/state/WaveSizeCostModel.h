@@ -0,0 +1,94 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  WaveSizeCostModel.h
+ * @brief LLPC header file: contains declaration of class lgc::WaveSizeCostModel
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "lgc/CommonDefs.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Support/Debug.h"
+
+namespace llvm {
+class Function;
+class Module;
+class TargetMachine;
+} // namespace llvm
+
+namespace lgc {
+
+// Statistics of one shader, estimated from its IR before lowering, that the wave size cost model works from
+struct WaveSizeEstimate {
+  unsigned instCount = 0;            // Number of instructions
+  unsigned peakLiveDwords = 0;       // Peak number of dwords of possibly divergent values live at once
+  unsigned subgroupOpCount = 0;      // Number of subgroup operations
+  unsigned divergentBranchCount = 0; // Number of conditional branches on possibly divergent conditions
+  unsigned memoryOpCount = 0;        // Number of memory, image and atomic operations
+};
+
+// =====================================================================================================================
+// Cost model that chooses between wave32 and wave64 for each shader from estimates of its register pressure,
+// subgroup operation use, divergence and memory intensity. See lgc/docs/WaveSizeCostModel.md.
+class WaveSizeCostModel {
+public:
+  explicit WaveSizeCostModel(const llvm::TargetMachine &targetMachine) : m_targetMachine(targetMachine) {}
+
+  static bool isEnabled();
+
+  void addModule(llvm::Module &module);
+
+  // Gets the estimates of the shaders of the modules added so far.
+  const ShaderStageMap<WaveSizeEstimate> &getEstimates() const { return m_estimates; }
+
+  static int getScore(ShaderStageEnum stage, const WaveSizeEstimate &estimate);
+
+  // Gets the wave size that the cost model prefers for a shader.
+  static unsigned getPreferredWaveSize(ShaderStageEnum stage, const WaveSizeEstimate &estimate) {
+    return getScore(stage, estimate) > 0 ? 32 : 64;
+  }
+
+private:
+  void addFunction(llvm::Function &func, WaveSizeEstimate &estimate) const;
+
+  const llvm::TargetMachine &m_targetMachine;   // Target machine, for the target's divergence rules
+  ShaderStageMap<WaveSizeEstimate> m_estimates; // Estimates of each shader stage
+};
+
+// =====================================================================================================================
+// Pass to print the wave size cost model's estimates and choice for each shader of the module
+class WaveSizeCostModelPrinter : public llvm::PassInfoMixin<WaveSizeCostModelPrinter> {
+public:
+  explicit WaveSizeCostModelPrinter(llvm::raw_ostream &out = llvm::dbgs()) : m_out(out) {}
+
+  llvm::PreservedAnalyses run(llvm::Module &module, llvm::ModuleAnalysisManager &analysisManager);
+
+private:
+  llvm::raw_ostream &m_out;
+};
+
+} // namespace lgc
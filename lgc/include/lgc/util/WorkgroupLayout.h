@@ -41,6 +41,9 @@ namespace lgc {
 
 SwizzleWorkgroupLayout calculateWorkgroupLayout(PipelineState *pipelineState, ShaderStageEnum shaderStage);
 
+SwizzleWorkgroupLayout chooseWorkgroupLayoutForImageAccess(PipelineState *pipelineState, ShaderStageEnum shaderStage,
+                                                           llvm::Function &reconfigFunc, SwizzleWorkgroupLayout layout);
+
 llvm::Value *reconfigWorkgroupLayout(llvm::Value *localInvocationId, PipelineState *pipelineState,
                                      ShaderStageEnum shaderStage, WorkgroupLayout macroLayout,
                                      WorkgroupLayout microLayout, unsigned workgroupSizeX, unsigned workgroupSizeY,
@@ -58,6 +58,7 @@ namespace lgc {
 class Builder;
 class LegacyPassManager;
 class PassManager;
+class GlueShaderTemplateCache;
 class PassManagerCache;
 class Pipeline;
 class TargetInfo;
@@ -158,6 +159,9 @@ public:
   // Get pass manager cache
   PassManagerCache *getPassManagerCache();
 
+  // Get the cache of glue shader templates
+  GlueShaderTemplateCache *getGlueShaderTemplateCache();
+
   // Make uber fetch table.
   //
   // @param inputs : Array of VertexInputDescription structs
@@ -178,6 +182,9 @@ private:
   unsigned m_palAbiVersion = 0xFFFFFFFF;             // PAL pipeline ABI version to compile for
   PassManagerCache *m_passManagerCache = nullptr;    // Pass manager cache and creator
   llvm::CodeGenOptLevel m_initialOptLevel;           // Optimization level at initialization
+
+  // Glue shader templates, created on first use
+  GlueShaderTemplateCache *m_glueShaderTemplateCache = nullptr;
 };
 
 } // namespace lgc
@@ -0,0 +1,108 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  Occupancy.h
+ * @brief LGC estimates of how many waves of a shader a SIMD can keep resident
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+
+namespace lgc {
+
+// Limits of one SIMD on the waves of a shader that it can keep resident. These are the limits of the smallest GPU of
+// each generation; the larger VGPR files of some GFX11 GPUs are not modeled.
+struct SimdLimits {
+  unsigned maxWaves;    // Maximum number of waves, of either wave size
+  unsigned vgprBytes;   // Size of the VGPR file
+  unsigned vgprGranule; // Granule of VGPR allocation, in VGPRs
+};
+
+// =====================================================================================================================
+// Gets the limits of one SIMD on the waves of a shader of the given wave size.
+//
+// GFX9 has 64KB of VGPRs per SIMD, allocated 4 at a time, and up to 10 waves. GFX10+ has 128KB of VGPRs per SIMD, that
+// is 1024 wave32 VGPRs or 512 wave64 ones. GFX10.1 allocates them 8 at a time in wave32 and 4 in wave64, and allows 20
+// waves; GFX10.3+ allocates them 16 and 8 at a time, and allows 16 waves. The wave limit is the same for both wave
+// sizes, so wave64 can keep up to twice as many lanes resident when VGPRs do not limit it.
+//
+// @param gfxIpMajor : Major version of the graphics IP
+// @param gfxIpMinor : Minor version of the graphics IP
+// @param waveSize : Wave size of the shader
+// @returns : Limits of the SIMD
+inline SimdLimits getSimdLimits(unsigned gfxIpMajor, unsigned gfxIpMinor, unsigned waveSize) {
+  if (gfxIpMajor < 10)
+    return {10, 64 * 1024, 4};
+  if (gfxIpMajor == 10 && gfxIpMinor < 3)
+    return {20, 128 * 1024, waveSize == 32 ? 8u : 4u};
+  return {16, 128 * 1024, waveSize == 32 ? 16u : 8u};
+}
+
+// =====================================================================================================================
+// Gets the number of waves of a shader that one SIMD can keep resident, as limited by the shader's VGPR count.
+//
+// @param gfxIpMajor : Major version of the graphics IP
+// @param gfxIpMinor : Minor version of the graphics IP
+// @param vgprCount : Number of VGPRs the shader uses
+// @param waveSize : Wave size of the shader
+// @returns : Waves per SIMD
+inline unsigned getWavesPerSimd(unsigned gfxIpMajor, unsigned gfxIpMinor, unsigned vgprCount, unsigned waveSize) {
+  const SimdLimits limits = getSimdLimits(gfxIpMajor, gfxIpMinor, waveSize);
+  const uint64_t allocatedVgprs = llvm::alignTo(std::max(vgprCount, 1u), limits.vgprGranule);
+  return std::min<uint64_t>(limits.maxWaves, limits.vgprBytes / (allocatedVgprs * std::max(waveSize, 1u) * 4));
+}
+
+// =====================================================================================================================
+// Gets the number of lanes of a shader that one SIMD can keep resident, as limited by the shader's VGPR count. This,
+// rather than the number of waves, is what compares the occupancy of shaders of different wave sizes.
+//
+// @param gfxIpMajor : Major version of the graphics IP
+// @param gfxIpMinor : Minor version of the graphics IP
+// @param vgprCount : Number of VGPRs the shader uses
+// @param waveSize : Wave size of the shader
+// @returns : Lanes per SIMD
+inline unsigned getLanesPerSimd(unsigned gfxIpMajor, unsigned gfxIpMinor, unsigned vgprCount, unsigned waveSize) {
+  return getWavesPerSimd(gfxIpMajor, gfxIpMinor, vgprCount, waveSize) * waveSize;
+}
+
+// =====================================================================================================================
+// Gets the number of VGPRs that a shader may use and still have the given number of waves per SIMD.
+//
+// @param gfxIpMajor : Major version of the graphics IP
+// @param gfxIpMinor : Minor version of the graphics IP
+// @param wavesPerSimd : Target number of waves per SIMD
+// @param waveSize : Wave size of the shader
+// @returns : VGPR count
+inline unsigned getVgprsForWavesPerSimd(unsigned gfxIpMajor, unsigned gfxIpMinor, unsigned wavesPerSimd,
+                                        unsigned waveSize) {
+  const SimdLimits limits = getSimdLimits(gfxIpMajor, gfxIpMinor, waveSize);
+  wavesPerSimd = std::clamp(wavesPerSimd, 1u, limits.maxWaves);
+  return llvm::alignDown(limits.vgprBytes / (wavesPerSimd * std::max(waveSize, 1u) * 4), limits.vgprGranule);
+}
+
+} // namespace lgc
@@ -0,0 +1,134 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  PerfEstimator.h
+ * @brief LGC static performance estimator library
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace lgc {
+
+// Kinds of instruction counted by the performance estimator.
+enum class PerfInstKind : unsigned {
+  Salu,      // Scalar ALU
+  Valu,      // Vector ALU
+  ValuTrans, // Vector transcendental or 64-bit float, issued at quarter rate or slower
+  Smem,      // Scalar memory
+  Vmem,      // Vector memory, including image and flat
+  Lds,       // LDS and GDS
+  Export,    // Export
+  Branch,    // Branch, call and end of program
+  Wait,      // Wait for memory counters
+  Other,     // Anything else, such as s_nop
+  Count
+};
+
+// Counters that a wait instruction can wait on.
+enum class PerfCounter : unsigned {
+  VmemLoad,  // Vector memory loads and atomics (vmcnt, loadcnt, samplecnt, bvhcnt)
+  VmemStore, // Vector memory stores, on GFX10+ (vscnt, storecnt)
+  Smem,      // Scalar memory (the SMEM part of lgkmcnt, kmcnt)
+  Lds,       // LDS (the LDS part of lgkmcnt, dscnt)
+  Export,    // Exports (expcnt)
+  Count
+};
+
+// Estimate of one basic block.
+struct PerfBlockEstimate {
+  uint64_t offset = 0;      // Offset of the block in its section
+  unsigned instCount = 0;   // Number of instructions
+  unsigned issueCycles = 0; // Estimated cycles to issue the instructions of one wave
+  unsigned stallCycles = 0; // Estimated cycles that one wave stalls in waits
+};
+
+// A wait instruction that is estimated to stall.
+struct PerfStallPoint {
+  uint64_t offset = 0;      // Offset of the wait instruction in its section
+  unsigned counterMask = 0; // Mask of the PerfCounter values that it stalls on
+  unsigned stallCycles = 0; // Estimated cycles that one wave stalls
+};
+
+// Estimate of one function, normally a shader entry point.
+struct ShaderPerfEstimate {
+  std::string name;                                                    // Symbol name of the function
+  std::string hwStage;                                                 // Hardware stage, or empty if unknown
+  unsigned waveSize = 64;                                              // Wave size the function is estimated for
+  unsigned codeBytes = 0;                                              // Size of the code
+  std::array<unsigned, unsigned(PerfInstKind::Count)> instCounts = {}; // Number of instructions of each kind
+  uint64_t issueCycles = 0;                                            // Sum of the issue cycles of the blocks
+  uint64_t stallCycles = 0;                                            // Sum of the stall cycles of the blocks
+  std::vector<PerfBlockEstimate> blocks;                               // Basic blocks, in layout order
+  std::vector<PerfStallPoint> stallPoints;                             // Stalling waits, in layout order
+};
+
+// Occupancy limits of one hardware stage, from the PAL metadata.
+struct HwStageOccupancy {
+  std::string hwStage;       // Hardware stage, e.g. ".cs"
+  unsigned waveSize = 64;    // Wave size
+  unsigned vgprCount = 0;    // VGPRs used
+  unsigned sgprCount = 0;    // SGPRs used
+  unsigned ldsBytes = 0;     // LDS used per workgroup
+  unsigned scratchBytes = 0; // Scratch used per lane
+  unsigned vgprLimit = 0;    // Waves per SIMD allowed by the VGPRs
+  unsigned sgprLimit = 0;    // Waves per SIMD allowed by the SGPRs
+  unsigned ldsLimit = 0;     // Waves per SIMD allowed by the LDS
+  unsigned occupancy = 0;    // Waves per SIMD allowed by all the limits
+};
+
+// Static performance estimate of an object.
+struct ObjectPerfEstimate {
+  std::string cpu;                        // Target GPU, e.g. "gfx1030"
+  std::vector<ShaderPerfEstimate> shaders; // Functions in the code sections
+  std::vector<HwStageOccupancy> hwStages;  // Hardware stages in the PAL metadata
+};
+
+// Get the name of an instruction kind, as used in the output.
+const char *getPerfInstKindName(PerfInstKind kind);
+
+// Get the name of a counter, as used in the output.
+const char *getPerfCounterName(PerfCounter counter);
+
+// Statically estimate the performance of the code in an ELF object.
+//
+// @param data : The object file contents
+// @returns : The estimate, or the Error if the object could not be decoded
+llvm::Expected<ObjectPerfEstimate> estimateObjectPerf(llvm::MemoryBufferRef data);
+
+// Output a performance estimate, as text or as JSON.
+//
+// @param estimate : The estimate to output
+// @param ostream : The stream to output into
+// @param json : True to output JSON, false to output text
+void printObjectPerfEstimate(const ObjectPerfEstimate &estimate, llvm::raw_ostream &ostream, bool json);
+
+} // namespace lgc
@@ -428,6 +428,10 @@ static_assert(sizeof(ShaderOptions) == sizeof(ShaderOptions::u32All));
 
 // ResourceNodeType declaration now in CommonDefs.h.
 
+// Binding of the block counter buffer (-lgc-block-counters) in the internal descriptor set. The front-end's own
+// binding (Vkgc::BlockCounterBufferBindingId) is checked to match.
+constexpr unsigned BlockCounterBufferBindingId = 35;
+
 // The representation of a user data resource node
 struct ResourceNode {
   ResourceNode() {}
@@ -985,6 +989,10 @@ public:
   // Set the client-defined metadata to be stored inside the ELF
   virtual void setClientMetadata(llvm::StringRef clientMetadata) = 0;
 
+  // Request a cheaper compile from generate(): only a minimal set of LLVM optimization passes is run, and codegen
+  // uses the lowest optimization level. Used by the front-end when a compile has run over its compile-time budget.
+  virtual void setReducedOptimization(bool reduced) = 0;
+
   // Set default tessellation inner/outer level from driver API
   virtual void setTessLevel(const float *tessLevelInner, const float *tessLevelOuter) = 0;
 
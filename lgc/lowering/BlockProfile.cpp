@@ -0,0 +1,419 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  BlockProfile.cpp
+ * @brief LLPC source file: contains implementation of classes lgc::InstrumentBlockCounters and lgc::ApplyBlockProfile.
+ ***********************************************************************************************************************
+ */
+#include "lgc/lowering/BlockProfile.h"
+#include "lgc/Debug.h"
+#include "lgc/builder/BuilderImpl.h"
+#include "lgc/state/AbiMetadata.h"
+#include "lgc/state/PalMetadata.h"
+#include "lgc/state/ShaderStage.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Transforms/Utils/LoopUtils.h"
+#include <map>
+
+#define DEBUG_TYPE "lgc-block-profile"
+
+using namespace llvm;
+using namespace lgc;
+
+// -lgc-block-counters: instrument shaders with basic block and branch execution counters
+static cl::opt<bool> BlockCounters("lgc-block-counters",
+                                   cl::desc("Instrument shaders with basic block and branch execution counters"),
+                                   cl::init(false));
+
+// -lgc-block-profile: apply a block profile to the shaders it has counts for
+static cl::opt<std::string> BlockProfileFile("lgc-block-profile",
+                                             cl::desc("Apply the block profile in the given file as branch weights "
+                                                      "and loop trip counts"),
+                                             cl::value_desc("filename"));
+
+// The shaders of a module, grouped by shader stage in stage order
+using StageFunctions = std::map<ShaderStageEnum, SmallVector<Function *, 4>>;
+
+// =====================================================================================================================
+// Groups the defined shader functions of a module by shader stage.
+//
+// @param module : LLVM module
+// @returns : Functions of each shader stage, in module order
+static StageFunctions getStageFunctions(Module &module) {
+  StageFunctions stageFuncs;
+  for (Function &func : module) {
+    if (func.isDeclaration())
+      continue;
+    if (auto stage = getShaderStage(&func))
+      stageFuncs[*stage].push_back(&func);
+  }
+  return stageFuncs;
+}
+
+// =====================================================================================================================
+// Gets the key of a shader in a block profile: its 128-bit shader hash as 32 hex digits, most significant first.
+//
+// @param options : Shader options holding the shader hash
+// @returns : Shader hash string
+static std::string getShaderHashString(const ShaderOptions &options) {
+  std::string hashString;
+  raw_string_ostream(hashString) << format_hex_no_prefix(options.hash[1], 16)
+                                 << format_hex_no_prefix(options.hash[0], 16);
+  return hashString;
+}
+
+// =====================================================================================================================
+// Gets the counter index that InstrumentBlockCounters attached to an instruction.
+//
+// @param inst : Block terminator
+// @param kind : Metadata kind ID of the counter
+// @returns : Counter index, or std::nullopt if the instruction has none
+static std::optional<unsigned> getCounterIndex(const Instruction *inst, unsigned kind) {
+  MDNode *metadata = inst->getMetadata(kind);
+  if (!metadata)
+    return std::nullopt;
+  return mdconst::extract<ConstantInt>(metadata->getOperand(0))->getZExtValue();
+}
+
+namespace lgc {
+
+// =====================================================================================================================
+// Checks whether the pass is needed, that is, when instrumenting or applying a block profile.
+bool InstrumentBlockCounters::isEnabled() {
+  return BlockCounters || !BlockProfileFile.empty();
+}
+
+// =====================================================================================================================
+// Executes this LGC lowering pass on the specified LLVM module.
+//
+// @param [in/out] module : LLVM module to be run on
+// @param [in/out] analysisManager : Analysis manager to use for this transformation
+// @returns : The preserved analyses (The analyses that are still valid after this pass)
+PreservedAnalyses InstrumentBlockCounters::run(Module &module, ModuleAnalysisManager &analysisManager) {
+  LLVM_DEBUG(dbgs() << "Run the pass Instrument-Block-Counters\n");
+  m_pipelineState = analysisManager.getResult<PipelineStateWrapper>(module).getPipelineState();
+
+  StageFunctions stageFuncs = getStageFunctions(module);
+  if (stageFuncs.empty())
+    return PreservedAnalyses::all();
+
+  // The blocks are numbered even without the counter buffer, so that a profile can be applied to them.
+  m_topNode = nullptr;
+  if (BlockCounters) {
+    m_topNode = m_pipelineState
+                    ->findResourceNode(ResourceNodeType::Unknown, InternalDescriptorSetId, BlockCounterBufferBindingId)
+                    .first;
+    if (!m_topNode) {
+      module.getContext().diagnose(DiagnosticInfoGeneric(
+          Twine("-lgc-block-counters: no block counter buffer at binding ") + Twine(BlockCounterBufferBindingId) +
+              " of the internal descriptor set, so the shaders are not instrumented",
+          DS_Warning));
+    }
+  }
+
+  msgpack::Document *document = m_pipelineState->getPalMetadata()->getDocument();
+  unsigned firstCounter = 0;
+  for (const auto &[stage, funcs] : stageFuncs) {
+    unsigned counterCount = numberShader(funcs, firstCounter, m_topNode != nullptr);
+    if (m_topNode) {
+      // Record where the counters of each shader are, for the tool that turns the buffer into a block profile.
+      auto blockCounters =
+          document->getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::BlockCounters].getMap(true);
+      blockCounters[".version"] = 1;
+      blockCounters[".user_data_offset"] = m_topNode->offsetInDwords;
+      auto shaders = blockCounters[".shaders"].getArray(true);
+      auto shader = shaders[shaders.size()].getMap(true);
+      shader[".stage"] = StringRef(getShaderStageAbbreviation(stage));
+      shader[".shader_hash"] = document->getNode(getShaderHashString(m_pipelineState->getShaderOptions(stage)), true);
+      shader[".first_counter"] = firstCounter;
+      shader[".counter_count"] = counterCount;
+    }
+    firstCounter += counterCount;
+  }
+
+  return m_topNode ? PreservedAnalyses::allInSet<CFGAnalyses>() : PreservedAnalyses::all();
+}
+
+// =====================================================================================================================
+// Numbers the counters of one shader, and instruments them. Each basic block gets a counter of its executions, and
+// each conditional branch a counter of its executions that take the true successor. The counter indices are attached
+// to the terminators, as they are the instructions that stay with the numbered block when later lowering splits it.
+//
+// @param funcs : Functions of the shader
+// @param firstCounter : Index of the first counter of the shader in the counter buffer
+// @param instrument : Whether to instrument the counters, rather than just number them
+// @returns : Number of counters of the shader
+unsigned InstrumentBlockCounters::numberShader(ArrayRef<Function *> funcs, unsigned firstCounter, bool instrument) {
+  BuilderImpl builder(m_pipelineState);
+  LLVMContext &context = builder.getContext();
+  const unsigned blockCounterKind = context.getMDKindID(BlockCounterMetadataName);
+  const unsigned branchCounterKind = context.getMDKindID(BranchCounterMetadataName);
+
+  // Increments the 64-bit counter of the given index in the counter buffer.
+  auto incrementCounter = [&builder, firstCounter](Value *counterBuffer, unsigned counterIndex, Value *increment) {
+    Value *counter =
+        builder.CreateGEP(builder.getInt64Ty(), counterBuffer, builder.getInt32(firstCounter + counterIndex));
+    builder.CreateAtomicRMW(AtomicRMWInst::Add, counter, increment, MaybeAlign(8), AtomicOrdering::Monotonic,
+                            SyncScope::System);
+  };
+
+  unsigned counterIndex = 0;
+  for (Function *func : funcs) {
+    Instruction *counterBuffer = nullptr;
+    if (instrument) {
+      builder.SetInsertPointPastAllocas(func);
+      counterBuffer = cast<Instruction>(builder.CreateBufferDesc(InternalDescriptorSetId, BlockCounterBufferBindingId,
+                                                                 builder.getInt32(0), Builder::BufferFlagWritten,
+                                                                 true));
+    }
+
+    for (BasicBlock &block : *func) {
+      Instruction *terminator = block.getTerminator();
+      terminator->setMetadata(blockCounterKind,
+                              MDNode::get(context, ConstantAsMetadata::get(builder.getInt32(counterIndex))));
+      if (counterBuffer) {
+        if (counterBuffer->getParent() == &block)
+          builder.SetInsertPoint(counterBuffer->getNextNode());
+        else
+          builder.SetInsertPoint(block.getFirstInsertionPt());
+        incrementCounter(counterBuffer, counterIndex, builder.getInt64(1));
+      }
+      ++counterIndex;
+
+      auto *branch = dyn_cast<BranchInst>(terminator);
+      if (!branch || !branch->isConditional())
+        continue;
+      branch->setMetadata(branchCounterKind,
+                          MDNode::get(context, ConstantAsMetadata::get(builder.getInt32(counterIndex))));
+      if (counterBuffer) {
+        builder.SetInsertPoint(branch);
+        incrementCounter(counterBuffer, counterIndex, builder.CreateZExt(branch->getCondition(), builder.getInt64Ty()));
+      }
+      ++counterIndex;
+    }
+  }
+  return counterIndex;
+}
+
+// =====================================================================================================================
+// Checks whether the pass is needed, that is, when applying a block profile.
+bool ApplyBlockProfile::isEnabled() {
+  return !BlockProfileFile.empty();
+}
+
+// =====================================================================================================================
+// Loads a block profile file. Counts of the same shader on several lines are summed.
+//
+// @param fileName : Name of the block profile file
+// @returns : The counts of each shader, keyed by shader hash string, or the error that makes the file unusable
+static Expected<StringMap<SmallVector<uint64_t, 0>>> loadBlockProfile(StringRef fileName) {
+  auto bufferOrErr = MemoryBuffer::getFile(fileName, /*IsText=*/true);
+  if (!bufferOrErr)
+    return createStringError(bufferOrErr.getError(), Twine("cannot read ") + fileName + ": " +
+                                                         bufferOrErr.getError().message());
+
+  StringMap<SmallVector<uint64_t, 0>> profile;
+  for (line_iterator lineIt(**bufferOrErr, /*SkipBlanks=*/true, '#'); !lineIt.is_at_end(); ++lineIt) {
+    SmallVector<StringRef, 16> fields;
+    SplitString(*lineIt, fields);
+    if (fields.empty())
+      continue;
+    SmallVector<uint64_t, 0> counts;
+    for (StringRef field : drop_begin(fields)) {
+      uint64_t count = 0;
+      if (field.getAsInteger(10, count)) {
+        return createStringError(inconvertibleErrorCode(),
+                                 Twine("bad count in ") + fileName + ":" + Twine(lineIt.line_number()));
+      }
+      counts.push_back(count);
+    }
+
+    SmallVector<uint64_t, 0> &shaderCounts = profile[fields[0].lower()];
+    if (shaderCounts.empty()) {
+      shaderCounts = std::move(counts);
+      continue;
+    }
+    if (shaderCounts.size() != counts.size()) {
+      return createStringError(inconvertibleErrorCode(),
+                               Twine("inconsistent counter count in ") + fileName + ":" + Twine(lineIt.line_number()));
+    }
+    for (auto [shaderCount, count] : zip(shaderCounts, counts))
+      shaderCount += count;
+  }
+  return profile;
+}
+
+// =====================================================================================================================
+// Executes this LGC lowering pass on the specified LLVM module.
+//
+// @param [in/out] module : LLVM module to be run on
+// @param [in/out] analysisManager : Analysis manager to use for this transformation
+// @returns : The preserved analyses (The analyses that are still valid after this pass)
+PreservedAnalyses ApplyBlockProfile::run(Module &module, ModuleAnalysisManager &analysisManager) {
+  LLVM_DEBUG(dbgs() << "Run the pass Apply-Block-Profile\n");
+  PipelineState *pipelineState = analysisManager.getResult<PipelineStateWrapper>(module).getPipelineState();
+  auto &fam = analysisManager.getResult<FunctionAnalysisManagerModuleProxy>(module).getManager();
+  LLVMContext &context = module.getContext();
+  const unsigned blockCounterKind = context.getMDKindID(BlockCounterMetadataName);
+  const unsigned branchCounterKind = context.getMDKindID(BranchCounterMetadataName);
+
+  // A profile that cannot be used is ignored, but the counter indices are still removed below.
+  StringMap<SmallVector<uint64_t, 0>> profile;
+  if (auto profileOrErr = loadBlockProfile(BlockProfileFile)) {
+    profile = std::move(*profileOrErr);
+  } else {
+    context.diagnose(
+        DiagnosticInfoGeneric(Twine("Block profile ignored: ") + toString(profileOrErr.takeError()), DS_Warning));
+  }
+  for (const auto &[stage, funcs] : getStageFunctions(module)) {
+    // The profile only fits a shader numbered the same way, so check that the number of counters matches.
+    unsigned counterCount = 0;
+    for (Function *func : funcs) {
+      for (BasicBlock &block : *func) {
+        for (unsigned kind : {blockCounterKind, branchCounterKind}) {
+          if (auto counterIndex = getCounterIndex(block.getTerminator(), kind))
+            counterCount = std::max(counterCount, *counterIndex + 1);
+        }
+      }
+    }
+
+    const std::string hashString = getShaderHashString(pipelineState->getShaderOptions(stage));
+    auto it = profile.find(hashString);
+    if (it != profile.end() && it->second.size() != counterCount) {
+      LLPC_OUTS("Block profile of " << getShaderStageAbbreviation(stage) << " shader " << hashString << " has "
+                                    << it->second.size() << " counters instead of " << counterCount << ", ignored\n");
+    } else if (it != profile.end()) {
+      for (Function *func : funcs)
+        applyToFunction(*func, it->second, fam);
+    }
+
+    // The counter indices are not needed any more.
+    for (Function *func : funcs) {
+      for (BasicBlock &block : *func) {
+        block.getTerminator()->setMetadata(blockCounterKind, nullptr);
+        block.getTerminator()->setMetadata(branchCounterKind, nullptr);
+      }
+    }
+  }
+
+  return PreservedAnalyses::allInSet<CFGAnalyses>();
+}
+
+// =====================================================================================================================
+// Applies the counts of a shader to one of its functions: the counts of each conditional branch become its branch
+// weights, and the average number of iterations per entry of each loop becomes its estimated trip count.
+//
+// @param [in/out] func : Function of the shader
+// @param counts : Counts of the shader, indexed by counter index
+// @param [in/out] fam : Function analysis manager
+void ApplyBlockProfile::applyToFunction(Function &func, ArrayRef<uint64_t> counts, FunctionAnalysisManager &fam) {
+  LLVMContext &context = func.getContext();
+  const unsigned blockCounterKind = context.getMDKindID(BlockCounterMetadataName);
+  const unsigned branchCounterKind = context.getMDKindID(BranchCounterMetadataName);
+
+  auto getCount = [counts](const Instruction *terminator, unsigned kind) -> std::optional<uint64_t> {
+    if (auto counterIndex = getCounterIndex(terminator, kind))
+      return counts[*counterIndex];
+    return std::nullopt;
+  };
+
+  // Gets the number of executions of a conditional branch that take each successor.
+  using SuccessorCounts = std::pair<uint64_t, uint64_t>;
+  auto getSuccessorCounts = [&](const BranchInst *branch) -> std::optional<SuccessorCounts> {
+    auto blockCount = getCount(branch, blockCounterKind);
+    auto takenCount = getCount(branch, branchCounterKind);
+    if (!blockCount || !takenCount || *takenCount > *blockCount)
+      return std::nullopt;
+    return std::make_pair(*takenCount, *blockCount - *takenCount);
+  };
+
+  MDBuilder mdBuilder(context);
+  for (BasicBlock &block : func) {
+    auto *branch = dyn_cast<BranchInst>(block.getTerminator());
+    if (!branch || !branch->isConditional())
+      continue;
+    auto successorCounts = getSuccessorCounts(branch);
+    // A block that never ran says nothing about which way its branch goes.
+    if (!successorCounts || successorCounts->first + successorCounts->second == 0)
+      continue;
+    // Branch weights are 32-bit, so scale the counts down to fit.
+    uint64_t scale = std::max(successorCounts->first, successorCounts->second) / UINT32_MAX + 1;
+    branch->setMetadata(LLVMContext::MD_prof,
+                        mdBuilder.createBranchWeights(successorCounts->first / scale, successorCounts->second / scale));
+  }
+
+  LoopInfo &loopInfo = fam.getResult<LoopAnalysis>(func);
+  for (Loop *loop : loopInfo.getLoopsInPreorder()) {
+    auto headerCount = getCount(loop->getHeader()->getTerminator(), blockCounterKind);
+    if (!headerCount)
+      continue;
+
+    // Count the executions of the back edges, from the latches to the header.
+    std::optional<uint64_t> backEdgeCount = 0;
+    SmallVector<BasicBlock *, 4> latches;
+    loop->getLoopLatches(latches);
+    for (BasicBlock *latch : latches) {
+      auto *branch = dyn_cast<BranchInst>(latch->getTerminator());
+      if (branch && branch->isUnconditional()) {
+        if (auto latchCount = getCount(branch, blockCounterKind)) {
+          *backEdgeCount += *latchCount;
+          continue;
+        }
+      } else if (branch) {
+        if (auto successorCounts = getSuccessorCounts(branch)) {
+          if (branch->getSuccessor(0) == loop->getHeader())
+            *backEdgeCount += successorCounts->first;
+          if (branch->getSuccessor(1) == loop->getHeader())
+            *backEdgeCount += successorCounts->second;
+          continue;
+        }
+      }
+      backEdgeCount = std::nullopt;
+      break;
+    }
+    if (!backEdgeCount || *backEdgeCount >= *headerCount)
+      continue;
+
+    // Every execution of the header not from a back edge is an entry into the loop.
+    uint64_t entryCount = *headerCount - *backEdgeCount;
+    uint64_t tripCount = (*headerCount + entryCount / 2) / entryCount;
+    tripCount = std::min<uint64_t>(tripCount, UINT32_MAX);
+    addStringMetadataToLoop(loop, "llvm.loop.estimated_trip_count", unsigned(tripCount));
+  }
+}
+
+} // namespace lgc
@@ -57,6 +57,12 @@ using namespace lgc;
 // -disable-gs-onchip: disable geometry shader on-chip mode
 cl::opt<bool> DisableGsOnChip("disable-gs-onchip", cl::desc("Disable geometry shader on-chip mode"), cl::init(false));
 
+// -reserve-lds-spill-area: reserve the LDS that a compute shader leaves free for spilling VGPRs
+static cl::opt<bool> ReserveLdsSpillArea("reserve-lds-spill-area",
+                                         cl::desc("Reserve the LDS that a compute shader leaves free, without reducing "
+                                                  "its occupancy, for spilling VGPRs before scratch"),
+                                         cl::init(false));
+
 namespace lgc {
 
 // Max size of primitives per subgroup for adjacency primitives or when GS instancing is used. This restriction is
@@ -188,6 +194,9 @@ PreservedAnalyses CollectResourceUsage::run(Module &module, ModuleAnalysisManage
   // Check ray query LDS stack usage
   checkRayQueryLdsStackUsage(&module);
 
+  // Set the LDS that each shader may spill to, now that the LDS the shaders use is known
+  setLdsSpillLimits(&module);
+
   if (pipelineState->isGraphics()) {
     // Set NGG control settings
     setNggControl(&module);
@@ -1297,6 +1306,62 @@ void CollectResourceUsage::checkRayQueryLdsStackUsage(Module *module) {
   }
 }
 
+// =====================================================================================================================
+// Set how much LDS the backend may use to spill VGPRs in each shader. That is the ldsSpillLimitDwords shader option,
+// but with -reserve-lds-spill-area, a compute shader gets the LDS that it leaves free, as far as reserving it does not
+// reduce the number of its workgroups that fit in a CU, capped by any ldsSpillLimitDwords.
+//
+// @param module : LLVM module
+void CollectResourceUsage::setLdsSpillLimits(Module *module) {
+  // The backend only supports LDS spilling in fragment and compute shaders.
+  for (auto stage : {ShaderStage::Fragment, ShaderStage::Compute}) {
+    if (m_pipelineState->hasShaderStage(stage)) {
+      m_pipelineState->getShaderResourceUsage(stage)->ldsSpillLimitDwords =
+          m_pipelineState->getShaderOptions(stage).ldsSpillLimitDwords;
+    }
+  }
+  if (!ReserveLdsSpillArea || !m_pipelineState->hasShaderStage(ShaderStage::Compute))
+    return;
+
+  // In a compute pipeline, all the LDS variables belong to the compute shader.
+  const DataLayout &dataLayout = module->getDataLayout();
+  uint64_t ldsBytes = 0;
+  for (GlobalVariable &global : module->globals()) {
+    if (global.getAddressSpace() != ADDR_SPACE_LOCAL || global.use_empty())
+      continue;
+    ldsBytes = alignTo(ldsBytes, global.getAlign().valueOrOne()) + dataLayout.getTypeAllocSize(global.getValueType());
+  }
+
+  // Workgroups per CU that the wave slots and the LDS allow. A wave takes one wave slot whatever its size, so the
+  // waves of a workgroup are counted at the compute shader's wave size.
+  const GpuProperty &gpuProperty = m_pipelineState->getTargetInfo().getGpuProperty();
+  const auto &computeMode = m_pipelineState->getShaderModes()->getComputeShaderMode();
+  const unsigned workgroupSize =
+      std::max(1u, computeMode.workgroupSizeX * computeMode.workgroupSizeY * computeMode.workgroupSizeZ);
+  const unsigned waveSize = m_pipelineState->getShaderWaveSize(ShaderStage::Compute);
+  const unsigned wavesPerWorkgroup = divideCeil(workgroupSize, waveSize);
+  const uint64_t ldsBytesPerCu = uint64_t(gpuProperty.ldsSizePerCu) * 4;
+  uint64_t workgroupsPerCu = std::max(1u, gpuProperty.maxWavesPerCu / wavesPerWorkgroup);
+  if (ldsBytes != 0)
+    workgroupsPerCu = std::min(workgroupsPerCu, std::max<uint64_t>(1, ldsBytesPerCu / ldsBytes));
+
+  // Spilling a VGPR takes a dword for each thread in the workgroup, so reserve whole VGPRs of the free LDS.
+  const uint64_t maxLdsBytes =
+      std::min<uint64_t>(uint64_t(gpuProperty.ldsSizePerThreadGroup) * 4, ldsBytesPerCu / workgroupsPerCu);
+  const uint64_t freeDwords = maxLdsBytes > ldsBytes ? (maxLdsBytes - ldsBytes) / 4 : 0;
+  unsigned spillDwords = freeDwords / workgroupSize * workgroupSize;
+  ResourceUsage *resUsage = m_pipelineState->getShaderResourceUsage(ShaderStage::Compute);
+  if (resUsage->ldsSpillLimitDwords != 0)
+    spillDwords = std::min(spillDwords, resUsage->ldsSpillLimitDwords);
+
+  LLPC_OUTS("LDS spill area for CS: " << ldsBytes << " bytes used, " << maxLdsBytes << " bytes allowed for "
+                                      << workgroupsPerCu << " workgroups per CU, " << spillDwords
+                                      << " dwords reserved\n");
+  resUsage->ldsSpillLimitDwords = spillDwords;
+  if (spillDwords != 0)
+    resUsage->ldsReservedBytes = ldsBytes + spillDwords * 4;
+}
+
 // =====================================================================================================================
 // Visits "call" instruction.
 //
@@ -0,0 +1,200 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  HoistDescLoads.cpp
+ * @brief LLPC source file: contains implementation of class lgc::HoistDescLoads.
+ *
+ * @details Buffer descriptors are loaded with a lgc.load.buffer.desc or lgc.load.strided.buffer.desc op at each use,
+ * and LowerDesc expands each op in place into the descriptor pointer computation and load. Generic CSE only combines
+ * loads where one dominates the other, so a shader that uses the same descriptor in several branches, or in a loop
+ * and after it, loads the descriptor again in each of them.
+ *
+ * This pass runs before LowerDesc. It groups the descriptor ops of a function by the descriptor that they load (set,
+ * binding, index, flags and stride), and replaces each group by one op in the nearest block that dominates all of
+ * them. A load with a dynamic index is only hoisted if it is not speculated, that is if one of the loads is in a block
+ * that post-dominates that block: on a path that did not load it, the index could be out of range. Hoisting keeps
+ * the descriptor live in SGPRs to its last use, so only the groups with the most loads are hoisted, as many as fit in
+ * an SGPR budget; the others are rematerialized in each block that uses them, combining only the loads within a
+ * block.
+ ***********************************************************************************************************************
+ */
+#include "lgc/lowering/HoistDescLoads.h"
+#include "lgc/Debug.h"
+#include "lgc/LgcDialect.h"
+#include "lgc/state/ShaderStage.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include <tuple>
+
+#define DEBUG_TYPE "lgc-hoist-desc-loads"
+
+using namespace llvm;
+using namespace lgc;
+
+STATISTIC(NumDescLoadsRemoved, "Number of descriptor loads removed");
+STATISTIC(NumDescLoadsHoisted, "Number of descriptors loaded once in a block that dominates all their uses");
+STATISTIC(NumDescLoadsRematerialized, "Number of descriptors reloaded in each block to save SGPRs");
+
+// -lgc-hoist-desc-loads: combine and hoist descriptor loads
+static cl::opt<bool> HoistDescLoadsOpt("lgc-hoist-desc-loads",
+                                       cl::desc("Combine the loads of each buffer descriptor in a function into one "
+                                                "load that dominates all of them"),
+                                       cl::init(false));
+
+// -lgc-hoist-desc-loads-sgpr-budget: SGPRs that descriptors hoisted across blocks may keep live
+static cl::opt<unsigned> SgprBudget("lgc-hoist-desc-loads-sgpr-budget",
+                                    cl::desc("Number of SGPRs that descriptors hoisted across blocks may keep live"),
+                                    cl::init(32));
+
+// Number of SGPRs that a buffer descriptor occupies
+static const unsigned DescSgprCount = 4;
+
+// The descriptor that a descriptor op loads: whether it is strided, descriptor set, binding, descriptor index, flags
+// and stride.
+using DescLoadKey = std::tuple<bool, uint64_t, unsigned, Value *, unsigned, unsigned>;
+
+// Index of the descriptor index in DescLoadKey
+static const unsigned DescIndexKeyElement = 3;
+
+// =====================================================================================================================
+// Get the descriptor that an instruction loads, if it is a descriptor op.
+//
+// @param inst : The instruction
+// @returns : The descriptor, or std::nullopt if the instruction is not a descriptor op
+static std::optional<DescLoadKey> getDescLoadKey(Instruction &inst) {
+  if (auto op = dyn_cast<LoadBufferDescOp>(&inst))
+    return DescLoadKey(false, op->getDescSet(), op->getBinding(), op->getDescIndex(), op->getFlags(), 0);
+  if (auto op = dyn_cast<LoadStridedBufferDescOp>(&inst))
+    return DescLoadKey(true, op->getDescSet(), op->getBinding(), op->getDescIndex(), op->getFlags(), op->getStride());
+  return std::nullopt;
+}
+
+// =====================================================================================================================
+// Replace loads of the same descriptor by the first of them.
+//
+// @param loads : The loads, in program order, all dominated by the first
+// @returns : Number of loads removed
+static unsigned combineLoads(ArrayRef<Instruction *> loads) {
+  for (Instruction *load : drop_begin(loads)) {
+    LLVM_DEBUG(dbgs() << "Replacing " << *load << "\n");
+    load->replaceAllUsesWith(loads.front());
+    load->eraseFromParent();
+  }
+  return loads.size() - 1;
+}
+
+// =====================================================================================================================
+// Check whether the pass is enabled.
+bool HoistDescLoads::isEnabled() {
+  return HoistDescLoadsOpt;
+}
+
+// =====================================================================================================================
+// Executes this LGC lowering pass on the specified LLVM function.
+//
+// @param [in/out] function : LLVM function to be run on
+// @param [in/out] analysisManager : Analysis manager to use for this transformation
+// @returns : The preserved analyses (The analyses that are still valid after this pass)
+PreservedAnalyses HoistDescLoads::run(Function &function, FunctionAnalysisManager &analysisManager) {
+  LLVM_DEBUG(dbgs() << "Run the pass Hoist-Desc-Loads on " << function.getName() << "\n");
+
+  // Group the descriptor ops by the descriptor that they load, each group in program order within a block.
+  MapVector<DescLoadKey, SmallVector<Instruction *, 4>> groups;
+  for (Instruction &inst : instructions(function)) {
+    if (auto key = getDescLoadKey(inst))
+      groups[*key].push_back(&inst);
+  }
+
+  // Combine the groups within a block, and find the block that would dominate each of the other groups. A group with
+  // a dynamic descriptor index can only be hoisted there if one of its loads already executes whenever that block
+  // does; otherwise the hoisted load could index past the end of the descriptor array on a path that never used it.
+  DominatorTree &dominatorTree = analysisManager.getResult<DominatorTreeAnalysis>(function);
+  PostDominatorTree &postDominatorTree = analysisManager.getResult<PostDominatorTreeAnalysis>(function);
+  SmallVector<std::tuple<SmallVector<Instruction *, 4> *, BasicBlock *, bool>, 8> crossBlockGroups;
+  unsigned removedCount = 0;
+  for (auto &entry : groups) {
+    SmallVector<Instruction *, 4> &loads = entry.second;
+    if (loads.size() < 2)
+      continue;
+    BasicBlock *block = loads.front()->getParent();
+    for (Instruction *load : drop_begin(loads))
+      block = dominatorTree.findNearestCommonDominator(block, load->getParent());
+    if (all_of(loads, [block](Instruction *load) { return load->getParent() == block; })) {
+      removedCount += combineLoads(loads);
+      continue;
+    }
+    auto postDominatesBlock = [&](Instruction *load) { return postDominatorTree.dominates(load->getParent(), block); };
+    bool canHoist = isa<Constant>(std::get<DescIndexKeyElement>(entry.first)) || any_of(loads, postDominatesBlock);
+    crossBlockGroups.push_back({&loads, block, canHoist});
+  }
+
+  // Hoist the groups with the most loads while their descriptors fit in the SGPR budget. The descriptor index
+  // dominates every load, so it also dominates the block that they are hoisted to.
+  stable_sort(crossBlockGroups,
+              [](const auto &lhs, const auto &rhs) { return std::get<0>(lhs)->size() > std::get<0>(rhs)->size(); });
+  unsigned hoistedCount = 0;
+  unsigned rematerializedCount = 0;
+  for (auto &[loads, block, canHoist] : crossBlockGroups) {
+    if (canHoist && (hoistedCount + 1) * DescSgprCount <= SgprBudget) {
+      // Keep the first load in the dominating block if there is one, or else move the first load to its end.
+      auto it = find_if(*loads, [block = block](Instruction *load) { return load->getParent() == block; });
+      if (it == loads->end())
+        loads->front()->moveBefore(block->getTerminator()->getIterator());
+      else
+        std::rotate(loads->begin(), it, std::next(it));
+      removedCount += combineLoads(*loads);
+      ++hoistedCount;
+      continue;
+    }
+
+    MapVector<BasicBlock *, SmallVector<Instruction *, 4>> blockLoads;
+    for (Instruction *load : *loads)
+      blockLoads[load->getParent()].push_back(load);
+    for (auto &blockEntry : blockLoads)
+      removedCount += combineLoads(blockEntry.second);
+    ++rematerializedCount;
+  }
+
+  if (removedCount == 0)
+    return PreservedAnalyses::all();
+
+  NumDescLoadsRemoved += removedCount;
+  NumDescLoadsHoisted += hoistedCount;
+  NumDescLoadsRematerialized += rematerializedCount;
+  if (auto stage = getShaderStage(&function)) {
+    LLPC_OUTS("Descriptor loads in " << getShaderStageAbbreviation(*stage) << " function " << function.getName()
+                                     << ": " << removedCount << " removed, " << hoistedCount
+                                     << " descriptors hoisted across blocks, " << rematerializedCount
+                                     << " rematerialized in each block\n");
+  }
+
+  return PreservedAnalyses::allInSet<CFGAnalyses>();
+}
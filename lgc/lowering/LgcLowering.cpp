@@ -41,6 +41,7 @@
 #include "lgc/lowering/AddBufferOperationMetadata.h"
 #include "lgc/lowering/AddLoopMetadata.h"
 #include "lgc/lowering/ApplyWorkarounds.h"
+#include "lgc/lowering/BlockProfile.h"
 #include "lgc/lowering/CheckShaderCache.h"
 #include "lgc/lowering/CollectImageOperations.h"
 #include "lgc/lowering/CollectResourceUsage.h"
@@ -49,9 +50,11 @@
 #include "lgc/lowering/EmitShaderHashToken.h"
 #include "lgc/lowering/FragmentColorExport.h"
 #include "lgc/lowering/GenerateCopyShader.h"
+#include "lgc/lowering/HoistDescLoads.h"
 #include "lgc/lowering/IncludeLlvmIr.h"
 #include "lgc/lowering/InitializeUndefInputs.h"
 #include "lgc/lowering/InitializeWorkgroupMemory.h"
+#include "lgc/lowering/LimitLoopUnroll.h"
 #include "lgc/lowering/LowerBufferOperations.h"
 #include "lgc/lowering/LowerCooperativeMatrix.h"
 #include "lgc/lowering/LowerDebugPrintf.h"
@@ -63,11 +66,13 @@
 #include "lgc/lowering/LowerMulDx9Zero.h"
 #include "lgc/lowering/LowerReadFirstLane.h"
 #include "lgc/lowering/LowerSubgroupOps.h"
+#include "lgc/lowering/MergeWaterfallLoops.h"
 #include "lgc/lowering/MutateEntryPoint.h"
 #include "lgc/lowering/PassthroughHullShader.h"
 #include "lgc/lowering/PeepholeOptimization.h"
 #include "lgc/lowering/PreparePipelineAbi.h"
 #include "lgc/lowering/ScalarizeLoads.h"
+#include "lgc/lowering/ScalarizeUniformLoads.h"
 #include "lgc/lowering/SetupTargetFeatures.h"
 #include "lgc/lowering/StructurizeBuffers.h"
 #include "lgc/lowering/VertexFetch.h"
@@ -75,6 +80,7 @@
 #include "lgc/state/AbiMetadata.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
+#include "lgc/state/WaveSizeCostModel.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRPrinter/IRPrintingPasses.h"
@@ -204,9 +210,13 @@ void LgcLowering::addPasses(PipelineState *pipelineState, lgc::PassManager &pass
   passMgr.addPass(LowerVertexFetch());
   passMgr.addPass(LowerFragmentColorExport());
   passMgr.addPass(LowerDebugPrintf());
+  if (InstrumentBlockCounters::isEnabled())
+    passMgr.addPass(InstrumentBlockCounters());
   // Mark shader stage for load/store.
   if (pipelineState->getTargetInfo().getGfxIpVersion().major >= 12)
     passMgr.addPass(createModuleToFunctionPassAdaptor(AddBufferOperationMetadata()));
+  if (HoistDescLoads::isEnabled())
+    passMgr.addPass(createModuleToFunctionPassAdaptor(HoistDescLoads()));
   passMgr.addPass(LowerDesc());
   passMgr.addPass(MutateEntryPoint());
   passMgr.addPass(createModuleToFunctionPassAdaptor(LowerPopsInterlock()));
@@ -223,7 +233,14 @@ void LgcLowering::addPasses(PipelineState *pipelineState, lgc::PassManager &pass
     LgcContext::createAndAddStartStopTimer(passMgr, optTimer, true);
   }
 
-  addOptimizationPasses(passMgr, optLevel);
+  // Apply the block profile before optimization, so that it guides the optimization passes.
+  if (ApplyBlockProfile::isEnabled())
+    passMgr.addPass(ApplyBlockProfile());
+
+  if (pipelineState->isReducedOptimization())
+    addReducedOptimizationPasses(passMgr);
+  else
+    addOptimizationPasses(passMgr, optLevel);
 
   if (loweringTimer) {
     LgcContext::createAndAddStartStopTimer(passMgr, optTimer, false);
@@ -266,6 +283,10 @@ void LgcLowering::addPasses(PipelineState *pipelineState, lgc::PassManager &pass
     fpm.addPass(ADCEPass());
     fpm.addPass(StructurizeBuffers());
     fpm.addPass(LowerBufferOperations());
+    if (MergeWaterfallLoops::isEnabled())
+      fpm.addPass(MergeWaterfallLoops());
+    if (ScalarizeUniformLoads::isEnabled())
+      fpm.addPass(ScalarizeUniformLoads());
     fpm.addPass(InstCombinePass());
     fpm.addPass(SimplifyCFGPass());
     passMgr.addPass(createModuleToFunctionPassAdaptor(std::move(fpm)));
@@ -278,6 +299,10 @@ void LgcLowering::addPasses(PipelineState *pipelineState, lgc::PassManager &pass
     FunctionPassManager fpm;
     fpm.addPass(StructurizeBuffers());
     fpm.addPass(LowerBufferOperations());
+    if (MergeWaterfallLoops::isEnabled())
+      fpm.addPass(MergeWaterfallLoops());
+    if (ScalarizeUniformLoads::isEnabled())
+      fpm.addPass(ScalarizeUniformLoads());
     fpm.addPass(InstCombinePass());
     passMgr.addPass(createModuleToFunctionPassAdaptor(std::move(fpm)));
   }
@@ -430,6 +455,8 @@ void LgcLowering::addOptimizationPasses(lgc::PassManager &passMgr, uint32_t optL
   lpm2.addPass(LoopIdiomRecognizePass());
   lpm2.addPass(LoopDeletionPass());
   fpm.addPass(createFunctionToLoopPassAdaptor(std::move(lpm2), true));
+  if (LimitLoopUnroll::isEnabled())
+    fpm.addPass(LimitLoopUnroll());
   fpm.addPass(LoopUnrollPass(
       LoopUnrollOptions(optLevel).setPeeling(true).setRuntime(false).setUpperBound(false).setPartial(false)));
   fpm.addPass(SROAPass(SROAOptions::ModifyCFG));
@@ -452,6 +479,8 @@ void LgcLowering::addOptimizationPasses(lgc::PassManager &passMgr, uint32_t optL
                                   .needCanonicalLoops(true)
                                   .hoistCommonInsts(true)
                                   .sinkCommonInsts(true)));
+  if (LimitLoopUnroll::isEnabled())
+    fpm.addPass(LimitLoopUnroll());
   fpm.addPass(LoopUnrollPass(LoopUnrollOptions(optLevel)));
   fpm.addPass(SROAPass(SROAOptions::ModifyCFG));
   // uses UniformityAnalysis
@@ -466,6 +495,26 @@ void LgcLowering::addOptimizationPasses(lgc::PassManager &passMgr, uint32_t optL
   passMgr.addPass(createModuleToFunctionPassAdaptor(std::move(fpm2)));
 }
 
+// =====================================================================================================================
+// Add the reduced set of optimization passes used when a compile has run over its compile-time budget. This keeps only
+// the cheap passes that clean up after lowering (promoting allocas in particular, to avoid scratch), and leaves out
+// loop transforms, unrolling, scalarization and GVN.
+//
+// @param [in/out] passMgr : Pass manager to add passes to
+void LgcLowering::addReducedOptimizationPasses(lgc::PassManager &passMgr) {
+  LLPC_OUTS("PassManager optimization level = reduced\n");
+
+  passMgr.addPass(ForceFunctionAttrsPass());
+  FunctionPassManager fpm;
+  fpm.addPass(SROAPass(SROAOptions::ModifyCFG));
+  fpm.addPass(EarlyCSEPass(true));
+  fpm.addPass(InstCombinePass());
+  fpm.addPass(SimplifyCFGPass());
+  fpm.addPass(LowerMulDx9Zero());
+  fpm.addPass(InferAlignmentPass());
+  passMgr.addPass(createModuleToFunctionPassAdaptor(std::move(fpm)));
+}
+
 // =====================================================================================================================
 // Initializes the pass according to the specified module.
 //
@@ -0,0 +1,263 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  LimitLoopUnroll.cpp
+ * @brief LLPC source file: contains implementation of class lgc::LimitLoopUnroll.
+ *
+ * @details LoopUnrollPass decides how far to unroll a loop from its size alone. Each unrolled copy of a loop body
+ * that loads memory adds the loaded values to what is live at once, as the scheduler moves the loads of all the copies
+ * ahead of their uses to hide their latency, so unrolling can take a shader past the VGPR count for its target
+ * occupancy, or make it spill.
+ *
+ * This pass runs before each LoopUnrollPass. For each loop it estimates the VGPRs live in the loop as:
+ *
+ *   base + factor * perCopy
+ *
+ * where base is the dwords of divergent values that are live into the loop or carried around it by header phis, and
+ * perCopy is the dwords of divergent values that the loop body loads from memory. Uniform values are left out as they
+ * live in SGPRs. The largest factor that keeps the estimate within the VGPR budget of the shader is turned into an
+ * amdgpu.loop.unroll.threshold of that many copies of the loop, or llvm.loop.unroll.disable if it is one. Loops with
+ * their own unroll metadata, from a SPIR-V loop control or a forced unroll count, are left alone.
+ *
+ * The VGPR budget is the shader's vgprLimit if it has one, and no more than the VGPRs per wave that allow the target
+ * waves per SIMD: the minimum of the function's amdgpu-waves-per-eu attribute, or -lgc-limit-loop-unroll-waves.
+ ***********************************************************************************************************************
+ */
+#include "lgc/lowering/LimitLoopUnroll.h"
+#include "lgc/Occupancy.h"
+#include "lgc/state/PipelineState.h"
+#include "lgc/state/ShaderStage.h"
+#include "lgc/state/TargetInfo.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/UniformityAnalysis.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "lgc-limit-loop-unroll"
+
+using namespace llvm;
+using namespace lgc;
+
+STATISTIC(NumLoopsLimited, "Number of loops whose unrolling is limited by estimated VGPR usage");
+STATISTIC(NumLoopsNotUnrolled, "Number of loops not unrolled because of estimated VGPR usage");
+
+// -lgc-limit-loop-unroll: limit loop unrolling by estimated VGPR usage
+static cl::opt<bool> LimitLoopUnrollOpt("lgc-limit-loop-unroll",
+                                        cl::desc("Limit loop unrolling to keep the estimated VGPR usage within the "
+                                                 "target occupancy"),
+                                        cl::init(false));
+
+// -lgc-limit-loop-unroll-waves: waves per SIMD to keep when the function does not say
+static cl::opt<unsigned> TargetWavesOpt("lgc-limit-loop-unroll-waves",
+                                        cl::desc("Target waves per SIMD for limiting loop unrolling, when the "
+                                                 "function has no amdgpu-waves-per-eu attribute"),
+                                        cl::init(4));
+
+// =====================================================================================================================
+// Get the number of dwords of a value, rounded up.
+//
+// @param value : The value
+// @param dataLayout : Data layout of the module
+// @returns : Number of dwords
+static unsigned getDwordCount(const Value *value, const DataLayout &dataLayout) {
+  return divideCeil(dataLayout.getTypeStoreSize(value->getType()).getKnownMinValue(), 4);
+}
+
+// =====================================================================================================================
+// Check whether a loop has unroll metadata of its own.
+//
+// @param loop : The loop
+// @returns : True if it has llvm.loop.unroll metadata
+static bool hasUnrollMetadata(const Loop &loop) {
+  MDNode *loopId = loop.getLoopID();
+  if (!loopId)
+    return false;
+  for (const MDOperand &operand : drop_begin(loopId->operands())) {
+    auto node = dyn_cast<MDNode>(operand);
+    if (!node || node->getNumOperands() == 0)
+      continue;
+    if (auto name = dyn_cast<MDString>(node->getOperand(0))) {
+      if (name->getString().starts_with("llvm.loop.unroll.") || name->getString() == "llvm.loop.disable_nonforced")
+        return true;
+    }
+  }
+  return false;
+}
+
+// =====================================================================================================================
+// Replace the amdgpu.loop.unroll.threshold metadata of a loop, if any, with new metadata.
+//
+// @param loop : The loop
+// @param newMetadata : The metadata to add
+static void setUnrollMetadata(Loop &loop, MDNode *newMetadata) {
+  LLVMContext &context = loop.getHeader()->getContext();
+  TempMDTuple tempNode = MDNode::getTemporary(context, {});
+  SmallVector<Metadata *, 4> mds = {tempNode.get()};
+  if (MDNode *loopId = loop.getLoopID()) {
+    for (const MDOperand &operand : drop_begin(loopId->operands())) {
+      auto node = dyn_cast<MDNode>(operand);
+      auto name = node && node->getNumOperands() != 0 ? dyn_cast<MDString>(node->getOperand(0)) : nullptr;
+      if (!name || name->getString() != "amdgpu.loop.unroll.threshold")
+        mds.push_back(operand);
+    }
+  }
+  mds.push_back(newMetadata);
+  MDNode *newLoopId = MDNode::getDistinct(context, mds);
+  newLoopId->replaceOperandWith(0, newLoopId);
+  loop.setLoopID(newLoopId);
+}
+
+// =====================================================================================================================
+// Get the number of VGPRs per lane that a function may use and still have its target waves per SIMD.
+//
+// @param function : The function
+// @param pipelineState : Pipeline state
+// @param shaderStage : Shader stage of the function
+// @returns : VGPR budget
+static unsigned getVgprBudget(const Function &function, PipelineState *pipelineState, ShaderStageEnum shaderStage) {
+  unsigned targetWaves = TargetWavesOpt;
+  Attribute wavesPerEu = function.getFnAttribute("amdgpu-waves-per-eu");
+  if (wavesPerEu.isStringAttribute()) {
+    auto [minWavesStr, maxWavesStr] = wavesPerEu.getValueAsString().split(',');
+    unsigned minWaves = 0;
+    unsigned maxWaves = 0;
+    if (!minWavesStr.getAsInteger(0, minWaves) && minWaves > 1)
+      targetWaves = minWaves;
+    if (!maxWavesStr.getAsInteger(0, maxWaves) && maxWaves != 0)
+      targetWaves = std::min(targetWaves, maxWaves);
+  }
+  targetWaves = std::max(targetWaves, 1u);
+
+  const TargetInfo &targetInfo = pipelineState->getTargetInfo();
+  const GfxIpVersion gfxIp = targetInfo.getGfxIpVersion();
+  unsigned budget = getVgprsForWavesPerSimd(gfxIp.major, gfxIp.minor, targetWaves,
+                                            pipelineState->getShaderWaveSize(shaderStage));
+  budget = std::min(budget, targetInfo.getGpuProperty().maxVgprsAvailable);
+  if (unsigned vgprLimit = pipelineState->getShaderOptions(shaderStage).vgprLimit)
+    budget = std::min(budget, vgprLimit);
+  return budget;
+}
+
+// =====================================================================================================================
+// Check whether the pass is enabled.
+bool LimitLoopUnroll::isEnabled() {
+  return LimitLoopUnrollOpt;
+}
+
+// =====================================================================================================================
+// Executes this LGC lowering pass on the specified LLVM function.
+//
+// @param [in/out] function : LLVM function to be run on
+// @param [in/out] analysisManager : Analysis manager to use for this transformation
+// @returns : The preserved analyses (The analyses that are still valid after this pass)
+PreservedAnalyses LimitLoopUnroll::run(Function &function, FunctionAnalysisManager &analysisManager) {
+  auto shaderStage = getShaderStage(&function);
+  if (!shaderStage)
+    return PreservedAnalyses::all();
+
+  LoopInfo &loopInfo = analysisManager.getResult<LoopAnalysis>(function);
+  if (loopInfo.empty())
+    return PreservedAnalyses::all();
+
+  LLVM_DEBUG(dbgs() << "Run the pass Limit-Loop-Unroll on " << function.getName() << "\n");
+
+  const auto &moduleAnalysisManager = analysisManager.getResult<ModuleAnalysisManagerFunctionProxy>(function);
+  PipelineState *pipelineState =
+      moduleAnalysisManager.getCachedResult<PipelineStateWrapper>(*function.getParent())->getPipelineState();
+  const unsigned budget = getVgprBudget(function, pipelineState, *shaderStage);
+  UniformityInfo &uniformityInfo = analysisManager.getResult<UniformityInfoAnalysis>(function);
+  ScalarEvolution &scalarEvolution = analysisManager.getResult<ScalarEvolutionAnalysis>(function);
+  const DataLayout &dataLayout = function.getParent()->getDataLayout();
+  LLVMContext &context = function.getContext();
+
+  bool changed = false;
+  for (Loop *loop : loopInfo.getLoopsInPreorder()) {
+    if (hasUnrollMetadata(*loop))
+      continue;
+
+    unsigned baseDwords = 0;
+    unsigned perCopyDwords = 0;
+    unsigned loopSize = 0;
+    SmallPtrSet<const Value *, 16> liveIns;
+    for (PHINode &phi : loop->getHeader()->phis()) {
+      if (uniformityInfo.isDivergent(&phi))
+        baseDwords += getDwordCount(&phi, dataLayout);
+    }
+    for (BasicBlock *block : loop->blocks()) {
+      for (Instruction &inst : *block) {
+        ++loopSize;
+        if (!inst.getType()->isVoidTy() && inst.mayReadFromMemory() && uniformityInfo.isDivergent(&inst))
+          perCopyDwords += getDwordCount(&inst, dataLayout);
+        // The values that header phis carry into the loop are counted as the phis.
+        if (isa<PHINode>(inst) && block == loop->getHeader())
+          continue;
+        for (Value *operand : inst.operands()) {
+          auto def = dyn_cast<Instruction>(operand);
+          if ((def && !loop->contains(def)) || isa<Argument>(operand)) {
+            if (uniformityInfo.isDivergent(operand) && liveIns.insert(operand).second)
+              baseDwords += getDwordCount(operand, dataLayout);
+          }
+        }
+      }
+    }
+    if (perCopyDwords == 0)
+      continue;
+
+    // The largest number of copies of the loop body whose estimated VGPR usage is within the budget.
+    unsigned maxFactor = baseDwords + perCopyDwords < budget ? (budget - baseDwords) / perCopyDwords : 1;
+    unsigned tripCount = scalarEvolution.getSmallConstantTripCount(loop);
+    LLVM_DEBUG(dbgs() << "Loop at depth " << loop->getLoopDepth() << ": " << baseDwords << " + factor * "
+                      << perCopyDwords << " VGPRs, budget " << budget << ", max unroll factor " << maxFactor
+                      << ", trip count " << tripCount << "\n");
+    if (tripCount != 0 && maxFactor >= tripCount)
+      continue;
+
+    if (maxFactor <= 1) {
+      setUnrollMetadata(*loop, MDNode::get(context, MDString::get(context, "llvm.loop.unroll.disable")));
+      ++NumLoopsNotUnrolled;
+    } else {
+      // LoopUnrollPass unrolls while the size of the unrolled loop is below the threshold.
+      unsigned threshold = loopSize * maxFactor;
+      if (MDNode *existing = findOptionMDForLoop(loop, "amdgpu.loop.unroll.threshold")) {
+        if (existing->getNumOperands() == 2) {
+          if (auto existingThreshold = mdconst::extract_or_null<ConstantInt>(existing->getOperand(1)))
+            threshold = std::min(threshold, unsigned(existingThreshold->getZExtValue()));
+        }
+      }
+      Metadata *thresholdMeta[] = {MDString::get(context, "amdgpu.loop.unroll.threshold"),
+                                   ConstantAsMetadata::get(ConstantInt::get(Type::getInt32Ty(context), threshold))};
+      setUnrollMetadata(*loop, MDNode::get(context, thresholdMeta));
+      ++NumLoopsLimited;
+    }
+    changed = true;
+  }
+
+  return changed ? PreservedAnalyses::allInSet<CFGAnalyses>() : PreservedAnalyses::all();
+}
@@ -159,6 +159,20 @@ BufferOpLowering::BufferOpLowering(TypeLowering &typeLowering, PipelineState &pi
   m_offsetType = m_builder.getPtrTy(ADDR_SPACE_CONST_32BIT);
 }
 
+// =====================================================================================================================
+// Check whether a scalar buffer load can load the given number of bytes. Loads of less than a dword are only allowed
+// on GFX12, when the driver pads the buffer sizes to the next dword.
+//
+// @param pipelineState : the PipelineState object
+// @param accessSize : the number of bytes to load
+// @returns : True if a scalar buffer load can load that many bytes
+bool BufferOpLowering::isScalarLoadSizeAllowed(const PipelineState &pipelineState, unsigned accessSize) {
+  const unsigned gfxIpMajor = pipelineState.getTargetInfo().getGfxIpVersion().major;
+  if (gfxIpMajor <= 11 || (gfxIpMajor == 12 && !pipelineState.getOptions().padBufferSizeToNextDword))
+    return accessSize >= 4;
+  return true;
+}
+
 // =====================================================================================================================
 // Register the visitors for buffer pointer & operation lowering with the given VisitorBuilder.
 //
@@ -1746,17 +1760,11 @@ Value *BufferOpLowering::replaceLoadStore(Instruction &inst) {
 
     Value *indexValue = isStridedPointer ? pointerValues[2] : nullptr;
     if (isLoad) {
-      bool accessSizeAllowed = true;
       if (m_pipelineState.getTargetInfo().getGfxIpVersion().major <= 11) {
         // TODO For stores?
         coherent.bits.dlc = isDlc;
-        accessSizeAllowed = accessSize >= 4;
-      }
-
-      if (!m_pipelineState.getOptions().padBufferSizeToNextDword &&
-          m_pipelineState.getTargetInfo().getGfxIpVersion().major == 12) {
-        accessSizeAllowed = accessSize >= 4;
       }
+      const bool accessSizeAllowed = isScalarLoadSizeAllowed(m_pipelineState, accessSize);
 
       const bool isDivergentPtr = m_uniformityInfo.isDivergent(pointerOperand);
 
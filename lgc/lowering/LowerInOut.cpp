@@ -503,6 +503,7 @@ void LowerInOut::processShader() {
         unsigned workgroupSizeY = mode.workgroupSizeY;
         unsigned workgroupSizeZ = mode.workgroupSizeZ;
         SwizzleWorkgroupLayout layout = calculateWorkgroupLayout(m_pipelineState, m_shaderStage.value());
+        layout = chooseWorkgroupLayoutForImageAccess(m_pipelineState, m_shaderStage.value(), func, layout);
         if (m_gfxIp.major >= 12) {
           // For HW swizzle, the large-pattern unroll is basically the same Z-order pattern used for 2x2
           WorkgroupLayout swizzleWgLayout = WorkgroupLayout::Unknown;
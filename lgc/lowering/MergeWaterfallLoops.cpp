@@ -0,0 +1,298 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  MergeWaterfallLoops.cpp
+ * @brief LLPC source file: contains implementation of class lgc::MergeWaterfallLoops.
+ *
+ * @details BuilderImpl::createWaterfallLoop and beginWaterfallLoop/endWaterfallLoop wrap each non-uniform image or
+ * buffer access in a waterfall loop of its own: a waterfall.begin on the non-uniform index, a readfirstlane of the
+ * index, the access, and a waterfall.end on each result (or a waterfall.last.use on the descriptor of a store). A
+ * shader that does several accesses with the same non-uniform index therefore runs several loops, each of which
+ * iterates once per distinct value of the index.
+ *
+ * This pass merges a waterfall loop into the previous one in the same basic block when both are keyed on a single
+ * index and the indices are the same value, or are computed in the same way from the same values. The second loop's
+ * body joins the first loop, its readfirstlane is replaced by the first loop's, and the first loop's waterfall.end
+ * calls move to the end of the merged loop. The pure instructions between the two loops move out of the way: those
+ * that do not depend on the first loop move before it, and those that do move after the merged loop.
+ ***********************************************************************************************************************
+ */
+#include "lgc/lowering/MergeWaterfallLoops.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+#define DEBUG_TYPE "lgc-merge-waterfall-loops"
+
+using namespace llvm;
+using namespace lgc;
+
+// -lgc-merge-waterfall-loops: merge adjacent waterfall loops on the same non-uniform index
+static cl::opt<bool> MergeWaterfallLoopsOpt("lgc-merge-waterfall-loops",
+                                            cl::desc("Merge adjacent waterfall loops on the same non-uniform index"),
+                                            cl::init(true));
+
+// Maximum depth of the instruction trees compared when proving two indices equal
+static constexpr unsigned MaxIndexCompareDepth = 8;
+
+#if defined(LLVM_HAVE_BRANCH_AMD_GFX)
+namespace {
+
+// Represents a waterfall loop keyed on a single index: a waterfall.begin, the calls that use its token, and the
+// instructions between them.
+struct WaterfallRegion {
+  IntrinsicInst *begin = nullptr;         // The waterfall.begin
+  IntrinsicInst *readFirstLane = nullptr; // The waterfall.readfirstlane of the index, if any
+  SmallVector<IntrinsicInst *, 2> ends;   // The waterfall.end calls, in block order
+  Instruction *last = nullptr;            // The last instruction of the loop
+
+  Value *getIndex() const { return begin->getArgOperand(1); }
+  bool contains(Instruction *inst) const {
+    return inst->getParent() == begin->getParent() && !inst->comesBefore(begin) && !last->comesBefore(inst);
+  }
+};
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Gather a waterfall loop from its waterfall.begin.
+//
+// @param begin : The waterfall.begin
+// @param [out] region : The loop
+// @returns : True if the loop is keyed on a single index, and all the uses of its token are in its basic block
+static bool gatherWaterfallRegion(IntrinsicInst *begin, WaterfallRegion &region) {
+  // A loop on several indices has a chain of waterfall.begin calls, each taking the previous one's token.
+  if (!isa<Constant>(begin->getArgOperand(0)))
+    return false;
+
+  region = {};
+  region.begin = begin;
+  region.last = begin;
+  for (User *user : begin->users()) {
+    auto intrinsic = dyn_cast<IntrinsicInst>(user);
+    if (!intrinsic || intrinsic->getParent() != begin->getParent())
+      return false;
+    switch (intrinsic->getIntrinsicID()) {
+    case Intrinsic::amdgcn_waterfall_readfirstlane:
+      if (intrinsic->getArgOperand(1) == region.getIndex() &&
+          (!region.readFirstLane || intrinsic->comesBefore(region.readFirstLane)))
+        region.readFirstLane = intrinsic;
+      break;
+    case Intrinsic::amdgcn_waterfall_end:
+      region.ends.push_back(intrinsic);
+      break;
+    case Intrinsic::amdgcn_waterfall_last_use:
+    case Intrinsic::amdgcn_waterfall_last_use_vgpr:
+      // The instruction that uses the value, typically a store, is the non-uniform instruction, so it is in the loop.
+      for (User *lastUseUser : intrinsic->users()) {
+        auto lastUseInst = cast<Instruction>(lastUseUser);
+        if (lastUseInst->getParent() != begin->getParent())
+          return false;
+        if (region.last->comesBefore(lastUseInst))
+          region.last = lastUseInst;
+      }
+      break;
+    default:
+      return false;
+    }
+    if (region.last->comesBefore(intrinsic))
+      region.last = intrinsic;
+  }
+  sort(region.ends, [](Instruction *lhs, Instruction *rhs) { return lhs->comesBefore(rhs); });
+
+  // The results of the loop must only be used after it.
+  for (IntrinsicInst *end : region.ends) {
+    for (User *user : end->users()) {
+      if (region.contains(cast<Instruction>(user)))
+        return false;
+    }
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Check whether two values are provably equal: either the same value, or the same pure operation on provably equal
+// operands.
+//
+// @param lhs : First value
+// @param rhs : Second value
+// @param depth : Maximum depth of instructions to compare
+// @returns : True if the values are provably equal
+static bool isProvablyEqual(Value *lhs, Value *rhs, unsigned depth) {
+  if (lhs == rhs)
+    return true;
+  auto lhsInst = dyn_cast<Instruction>(lhs);
+  auto rhsInst = dyn_cast<Instruction>(rhs);
+  if (!lhsInst || !rhsInst || depth == 0)
+    return false;
+  if (!lhsInst->isSameOperationAs(rhsInst) || isa<PHINode>(lhsInst) || isa<CallBase>(lhsInst) ||
+      lhsInst->mayReadOrWriteMemory())
+    return false;
+  for (unsigned idx = 0, end = lhsInst->getNumOperands(); idx != end; ++idx) {
+    if (!isProvablyEqual(lhsInst->getOperand(idx), rhsInst->getOperand(idx), depth - 1))
+      return false;
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Try to merge a waterfall loop into the previous one in the same basic block.
+//
+// @param [in/out] first : The earlier loop, which becomes the merged loop
+// @param second : The later loop, which is removed if it is merged
+// @returns : True if the loops were merged
+static bool mergeWaterfallRegions(WaterfallRegion &first, WaterfallRegion &second) {
+  if (first.begin->getParent() != second.begin->getParent() || !first.last->comesBefore(second.begin))
+    return false;
+  if (!isProvablyEqual(first.getIndex(), second.getIndex(), MaxIndexCompareDepth))
+    return false;
+
+  // Decide where each instruction between the loops goes. They must be pure, so that moving them does not change
+  // what they compute. One that depends on the first loop moves after the merged loop, so the second loop must not
+  // use it.
+  SmallPtrSet<Instruction *, 16> dependsOnFirst;
+  for (Instruction &inst : make_range(first.begin->getIterator(), std::next(first.last->getIterator())))
+    dependsOnFirst.insert(&inst);
+  SmallVector<Instruction *, 8> toHoist;
+  SmallVector<Instruction *, 8> toSink;
+  for (Instruction &inst : make_range(std::next(first.last->getIterator()), second.begin->getIterator())) {
+    if (isa<PHINode>(inst) || isa<CallBase>(inst) || inst.mayReadOrWriteMemory() || inst.mayHaveSideEffects())
+      return false;
+    bool isDependent = any_of(inst.operands(), [&](Value *operand) {
+      auto operandInst = dyn_cast<Instruction>(operand);
+      return operandInst && dependsOnFirst.count(operandInst);
+    });
+    if (!isDependent) {
+      toHoist.push_back(&inst);
+      continue;
+    }
+    if (any_of(inst.users(), [&](User *user) { return second.contains(cast<Instruction>(user)); }))
+      return false;
+    dependsOnFirst.insert(&inst);
+    toSink.push_back(&inst);
+  }
+
+  LLVM_DEBUG(dbgs() << "Merging waterfall loop " << *second.begin << "\n  into " << *first.begin << "\n");
+
+  for (Instruction *inst : toHoist)
+    inst->moveBefore(first.begin->getIterator());
+
+  // Inside the merged loop, the second loop sees the first loop's results for the lanes of the current iteration,
+  // which are the ones it is processing, so it can use them without their waterfall.end.
+  for (IntrinsicInst *end : first.ends) {
+    end->replaceUsesWithIf(end->getArgOperand(1),
+                           [&](Use &use) { return second.contains(cast<Instruction>(use.getUser())); });
+  }
+
+  // Move the second loop's calls onto the first loop's token, and share the first loop's readfirstlane.
+  for (Use &use : make_early_inc_range(second.begin->uses()))
+    use.set(first.begin);
+  if (second.readFirstLane && first.readFirstLane &&
+      second.readFirstLane->getType() == first.readFirstLane->getType()) {
+    second.readFirstLane->replaceAllUsesWith(first.readFirstLane);
+    second.readFirstLane->eraseFromParent();
+  } else if (!first.readFirstLane) {
+    first.readFirstLane = second.readFirstLane;
+  }
+  Value *secondIndex = second.getIndex();
+  second.begin->eraseFromParent();
+  RecursivelyDeleteTriviallyDeadInstructions(secondIndex);
+
+  // The first loop's results, and the instructions that depend on them, now come after the merged loop.
+  Instruction *insertPt = second.last;
+  for (IntrinsicInst *end : first.ends) {
+    end->moveAfter(insertPt);
+    insertPt = end;
+  }
+  first.last = insertPt;
+  for (Instruction *inst : toSink) {
+    inst->moveAfter(insertPt);
+    insertPt = inst;
+  }
+  first.ends.append(second.ends);
+  return true;
+}
+#endif
+
+// =====================================================================================================================
+// Check whether the pass is enabled.
+bool MergeWaterfallLoops::isEnabled() {
+  return MergeWaterfallLoopsOpt;
+}
+
+// =====================================================================================================================
+// Executes this LGC lowering pass on the specified LLVM function.
+//
+// @param [in/out] function : LLVM function to be run on
+// @param [in/out] analysisManager : Analysis manager to use for this transformation
+// @returns : The preserved analyses (The analyses that are still valid after this pass)
+PreservedAnalyses MergeWaterfallLoops::run(Function &function, FunctionAnalysisManager &analysisManager) {
+#if !defined(LLVM_HAVE_BRANCH_AMD_GFX)
+  return PreservedAnalyses::all();
+#else
+  LLVM_DEBUG(dbgs() << "Run the pass Merge-Waterfall-Loops on " << function.getName() << "\n");
+
+  bool changed = false;
+  for (BasicBlock &block : function) {
+    SmallVector<IntrinsicInst *, 4> begins;
+    for (Instruction &inst : block) {
+      if (auto intrinsic = dyn_cast<IntrinsicInst>(&inst)) {
+        if (intrinsic->getIntrinsicID() == Intrinsic::amdgcn_waterfall_begin)
+          begins.push_back(intrinsic);
+      }
+    }
+    if (begins.size() < 2)
+      continue;
+
+    // Merge each loop into the loop before it where possible, so that a run of loops on the same index becomes one.
+    WaterfallRegion current;
+    bool haveCurrent = false;
+    for (IntrinsicInst *begin : begins) {
+      WaterfallRegion next;
+      if (!gatherWaterfallRegion(begin, next)) {
+        haveCurrent = false;
+        continue;
+      }
+      if (haveCurrent && mergeWaterfallRegions(current, next)) {
+        changed = true;
+        continue;
+      }
+      current = next;
+      haveCurrent = true;
+    }
+  }
+
+  if (!changed)
+    return PreservedAnalyses::all();
+  PreservedAnalyses preservedAnalyses;
+  preservedAnalyses.preserveSet<CFGAnalyses>();
+  return preservedAnalyses;
+#endif
+}
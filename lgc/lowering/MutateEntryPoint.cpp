@@ -1642,11 +1642,9 @@ void MutateEntryPoint::setFuncAttrs(Function *entryPoint) {
     builder.addAttribute("amdgpu-unroll-threshold", "700");
   }
 
-  if (shaderOptions->ldsSpillLimitDwords != 0) {
-    // Sanity check: LDS spilling is only supported in Fragment and Compute.
-    if (m_shaderStage == ShaderStage::Fragment || m_shaderStage == ShaderStage::Compute)
-      builder.addAttribute("amdgpu-lds-spill-limit-dwords", std::to_string(shaderOptions->ldsSpillLimitDwords));
-  }
+  // CollectResourceUsage only sets the LDS spill limit for Fragment and Compute, where LDS spilling is supported.
+  if (resUsage->ldsSpillLimitDwords != 0)
+    builder.addAttribute("amdgpu-lds-spill-limit-dwords", std::to_string(resUsage->ldsSpillLimitDwords));
 
   if (shaderOptions->disableCodeSinking)
     builder.addAttribute("disable-code-sinking");
@@ -1069,6 +1069,10 @@ void RegisterMetadataBuilder::buildCsRegisters(ShaderStageEnum shaderStage) {
   getComputeRegNode()[Util::Abi::ComputeRegisterMetadataKey::TgSizeEn] = true;
 
   const auto resUsage = m_pipelineState->getShaderResourceUsage(shaderStage);
+
+  // Allocate the LDS spill area reserved by CollectResourceUsage along with the shader's own LDS.
+  if (shaderStage == ShaderStage::Compute)
+    setLdsSizeByteSize(Util::Abi::HardwareStage::Cs, resUsage->ldsReservedBytes);
   const auto &computeMode = m_pipelineState->getShaderModes()->getComputeShaderMode();
 
   unsigned workgroupSizes[3] = {};
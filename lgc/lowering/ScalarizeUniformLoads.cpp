@@ -0,0 +1,256 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  ScalarizeUniformLoads.cpp
+ * @brief LLPC source file: contains implementation of class lgc::ScalarizeUniformLoads.
+ *
+ * @details LowerBufferOperations only emits a scalar buffer load for a load from an invariant buffer. A load from a
+ * buffer that is merely not written by the shader, at an offset that is the same in every lane, is left as a vector
+ * memory load, returning its uniform result in VGPRs; inside a loop, it is repeated every iteration.
+ *
+ * This pass runs after LowerBufferOperations. It uses LLVM's uniformity analysis, which follows values through phis
+ * and across loops, to find raw buffer loads whose descriptor and offset are uniform, and turns them into scalar
+ * buffer loads. The scalar cache is not coherent with vector memory writes, so this is only done in pipelines that do
+ * not write any memory that a buffer load could read, in any of their stages. A scalar load whose operands are
+ * invariant in the loop that contains it, and which executes whenever the loop does, is then hoisted into the loop
+ * preheader, as far out as possible.
+ ***********************************************************************************************************************
+ */
+#include "lgc/lowering/ScalarizeUniformLoads.h"
+#include "lgc/lowering/LowerBufferOperations.h"
+#include "lgc/state/IntrinsDefs.h"
+#include "lgc/state/PipelineState.h"
+#include "lgc/state/ShaderStage.h"
+#include "lgc/state/TargetInfo.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/UniformityAnalysis.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/IR/PatternMatch.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "lgc-scalarize-uniform-loads"
+
+using namespace llvm;
+using namespace lgc;
+
+STATISTIC(NumLoadsScalarized, "Number of uniform buffer loads turned into scalar loads");
+STATISTIC(NumLoadsHoisted, "Number of scalar loads hoisted out of at least one loop");
+
+// -lgc-scalarize-uniform-loads: turn uniform buffer loads into scalar loads
+static cl::opt<bool> ScalarizeUniformLoadsOpt("lgc-scalarize-uniform-loads",
+                                              cl::desc("Turn buffer loads with a uniform descriptor and offset into "
+                                                       "scalar loads in pipelines that do not write buffer memory"),
+                                              cl::init(false));
+
+// =====================================================================================================================
+// Check whether an instruction may write memory that a buffer load could read.
+//
+// @param inst : The instruction
+// @returns : True if it may write such memory
+static bool mayWriteBufferMemory(const Instruction &inst) {
+  if (!inst.mayWriteToMemory())
+    return false;
+
+  // LDS and private memory cannot be read by a buffer load.
+  auto isBufferAddrSpace = [](unsigned addrSpace) {
+    return addrSpace != ADDR_SPACE_LOCAL && addrSpace != ADDR_SPACE_PRIVATE;
+  };
+  if (auto store = dyn_cast<StoreInst>(&inst))
+    return isBufferAddrSpace(store->getPointerAddressSpace());
+  if (auto atomicRmw = dyn_cast<AtomicRMWInst>(&inst))
+    return isBufferAddrSpace(atomicRmw->getPointerAddressSpace());
+  if (auto cmpXchg = dyn_cast<AtomicCmpXchgInst>(&inst))
+    return isBufferAddrSpace(cmpXchg->getPointerAddressSpace());
+
+  // Calls such as exports only write memory that is not accessible to the shader.
+  if (auto call = dyn_cast<CallBase>(&inst))
+    return isModSet(call->getMemoryEffects().getWithoutLoc(IRMemLocation::InaccessibleMem).getModRef());
+
+  // Fences order this wave's accesses with other waves' writes, which the scalar cache would not see.
+  return true;
+}
+
+// =====================================================================================================================
+// Check whether a raw buffer load can be turned into a scalar buffer load.
+//
+// @param load : The raw buffer load
+// @param uniformityInfo : Uniformity of the values in the function
+// @param pipelineState : Pipeline state
+// @returns : True if it can be scalarized
+static bool isScalarizable(const IntrinsicInst &load, const UniformityInfo &uniformityInfo,
+                           const PipelineState &pipelineState) {
+  // Scalar buffer loads load 1, 2, 4, 8 or 16 dwords, or, where LowerBufferOperations would use them for it, a byte
+  // or a short.
+  Type *type = load.getType();
+  const unsigned accessSize = load.getModule()->getDataLayout().getTypeStoreSize(type);
+  if (!BufferOpLowering::isScalarLoadSizeAllowed(pipelineState, accessSize))
+    return false;
+  if (accessSize < 4) {
+    if (!type->isIntegerTy(8) && !type->isIntegerTy(16))
+      return false;
+  } else {
+    auto vectorType = dyn_cast<FixedVectorType>(type);
+    unsigned numElements = vectorType ? vectorType->getNumElements() : 1;
+    Type *elementType = type->getScalarType();
+    if (!elementType->isIntegerTy(32) && !elementType->isFloatTy())
+      return false;
+    if (!isPowerOf2_32(numElements) || numElements > 16)
+      return false;
+  }
+
+  // Coherent and swizzled loads stay vector memory loads.
+  auto aux = dyn_cast<ConstantInt>(load.getArgOperand(3));
+  if (!aux)
+    return false;
+  CoherentFlag coherent = {};
+  coherent.u32All = aux->getZExtValue();
+  if (pipelineState.getTargetInfo().getGfxIpVersion().major >= 12) {
+    if (coherent.gfx12.scope != 0 || coherent.gfx12.swz)
+      return false;
+  } else if (coherent.bits.glc || coherent.bits.dlc || coherent.bits.swz) {
+    return false;
+  }
+
+  return !uniformityInfo.isDivergent(load.getArgOperand(0)) && !uniformityInfo.isDivergent(load.getArgOperand(1)) &&
+         !uniformityInfo.isDivergent(load.getArgOperand(2));
+}
+
+// =====================================================================================================================
+// Hoist a scalar load out of the loops that it is invariant in, as far out as possible. A load is only hoisted out of
+// a loop if it executes on every path through the loop that leaves it, so that it does not add a load to a path that
+// had none.
+//
+// @param load : The scalar load
+// @param loopInfo : Loop info of the function
+// @param dominatorTree : Dominator tree of the function
+// @returns : True if it was hoisted out of at least one loop
+static bool hoistOutOfLoops(Instruction *load, LoopInfo &loopInfo, DominatorTree &dominatorTree) {
+  bool hoisted = false;
+  for (Loop *loop = loopInfo.getLoopFor(load->getParent()); loop; loop = loop->getParentLoop()) {
+    BasicBlock *preheader = loop->getLoopPreheader();
+    if (!preheader)
+      break;
+    SmallVector<BasicBlock *, 4> exitingBlocks;
+    loop->getExitingBlocks(exitingBlocks);
+    if (any_of(exitingBlocks,
+               [&](BasicBlock *exiting) { return !dominatorTree.dominates(load->getParent(), exiting); }))
+      break;
+
+    // Hoist the computation of the offset along with the load, if it is pure and invariant too.
+    bool changed = false;
+    if (!all_of(load->operands(), [&](Value *operand) {
+          return loop->makeLoopInvariant(operand, changed, preheader->getTerminator());
+        }))
+      break;
+    load->moveBefore(preheader->getTerminator()->getIterator());
+    hoisted = true;
+  }
+  return hoisted;
+}
+
+// =====================================================================================================================
+// Check whether the pass is enabled.
+bool ScalarizeUniformLoads::isEnabled() {
+  return ScalarizeUniformLoadsOpt;
+}
+
+// =====================================================================================================================
+// Executes this LGC lowering pass on the specified LLVM function.
+//
+// @param [in/out] function : LLVM function to be run on
+// @param [in/out] analysisManager : Analysis manager to use for this transformation
+// @returns : The preserved analyses (The analyses that are still valid after this pass)
+PreservedAnalyses ScalarizeUniformLoads::run(Function &function, FunctionAnalysisManager &analysisManager) {
+  const auto &moduleAnalysisManager = analysisManager.getResult<ModuleAnalysisManagerFunctionProxy>(function);
+  PipelineState *pipelineState =
+      moduleAnalysisManager.getCachedResult<PipelineStateWrapper>(*function.getParent())->getPipelineState();
+
+  LLVM_DEBUG(dbgs() << "Run the pass Scalarize-Uniform-Loads on " << function.getName() << "\n");
+
+  auto shaderStage = getShaderStage(&function);
+  if (!shaderStage)
+    return PreservedAnalyses::all();
+
+  // A write anywhere in the pipeline could be to the memory that a load reads: the other stages of a graphics pipeline
+  // run at the same time as this one, on the same data. They are only all in the module for a whole pipeline.
+  if (!pipelineState->isWholePipeline() && pipelineState->isGraphics()) {
+    LLVM_DEBUG(dbgs() << "Not a whole graphics pipeline\n");
+    return PreservedAnalyses::all();
+  }
+  for (Function &pipelineFunc : *function.getParent()) {
+    if (pipelineFunc.isDeclaration())
+      continue;
+    for (Instruction &inst : instructions(pipelineFunc)) {
+      if (mayWriteBufferMemory(inst)) {
+        LLVM_DEBUG(dbgs() << "Pipeline may write buffer memory: " << inst << "\n");
+        return PreservedAnalyses::all();
+      }
+    }
+  }
+
+  UniformityInfo &uniformityInfo = analysisManager.getResult<UniformityInfoAnalysis>(function);
+  SmallVector<IntrinsicInst *, 8> loads;
+  for (Instruction &inst : instructions(function)) {
+    if (auto intrinsic = dyn_cast<IntrinsicInst>(&inst)) {
+      if (intrinsic->getIntrinsicID() == Intrinsic::amdgcn_raw_buffer_load &&
+          isScalarizable(*intrinsic, uniformityInfo, *pipelineState))
+        loads.push_back(intrinsic);
+    }
+  }
+  if (loads.empty())
+    return PreservedAnalyses::all();
+
+  LoopInfo &loopInfo = analysisManager.getResult<LoopAnalysis>(function);
+  DominatorTree &dominatorTree = analysisManager.getResult<DominatorTreeAnalysis>(function);
+  IRBuilder<> builder(function.getContext());
+  for (IntrinsicInst *load : loads) {
+    LLVM_DEBUG(dbgs() << "Scalarizing uniform load: " << *load << "\n");
+    builder.SetInsertPoint(load);
+    Value *offset = load->getArgOperand(1);
+    if (!PatternMatch::match(load->getArgOperand(2), PatternMatch::m_Zero()))
+      offset = builder.CreateAdd(offset, load->getArgOperand(2));
+    CallInst *scalarLoad = builder.CreateIntrinsic(Intrinsic::amdgcn_s_buffer_load, load->getType(),
+                                                   {load->getArgOperand(0), offset, load->getArgOperand(3)});
+    scalarLoad->setMetadata(LLVMContext::MD_invariant_load, MDNode::get(function.getContext(), {}));
+    scalarLoad->takeName(load);
+    load->replaceAllUsesWith(scalarLoad);
+    load->eraseFromParent();
+    ++NumLoadsScalarized;
+
+    if (hoistOutOfLoops(scalarLoad, loopInfo, dominatorTree))
+      ++NumLoadsHoisted;
+  }
+
+  PreservedAnalyses preservedAnalyses;
+  preservedAnalyses.preserveSet<CFGAnalyses>();
+  return preservedAnalyses;
+}
@@ -34,6 +34,8 @@
 #include "lgc/lowering/LgcLowering.h"
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
+#include "lgc/state/WaveSizeCostModel.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IRPrinter/IRPrintingPasses.h"
@@ -146,6 +148,17 @@ std::unique_ptr<Module> PipelineState::irLink(MutableArrayRef<std::unique_ptr<Mo
     attachModule(module.get(), pipelineLink);
   }
 
+  // With -wave-size-cost-model, look at all the shaders while they are still separate modules, before the wave sizes
+  // are determined and recorded below.
+  if (WaveSizeCostModel::isEnabled()) {
+    SmallVector<Module *, 8> shaderModules;
+    for (auto &module : modules) {
+      if (module)
+        shaderModules.push_back(module.get());
+    }
+    runWaveSizeCostModel(shaderModules);
+  }
+
   // The front-end was using a BuilderRecorder; record pipeline state into IR metadata.
   record(modules[0].get());
 
@@ -242,6 +255,14 @@ bool PipelineState::generate(Module *pipelineModule, raw_pwrite_stream &outStrea
     // Run the "whole pipeline" passes.
     passMgr->run(*pipelineModule);
   } else {
+    // With reduced optimization, codegen runs at the lowest optimization level that is supported. The target machine
+    // is shared by all compiles in this LgcContext, so the original level is restored afterwards.
+    TargetMachine *targetMachine = getLgcContext()->getTargetMachine();
+    const CodeGenOptLevel originalOptLevel = targetMachine->getOptLevel();
+    if (m_reducedOptimization && originalOptLevel > CodeGenOptLevel::Less)
+      targetMachine->setOptLevel(CodeGenOptLevel::Less);
+    auto restoreOptLevel = make_scope_exit([&] { targetMachine->setOptLevel(originalOptLevel); });
+
     // LGC lowering.
     LgcLowering::addPasses(this, *passMgr, patchTimer, optTimer, std::move(checkShaderCacheFunc),
                            static_cast<uint32_t>(getLgcContext()->getOptimizationLevel()));
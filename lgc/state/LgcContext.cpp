@@ -34,6 +34,7 @@
 #include "lgc/LgcDialect.h"
 #include "lgc/PassManager.h"
 #include "lgc/lowering/LgcLowering.h"
+#include "lgc/state/GlueShaderTemplateCache.h"
 #include "lgc/state/PassManagerCache.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
@@ -277,6 +278,7 @@ LgcContext::LgcContext(LLVMContext &context, unsigned palAbiVersion) : m_context
 LgcContext::~LgcContext() {
   delete m_targetInfo;
   delete m_passManagerCache;
+  delete m_glueShaderTemplateCache;
 }
 
 // =====================================================================================================================
@@ -358,3 +360,11 @@ PassManagerCache *LgcContext::getPassManagerCache() {
     m_passManagerCache = new PassManagerCache(this);
   return m_passManagerCache;
 }
+
+// =====================================================================================================================
+// Get the cache of glue shader templates
+GlueShaderTemplateCache *LgcContext::getGlueShaderTemplateCache() {
+  if (!m_glueShaderTemplateCache)
+    m_glueShaderTemplateCache = new GlueShaderTemplateCache;
+  return m_glueShaderTemplateCache;
+}
@@ -209,8 +209,9 @@ void PalMetadata::mergeFromBlob(llvm::StringRef blob, bool isGlueCode) {
       return -1;
     // Special cases of merging.
     if (mapKey.isString()) {
-      // For .userdatalimit, register counts, and register limits, take the max value.
+      // For .userdatalimit, register counts, register limits and LDS size, take the max value.
       if (mapKey.getString() == Util::Abi::PipelineMetadataKey::UserDataLimit ||
+          mapKey.getString() == Util::Abi::HardwareStageMetadataKey::LdsSize ||
           mapKey.getString() == Util::Abi::HardwareStageMetadataKey::SgprCount ||
           mapKey.getString() == Util::Abi::HardwareStageMetadataKey::SgprLimit ||
           mapKey.getString() == Util::Abi::HardwareStageMetadataKey::VgprCount ||
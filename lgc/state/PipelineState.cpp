@@ -36,6 +36,7 @@
 #include "lgc/state/AbiMetadata.h"
 #include "lgc/state/PalMetadata.h"
 #include "lgc/state/TargetInfo.h"
+#include "lgc/state/WaveSizeCostModel.h"
 #include "lgc/util/Internal.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Module.h"
@@ -478,6 +479,9 @@ void PipelineState::readState(Module *module) {
   if (!m_palMetadata)
     m_palMetadata = new PalMetadata(this, module);
   readWaveSize(module);
+  // Without wave sizes in the IR, as in lit tests, they are chosen on demand, so the cost model looks at this module.
+  if (m_waveSize[0] == 0 && WaveSizeCostModel::isEnabled())
+    runWaveSizeCostModel(module);
   setXfbStateMetadata(module);
 }
 
@@ -1384,6 +1388,20 @@ void PipelineState::determineShaderWaveSize(Module *module) {
   }
 }
 
+// =====================================================================================================================
+// Run the wave size cost model on the shaders of the given modules, for setShaderDefaultWaveSize to use its choices.
+//
+// @param modules : IR modules of the shaders, before lowering
+void PipelineState::runWaveSizeCostModel(ArrayRef<Module *> modules) {
+  WaveSizeCostModel costModel(*getLgcContext()->getTargetMachine());
+  for (Module *module : modules)
+    costModel.addModule(*module);
+
+  m_preferredWaveSize.clear();
+  for (const auto &[stage, estimate] : costModel.getEstimates())
+    m_preferredWaveSize[stage] = WaveSizeCostModel::getPreferredWaveSize(stage, estimate);
+}
+
 // =====================================================================================================================
 // Get number of patch control points. The front-end supplies this as TessellationMode::inputVertices.
 unsigned PipelineState::getNumPatchControlPoints() const {
@@ -1633,6 +1651,13 @@ void PipelineState::setShaderDefaultWaveSize(ShaderStageEnum stage) {
     if (getTargetInfo().getGfxIpVersion() >= GfxIpVersion({11}))
       waveSize = 64;
 
+    // With -wave-size-cost-model, the cost model's choice replaces the preferences above, except where the legacy GS
+    // path needs wave64.
+    unsigned preferredWaveSize = m_preferredWaveSize.lookup(stage);
+    if (preferredWaveSize != 0 &&
+        !(hasShaderStage(ShaderStage::Geometry) && getTargetInfo().getGfxIpVersion().major < 11))
+      waveSize = preferredWaveSize;
+
     unsigned waveSizeOption = getShaderOptions(stage).waveSize;
     if (waveSizeOption != 0) {
       waveSize = waveSizeOption;
@@ -93,6 +93,10 @@ static void setGfx10BaseInfo(TargetInfo *targetInfo) {
   targetInfo->getGpuProperty().gsOnChipDefaultPrimsPerSubgroup = 64;
 
   targetInfo->getGpuProperty().ldsSizePerThreadGroup = 16384;
+  targetInfo->getGpuProperty().ldsSizePerCu = 16384;
+
+  // Two SIMDs per CU, each with 20 wave slots.
+  targetInfo->getGpuProperty().maxWavesPerCu = 40;
 
   targetInfo->getGpuProperty().maxSgprsAvailable = 102;
   targetInfo->getGpuProperty().supportsDpp = true;
@@ -215,6 +219,8 @@ static void setGfx103Info(TargetInfo *targetInfo) {
   targetInfo->getGpuProperty().supportIntegerDotFlag.compBitwidth4 = true;
   targetInfo->getGpuProperty().supportIntegerDotFlag.sameSignedness = true;
   targetInfo->getGpuProperty().supportsRbPlus = true;
+  // Two SIMDs per CU, each with 16 wave slots.
+  targetInfo->getGpuProperty().maxWavesPerCu = 32;
 }
 
 // gfx1030
@@ -295,6 +301,8 @@ static void setGfx11Info(TargetInfo *targetInfo) {
   targetInfo->getGpuProperty().supportIntegerDotFlag.sameSignedness = true;
   targetInfo->getGpuProperty().supportIntegerDotFlag.diffSignedness = true;
   targetInfo->getGpuProperty().supportsRbPlus = true;
+  // Two SIMDs per CU, each with 16 wave slots.
+  targetInfo->getGpuProperty().maxWavesPerCu = 32;
 }
 
 // gfx1100
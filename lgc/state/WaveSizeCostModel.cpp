@@ -0,0 +1,353 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  WaveSizeCostModel.cpp
+ * @brief LLPC source file: contains implementation of class lgc::WaveSizeCostModel.
+ ***********************************************************************************************************************
+ */
+#include "lgc/state/WaveSizeCostModel.h"
+#include "lgc/LgcContext.h"
+#include "lgc/LgcDialect.h"
+#include "lgc/builder/BuilderRecorder.h"
+#include "lgc/state/PipelineState.h"
+#include "lgc/state/ShaderStage.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/Analysis/CycleAnalysis.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/UniformityAnalysis.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Target/TargetMachine.h"
+
+#define DEBUG_TYPE "lgc-wave-size-cost-model"
+
+using namespace llvm;
+using namespace lgc;
+
+// -wave-size-cost-model: choose the wave size of each shader with the cost model
+static cl::opt<bool> WaveSizeCostModelOpt("wave-size-cost-model",
+                                          cl::desc("Choose wave32 or wave64 for each shader from a cost model of its "
+                                                   "IR, where the wave size is not otherwise requested"),
+                                          cl::init(false));
+
+// Thresholds of the cost model. See lgc/docs/WaveSizeCostModel.md for the reasoning behind them.
+static constexpr unsigned HighPressureDwords = 64;   // Live dwords above which register pressure is high
+static constexpr unsigned MediumPressureDwords = 32; // Live dwords above which register pressure is medium
+static constexpr unsigned ManySubgroupOps = 8;       // Subgroup operations above which a shader is subgroup-heavy
+static constexpr unsigned DivergentBranchRatio = 16; // Instructions per divergent branch at which code is divergent
+
+// Size of the liveness bit matrix of a function, in bits, above which its register pressure is assumed to be high
+// rather than computed
+static constexpr uint64_t MaxLivenessBits = 1 << 24;
+
+// =====================================================================================================================
+// Returns whether the cost model is enabled by -wave-size-cost-model
+bool WaveSizeCostModel::isEnabled() {
+  return WaveSizeCostModelOpt;
+}
+
+// =====================================================================================================================
+// Gets the opcode of a call to a recorded Builder function.
+//
+// @param inst : Instruction to check
+// @returns : Builder opcode, or std::nullopt if the instruction is not a recorded Builder call
+static std::optional<BuilderOpcode> getBuilderOpcode(const Instruction &inst) {
+  auto *call = dyn_cast<CallInst>(&inst);
+  const Function *callee = call ? call->getCalledFunction() : nullptr;
+  if (!callee || !callee->isDeclaration())
+    return std::nullopt;
+  return BuilderRecorder::getOpcode(*callee);
+}
+
+// =====================================================================================================================
+// Checks whether an instruction is a subgroup operation: an lgc subgroup op, or a recorded Builder subgroup or quad
+// operation.
+//
+// @param inst : Instruction to check
+static bool isSubgroupOp(const Instruction &inst) {
+  if (isa<SubgroupElectOp, SubgroupAnyOp, SubgroupAllOp, SubgroupAllEqualOp, SubgroupRotateOp>(inst))
+    return true;
+  // The Builder subgroup operations are numbered together, from SubgroupBroadcast to QuadAny.
+  auto opcode = getBuilderOpcode(inst);
+  return opcode && *opcode >= BuilderOpcode::SubgroupBroadcast && *opcode <= BuilderOpcode::QuadAny;
+}
+
+// =====================================================================================================================
+// Checks whether an instruction accesses memory other than private memory: a load, store, atomic or image operation.
+//
+// @param inst : Instruction to check
+static bool isMemoryOp(const Instruction &inst) {
+  if (auto *load = dyn_cast<LoadInst>(&inst))
+    return load->getPointerAddressSpace() != ADDR_SPACE_PRIVATE;
+  if (auto *store = dyn_cast<StoreInst>(&inst))
+    return store->getPointerAddressSpace() != ADDR_SPACE_PRIVATE;
+  if (isa<AtomicRMWInst, AtomicCmpXchgInst, LoadTfeOp, GroupMemcpyOp>(inst))
+    return true;
+
+  auto opcode = getBuilderOpcode(inst);
+  if (!opcode)
+    return false;
+  switch (*opcode) {
+  case BuilderOpcode::ImageLoad:
+  case BuilderOpcode::ImageLoadWithFmask:
+  case BuilderOpcode::ImageStore:
+  case BuilderOpcode::ImageSample:
+  case BuilderOpcode::ImageSampleConvert:
+  case BuilderOpcode::ImageGather:
+  case BuilderOpcode::ImageAtomic:
+  case BuilderOpcode::ImageAtomicCompareSwap:
+  case BuilderOpcode::ImageBvhIntersectRay:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// =====================================================================================================================
+// Adds the shaders of a module to the estimates. Functions of the same shader stage, even in different modules, are
+// added to the same shader.
+//
+// @param module : IR module, before lowering
+void WaveSizeCostModel::addModule(Module &module) {
+  for (Function &func : module) {
+    if (func.isDeclaration())
+      continue;
+    if (auto stage = getShaderStage(&func))
+      addFunction(func, m_estimates[*stage]);
+  }
+}
+
+// =====================================================================================================================
+// Adds a function to the estimates of its shader.
+//
+// @param func : Function to add
+// @param [in/out] estimate : Estimates of the function's shader
+void WaveSizeCostModel::addFunction(Function &func, WaveSizeEstimate &estimate) const {
+  // Find the divergent values and branches with the target's uniformity analysis. Before lowering, the lgc ops and
+  // recorded Builder calls that cannot introduce divergence are marked NoDivergenceSource; other calls, such as
+  // shader input reads, are sources of divergence, as are atomics and the function arguments.
+  DominatorTree domTree(func);
+  CycleInfo cycleInfo;
+  cycleInfo.compute(func);
+  TargetTransformInfo targetTransformInfo = m_targetMachine.getTargetTransformInfo(func);
+  UniformityInfo uniformityInfo(domTree, cycleInfo, &targetTransformInfo);
+  if (targetTransformInfo.hasBranchDivergence(&func))
+    uniformityInfo.compute();
+
+  for (const BasicBlock &block : func) {
+    for (const Instruction &inst : block) {
+      if (inst.isDebugOrPseudoInst())
+        continue;
+      ++estimate.instCount;
+      if (isMemoryOp(inst))
+        ++estimate.memoryOpCount;
+      if (isSubgroupOp(inst))
+        ++estimate.subgroupOpCount;
+    }
+    if (block.getTerminator() && uniformityInfo.hasDivergentTerminator(block))
+      ++estimate.divergentBranchCount;
+  }
+
+  // Number the divergent values, which is what will need VGPRs, with their sizes in dwords. Uniform values are
+  // assumed to be in SGPRs, and do not count towards the register pressure.
+  const DataLayout &dataLayout = func.getParent()->getDataLayout();
+  DenseMap<const Value *, unsigned> valueIndices;
+  SmallVector<unsigned, 32> valueDwords;
+  auto numberValue = [&](const Value *value) {
+    Type *ty = value->getType();
+    if (!uniformityInfo.isDivergent(value) || !ty->isSized())
+      return;
+    unsigned dwords = divideCeil(dataLayout.getTypeSizeInBits(ty).getFixedValue(), 32);
+    if (dwords == 0)
+      return;
+    valueIndices[value] = valueDwords.size();
+    valueDwords.push_back(dwords);
+  };
+  for (const Argument &arg : func.args())
+    numberValue(&arg);
+  for (const BasicBlock &block : func) {
+    for (const Instruction &inst : block)
+      numberValue(&inst);
+  }
+  if (valueDwords.empty())
+    return;
+
+  SmallVector<const BasicBlock *, 16> blocks(post_order(&func.getEntryBlock()));
+  if (uint64_t(blocks.size()) * valueDwords.size() > MaxLivenessBits) {
+    estimate.peakLiveDwords = std::max(estimate.peakLiveDwords, HighPressureDwords);
+    return;
+  }
+
+  // Compute the upward-exposed uses and the definitions of each block. PHI operands are instead live out of the
+  // corresponding predecessor.
+  const unsigned valueCount = valueDwords.size();
+  DenseMap<const BasicBlock *, unsigned> blockIndices;
+  for (unsigned blockIdx = 0; blockIdx != blocks.size(); ++blockIdx)
+    blockIndices[blocks[blockIdx]] = blockIdx;
+  SmallVector<BitVector, 16> uses(blocks.size(), BitVector(valueCount));
+  SmallVector<BitVector, 16> defs(blocks.size(), BitVector(valueCount));
+  SmallVector<BitVector, 16> liveIns(blocks.size(), BitVector(valueCount));
+  SmallVector<BitVector, 16> liveOuts(blocks.size(), BitVector(valueCount));
+  for (unsigned blockIdx = 0; blockIdx != blocks.size(); ++blockIdx) {
+    for (const Instruction &inst : *blocks[blockIdx]) {
+      if (!isa<PHINode>(inst)) {
+        for (const Value *operand : inst.operands()) {
+          auto it = valueIndices.find(operand);
+          if (it != valueIndices.end() && !defs[blockIdx].test(it->second))
+            uses[blockIdx].set(it->second);
+        }
+      }
+      auto it = valueIndices.find(&inst);
+      if (it != valueIndices.end())
+        defs[blockIdx].set(it->second);
+    }
+  }
+
+  // Iterate the liveness to a fixed point, visiting blocks in post order so that most of it is found in one pass.
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (unsigned blockIdx = 0; blockIdx != blocks.size(); ++blockIdx) {
+      const BasicBlock *block = blocks[blockIdx];
+      BitVector &liveOut = liveOuts[blockIdx];
+      for (const BasicBlock *succ : successors(block)) {
+        liveOut |= liveIns[blockIndices.lookup(succ)];
+        for (const PHINode &phi : succ->phis()) {
+          auto it = valueIndices.find(phi.getIncomingValueForBlock(block));
+          if (it != valueIndices.end())
+            liveOut.set(it->second);
+        }
+      }
+      BitVector liveIn = liveOut;
+      liveIn.reset(defs[blockIdx]);
+      liveIn |= uses[blockIdx];
+      if (liveIn != liveIns[blockIdx]) {
+        liveIns[blockIdx] = std::move(liveIn);
+        changed = true;
+      }
+    }
+  }
+
+  // Walk each block backwards from its live-out values to find the peak number of live dwords.
+  for (unsigned blockIdx = 0; blockIdx != blocks.size(); ++blockIdx) {
+    BitVector live = liveOuts[blockIdx];
+    unsigned liveDwords = 0;
+    for (unsigned valueIdx : live.set_bits())
+      liveDwords += valueDwords[valueIdx];
+    estimate.peakLiveDwords = std::max(estimate.peakLiveDwords, liveDwords);
+
+    for (const Instruction &inst : reverse(*blocks[blockIdx])) {
+      if (isa<PHINode>(inst))
+        break;
+      auto it = valueIndices.find(&inst);
+      if (it != valueIndices.end() && live.test(it->second)) {
+        live.reset(it->second);
+        liveDwords -= valueDwords[it->second];
+      }
+      for (const Value *operand : inst.operands()) {
+        auto operandIt = valueIndices.find(operand);
+        if (operandIt != valueIndices.end() && !live.test(operandIt->second)) {
+          live.set(operandIt->second);
+          liveDwords += valueDwords[operandIt->second];
+        }
+      }
+      estimate.peakLiveDwords = std::max(estimate.peakLiveDwords, liveDwords);
+    }
+  }
+}
+
+// =====================================================================================================================
+// Gets the cost model's score of a shader. A positive score favors wave32, and zero or a negative score favors wave64.
+//
+// @param stage : Shader stage
+// @param estimate : Estimates of the shader
+int WaveSizeCostModel::getScore(ShaderStageEnum stage, const WaveSizeEstimate &estimate) {
+  int score = 0;
+
+  // Register pressure: wave32 keeps twice as many waves resident for the same VGPR count, which matters most for
+  // hiding latency when few waves fit.
+  if (estimate.peakLiveDwords >= HighPressureDwords)
+    score += 2;
+  else if (estimate.peakLiveDwords >= MediumPressureDwords)
+    score += 1;
+
+  // Subgroup operations: reductions, scans and shuffles take fewer steps across 32 lanes.
+  if (estimate.subgroupOpCount >= ManySubgroupOps)
+    score += 2;
+  else if (estimate.subgroupOpCount != 0)
+    score += 1;
+
+  // Divergence: a narrower wave is less likely to execute both sides of a divergent branch.
+  if (estimate.divergentBranchCount != 0 &&
+      estimate.divergentBranchCount * DivergentBranchRatio >= estimate.instCount)
+    score += 1;
+
+  // Memory intensity: wave64 issues each memory instruction for twice the lanes, keeping more requests in flight.
+  if (estimate.instCount != 0) {
+    if (estimate.memoryOpCount * 4 >= estimate.instCount)
+      score -= 2;
+    else if (estimate.memoryOpCount * 8 >= estimate.instCount)
+      score -= 1;
+  }
+
+  // Fragment shaders keep the recommended wave64 unless the other factors clearly favor wave32.
+  if (stage == ShaderStage::Fragment)
+    score -= 1;
+
+  return score;
+}
+
+// =====================================================================================================================
+// Prints the estimates and choice of the cost model for each shader of the module.
+//
+// @param [in/out] module : LLVM module to be run on
+// @param [in/out] analysisManager : Analysis manager to use for this transformation
+// @returns : The preserved analyses (The analyses that are still valid after this pass)
+PreservedAnalyses WaveSizeCostModelPrinter::run(Module &module, ModuleAnalysisManager &analysisManager) {
+  PipelineState *pipelineState = analysisManager.getResult<PipelineStateWrapper>(module).getPipelineState();
+  WaveSizeCostModel costModel(*pipelineState->getLgcContext()->getTargetMachine());
+  costModel.addModule(module);
+  const ShaderStageMap<WaveSizeEstimate> &estimates = costModel.getEstimates();
+
+  m_out << "Wave size cost model:\n";
+  for (ShaderStageEnum stage : ShaderStages) {
+    auto it = estimates.find(stage);
+    if (it == estimates.end())
+      continue;
+    const WaveSizeEstimate &estimate = it->second;
+    m_out << "  " << getShaderStageAbbreviation(stage) << ": instructions " << estimate.instCount
+          << ", peak live dwords " << estimate.peakLiveDwords << ", subgroup ops " << estimate.subgroupOpCount
+          << ", divergent branches " << estimate.divergentBranchCount << ", memory ops " << estimate.memoryOpCount
+          << ", score " << WaveSizeCostModel::getScore(stage, estimate) << ", wave"
+          << WaveSizeCostModel::getPreferredWaveSize(stage, estimate) << "\n";
+  }
+  return PreservedAnalyses::all();
+}
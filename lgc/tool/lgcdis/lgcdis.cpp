@@ -30,6 +30,7 @@
  */
 
 #include "lgc/Disassembler.h"
+#include "lgc/PerfEstimator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
@@ -48,8 +49,29 @@ cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore, cl::ValueRequired,
 // -o: output filename
 cl::opt<std::string> OutFileName("o", cl::cat(LgcDisCategory), cl::desc("Output filename ('-' for stdout)"),
                                  cl::value_desc("filename"));
+
+// -perf-estimate: output a static performance estimate instead of the disassembly
+cl::opt<bool> PerfEstimate("perf-estimate", cl::cat(LgcDisCategory),
+                           cl::desc("Output a static performance estimate of the code instead of disassembling it"));
+
+// -perf-json: output the performance estimate as JSON
+cl::opt<bool> PerfJson("perf-json", cl::cat(LgcDisCategory), cl::desc("Output the performance estimate as JSON"));
 } // anonymous namespace
 
+// =====================================================================================================================
+// Estimate the performance of an object, and output the estimate as text or, with -perf-json, as JSON.
+//
+// @param data : The object file contents
+// @param ostream : The stream to output into
+// @returns : Error::success() if no errors occurred, otherwise returns the Error object
+static Error outputPerfEstimate(MemoryBufferRef data, raw_ostream &ostream) {
+  Expected<ObjectPerfEstimate> estimate = estimateObjectPerf(data);
+  if (!estimate)
+    return estimate.takeError();
+  printObjectPerfEstimate(*estimate, ostream, PerfJson);
+  return Error::success();
+}
+
 // =====================================================================================================================
 // Main code of LGC disassembler utility
 //
@@ -87,7 +109,8 @@ int main(int argc, char **argv) {
       errs() << "\n";
       return 1;
     }
-    Error err = disassembleObject((*fileOrErr)->getMemBufferRef(), ostream);
+    Error err = PerfEstimate || PerfJson ? outputPerfEstimate((*fileOrErr)->getMemBufferRef(), ostream)
+                                         : disassembleObject((*fileOrErr)->getMemBufferRef(), ostream);
     if (err)
       report_fatal_error(Twine((*fileOrErr)->getBufferIdentifier()) + ": " + toString(std::move(err)));
   }
@@ -0,0 +1,302 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "lgc/ElfLinker.h"
+#include "lgc/LgcContext.h"
+#include "lgc/LgcDialect.h"
+#include "lgc/Pipeline.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Target/TargetMachine.h"
+#include "gmock/gmock.h"
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+using namespace lgc;
+using namespace llvm;
+
+namespace {
+
+// Append a POD value to an ELF under construction.
+template <typename T> void appendPod(std::string &elf, const T &value) {
+  elf.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// =====================================================================================================================
+// Build a minimal unlinked compute shader ELF with one global function symbol in .text, one local data symbol in
+// .rodata, and the given number of relocations from .text to the data symbol. This is the shape of input that
+// makes the linker look up the per-input ".rodata" symbol once per relocation.
+//
+// @param inputIdx : Index of this input, used to give the function symbol a unique name
+// @param numRelocs : Number of relocations to generate
+std::string buildUnlinkedElf(unsigned inputIdx, unsigned numRelocs) {
+  // Section indices.
+  enum : unsigned { NullSect, StrTabSect, SymTabSect, TextSect, RodataSect, RelTextSect, NumSects };
+
+  std::string strings(1, '\0');
+  auto addString = [&](StringRef str) {
+    unsigned index = strings.size();
+    strings += str;
+    strings += '\0';
+    return index;
+  };
+  unsigned sectNames[NumSects] = {0,
+                                  addString(".strtab"),
+                                  addString(".symtab"),
+                                  addString(".text"),
+                                  addString(".rodata"),
+                                  addString(".rel.text")};
+
+  // .text: one dword per relocation, filled with s_nop.
+  std::string text;
+  for (unsigned idx = 0; idx != std::max(numRelocs, 1U); ++idx)
+    appendPod<uint32_t>(text, 0xBF800000);
+  std::string rodata(16, '\0');
+
+  // Symbols: null, then the local data symbol, then the global function symbol.
+  SmallVector<ELF::Elf64_Sym, 3> symbols(3);
+  symbols[1].st_name = addString("rodata");
+  symbols[1].setBindingAndType(ELF::STB_LOCAL, ELF::STT_OBJECT);
+  symbols[1].st_shndx = RodataSect;
+  symbols[1].st_size = rodata.size();
+  symbols[2].st_name = addString(("_amdgpu_cs_main_" + Twine(inputIdx)).str());
+  symbols[2].setBindingAndType(ELF::STB_GLOBAL, ELF::STT_FUNC);
+  symbols[2].st_shndx = TextSect;
+  symbols[2].st_size = text.size();
+
+  SmallVector<ELF::Elf64_Rel, 16> relocs(numRelocs);
+  for (unsigned idx = 0; idx != numRelocs; ++idx) {
+    relocs[idx].r_offset = idx * sizeof(uint32_t);
+    relocs[idx].setSymbolAndType(1, ELF::R_AMDGPU_ABS32);
+  }
+
+  // Lay out the file: ELF header, section contents, then the section table.
+  std::string elf;
+  ELF::Elf64_Ehdr ehdr = {};
+  elf.resize(sizeof(ehdr));
+  ELF::Elf64_Shdr shdrs[NumSects] = {};
+  auto addSection = [&](unsigned sectIdx, StringRef contents, unsigned type, uint64_t flags, uint64_t align) {
+    elf.append(offsetToAlignment(elf.size(), Align(align)), '\0');
+    shdrs[sectIdx].sh_name = sectNames[sectIdx];
+    shdrs[sectIdx].sh_type = type;
+    shdrs[sectIdx].sh_flags = flags;
+    shdrs[sectIdx].sh_offset = elf.size();
+    shdrs[sectIdx].sh_size = contents.size();
+    shdrs[sectIdx].sh_addralign = align;
+    elf += contents;
+  };
+  addSection(TextSect, text, ELF::SHT_PROGBITS, ELF::SHF_ALLOC | ELF::SHF_EXECINSTR, 256);
+  addSection(RodataSect, rodata, ELF::SHT_PROGBITS, ELF::SHF_ALLOC, 4);
+  addSection(SymTabSect,
+             StringRef(reinterpret_cast<const char *>(symbols.data()), symbols.size() * sizeof(ELF::Elf64_Sym)),
+             ELF::SHT_SYMTAB, 0, 8);
+  shdrs[SymTabSect].sh_link = StrTabSect;
+  shdrs[SymTabSect].sh_info = 2; // Index of first non-local symbol
+  shdrs[SymTabSect].sh_entsize = sizeof(ELF::Elf64_Sym);
+  addSection(RelTextSect,
+             StringRef(reinterpret_cast<const char *>(relocs.data()), relocs.size() * sizeof(ELF::Elf64_Rel)),
+             ELF::SHT_REL, 0, 8);
+  shdrs[RelTextSect].sh_link = SymTabSect;
+  shdrs[RelTextSect].sh_info = TextSect;
+  shdrs[RelTextSect].sh_entsize = sizeof(ELF::Elf64_Rel);
+  addSection(StrTabSect, strings, ELF::SHT_STRTAB, 0, 1);
+
+  elf.append(offsetToAlignment(elf.size(), Align(8)), '\0');
+  memcpy(ehdr.e_ident, ELF::ElfMagic, strlen(ELF::ElfMagic));
+  ehdr.e_ident[ELF::EI_CLASS] = ELF::ELFCLASS64;
+  ehdr.e_ident[ELF::EI_DATA] = ELF::ELFDATA2LSB;
+  ehdr.e_ident[ELF::EI_VERSION] = ELF::EV_CURRENT;
+  ehdr.e_ident[ELF::EI_OSABI] = ELF::ELFOSABI_AMDGPU_PAL;
+  ehdr.e_type = ELF::ET_REL;
+  ehdr.e_machine = ELF::EM_AMDGPU;
+  ehdr.e_version = ELF::EV_CURRENT;
+  ehdr.e_flags = ELF::EF_AMDGPU_MACH_AMDGCN_GFX1010;
+  ehdr.e_shoff = elf.size();
+  ehdr.e_ehsize = sizeof(ehdr);
+  ehdr.e_shentsize = sizeof(ELF::Elf64_Shdr);
+  ehdr.e_shnum = NumSects;
+  ehdr.e_shstrndx = StrTabSect;
+  memcpy(&elf[0], &ehdr, sizeof(ehdr));
+  elf.append(reinterpret_cast<const char *>(shdrs), sizeof(shdrs));
+  return elf;
+}
+
+// =====================================================================================================================
+// Fixture that owns an LGC context for ELF link tests.
+class ElfLinkerTest : public testing::Test {
+protected:
+  void SetUp() override {
+    LgcContext::initialize();
+    m_dialectContext = llvm_dialects::DialectContext::make<LgcDialect>(m_context);
+    m_targetMachine = LgcContext::createTargetMachine("gfx1010", CodeGenOptLevel::Default);
+    ASSERT_TRUE(m_targetMachine);
+    m_lgcContext.reset(LgcContext::create(&*m_targetMachine, m_context, /*palAbiVersion=*/0xFFFFFFFF));
+  }
+
+  // Link the given number of generated inputs, each with the given number of relocations, and return the
+  // time taken by ElfLinker::link in microseconds.
+  //
+  // @param numInputs : Number of input ELFs
+  // @param numRelocs : Number of relocations in each input ELF
+  // @param [out] linkedElf : Linked ELF
+  int64_t link(unsigned numInputs, unsigned numRelocs, SmallString<0> &linkedElf) {
+    std::vector<std::string> elfs;
+    std::vector<std::string> names;
+    SmallVector<MemoryBufferRef, 16> elfRefs;
+    elfs.reserve(numInputs);
+    names.reserve(numInputs);
+    for (unsigned idx = 0; idx != numInputs; ++idx) {
+      elfs.push_back(buildUnlinkedElf(idx, numRelocs));
+      names.push_back(("input" + Twine(idx) + ".elf").str());
+    }
+    for (unsigned idx = 0; idx != numInputs; ++idx)
+      elfRefs.push_back(MemoryBufferRef(elfs[idx], names[idx]));
+
+    std::unique_ptr<Pipeline> pipeline(m_lgcContext->createPipeline());
+    std::unique_ptr<ElfLinker> elfLinker(pipeline->createElfLinker(elfRefs));
+    linkedElf.clear();
+    raw_svector_ostream outStream(linkedElf);
+    auto startTime = std::chrono::steady_clock::now();
+    bool success = elfLinker->link(outStream);
+    auto endTime = std::chrono::steady_clock::now();
+    EXPECT_TRUE(success);
+    return std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+  }
+
+  // Compile the color export shader of a pipeline with the given internal pipeline hash and one color target, and
+  // return the time taken by ElfLinker::compileGlue in microseconds.
+  //
+  // @param hash : Internal pipeline hash of the pipeline
+  // @param [out] glueElf : ELF of the color export shader
+  int64_t compileColorExportGlue(uint64_t hash, std::string &glueElf) {
+    std::unique_ptr<Pipeline> pipeline(m_lgcContext->createPipeline());
+    Options options = {};
+    options.hash[0] = hash;
+    options.hash[1] = ~hash;
+    pipeline->setOptions(options);
+    ColorExportFormat format = {BufDataFormat32_32_32_32, BufNumFormatFloat, 0, 0, 0xF};
+    pipeline->setColorExportState(format, ColorExportState());
+
+    std::unique_ptr<ElfLinker> elfLinker(pipeline->createElfLinker({}));
+    ColorExportInfo exportInfo = {0, 0, false, FixedVectorType::get(Type::getFloatTy(m_context), 4)};
+    elfLinker->createColorExportShader(exportInfo, /*enableKill=*/false);
+    auto startTime = std::chrono::steady_clock::now();
+    glueElf = elfLinker->compileGlue(0).str();
+    auto endTime = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+  }
+
+  LLVMContext m_context;
+  std::unique_ptr<llvm_dialects::DialectContext> m_dialectContext;
+  std::unique_ptr<TargetMachine> m_targetMachine;
+  std::unique_ptr<LgcContext> m_lgcContext;
+};
+
+} // anonymous namespace
+
+// Check that the linked ELF has a symbol per input function plus one per-input data symbol, and that every input
+// relocation is carried through against its input's data symbol.
+TEST_F(ElfLinkerTest, SymbolsAndRelocations) {
+  constexpr unsigned NumInputs = 8;
+  constexpr unsigned NumRelocs = 5;
+  SmallString<0> linkedElf;
+  link(NumInputs, NumRelocs, linkedElf);
+
+  auto objectFile = cantFail(object::ObjectFile::createELFObjectFile(MemoryBufferRef(linkedElf, "linked")));
+  unsigned numFuncs = 0;
+  unsigned numData = 0;
+  for (const object::SymbolRef &sym : objectFile->symbols()) {
+    StringRef name = cantFail(sym.getName());
+    if (name.starts_with("_amdgpu_cs_main_"))
+      ++numFuncs;
+    else if (name.starts_with("rodata.input"))
+      ++numData;
+  }
+  EXPECT_EQ(numFuncs, NumInputs);
+  EXPECT_EQ(numData, NumInputs);
+
+  unsigned numRelocs = 0;
+  for (const object::SectionRef &section : objectFile->sections()) {
+    for (const object::RelocationRef &reloc : section.relocations()) {
+      EXPECT_TRUE(cantFail(reloc.getSymbol()->getName()).starts_with("rodata.input"));
+      ++numRelocs;
+    }
+  }
+  EXPECT_EQ(numRelocs, NumInputs * NumRelocs);
+}
+
+// Check that ElfLinker::link scales linearly with the number of inputs. Each relocation looks up its input's data
+// symbol by name, so a linear symbol search would make the link quadratic in the number of inputs. The bound is loose,
+// as wall-clock times are noisy on a loaded machine: each size is linked a few times and the fastest is taken, and
+// linking 8 times as many inputs may take up to 32 times as long, where a quadratic link would take 64 times as long.
+// The link times are also recorded as test properties for tracking.
+TEST_F(ElfLinkerTest, LinkScalesWithInputs) {
+  constexpr unsigned NumRelocs = 256;
+  constexpr unsigned SmallNumInputs = 64;
+  constexpr unsigned LargeNumInputs = 512;
+  constexpr unsigned NumRuns = 3;
+  constexpr int64_t MaxGrowth = 4 * (LargeNumInputs / SmallNumInputs);
+  // Floor on the small link time, so that timer granularity cannot make the bound too tight.
+  constexpr int64_t MinSmallLinkTimeUs = 100;
+
+  SmallString<0> linkedElf;
+  int64_t smallLinkTime = std::numeric_limits<int64_t>::max();
+  int64_t largeLinkTime = std::numeric_limits<int64_t>::max();
+  for (unsigned run = 0; run != NumRuns; ++run) {
+    smallLinkTime = std::min(smallLinkTime, link(SmallNumInputs, NumRelocs, linkedElf));
+    largeLinkTime = std::min(largeLinkTime, link(LargeNumInputs, NumRelocs, linkedElf));
+  }
+  RecordProperty("SmallLinkTimeUs", std::to_string(smallLinkTime));
+  RecordProperty("LargeLinkTimeUs", std::to_string(largeLinkTime));
+  EXPECT_LE(largeLinkTime, MaxGrowth * std::max(smallLinkTime, MinSmallLinkTimeUs));
+
+  auto objectFile = cantFail(object::ObjectFile::createELFObjectFile(MemoryBufferRef(linkedElf, "linked")));
+  unsigned numRelocs = 0;
+  for (const object::SectionRef &section : objectFile->sections())
+    numRelocs += std::distance(section.relocation_begin(), section.relocation_end());
+  EXPECT_EQ(numRelocs, LargeNumInputs * NumRelocs);
+}
+
+// Measure the latency that glue shader templates take out of linking: the color export shader of the first pipeline
+// is compiled through codegen as a template, and that of a second pipeline that only differs in its hash is
+// instantiated from it, which only copies and patches the template ELF.
+TEST_F(ElfLinkerTest, GlueShaderTemplateLinkLatency) {
+  std::string compiledElf;
+  std::string instantiatedElf;
+  int64_t compileTime = compileColorExportGlue(0x1111, compiledElf);
+  int64_t instantiateTime = compileColorExportGlue(0x2222, instantiatedElf);
+  RecordProperty("CompileGlueUs", std::to_string(compileTime));
+  RecordProperty("InstantiateGlueUs", std::to_string(instantiateTime));
+
+  ASSERT_FALSE(compiledElf.empty());
+  EXPECT_EQ(instantiatedElf.size(), compiledElf.size());
+  EXPECT_NE(instantiatedElf, compiledElf);
+  EXPECT_LT(instantiateTime, compileTime);
+}
@@ -29,10 +29,268 @@
 ***********************************************************************************************************************
 */
 #include "lgc/util/WorkgroupLayout.h"
+#include "lgc/Debug.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace lgc;
 using namespace llvm;
 
+// -auto-cs-thread-id-swizzle: choose a thread ID swizzle from how the local invocation ID addresses 2D images
+static cl::opt<bool> AutoCsThreadIdSwizzle("auto-cs-thread-id-swizzle",
+                                           cl::desc("Swizzle the thread ID of compute shaders that address 2D images "
+                                                    "with the X and Y of the local invocation ID"),
+                                           cl::init(false));
+
+namespace {
+
+// How a compute shader addresses 2D images with its local invocation ID.
+enum class ImageAccessPattern : unsigned {
+  None,   // No 2D image coordinate derives from the local invocation ID
+  Linear, // Coordinates of a 2D image derive from the local invocation ID, but not separately from X and Y
+  Tiled,  // One coordinate of a 2D image derives from X of the local invocation ID, and another from Y
+};
+
+// Bits of the mask of local invocation ID components that a value derives from.
+constexpr unsigned DerivesFromX = 1;
+constexpr unsigned DerivesFromY = 2;
+
+// Masks of local invocation ID components, for each element of a value. A scalar has one element.
+typedef SmallVector<unsigned, 4> ElementMasks;
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Get the number of elements of a value whose derivation from the local invocation ID is tracked.
+//
+// @param ty : Type of the value
+// @returns : The number of elements, or 0 if the value is not tracked
+static unsigned getElementCount(Type *ty) {
+  unsigned elementCount = 1;
+  if (auto *vecTy = dyn_cast<FixedVectorType>(ty)) {
+    elementCount = vecTy->getNumElements();
+    ty = vecTy->getElementType();
+  }
+  if (!ty->isIntegerTy() && !ty->isFloatingPointTy())
+    return 0;
+  return elementCount;
+}
+
+// =====================================================================================================================
+// Get the mask of local invocation ID components that one element of a value derives from.
+//
+// @param derivation : Element masks of the values found so far to derive from the local invocation ID
+// @param value : The value
+// @param element : The element, or UINT_MAX for the union of all elements
+// @returns : The mask of DerivesFromX and DerivesFromY
+static unsigned getDerivation(const DenseMap<Value *, ElementMasks> &derivation, Value *value, unsigned element) {
+  auto it = derivation.find(value);
+  if (it == derivation.end())
+    return 0;
+  if (element < it->second.size())
+    return it->second[element];
+  unsigned mask = 0;
+  for (unsigned elementMask : it->second)
+    mask |= elementMask;
+  return mask;
+}
+
+// =====================================================================================================================
+// Get the masks of local invocation ID components that each element of the result of an instruction derives from,
+// given those of its operands. Only arithmetic, conversions and vector element moves are followed.
+//
+// @param derivation : Element masks of the values found so far to derive from the local invocation ID
+// @param inst : The instruction
+// @param [out] masks : The element masks of the result of the instruction
+// @returns : False if the derivation is not followed through the instruction
+static bool getDerivation(const DenseMap<Value *, ElementMasks> &derivation, Instruction *inst, ElementMasks &masks) {
+  unsigned elementCount = getElementCount(inst->getType());
+  if (elementCount == 0)
+    return false;
+  masks.assign(elementCount, 0);
+
+  if (auto *extract = dyn_cast<ExtractElementInst>(inst)) {
+    auto *index = dyn_cast<ConstantInt>(extract->getIndexOperand());
+    masks[0] = getDerivation(derivation, extract->getVectorOperand(), index ? index->getZExtValue() : UINT_MAX);
+    return true;
+  }
+
+  if (auto *insert = dyn_cast<InsertElementInst>(inst)) {
+    auto *index = dyn_cast<ConstantInt>(insert->getOperand(2));
+    unsigned scalarMask = getDerivation(derivation, insert->getOperand(1), 0);
+    for (unsigned element = 0; element != elementCount; ++element) {
+      if (index && index->getZExtValue() == element)
+        masks[element] = scalarMask;
+      else
+        masks[element] = getDerivation(derivation, insert->getOperand(0), element) | (index ? 0 : scalarMask);
+    }
+    return true;
+  }
+
+  if (auto *shuffle = dyn_cast<ShuffleVectorInst>(inst)) {
+    unsigned inputCount = cast<FixedVectorType>(shuffle->getOperand(0)->getType())->getNumElements();
+    for (unsigned element = 0; element != elementCount; ++element) {
+      int maskElement = shuffle->getMaskValue(element);
+      if (maskElement < 0)
+        continue;
+      if (unsigned(maskElement) < inputCount)
+        masks[element] = getDerivation(derivation, shuffle->getOperand(0), maskElement);
+      else
+        masks[element] = getDerivation(derivation, shuffle->getOperand(1), maskElement - inputCount);
+    }
+    return true;
+  }
+
+  SmallVector<Value *, 4> operands;
+  if (auto *minMax = dyn_cast<MinMaxIntrinsic>(inst))
+    operands.append({minMax->getLHS(), minMax->getRHS()});
+  else if (auto *select = dyn_cast<SelectInst>(inst))
+    operands.append({select->getTrueValue(), select->getFalseValue()});
+  else if (isa<BinaryOperator>(inst) || isa<UnaryOperator>(inst) || isa<CastInst>(inst) || isa<PHINode>(inst))
+    operands.append(inst->op_begin(), inst->op_end());
+  else
+    return false;
+
+  for (Value *operand : operands) {
+    // An operand with a different number of elements, such as that of a bitcast, taints all elements.
+    bool sameShape = getElementCount(operand->getType()) == elementCount;
+    for (unsigned element = 0; element != elementCount; ++element)
+      masks[element] |= getDerivation(derivation, operand, sameShape ? element : UINT_MAX);
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Classify how a 2D image intrinsic call is addressed by the local invocation ID. The coordinates are the operands
+// before the resource descriptor, after the data of a store or atomic.
+//
+// @param derivation : Element masks of the values that derive from the local invocation ID
+// @param call : The image intrinsic call
+// @returns : The access pattern of the call
+static ImageAccessPattern getImageAccessPattern(const DenseMap<Value *, ElementMasks> &derivation, CallInst &call) {
+  StringRef name = call.getCalledFunction()->getName();
+  unsigned firstCoord = 0;
+  if (name.starts_with("llvm.amdgcn.image.atomic.cmpswap"))
+    firstCoord = 2;
+  else if (name.starts_with("llvm.amdgcn.image.store") || name.starts_with("llvm.amdgcn.image.atomic"))
+    firstCoord = 1;
+
+  SmallVector<unsigned, 4> coordMasks;
+  for (unsigned argIdx = firstCoord; argIdx != call.arg_size(); ++argIdx) {
+    Value *arg = call.getArgOperand(argIdx);
+    if (arg->getType()->isVectorTy() || arg->getType()->isPointerTy())
+      break;
+    if (unsigned mask = getDerivation(derivation, arg, 0))
+      coordMasks.push_back(mask);
+  }
+
+  if (is_contained(coordMasks, DerivesFromX) && is_contained(coordMasks, DerivesFromY))
+    return ImageAccessPattern::Tiled;
+  if (coordMasks.size() >= 2)
+    return ImageAccessPattern::Linear;
+  return ImageAccessPattern::None;
+}
+
+// =====================================================================================================================
+// Find how a compute shader addresses 2D images with its local invocation ID, by following the values that derive
+// from the results of the calls to lgc.reconfigure.local.invocation.id into the coordinates of 2D image intrinsics.
+//
+// @param reconfigFunc : Declaration of lgc.reconfigure.local.invocation.id
+// @param hasY : Whether the workgroup has more than one invocation in Y
+// @returns : The access pattern of the shader, the most tiled of those of its 2D image calls
+static ImageAccessPattern getLocalInvocationIdImageAccess(Function &reconfigFunc, bool hasY) {
+  DenseMap<Value *, ElementMasks> derivation;
+  SmallVector<Instruction *, 16> worklist;
+  for (User *user : reconfigFunc.users()) {
+    auto *reconfigCall = cast<CallInst>(user);
+    // BuiltInUnswizzledLocalInvocationId is never swizzled.
+    if (!cast<ConstantInt>(reconfigCall->getArgOperand(1))->isZero())
+      continue;
+    derivation[reconfigCall] = {DerivesFromX, hasY ? DerivesFromY : 0, 0};
+    worklist.push_back(reconfigCall);
+  }
+
+  // The masks only ever grow, so this reaches a fixed point even around loops.
+  SmallVector<CallInst *, 8> imageCalls;
+  while (!worklist.empty()) {
+    Instruction *inst = worklist.pop_back_val();
+    for (User *user : inst->users()) {
+      auto *userInst = cast<Instruction>(user);
+      if (auto *call = dyn_cast<CallInst>(userInst)) {
+        Function *callee = call->getCalledFunction();
+        if (callee && callee->getName().starts_with("llvm.amdgcn.image.") && callee->getName().contains(".2d")) {
+          if (!is_contained(imageCalls, call))
+            imageCalls.push_back(call);
+          continue;
+        }
+      }
+      ElementMasks masks;
+      if (!getDerivation(derivation, userInst, masks))
+        continue;
+      ElementMasks &oldMasks = derivation[userInst];
+      if (masks == oldMasks)
+        continue;
+      oldMasks = std::move(masks);
+      worklist.push_back(userInst);
+    }
+  }
+
+  ImageAccessPattern pattern = ImageAccessPattern::None;
+  for (CallInst *call : imageCalls)
+    pattern = std::max(pattern, getImageAccessPattern(derivation, *call));
+  return pattern;
+}
+
+// =====================================================================================================================
+// Choose a thread ID swizzle for a compute or task shader that addresses 2D images with the X and Y of its local
+// invocation ID, so that each wave touches a compact tile of the image rather than a row of it. This applies only
+// with -auto-cs-thread-id-swizzle, and only if neither the options nor the derivative mode already chose a layout.
+//
+// @param pipelineState : Pipeline state
+// @param shaderStage : Shader stage
+// @param reconfigFunc : Declaration of lgc.reconfigure.local.invocation.id
+// @param layout : The layout from calculateWorkgroupLayout
+// @returns : The layout to use
+SwizzleWorkgroupLayout lgc::chooseWorkgroupLayoutForImageAccess(PipelineState *pipelineState,
+                                                                ShaderStageEnum shaderStage, Function &reconfigFunc,
+                                                                SwizzleWorkgroupLayout layout) {
+  if (!AutoCsThreadIdSwizzle)
+    return layout;
+  const Options &options = pipelineState->getOptions();
+  if (layout.microLayout != WorkgroupLayout::Unknown || layout.macroLayout != WorkgroupLayout::Unknown ||
+      options.xInterleave != 0 || options.yInterleave != 0)
+    return layout;
+
+  auto &mode = pipelineState->getShaderModes()->getComputeShaderMode();
+  unsigned workgroupSizeX = mode.workgroupSizeX;
+  unsigned workgroupSizeY = mode.workgroupSizeY;
+  const char *stageName = getShaderStageAbbreviation(shaderStage);
+
+  switch (getLocalInvocationIdImageAccess(reconfigFunc, workgroupSizeY > 1)) {
+  case ImageAccessPattern::None:
+    LLPC_OUTS("Thread ID swizzle for " << stageName << ": none, no 2D image is addressed by the local invocation ID\n");
+    break;
+  case ImageAccessPattern::Linear:
+    LLPC_OUTS("Thread ID swizzle for " << stageName << ": none, 2D images are addressed by a linear local invocation "
+                                                       "ID; a 2D workgroup size would allow a swizzle\n");
+    break;
+  case ImageAccessPattern::Tiled:
+    if (workgroupSizeX >= 16 && workgroupSizeX % 8 == 0 && workgroupSizeY % 4 == 0) {
+      layout.macroLayout = WorkgroupLayout::SexagintiQuads;
+      LLPC_OUTS("Thread ID swizzle for " << stageName << ": 8x8 tiles\n");
+    } else if (workgroupSizeX % 2 == 0 && workgroupSizeY % 2 == 0) {
+      layout.microLayout = WorkgroupLayout::Quads;
+      LLPC_OUTS("Thread ID swizzle for " << stageName << ": 2x2 quads\n");
+    } else {
+      LLPC_OUTS("Thread ID swizzle for " << stageName << ": none, workgroup size " << workgroupSizeX << "x"
+                                         << workgroupSizeY << " cannot be swizzled\n");
+    }
+    break;
+  }
+  return layout;
+}
+
 // =====================================================================================================================
 // Do automatic workgroup size reconfiguration in a compute shader, to allow ReconfigWorkgroupLayout
 // to apply optimizations.
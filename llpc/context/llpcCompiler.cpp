@@ -88,6 +88,7 @@
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IRPrinter/IRPrintingPasses.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
@@ -101,8 +102,12 @@
 #include "llvm/Transforms/Scalar/SROA.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <future>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <unordered_set>
 
@@ -144,6 +149,12 @@ opt<std::string> PipelineDumpDir("pipeline-dump-dir", desc("Directory where pipe
 // -enable-pipeline-dump: enable pipeline info dump
 opt<bool> EnablePipelineDump("enable-pipeline-dump", desc("Enable pipeline info dump"), init(false));
 
+// -async-pipeline-dump: write pipeline dump files on a background thread
+opt<bool> AsyncPipelineDump("async-pipeline-dump",
+                            desc("Write pipeline dump files, and disassemble dumped pipeline binaries, on a background "
+                                 "thread instead of the compiling thread"),
+                            init(false));
+
 // DEPRECATED: This option should be removed once XGL sets the corresponding pipeline option.
 // -use-relocatable-shader-elf: Gets LLVM to generate more generic elf files for each shader individually, and LLPC will
 // then link those ELF files to generate the compiled pipeline.
@@ -173,6 +184,12 @@ opt<bool> EnablePerStageCache("enable-per-stage-cache", cl::desc("Enable shader
 opt<int> ContextReuseLimit("context-reuse-limit",
                            cl::desc("The maximum number of times a compiler context can be reused"), init(100));
 
+// -context-memory-budget: The maximum estimated memory (in KB) a compiler context may retain before it is recycled.
+opt<unsigned> ContextMemoryBudget("context-memory-budget",
+                                  cl::desc("Recycle a compiler context once its estimated retained memory exceeds "
+                                           "this many KB (0 means unlimited)"),
+                                  init(0));
+
 // -fatal-llvm-errors: Make all LLVM errors fatal
 opt<bool> FatalLlvmErrors("fatal-llvm-errors", cl::desc("Make all LLVM errors fatal"), init(false));
 
@@ -183,8 +200,32 @@ opt<bool> EnablePartPipeline("enable-part-pipeline", cl::desc("Enable part pipel
 opt<int> AddRtHelpers("add-rt-helpers", cl::desc("Add this number of helper threads for each RT pipeline compile"),
                       init(0));
 
+// -batch-compile-threads: Number of threads used to build the pipelines of a batch
+opt<unsigned> BatchCompileThreads("batch-compile-threads",
+                                  cl::desc("Number of threads used to build the pipelines of a pipeline batch "
+                                           "(0 means use all available cores)"),
+                                  init(0));
+
+// -force-compile-time-budget-exceeded: Treat the compile-time budget of a pipeline as used up, for testing
+opt<bool> ForceCompileTimeBudgetExceeded("force-compile-time-budget-exceeded",
+                                         cl::desc("Treat the compile-time budget of a pipeline that has one as used up "
+                                                  "when it is checked, whatever the time taken (for testing)"),
+                                         init(false));
+
+// -concurrent-part-pipelines: Compile the fragment and pre-rasterization part pipelines concurrently
+opt<bool> ConcurrentPartPipelines("concurrent-part-pipelines",
+                                  cl::desc("Compile the fragment and pre-rasterization part pipelines concurrently"),
+                                  init(true));
+
+// -unlinked-stage-threads: Number of threads used to build the unlinked stages of a relocatable pipeline
+opt<unsigned> UnlinkedStageThreads("unlinked-stage-threads",
+                                   cl::desc("Number of threads used to build the unlinked shader stages of a "
+                                            "relocatable pipeline (0 means one per stage, 1 means sequential)"),
+                                   init(0));
+
 extern opt<bool> EnableOuts;
 extern opt<bool> EnableErrs;
+extern opt<bool> EnableTimerProfile;
 
 extern opt<std::string> LogFileDbgs;
 extern opt<std::string> LogFileOuts;
@@ -433,6 +474,15 @@ Compiler::Compiler(GfxIpVersion gfxIp, const char *apiName, unsigned optionCount
 // =====================================================================================================================
 Compiler::~Compiler() {
   bool shutdown = false;
+  if (uint64_t collapsedCount = getCollapsedCompileCount())
+    LLPC_OUTS("Collapsed " << collapsedCount << " compile requests into identical in-flight compiles\n");
+  if (m_partPipelineCounts.concurrentCompiles || m_partPipelineCounts.preRasterEarlyCacheHits ||
+      m_partPipelineCounts.preRasterLateCacheHits) {
+    TimerProfiler::reportPartPipelineCounts(m_partPipelineCounts.concurrentCompiles,
+                                            m_partPipelineCounts.preRasterEarlyCacheHits,
+                                            m_partPipelineCounts.preRasterLateCacheHits);
+  }
+
   {
     // Free context pool
     std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
@@ -478,6 +528,8 @@ Compiler::~Compiler() {
     remove_fatal_error_handler();
     delete m_contextPool;
     m_contextPool = nullptr;
+    // Finish any asynchronous pipeline dumps now, rather than leaving the dump writer's thread to static destruction.
+    PipelineDumper::ShutdownAsyncDumps();
   }
 }
 
@@ -656,7 +708,8 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
 
     if (shaderModuleData->binType == BinaryType::Spirv && cl::EnablePipelineDump) {
       // Dump the original input binary, since the offline tool will re-run BuildShaderModule
-      PipelineDumper::DumpSpirvBinary(cl::PipelineDumpDir.c_str(), &shaderInfo->shaderBin, &hash);
+      PipelineDumper::DumpSpirvBinary(cl::PipelineDumpDir.c_str(), &shaderInfo->shaderBin, &hash,
+                                      cl::AsyncPipelineDump);
     }
 
     return Result::Success;
@@ -788,7 +841,8 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
 
   if (moduleData.binType == BinaryType::Spirv && cl::EnablePipelineDump) {
     // Dump the original input binary, since the offline tool will re-run BuildShaderModule
-    PipelineDumper::DumpSpirvBinary(cl::PipelineDumpDir.c_str(), &shaderInfo->shaderBin, &hash);
+    PipelineDumper::DumpSpirvBinary(cl::PipelineDumpDir.c_str(), &shaderInfo->shaderBin, &hash,
+                                    cl::AsyncPipelineDump);
   }
 
   return result;
@@ -1625,6 +1679,12 @@ Result Compiler::buildUnlinkedShaderInternal(Context *context, ArrayRef<const Pi
   const auto shaderStages = maskToShaderStages(shaderStageMask);
   assert(all_of(shaderStages, isNativeStage) && "Unexpected stage kind");
 
+  // The stage cache accesses of the shader stages of this unlinked stage. The other unlinked stages of the pipeline
+  // may be building concurrently, so a waiter for an identical in-flight compile must only be given these.
+  const auto typeStages = maskToShaderStages(getShaderStageMaskForType(stage));
+  MutableArrayRef<CacheAccessInfo> typeStageCacheAccesses =
+      stageCacheAccesses.slice(typeStages.front(), typeStages.back() - typeStages.front() + 1);
+
   // Check the cache for the relocatable shader for this stage.
   MetroHash::Hash cacheHash = {};
   auto caches = getInternalCaches();
@@ -1671,9 +1731,16 @@ Result Compiler::buildUnlinkedShaderInternal(Context *context, ArrayRef<const Pi
     for (ShaderStage nativeStage : shaderStages)
       singleStageShaderInfo[nativeStage] = shaderInfo[nativeStage];
 
-    result = buildPipelineInternal(context, singleStageShaderInfo, PipelineLink::Unlinked, nullptr, &elfPackage,
-                                   stageCacheAccesses);
-    if (result == Result::Success) {
+    bool ranCompile = false;
+    result = m_inFlightStages.run(
+        cacheHash, elfPackage, typeStageCacheAccesses,
+        [&](ElfPackage &elf) {
+          return buildPipelineInternal(context, singleStageShaderInfo, PipelineLink::Unlinked, nullptr, &elf,
+                                       stageCacheAccesses);
+        },
+        &ranCompile);
+    // Only the request that ran the compile stores its ELF; the others leave their cache entries to the cache.
+    if (result == Result::Success && ranCompile) {
       // Add the result to the cache.
       BinaryData elfBin = {elfPackage.size(), elfPackage.data()};
       cacheAccessor.setElfInCache(elfBin);
@@ -1711,11 +1778,50 @@ Result Compiler::buildPipelineWithRelocatableElf(Context *context, ArrayRef<cons
   LLPC_OUTS("LLPC version: " << VersionTuple(LLPC_INTERFACE_MAJOR_VERSION, LLPC_INTERFACE_MINOR_VERSION) << "\n");
   LLPC_OUTS("Hash for pipeline cache lookup: " << formatBytesLittleEndian<uint8_t>(originalCacheHash.bytes) << "\n");
 
+  SmallVector<UnlinkedShaderStage, enumCount<UnlinkedShaderStage>()> stages;
   for (UnlinkedShaderStage stage : lgc::enumRange<UnlinkedShaderStage>()) {
-    if (!hasDataForUnlinkedShaderType(stage, shaderInfo))
-      continue;
-    if (buildUnlinkedShaderInternal(context, shaderInfo, stage, elf[stage], stageCacheAccesses) != Result::Success)
+    if (hasDataForUnlinkedShaderType(stage, shaderInfo))
+      stages.push_back(stage);
+  }
+
+  // Each unlinked stage produces an independent relocatable ELF, so the stages of a graphics pipeline can be built
+  // concurrently, each on its own pooled context with its own pipeline context. The stages are built in order on the
+  // given context when verbose output is enabled, so that the log stays readable.
+  const bool buildConcurrently = cl::UnlinkedStageThreads != 1 && stages.size() > 1 && !EnableOuts() &&
+                                 context->getPipelineType() == PipelineType::Graphics;
+  const unsigned numThreads = buildConcurrently ? cl::UnlinkedStageThreads : 1;
+
+  // The per-stage cache lookups happen in buildUnlinkedShaderInternal, before anything is compiled.
+  Result stageResults[enumCount<UnlinkedShaderStage>()] = {};
+  Error err = parallelFor(numThreads, stages, [&](UnlinkedShaderStage stage) -> Error {
+    Result &stageResult = stageResults[stage];
+    if (!buildConcurrently) {
+      stageResult = buildUnlinkedShaderInternal(context, shaderInfo, stage, elf[stage], stageCacheAccesses);
+    } else {
+      auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
+      MetroHash::Hash pipelineHash = context->getPipelineContext()->getPipelineHashCodeWithoutCompact();
+      MetroHash::Hash cacheHash = originalCacheHash;
+      GraphicsContext stageGraphicsContext(m_gfxIp, m_apiName, pipelineInfo, &pipelineHash, &cacheHash);
+      stageGraphicsContext.setUnlinked(true);
+
+      Context *stageContext = acquireContext();
+      stageContext->attachPipelineContext(&stageGraphicsContext);
+      stageResult = buildUnlinkedShaderInternal(stageContext, shaderInfo, stage, elf[stage], stageCacheAccesses);
+      releaseContext(stageContext);
+    }
+    if (stageResult != Result::Success)
+      return createResultError(stageResult, Twine("Failed to build unlinked ") + getUnlinkedShaderStageName(stage) +
+                                                " stage");
+    return Error::success();
+  });
+  // The failure is reported through the result of the first failed stage, so that the caller can fall back to another
+  // compilation scheme instead of linking an incomplete set of ELFs.
+  consumeError(std::move(err));
+  for (UnlinkedShaderStage stage : stages) {
+    if (stageResults[stage] != Result::Success) {
+      result = stageResults[stage];
       break;
+    }
   }
   context->getPipelineContext()->setUnlinked(false);
 
@@ -1797,12 +1903,15 @@ bool Compiler::canUseRelocatableComputeShaderElf(const ComputePipelineBuildInfo
 // @param shaderInfo : Shader info of this pipeline
 // @param pipelineLink : WholePipeline = whole pipeline compile
 //                       Unlinked = shader or part-pipeline compiled without pipeline state such as vertex fetch
-// @param otherPartPipeline : Nullptr or the other Pipeline object containing FS input mappings for a part-pipeline
-//                            compilation of the pre-rasterization stages
+// @param getOtherPartPipeline : Nullptr, or for a part-pipeline compilation of the pre-rasterization stages, a function
+//                               that gets the other Pipeline object containing FS input mappings (or nullptr if there
+//                               are none). It is called once the shaders have been lowered, may wait for the fragment
+//                               part pipeline, and cancels the compile if it returns a result other than Success.
 // @param [out] pipelineElf : Output Elf package
 // @param [out] pipelineElf : Stage cache access info.
 Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const PipelineShaderInfo *> shaderInfo,
-                                       PipelineLink pipelineLink, Pipeline *otherPartPipeline, ElfPackage *pipelineElf,
+                                       PipelineLink pipelineLink,
+                                       function_ref<Result(Pipeline *&)> getOtherPartPipeline, ElfPackage *pipelineElf,
                                        llvm::MutableArrayRef<CacheAccessInfo> stageCacheAccesses) {
   Result result = Result::Success;
   unsigned passIndex = 0;
@@ -1827,8 +1936,14 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
   const PipelineShaderInfo *shaderInfoEntry = shaderInfo[0] ? shaderInfo[0] : shaderInfo.back();
   if (shaderInfoEntry) {
     const ShaderModuleData *moduleData = reinterpret_cast<const ShaderModuleData *>(shaderInfoEntry->pModuleData);
-    if (moduleData && moduleData->binType == BinaryType::LlvmBc)
-      pipelineModule = context->loadLibrary(&moduleData->binCode);
+    if (moduleData && moduleData->binType == BinaryType::LlvmBc) {
+      SmallVector<StringRef> entryNames;
+      for (const PipelineShaderInfo *oneShaderInfo : shaderInfo) {
+        if (oneShaderInfo && oneShaderInfo->pModuleData && oneShaderInfo->pEntryTarget)
+          entryNames.push_back(oneShaderInfo->pEntryTarget);
+      }
+      pipelineModule = context->loadLibrary(&moduleData->binCode, entryNames);
+    }
   }
 
   // If not IR input, run the per-shader passes, including SPIR-V translation, and then link the modules
@@ -1888,16 +2003,14 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
 
       // If input shader module is llvm bc, skip spirv to llvm translation
       if (moduleData->binType == BinaryType::LlvmBc) {
-        llvm::SMDiagnostic errDiag;
-        llvm::StringRef bcStringRef(static_cast<const char *>(moduleData->binCode.pCode), moduleData->binCode.codeSize);
-        llvm::MemoryBufferRef bcBufferRef(bcStringRef, "");
-
-        Expected<std::unique_ptr<Module>> MOrErr = llvm::parseBitcodeFile(bcBufferRef, *context);
-        if (!MOrErr) {
+        SmallVector<StringRef, 1> entryNames;
+        if (shaderInfoEntry->pEntryTarget)
+          entryNames.push_back(shaderInfoEntry->pEntryTarget);
+        modules[shaderIndex] = context->loadLibrary(&moduleData->binCode, entryNames);
+        if (!modules[shaderIndex]) {
           report_fatal_error("Failed to read bitcode");
           continue;
         }
-        modules[shaderIndex] = std::move(*MOrErr);
       }
 
       std::unique_ptr<lgc::PassManager> lowerPassMgr(lgc::PassManager::Create(context->getLgcContext()));
@@ -1993,15 +2106,21 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
 
     // If this is a part-pipeline compile of the pre-rasterization stages, give the "other" pipeline object
     // containing the FS input mappings to our pipeline object.
-    if (otherPartPipeline)
-      pipeline->setOtherPartPipeline(*otherPartPipeline);
+    if (result == Result::Success && getOtherPartPipeline) {
+      Pipeline *otherPartPipeline = nullptr;
+      result = getOtherPartPipeline(otherPartPipeline);
+      if (otherPartPipeline)
+        pipeline->setOtherPartPipeline(*otherPartPipeline);
+    }
 
     // Link the shader modules into a single pipeline module.
-    pipelineModule = pipeline->irLink(
-        modulesToLink, context->getPipelineContext()->isUnlinked() ? PipelineLink::Unlinked : pipelineLink);
-    if (!pipelineModule) {
-      LLPC_ERRS("Failed to link shader modules into pipeline module\n");
-      result = Result::ErrorInvalidShader;
+    if (result == Result::Success) {
+      pipelineModule = pipeline->irLink(
+          modulesToLink, context->getPipelineContext()->isUnlinked() ? PipelineLink::Unlinked : pipelineLink);
+      if (!pipelineModule) {
+        LLPC_ERRS("Failed to link shader modules into pipeline module\n");
+        result = Result::ErrorInvalidShader;
+      }
     }
   }
 
@@ -2029,6 +2148,19 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
   if (!checkPerStageCache)
     checkShaderCacheFunc = nullptr;
 
+  // If the whole-pipeline compile has used up its compile-time budget by now, do the rest with reduced optimization.
+  const unsigned compileTimeBudgetMs = context->getPipelineContext()->getPipelineOptions()->compileTimeBudgetMs;
+  if (result == Result::Success && compileTimeBudgetMs != 0 && pipelineLink == PipelineLink::WholePipeline &&
+      !buildingRelocatableElf) {
+    const uint64_t compileTimeUs = context->getPipelineContext()->getCompileTimeUs();
+    if (compileTimeUs >= uint64_t(compileTimeBudgetMs) * 1000 || cl::ForceCompileTimeBudgetExceeded) {
+      LLPC_OUTS("Compile-time budget of " << compileTimeBudgetMs << " ms used up after " << compileTimeUs / 1000
+                                          << " ms, compiling with reduced optimization\n");
+      pipeline->setReducedOptimization(true);
+      context->getPipelineContext()->setReducedOptimization(true);
+    }
+  }
+
   // Generate pipeline.
   raw_svector_ostream elfStream(*pipelineElf);
 
@@ -2180,14 +2312,17 @@ unsigned GraphicsShaderCacheChecker::check(const Module *module, const unsigned
 // @param result : Result of compile
 // @param outputPipelineElf : ELF output of compile, updated to merge ELF from shader cache
 void GraphicsShaderCacheChecker::updateAndMerge(Result result, ElfPackage *outputPipelineElf) {
-  // Update the shader cache if required, with the compiled pipeline or with a failure state.
+  // Update the shader cache if required, with the compiled pipeline or with a failure state. A pipeline compiled with
+  // reduced optimization is not cached, so that a later compile without a compile-time budget does the full job.
+  const bool cacheable = !m_context->getPipelineContext()->isReducedOptimization();
   bool needToMergeElf = false;
   BinaryData pipelineElf = {};
   pipelineElf.codeSize = outputPipelineElf->size();
   pipelineElf.pCode = outputPipelineElf->data();
   if (m_nonFragmentCacheAccessor) {
     if (!m_nonFragmentCacheAccessor->isInCache()) {
-      m_nonFragmentCacheAccessor->setElfInCache(pipelineElf);
+      if (cacheable)
+        m_nonFragmentCacheAccessor->setElfInCache(pipelineElf);
       LLPC_OUTS("Non fragment shader cache miss.\n");
     } else {
       needToMergeElf = true;
@@ -2197,7 +2332,8 @@ void GraphicsShaderCacheChecker::updateAndMerge(Result result, ElfPackage *outpu
 
   if (m_fragmentCacheAccessor) {
     if (!m_fragmentCacheAccessor->isInCache()) {
-      m_fragmentCacheAccessor->setElfInCache(pipelineElf);
+      if (cacheable)
+        m_fragmentCacheAccessor->setElfInCache(pipelineElf);
       LLPC_OUTS("Fragment shader cache miss.\n");
     } else {
       needToMergeElf = true;
@@ -2230,11 +2366,16 @@ void GraphicsShaderCacheChecker::updateAndMerge(Result result, ElfPackage *outpu
     }
 
     // Merge and store the result in pipelineElf
+    auto mergeStart = std::chrono::steady_clock::now();
     ElfWriter<Elf64> writer(m_context->getGfxIpVersion());
     auto result = writer.ReadFromBuffer(nonFragmentElf.pCode, nonFragmentElf.codeSize);
     assert(result == Result::Success);
     (void(result)); // unused
     writer.mergeElfBinary(m_context, &fragmentElf, outputPipelineElf);
+    auto mergeUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mergeStart).count();
+    TimerProfiler::reportElfMerge(m_context->getPipelineHashCode(), nonFragmentElf.codeSize, fragmentElf.codeSize,
+                                  outputPipelineElf->size(), mergeUs);
   }
 }
 
@@ -2338,13 +2479,76 @@ Result Compiler::buildGraphicsPipelineWithPartPipelines(Context *context,
   context->getPipelineContext()->setPipelineState(&*elfLinkerPipeline, /*hasher=*/nullptr, /*unlinked=*/true);
 
   bool textualOutput = false;
-  // For each of the two part pipelines (fragment first, then pre-rasterization)...
-  for (auto partPipelineStage : lgc::enumRange<PartPipelineStage>()) {
-    // Compile the part pipelines, or find it in the cache.
-    llvm::StringRef partPipelineElf;
-    unsigned partStageMask = partPipelineStage == PartPipelineStageFragment
-                                 ? shaderStageToMask(ShaderStageFragment)
-                                 : wholeStageMask & ~shaderStageToMask(ShaderStageFragment);
+
+  // Add a part-pipeline ELF to the link, first storing it in the cache if it was just compiled.
+  //
+  // @param partPipelineElf : Part-pipeline ELF, from the cache or just compiled
+  // @param cacheAccessor : Accessor to store the ELF in the cache with if this request just compiled it, otherwise
+  //                        nullptr
+  auto addPartPipelineElf = [&](StringRef partPipelineElf, CacheAccessor *cacheAccessor) {
+    // If the "ELF" does not look like ELF, then it must be textual output from -emit-lgc, -emit-llvm,
+    // -filetype=asm. We can't link that, so just concatenate it on to the output. Such output is never cached.
+    if (partPipelineElf.size() < 4 || !partPipelineElf.starts_with("\177ELF")) {
+      const unsigned char magic[] = {'B', 'C', 0xC0, 0xDE};
+      if (partPipelineElf.size() > 4 && memcmp(partPipelineElf.data(), magic, sizeof(magic)) == 0)
+        report_fatal_error("Cannot emit llvm bitcode with part pipeline compilation.");
+      if (textualOutput)
+        *pipelineElf += "Part Pipeline:\n";
+      *pipelineElf += partPipelineElf;
+      textualOutput = true;
+      return;
+    }
+
+    // Store the part-pipeline ELF in the cache.
+    if (cacheAccessor)
+      cacheAccessor->setElfInCache(BinaryData({partPipelineElf.size(), partPipelineElf.data()}));
+
+    if (Llpc::EnableOuts()) {
+      ElfReader<Elf64> reader(m_gfxIp);
+      size_t readSize = 0;
+      if (reader.ReadFromBuffer(partPipelineElf.data(), &readSize) == Result::Success) {
+        LLPC_OUTS("===============================================================================\n");
+        LLPC_OUTS("// LLPC part-pipeline ELF (from cache or just compiled)\n");
+        LLPC_OUTS(reader);
+      }
+    }
+
+    // Add the ELF to the linker.
+    elfLinker->addInputElf(llvm::MemoryBufferRef(partPipelineElf, ""));
+  };
+
+  // Keep the PipelineShaderInfo structs for the shaders included in a part pipeline.
+  auto getPartPipelineShaderInfo = [&](unsigned partStageMask) {
+    llvm::SmallVector<const PipelineShaderInfo *, 4> partPipelineShaderInfo;
+    for (const PipelineShaderInfo *oneShaderInfo : shaderInfo) {
+      if (oneShaderInfo && isShaderStageInMask(oneShaderInfo->entryStage, partStageMask))
+        partPipelineShaderInfo.push_back(oneShaderInfo);
+    }
+    return partPipelineShaderInfo;
+  };
+
+  // Get the stage cache accesses of the shaders in a part pipeline. A waiter for an identical in-flight compile copies
+  // those of the compile, so it must not be given those of the other part pipeline, which may be compiling
+  // concurrently.
+  auto getPartStageCacheAccesses = [&](PartPipelineStage partPipelineStage) {
+    static_assert(ShaderStageFragment + 1 == ShaderStageGfxCount, "Fragment must be the last graphics stage");
+    if (partPipelineStage == PartPipelineStageFragment)
+      return stageCacheAccesses.slice(ShaderStageFragment, 1);
+    return stageCacheAccesses.take_front(ShaderStageFragment);
+  };
+
+  // Get the shader stages of a part pipeline.
+  auto getPartStageMask = [&](PartPipelineStage partPipelineStage) {
+    return partPipelineStage == PartPipelineStageFragment
+               ? shaderStageToMask(ShaderStageFragment)
+               : wholeStageMask & ~shaderStageToMask(ShaderStageFragment);
+  };
+
+  // Hash the shaders of a part pipeline and the pipeline state applicable to them. This leaves the shader stage mask of
+  // the pipeline context set to the part pipeline. For the pre-rasterization part pipeline, that is not the complete
+  // hash, which also covers the FS input mappings from the fragment part pipeline; see completePreRasterHash.
+  auto hashPartPipeline = [&](PartPipelineStage partPipelineStage) {
+    unsigned partStageMask = getPartStageMask(partPipelineStage);
     context->getPipelineContext()->setShaderStageMask(partStageMask);
 
     // TODO: preRasterFlags.hasXfb may need to be set properly for graphics Separate Compilation.
@@ -2353,7 +2557,6 @@ Result Compiler::buildGraphicsPipelineWithPartPipelines(Context *context,
       preRasterFlags.hasGs = true;
       context->getPipelineContext()->setPreRasterFlags(preRasterFlags);
     }
-    // Hash the selected shaders and the pipeline state applicable to them.
     Util::MetroHash64 hasher;
     for (const PipelineShaderInfo *shaderInfoEntry : shaderInfo) {
       if (shaderInfoEntry) {
@@ -2367,77 +2570,214 @@ Result Compiler::buildGraphicsPipelineWithPartPipelines(Context *context,
     // Add applicable pipeline state to the hash. (This uses getShaderStageMask() to decide which parts of the
     // state are applicable.)
     context->getPipelineContext()->setPipelineState(/*pipeline=*/nullptr, /*hasher=*/&hasher, /*unlinked=*/false);
-
-    // If we are doing the pre-rasterization part pipeline, the linker's pipeline object contains the FS input mapping
-    // state. We need to include that state in the hash.
-    if (partPipelineStage == PartPipelineStagePreRasterization && elfLinker->haveFsInputMappings()) {
-      assert(elfLinker);
-      StringRef fsInputMappings = elfLinker->getFsInputMappings();
-      hasher.Update(reinterpret_cast<const uint8_t *>(fsInputMappings.data()), fsInputMappings.size());
-    }
-
-    // Finalize the hash, and look it up in the cache.
     MetroHash::Hash partPipelineHash = {};
     hasher.Finalize(partPipelineHash.bytes);
-    CacheAccessor cacheAccessor(partPipelineHash, getInternalCaches());
-    if (cacheAccessor.isInCache()) {
-      LLPC_OUTS("Cache hit for stage " << getPartPipelineStageName(partPipelineStage) << ".\n");
+    return partPipelineHash;
+  };
 
-      // Mark the applicable entries in stageCacheAccesses.
-      for (ShaderStage shaderStage : maskToShaderStages(partStageMask)) {
-        stageCacheAccesses[shaderStage] = CacheAccessInfo::InternalCacheHit;
-      }
-      // Get the ELF from the cache.
-      partPipelineElf = llvm::StringRef(static_cast<const char *>(cacheAccessor.getElfFromCache().pCode),
-                                        cacheAccessor.getElfFromCache().codeSize);
-    } else {
+  // Complete the pre-rasterization part-pipeline hash with the FS input mappings in the linker's pipeline object, which
+  // are only there once the fragment part pipeline has been added to the link.
+  auto completePreRasterHash = [&](const MetroHash::Hash &preRasterPartialHash) {
+    if (!elfLinker->haveFsInputMappings())
+      return preRasterPartialHash;
+    StringRef fsInputMappings = elfLinker->getFsInputMappings();
+    Util::MetroHash64 hasher;
+    hasher.Update(preRasterPartialHash.bytes, sizeof(preRasterPartialHash.bytes));
+    hasher.Update(reinterpret_cast<const uint8_t *>(fsInputMappings.data()), fsInputMappings.size());
+    MetroHash::Hash preRasterHash = {};
+    hasher.Finalize(preRasterHash.bytes);
+    return preRasterHash;
+  };
+
+  // Look a part pipeline up in the cache, and add it to the link on a hit.
+  //
+  // @param partPipelineStage : Part pipeline to look up
+  // @param cacheAccessor : Accessor for the complete hash of the part pipeline
+  // @returns : True if the part pipeline was in the cache
+  auto addCachedPartPipeline = [&](PartPipelineStage partPipelineStage, CacheAccessor &cacheAccessor) {
+    if (!cacheAccessor.isInCache()) {
       LLPC_OUTS("Cache miss for stage " << getPartPipelineStageName(partPipelineStage) << ".\n");
+      return false;
+    }
+    LLPC_OUTS("Cache hit for stage " << getPartPipelineStageName(partPipelineStage) << ".\n");
+
+    // Mark the applicable entries in stageCacheAccesses.
+    for (ShaderStage shaderStage : maskToShaderStages(getPartStageMask(partPipelineStage)))
+      stageCacheAccesses[shaderStage] = CacheAccessInfo::InternalCacheHit;
+    // Get the ELF from the cache.
+    addPartPipelineElf(llvm::StringRef(static_cast<const char *>(cacheAccessor.getElfFromCache().pCode),
+                                       cacheAccessor.getElfFromCache().codeSize),
+                       nullptr);
+    return true;
+  };
 
-      // Compile the part pipeline.
-      // Keep the PipelineShaderInfo structs for the shaders we are including.
-      llvm::SmallVector<const PipelineShaderInfo *, 4> partPipelineShaderInfo;
-      for (const PipelineShaderInfo *oneShaderInfo : shaderInfo) {
-        if (oneShaderInfo && isShaderStageInMask(oneShaderInfo->entryStage, partStageMask))
-          partPipelineShaderInfo.push_back(oneShaderInfo);
-      }
-      auto otherPartPipeline =
-          (!textualOutput && partPipelineStage == PartPipelineStagePreRasterization) ? &*elfLinkerPipeline : nullptr;
-      Result result =
-          buildPipelineInternal(context, partPipelineShaderInfo, PipelineLink::PartPipeline, otherPartPipeline,
-                                &partPipelineBuffers[partPipelineStage], stageCacheAccesses);
+  // Compile a part pipeline, or wait for an identical compile that is already in flight.
+  //
+  // @param partContext : Context to compile with, its pipeline context set up for the part pipeline
+  // @param partPipelineStage : Part pipeline to compile
+  // @param inFlightHash : Hash that identifies identical compiles
+  // @param getOtherPartPipeline : Passed on to buildPipelineInternal
+  // @param [out] ranCompile : Set to whether this request did the compile rather than waiting for another
+  auto compilePartPipeline = [&](Context *partContext, PartPipelineStage partPipelineStage,
+                                 const MetroHash::Hash &inFlightHash,
+                                 function_ref<Result(Pipeline *&)> getOtherPartPipeline, bool &ranCompile) {
+    return m_inFlightStages.run(
+        inFlightHash, partPipelineBuffers[partPipelineStage], getPartStageCacheAccesses(partPipelineStage),
+        [&](ElfPackage &elf) {
+          return buildPipelineInternal(partContext, getPartPipelineShaderInfo(getPartStageMask(partPipelineStage)),
+                                       PipelineLink::PartPipeline, getOtherPartPipeline, &elf, stageCacheAccesses);
+        },
+        &ranCompile);
+  };
+
+  // Look the fragment part pipeline up in the cache before anything is lowered. The pre-rasterization part pipeline
+  // cannot be looked up yet, as its hash includes the FS input mappings. Instead, the compiler remembers which
+  // pre-rasterization part pipelines it has put in the cache or found there, by their hash without the mappings.
+  const MetroHash::Hash fragmentHash = hashPartPipeline(PartPipelineStageFragment);
+  CacheAccessor fragmentCacheAccessor(fragmentHash, getInternalCaches());
+  const bool fragmentInCache = addCachedPartPipeline(PartPipelineStageFragment, fragmentCacheAccessor);
+  const MetroHash::Hash preRasterPartialHash = hashPartPipeline(PartPipelineStagePreRasterization);
+
+  // The pre-rasterization part pipeline only needs the FS input mappings from the fragment part pipeline, and does
+  // not need them until its shaders have been lowered. So, when the fragment part pipeline misses the cache and the
+  // pre-rasterization one is not known to be cached, they are compiled concurrently, and the pre-rasterization compile
+  // only waits for the fragment one when it needs the FS input mappings. Otherwise, they are handled one after the
+  // other, so that a cached pre-rasterization part pipeline is found without lowering anything. That is also done
+  // when verbose output is enabled, so that the log stays readable.
+  const bool compileConcurrently = cl::ConcurrentPartPipelines && !EnableOuts() && !fragmentInCache &&
+                                   !isPreRasterPartPipelineKnownCached(preRasterPartialHash);
+
+  if (!compileConcurrently) {
+    if (!fragmentInCache) {
+      context->getPipelineContext()->setShaderStageMask(getPartStageMask(PartPipelineStageFragment));
+      bool ranCompile = false;
+      Result result = compilePartPipeline(context, PartPipelineStageFragment, fragmentHash, nullptr, ranCompile);
       if (result != Result::Success)
         return result;
-      partPipelineElf = partPipelineBuffers[partPipelineStage];
-
-      // If the "ELF" does not look like ELF, then it must be textual output from -emit-lgc, -emit-llvm, -filetype=asm.
-      // We can't link that, so just concatenate it on to the output.
-      if (partPipelineElf.size() < 4 || !partPipelineElf.starts_with("\177ELF")) {
-        const unsigned char magic[] = {'B', 'C', 0xC0, 0xDE};
-        if (partPipelineElf.size() > 4 && memcmp(partPipelineElf.data(), magic, sizeof(magic)) == 0)
-          report_fatal_error("Cannot emit llvm bitcode with part pipeline compilation.");
-        if (textualOutput)
-          *pipelineElf += "Part Pipeline:\n";
-        *pipelineElf += partPipelineElf;
-        textualOutput = true;
-        continue;
-      }
+      addPartPipelineElf(partPipelineBuffers[PartPipelineStageFragment], ranCompile ? &fragmentCacheAccessor : nullptr);
+    }
 
-      // Store the part-pipeline ELF in the cache.
-      cacheAccessor.setElfInCache(BinaryData({partPipelineElf.size(), partPipelineElf.data()}));
+    // The linker's pipeline object now contains the FS input mapping state, so the pre-rasterization part pipeline can
+    // be looked up in the cache.
+    context->getPipelineContext()->setShaderStageMask(getPartStageMask(PartPipelineStagePreRasterization));
+    const MetroHash::Hash preRasterHash = completePreRasterHash(preRasterPartialHash);
+    CacheAccessor cacheAccessor(preRasterHash, getInternalCaches());
+    if (addCachedPartPipeline(PartPipelineStagePreRasterization, cacheAccessor)) {
+      ++m_partPipelineCounts.preRasterEarlyCacheHits;
+    } else {
+      Pipeline *otherPartPipeline = textualOutput ? nullptr : &*elfLinkerPipeline;
+      auto getOtherPartPipeline = [otherPartPipeline](Pipeline *&other) {
+        other = otherPartPipeline;
+        return Result::Success;
+      };
+      bool ranCompile = false;
+      Result result = compilePartPipeline(context, PartPipelineStagePreRasterization, preRasterHash,
+                                          getOtherPartPipeline, ranCompile);
+      if (result != Result::Success)
+        return result;
+      addPartPipelineElf(partPipelineBuffers[PartPipelineStagePreRasterization],
+                         ranCompile ? &cacheAccessor : nullptr);
     }
+    if (cacheAccessor.isInCache())
+      addPreRasterPartPipelineKnownCached(preRasterPartialHash);
+  } else {
+    ++m_partPipelineCounts.concurrentCompiles;
 
-    if (Llpc::EnableOuts()) {
-      ElfReader<Elf64> reader(m_gfxIp);
-      size_t readSize = 0;
-      if (reader.ReadFromBuffer(partPipelineElf.data(), &readSize) == Result::Success) {
-        LLPC_OUTS("===============================================================================\n");
-        LLPC_OUTS("// LLPC part-pipeline ELF (from cache or just compiled)\n");
-        LLPC_OUTS(reader);
+    // The fragment part pipeline gets its own context and a copy of the pipeline context set up the same way as ours.
+    auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
+    MetroHash::Hash pipelineHash = context->getPipelineContext()->getPipelineHashCodeWithoutCompact();
+    MetroHash::Hash cacheHash = context->getPipelineContext()->getCacheHashCodeWithoutCompact();
+    GraphicsContext fragmentGraphicsContext(m_gfxIp, m_apiName, pipelineInfo, &pipelineHash, &cacheHash);
+    fragmentGraphicsContext.setShaderStageMask(getPartStageMask(PartPipelineStageFragment));
+    fragmentGraphicsContext.setPreRasterFlags(context->getPipelineContext()->getPreRasterFlags());
+    fragmentGraphicsContext.setUnlinked(context->getPipelineContext()->isUnlinked());
+    std::promise<Result> fragmentPromise;
+    std::future<Result> fragmentFuture = fragmentPromise.get_future();
+    bool fragmentRanCompile = false;
+
+    // Identical pre-rasterization compiles are those with the same shaders and state, and the same fragment part
+    // pipeline to take the FS input mappings from.
+    Util::MetroHash64 inFlightHasher;
+    inFlightHasher.Update(preRasterPartialHash.bytes, sizeof(preRasterPartialHash.bytes));
+    inFlightHasher.Update(fragmentHash.bytes, sizeof(fragmentHash.bytes));
+    MetroHash::Hash preRasterInFlightHash = {};
+    inFlightHasher.Finalize(preRasterInFlightHash.bytes);
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point fragmentStart, fragmentEnd, preRasterStart, preRasterEnd;
+    Clock::duration waitTime = {};
+    bool handedOff = false;
+    std::optional<CacheAccessor> cacheAccessor;
+
+    // Wait for the fragment part pipeline and add it to the link, then complete the pre-rasterization hash with the
+    // FS input mappings and look it up in the cache. A cache hit cancels the compile with Result::NotReady.
+    auto handOff = [&](Pipeline *&otherPartPipeline) -> Result {
+      handedOff = true;
+      Clock::time_point waitStart = Clock::now();
+      Result fragmentResult = fragmentFuture.get();
+      waitTime = Clock::now() - waitStart;
+      if (fragmentResult != Result::Success)
+        return fragmentResult;
+      addPartPipelineElf(partPipelineBuffers[PartPipelineStageFragment],
+                         fragmentRanCompile ? &fragmentCacheAccessor : nullptr);
+
+      cacheAccessor.emplace(completePreRasterHash(preRasterPartialHash), getInternalCaches());
+      if (cacheAccessor->isInCache())
+        return Result::NotReady;
+      otherPartPipeline = textualOutput ? nullptr : &*elfLinkerPipeline;
+      return Result::Success;
+    };
+
+    // Compile the two part pipelines as two tasks, the fragment one first. Each task records its own result.
+    Result result = Result::Success;
+    bool ranCompile = false;
+    const PartPipelineStage partPipelineStages[] = {PartPipelineStageFragment, PartPipelineStagePreRasterization};
+    cantFail(parallelFor(enumCount<PartPipelineStage>(), partPipelineStages, [&](PartPipelineStage partPipelineStage) {
+      if (partPipelineStage == PartPipelineStageFragment) {
+        fragmentStart = Clock::now();
+        Context *fragmentContext = acquireContext();
+        fragmentContext->attachPipelineContext(&fragmentGraphicsContext);
+        Result fragmentResult = compilePartPipeline(fragmentContext, PartPipelineStageFragment, fragmentHash, nullptr,
+                                                    fragmentRanCompile);
+        releaseContext(fragmentContext);
+        fragmentEnd = Clock::now();
+        fragmentPromise.set_value(fragmentResult);
+        return Error::success();
       }
-    }
 
-    // Add the ELF to the linker.
-    elfLinker->addInputElf(llvm::MemoryBufferRef(partPipelineElf, ""));
+      preRasterStart = Clock::now();
+      result = compilePartPipeline(context, PartPipelineStagePreRasterization, preRasterInFlightHash, handOff,
+                                   ranCompile);
+      // A compile that did not get as far as the hand-off, or that waited for an identical compile, still needs the
+      // fragment part pipeline and the cache lookup.
+      if (!handedOff) {
+        Pipeline *otherPartPipeline = nullptr;
+        Result handOffResult = handOff(otherPartPipeline);
+        if (result == Result::Success)
+          result = handOffResult;
+      }
+      preRasterEnd = Clock::now();
+      return Error::success();
+    }));
+
+    auto toUs = [](Clock::duration duration) {
+      return uint64_t(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+    };
+    TimerProfiler::reportPartPipelineOverlap(context->getPipelineHashCode(), toUs(fragmentEnd - fragmentStart),
+                                             toUs(preRasterEnd - preRasterStart), toUs(waitTime),
+                                             toUs(std::min(fragmentEnd, preRasterEnd) - preRasterStart));
+
+    if (result == Result::NotReady && cacheAccessor && cacheAccessor->isInCache()) {
+      ++m_partPipelineCounts.preRasterLateCacheHits;
+      addCachedPartPipeline(PartPipelineStagePreRasterization, *cacheAccessor);
+    } else if (result == Result::Success) {
+      addPartPipelineElf(partPipelineBuffers[PartPipelineStagePreRasterization],
+                         ranCompile ? &*cacheAccessor : nullptr);
+    } else {
+      return result;
+    }
+    if (cacheAccessor->isInCache())
+      addPreRasterPartPipelineKnownCached(preRasterPartialHash);
   }
 
   Result result = Result::Success;
@@ -2518,13 +2858,26 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
   }
 
   ElfPackage candidateElf;
+  pipelineOut->reducedOptimization = false;
+  bool ranCompile = true;
 
   if (!cacheAccessor || !cacheAccessor->isInCache()) {
     LLPC_OUTS("Cache miss for graphics pipeline.\n");
-    GraphicsContext *graphicsContext = new GraphicsContext(m_gfxIp, m_apiName, pipelineInfo, &pipelineHash, &cacheHash);
-    result = buildGraphicsPipelineInternal(graphicsContext, shaderInfo, buildUsingRelocatableElf, &candidateElf,
-                                           pipelineOut->stageCacheAccesses);
-    delete graphicsContext;
+    auto buildPipeline = [&](ElfPackage &elf) {
+      GraphicsContext *graphicsContext =
+          new GraphicsContext(m_gfxIp, m_apiName, pipelineInfo, &pipelineHash, &cacheHash);
+      Result buildResult = buildGraphicsPipelineInternal(graphicsContext, shaderInfo, buildUsingRelocatableElf, &elf,
+                                                         pipelineOut->stageCacheAccesses);
+      pipelineOut->reducedOptimization = graphicsContext->isReducedOptimization();
+      delete graphicsContext;
+      return buildResult;
+    };
+    // A compile with a compile-time budget must not wait for an identical compile that has no budget.
+    if (pipelineInfo->options.compileTimeBudgetMs != 0)
+      result = buildPipeline(candidateElf);
+    else
+      result = m_inFlightPipelines.run(cacheHash, candidateElf, pipelineOut->stageCacheAccesses, buildPipeline,
+                                       &ranCompile);
 
     if (result == Result::Success) {
       elfBin.codeSize = candidateElf.size();
@@ -2557,7 +2910,8 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
     }
   }
 
-  if (cacheAccessor && !cacheAccessor->isInCache() && result == Result::Success) {
+  if (cacheAccessor && !cacheAccessor->isInCache() && result == Result::Success && ranCompile &&
+      !pipelineOut->reducedOptimization) {
     LLPC_OUTS("Adding graphics pipeline to the cache.\n");
     cacheAccessor->setElfInCache(elfBin);
   }
@@ -2676,13 +3030,25 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
   }
 
   ElfPackage candidateElf;
+  pipelineOut->reducedOptimization = false;
+  bool ranCompile = true;
   if (!cacheAccessor || !cacheAccessor->isInCache()) {
     LLPC_OUTS("Cache miss for compute pipeline.\n");
-    ComputeContext *computeContext =
-        new ComputeContext(m_gfxIp, m_apiName, pipelineInfo, outStream.str(), &pipelineHash, &cacheHash);
-    result = buildComputePipelineInternal(computeContext, pipelineInfo, buildUsingRelocatableElf, &candidateElf,
-                                          &pipelineOut->stageCacheAccess);
-    delete computeContext;
+    auto buildPipeline = [&](ElfPackage &elf) {
+      ComputeContext *computeContext =
+          new ComputeContext(m_gfxIp, m_apiName, pipelineInfo, outStream.str(), &pipelineHash, &cacheHash);
+      Result buildResult = buildComputePipelineInternal(computeContext, pipelineInfo, buildUsingRelocatableElf, &elf,
+                                                        &pipelineOut->stageCacheAccess);
+      pipelineOut->reducedOptimization = computeContext->isReducedOptimization();
+      delete computeContext;
+      return buildResult;
+    };
+    // A compile with a compile-time budget must not wait for an identical compile that has no budget.
+    if (pipelineInfo->options.compileTimeBudgetMs != 0)
+      result = buildPipeline(candidateElf);
+    else
+      result = m_inFlightPipelines.run(cacheHash, candidateElf, pipelineOut->stageCacheAccess, buildPipeline,
+                                       &ranCompile);
 
     if (cacheAccessor && pipelineOut->pipelineCacheAccess == CacheAccessInfo::CacheNotChecked)
       pipelineOut->pipelineCacheAccess = CacheAccessInfo::CacheMiss;
@@ -2712,7 +3078,7 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
   pipelineOut->pipelineBin.codeSize = elfBin.codeSize;
   pipelineOut->pipelineBin.pCode = code;
 
-  if (cacheAccessor && !cacheAccessor->isInCache()) {
+  if (cacheAccessor && !cacheAccessor->isInCache() && ranCompile && !pipelineOut->reducedOptimization) {
     cacheAccessor->setElfInCache(elfBin);
   }
 
@@ -2938,6 +3304,216 @@ Result Compiler::BuildRayTracingPipeline(const RayTracingPipelineBuildInfo *pipe
   return result;
 }
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 77
+// =====================================================================================================================
+// Gets a rough estimate of the cost of compiling the given shaders, based on the size of their SPIR-V.
+//
+// @param shaderInfo : Shader info of the pipeline
+static size_t estimateCompileCost(ArrayRef<const PipelineShaderInfo *> shaderInfo) {
+  size_t cost = 0;
+  for (const PipelineShaderInfo *info : shaderInfo) {
+    if (info && info->pModuleData)
+      cost += reinterpret_cast<const ShaderModuleData *>(info->pModuleData)->binCode.codeSize;
+  }
+  return cost;
+}
+
+// =====================================================================================================================
+// Copy the output of a ray tracing pipeline into a single new allocation, laid out the same way as
+// BuildRayTracingPipeline lays it out.
+//
+// @param source : Output of the ray tracing pipeline that was compiled
+// @param [out] dest : Output that receives the copy
+// @param destInfo : Build info of the pipeline that receives the copy, for its allocator
+static Result copyRayTracingPipelineOut(const RayTracingPipelineBuildOut &source, RayTracingPipelineBuildOut &dest,
+                                        const RayTracingPipelineBuildInfo *destInfo) {
+  size_t elfSize = 0;
+  for (unsigned i = 0; i < source.pipelineBinCount; ++i)
+    elfSize += source.pipelineBins[i].codeSize;
+  const size_t alignedElfSize = alignTo(elfSize, alignof(BinaryData));
+  const size_t binaryDataSize = sizeof(BinaryData) * source.pipelineBinCount;
+  const size_t shaderPropsSize = sizeof(RayTracingShaderProperty) * source.shaderPropSet.shaderCount;
+  const size_t shaderGroupHandleSize = sizeof(RayTracingShaderIdentifier) * source.shaderGroupHandle.shaderHandleCount;
+  const size_t summarySize = alignTo(source.librarySummary.codeSize, 8);
+
+  if (!destInfo->pfnOutputAlloc)
+    return Result::ErrorInvalidPointer;
+  void *allocBuf = destInfo->pfnOutputAlloc(destInfo->pInstance, destInfo->pUserData,
+                                            alignedElfSize + binaryDataSize + shaderPropsSize + shaderGroupHandleSize +
+                                                summarySize);
+  if (!allocBuf)
+    return Result::ErrorOutOfMemory;
+
+  dest = source;
+  BinaryData *pipelineBins = reinterpret_cast<BinaryData *>(voidPtrInc(allocBuf, alignedElfSize));
+  for (unsigned i = 0; i < source.pipelineBinCount; ++i) {
+    memcpy(allocBuf, source.pipelineBins[i].pCode, source.pipelineBins[i].codeSize);
+    pipelineBins[i].pCode = allocBuf;
+    pipelineBins[i].codeSize = source.pipelineBins[i].codeSize;
+    allocBuf = voidPtrInc(allocBuf, source.pipelineBins[i].codeSize);
+  }
+  dest.pipelineBins = pipelineBins;
+  allocBuf = voidPtrInc(allocBuf, alignedElfSize - elfSize + binaryDataSize);
+
+  if (shaderPropsSize != 0) {
+    memcpy(allocBuf, source.shaderPropSet.shaderProps, shaderPropsSize);
+    dest.shaderPropSet.shaderProps = static_cast<RayTracingShaderProperty *>(allocBuf);
+    allocBuf = voidPtrInc(allocBuf, shaderPropsSize);
+  }
+
+  if (shaderGroupHandleSize != 0)
+    memcpy(allocBuf, source.shaderGroupHandle.shaderHandles, shaderGroupHandleSize);
+  dest.shaderGroupHandle.shaderHandles = static_cast<RayTracingShaderIdentifier *>(allocBuf);
+  allocBuf = voidPtrInc(allocBuf, shaderGroupHandleSize);
+
+  memcpy(allocBuf, source.librarySummary.pCode, source.librarySummary.codeSize);
+  dest.librarySummary.pCode = allocBuf;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Copy the output of a batch entry to an identical entry that was not compiled, and dump it as the compile of the entry
+// would have.
+//
+// @param source : Batch entry that was compiled
+// @param [in/out] dest : Batch entry that receives a copy of the output
+Result Compiler::copyBatchEntryOutput(const PipelineBatchEntry &source, PipelineBatchEntry &dest) {
+  dumpCompilerOptions(dest.pPipelineDumpFile);
+  if (dest.type == PipelineBatchEntryType::RayTracing)
+    return copyRayTracingPipelineOut(*source.pRayTracingOut, *dest.pRayTracingOut, dest.pRayTracingInfo);
+
+  const BinaryData *sourceBin = nullptr;
+  BinaryData *destBin = nullptr;
+  OutputAllocFunc outputAlloc = nullptr;
+  void *instance = nullptr;
+  void *userData = nullptr;
+
+  if (dest.type == PipelineBatchEntryType::Graphics) {
+    sourceBin = &source.pGraphicsOut->pipelineBin;
+    destBin = &dest.pGraphicsOut->pipelineBin;
+    dest.pGraphicsOut->pipelineCacheAccess = source.pGraphicsOut->pipelineCacheAccess;
+    memcpy(dest.pGraphicsOut->stageCacheAccesses, source.pGraphicsOut->stageCacheAccesses,
+           sizeof(dest.pGraphicsOut->stageCacheAccesses));
+    dest.pGraphicsOut->reducedOptimization = source.pGraphicsOut->reducedOptimization;
+    outputAlloc = dest.pGraphicsInfo->pfnOutputAlloc;
+    instance = dest.pGraphicsInfo->pInstance;
+    userData = dest.pGraphicsInfo->pUserData;
+  } else {
+    assert(dest.type == PipelineBatchEntryType::Compute);
+    sourceBin = &source.pComputeOut->pipelineBin;
+    destBin = &dest.pComputeOut->pipelineBin;
+    dest.pComputeOut->pipelineCacheAccess = source.pComputeOut->pipelineCacheAccess;
+    dest.pComputeOut->stageCacheAccess = source.pComputeOut->stageCacheAccess;
+    dest.pComputeOut->reducedOptimization = source.pComputeOut->reducedOptimization;
+    outputAlloc = dest.pComputeInfo->pfnOutputAlloc;
+    instance = dest.pComputeInfo->pInstance;
+    userData = dest.pComputeInfo->pUserData;
+  }
+
+  if (!outputAlloc)
+    return Result::ErrorInvalidPointer;
+
+  void *allocBuf = outputAlloc(instance, userData, sourceBin->codeSize);
+  if (!allocBuf)
+    return Result::ErrorOutOfMemory;
+
+  memcpy(allocBuf, sourceBin->pCode, sourceBin->codeSize);
+  destBin->codeSize = sourceBin->codeSize;
+  destBin->pCode = allocBuf;
+
+  PipelineDumper::DumpPm4Crc(reinterpret_cast<PipelineDumpFile *>(dest.pPipelineDumpFile), m_gfxIp, destBin);
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Build a batch of pipelines.
+//
+// Pipelines with the same cache hash are compiled only once; the remaining entries receive a copy of the output, and
+// are dumped, once the batch has been compiled. The unique pipelines are compiled on up to -batch-compile-threads
+// threads, with the largest pipelines started first so that a long compile does not end up as the tail of the batch.
+// Each compile acquires its own context from the context pool.
+//
+// @param entryCount : Count of pipelines in the batch
+// @param [in/out] entries : Pipelines to build
+Result Compiler::BuildPipelineBatch(unsigned entryCount, PipelineBatchEntry *entries) {
+  // For each entry, the index of the entry that is actually compiled.
+  SmallVector<unsigned> primaryIndices(entryCount);
+  std::map<std::pair<PipelineBatchEntryType, MetroHash::Hash>, unsigned> primaryByHash;
+  SmallVector<std::pair<size_t, unsigned>> compileOrder;
+
+  for (unsigned i = 0; i < entryCount; ++i) {
+    PipelineBatchEntry &entry = entries[i];
+    entry.result = Result::Success;
+    entry.elapsedTimeUs = 0;
+    entry.deduplicated = false;
+
+    MetroHash::Hash cacheHash = {};
+    size_t cost = 0;
+    if (entry.type == PipelineBatchEntryType::Graphics) {
+      const GraphicsPipelineBuildInfo *info = entry.pGraphicsInfo;
+      cacheHash = PipelineDumper::generateHashForGraphicsPipeline(info, true);
+      cost = estimateCompileCost({&info->task, &info->vs, &info->tcs, &info->tes, &info->gs, &info->mesh, &info->fs});
+    } else if (entry.type == PipelineBatchEntryType::Compute) {
+      cacheHash = PipelineDumper::generateHashForComputePipeline(entry.pComputeInfo, true);
+      cost = estimateCompileCost({&entry.pComputeInfo->cs});
+    } else {
+      const RayTracingPipelineBuildInfo *info = entry.pRayTracingInfo;
+      cacheHash = PipelineDumper::generateHashForRayTracingPipeline(info, true);
+      for (unsigned shaderIdx = 0; shaderIdx < info->shaderCount; ++shaderIdx)
+        cost += estimateCompileCost({&info->pShaders[shaderIdx]});
+    }
+
+    auto it = primaryByHash.insert({{entry.type, cacheHash}, i}).first;
+    primaryIndices[i] = it->second;
+    if (it->second == i)
+      compileOrder.push_back({cost, i});
+  }
+
+  llvm::stable_sort(compileOrder, [](const std::pair<size_t, unsigned> &lhs, const std::pair<size_t, unsigned> &rhs) {
+    return lhs.first > rhs.first;
+  });
+
+  // Failures are recorded per entry, so the task never returns an error and the rest of the batch still gets built.
+  Error err = parallelFor(cl::BatchCompileThreads, compileOrder, [&](const std::pair<size_t, unsigned> &task) {
+    PipelineBatchEntry &entry = entries[task.second];
+    auto startTime = std::chrono::steady_clock::now();
+    if (entry.type == PipelineBatchEntryType::Graphics)
+      entry.result = BuildGraphicsPipeline(entry.pGraphicsInfo, entry.pGraphicsOut, entry.pPipelineDumpFile);
+    else if (entry.type == PipelineBatchEntryType::Compute)
+      entry.result = BuildComputePipeline(entry.pComputeInfo, entry.pComputeOut, entry.pPipelineDumpFile);
+    else
+      entry.result = BuildRayTracingPipeline(entry.pRayTracingInfo, entry.pRayTracingOut, entry.pPipelineDumpFile);
+    entry.elapsedTimeUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+    return Error::success();
+  });
+  cantFail(std::move(err));
+
+  Result batchResult = Result::Success;
+  for (unsigned i = 0; i < entryCount; ++i) {
+    PipelineBatchEntry &entry = entries[i];
+    const PipelineBatchEntry &primary = entries[primaryIndices[i]];
+    if (primaryIndices[i] != i) {
+      auto startTime = std::chrono::steady_clock::now();
+      entry.deduplicated = true;
+      entry.result = primary.result;
+      if (entry.result == Result::Success)
+        entry.result = copyBatchEntryOutput(primary, entry);
+      entry.elapsedTimeUs =
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    if (batchResult == Result::Success)
+      batchResult = entry.result;
+  }
+
+  LLPC_OUTS("Pipeline batch: " << entryCount << " pipelines, " << compileOrder.size() << " compiled, "
+                               << (entryCount - compileOrder.size()) << " deduplicated\n");
+
+  return batchResult;
+}
+#endif
+
 // =====================================================================================================================
 // Build single ray tracing pipeline ELF package.
 //
@@ -3536,6 +4112,8 @@ void Compiler::checkRayTracingLeadElf(ElfPackage *pipelineElf, RayTracingContext
   }
 
   ElfNote metaNote = reader.getNote(Abi::MetadataNoteType);
+  if (!metaNote.data)
+    return;
   msgpack::Document document;
 
   auto success =
@@ -3562,10 +4140,15 @@ MetroHash::Hash Compiler::generateHashForCompileOptions(unsigned optionCount, co
   // Options which needn't affect compilation results
   static StringRef IgnoredOptions[] = {cl::PipelineDumpDir.ArgStr,
                                        cl::EnablePipelineDump.ArgStr,
+                                       cl::AsyncPipelineDump.ArgStr,
                                        cl::EnableOuts.ArgStr,
                                        cl::EnableErrs.ArgStr,
                                        cl::LogFileDbgs.ArgStr,
                                        cl::LogFileOuts.ArgStr,
+                                       cl::ContextMemoryBudget.ArgStr,
+                                       cl::BatchCompileThreads.ArgStr,
+                                       cl::UnlinkedStageThreads.ArgStr,
+                                       cl::ConcurrentPartPipelines.ArgStr,
                                        "unlinked",
                                        "o"};
 
@@ -3637,6 +4220,13 @@ Result Compiler::validatePipelineShaderInfo(const PipelineShaderInfo *shaderInfo
   return result;
 }
 
+// =====================================================================================================================
+// Returns true if the memory retained by pooled contexts needs to be measured, either to apply the memory budget or to
+// report it in the timer profile.
+static bool isContextMemoryTracked() {
+  return cl::ContextMemoryBudget > 0 || TimePassesIsEnabled || cl::EnableTimerProfile;
+}
+
 // =====================================================================================================================
 // Acquires a free context from context pool.
 Context *Compiler::acquireContext() const {
@@ -3644,19 +4234,37 @@ Context *Compiler::acquireContext() const {
 
   std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
 
+  const bool trackMemory = isContextMemoryTracked();
+  bool otherContextInUse = false;
+
   // Try to find a free context from pool first
   for (auto &context : *m_contextPool) {
     GfxIpVersion gfxIpVersion = context->getGfxIpVersion();
 
-    if (!context->isInUse() && gfxIpVersion == m_gfxIp) {
-      // Free up context if it is being used too many times to avoid consuming too much memory.
+    if (context->isInUse()) {
+      // Heap growth can no longer be attributed to a single context.
+      otherContextInUse = true;
+      context->invalidateMemorySample();
+      continue;
+    }
+
+    if (!freeContext && gfxIpVersion == m_gfxIp) {
+      // Free up context if it is being used too many times, or if it has accumulated too much memory in uniqued
+      // constants, types and metadata, to avoid consuming too much memory.
       int contextReuseLimit = cl::ContextReuseLimit.getValue();
-      if (contextReuseLimit > 0 && context->getUseCount() > contextReuseLimit) {
+      size_t memoryBudget = static_cast<size_t>(cl::ContextMemoryBudget.getValue()) << 10;
+      const char *recycleReason = nullptr;
+      if (contextReuseLimit > 0 && context->getUseCount() > contextReuseLimit)
+        recycleReason = "reuse limit";
+      else if (memoryBudget > 0 && context->getRetainedMemory() > memoryBudget)
+        recycleReason = "memory budget";
+
+      if (recycleReason) {
+        TimerProfiler::reportContextRecycle(context->getRetainedMemory(), context->getUseCount(), recycleReason);
         delete context;
         context = new Context(m_gfxIp);
       }
       freeContext = context;
-      break;
     }
   }
 
@@ -3668,6 +4276,8 @@ Context *Compiler::acquireContext() const {
 
   assert(freeContext);
   freeContext->setInUse(true);
+  if (trackMemory)
+    freeContext->beginMemorySample(!otherContextInUse);
 
   return freeContext;
 }
@@ -3678,7 +4288,13 @@ Context *Compiler::acquireContext() const {
 // @param context : LLPC context
 void Compiler::releaseContext(Context *context) const {
   std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
+  PipelineContext *pipelineContext = context->getPipelineContext();
+  uint64_t pipelineHash = pipelineContext ? pipelineContext->getPipelineHashCode() : 0;
   context->reset();
+  if (isContextMemoryTracked()) {
+    context->endMemorySample(m_memoryStats);
+    TimerProfiler::reportContextMemory(pipelineHash, context->getRetainedMemory(), context->getUseCount());
+  }
   context->setInUse(false);
 }
 
@@ -32,6 +32,7 @@
 
 #include "llpc.h"
 #include "llpcCacheAccessor.h"
+#include "llpcInFlightCompiles.h"
 #include "llpcShaderModuleHelper.h"
 #include "llpcUtil.h"
 #include "vkgcElfReader.h"
@@ -39,8 +40,11 @@
 #include "lgc/CommonDefs.h"
 #include "lgc/LgcRtDialect.h"
 #include "llvm/Support/Mutex.h"
+#include <atomic>
 #include <condition_variable>
+#include <mutex>
 #include <optional>
+#include <set>
 
 namespace llvm {
 
@@ -100,6 +104,22 @@ private:
   Vkgc::EntryHandle m_fragmentEntry;
 };
 
+// =====================================================================================================================
+// Running totals of the heap growth over the sampled uses of pooled contexts, used to estimate the growth of the uses
+// that could not be sampled.
+struct ContextMemoryStats {
+  size_t sampledGrowth = 0;     // Total heap growth of the sampled uses
+  unsigned sampledUseCount = 0; // Number of sampled uses
+};
+
+// =====================================================================================================================
+// Counts of how the part pipelines built by a compiler were handled, reported by the timer profiler.
+struct PartPipelineCounts {
+  std::atomic<uint64_t> concurrentCompiles{0};      // Fragment and pre-rasterization part pipelines compiled together
+  std::atomic<uint64_t> preRasterEarlyCacheHits{0}; // Pre-rasterization cache hits found without lowering anything
+  std::atomic<uint64_t> preRasterLateCacheHits{0};  // Pre-rasterization compiles cancelled by a cache hit at hand-off
+};
+
 // =====================================================================================================================
 // Represents LLPC pipeline compiler.
 class Compiler : public ICompiler {
@@ -134,6 +154,10 @@ public:
                                          RayTracingPipelineBuildOut *pipelineOut, void *pipelineDumpFile = nullptr,
                                          IHelperThreadProvider *pHelperThreadProvider = nullptr);
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 77
+  virtual Result BuildPipelineBatch(unsigned entryCount, PipelineBatchEntry *entries);
+#endif
+
   Result buildTransformVertexShader(Context *context, const PipelineShaderInfo *shaderInfo,
                                     llvm::raw_pwrite_stream &outStream);
 
@@ -155,7 +179,8 @@ public:
                                          llvm::MutableArrayRef<CacheAccessInfo> stageCacheAccesses);
 
   Result buildPipelineInternal(Context *context, llvm::ArrayRef<const PipelineShaderInfo *> shaderInfo,
-                               lgc::PipelineLink pipelineLink, lgc::Pipeline *otherPartPipeline,
+                               lgc::PipelineLink pipelineLink,
+                               llvm::function_ref<Result(lgc::Pipeline *&)> getOtherPartPipeline,
                                ElfPackage *pipelineElf, llvm::MutableArrayRef<CacheAccessInfo> stageCacheAccesses);
 
   // Gets the count of compiler instance.
@@ -172,6 +197,11 @@ public:
 
   Vkgc::ICache *getInternalCaches() { return m_cache; }
 
+  // Gets the number of compile requests that were collapsed into an identical in-flight compile.
+  uint64_t getCollapsedCompileCount() const {
+    return m_inFlightPipelines.getCollapsedCount() + m_inFlightStages.getCollapsedCount();
+  }
+
   Context *acquireContext() const;
   void releaseContext(Context *context) const;
 
@@ -184,6 +214,18 @@ public:
   void setUseGpurt(lgc::Pipeline *pipeline);
 
 private:
+  // Checks whether a pre-rasterization part pipeline is known to be in the cache, by its hash without the FS input
+  // mappings.
+  bool isPreRasterPartPipelineKnownCached(const MetroHash::Hash &preRasterPartialHash) {
+    std::lock_guard<std::mutex> lock(m_knownCachedPreRasterMutex);
+    return m_knownCachedPreRaster.count(preRasterPartialHash) != 0;
+  }
+  // Records that a pre-rasterization part pipeline is in the cache, by its hash without the FS input mappings.
+  void addPreRasterPartPipelineKnownCached(const MetroHash::Hash &preRasterPartialHash) {
+    std::lock_guard<std::mutex> lock(m_knownCachedPreRasterMutex);
+    m_knownCachedPreRaster.insert(preRasterPartialHash);
+  }
+
   Compiler() = delete;
   Compiler(const Compiler &) = delete;
   Compiler &operator=(const Compiler &) = delete;
@@ -206,6 +248,9 @@ private:
                                      Vkgc::UnlinkedShaderStage stage, ElfPackage &elfPackage,
                                      llvm::MutableArrayRef<CacheAccessInfo> stageCacheAccesses);
   void dumpCompilerOptions(void *pipelineDumpFile);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 77
+  Result copyBatchEntryOutput(const PipelineBatchEntry &source, PipelineBatchEntry &dest);
+#endif
   void dumpFragmentOutputs(void *pipelineDumpFile, const uint8_t *data, unsigned size);
   Result generatePipeline(Context *context, unsigned moduleIndex, std::unique_ptr<llvm::Module> module,
                           ElfPackage &pipelineElf, lgc::Pipeline *pipeline, TimerProfiler &timerProfiler);
@@ -220,6 +265,14 @@ private:
   static std::vector<Context *> *m_contextPool; // Context pool
   unsigned m_relocatablePipelineCompilations;   // The number of pipelines compiled using relocatable shader elf
   static llvm::sys::Mutex m_helperThreadMutex;  // Mutex for helper thread
+  InFlightCompiles m_inFlightPipelines;         // Whole-pipeline compiles in progress, by cache hash
+  InFlightCompiles m_inFlightStages;            // Unlinked shader and part-pipeline compiles in progress, by cache hash
+  mutable ContextMemoryStats m_memoryStats;     // Heap growth of sampled context uses, under m_contextPoolMutex
+  PartPipelineCounts m_partPipelineCounts;      // How the part pipelines built by this compiler were handled
+
+  // Pre-rasterization part pipelines put in or found in the cache, by their hash without the FS input mappings.
+  std::set<MetroHash::Hash> m_knownCachedPreRaster;
+  std::mutex m_knownCachedPreRasterMutex; // Mutex for m_knownCachedPreRaster
 
   void buildShaderModuleResourceUsage(
       const ShaderModuleBuildInfo *shaderInfo, SPIRV::SPIRVModule *module, Vkgc::ResourcesNodes &resourcesNodes,
@@ -71,6 +71,7 @@
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/AlwaysInliner.h"
@@ -112,6 +113,49 @@ void Context::reset() {
   m_builder = nullptr;
 }
 
+// =====================================================================================================================
+// Start sampling heap usage for one use of this context. Memory that is still allocated once the context has been
+// reset() is what the LLVMContext keeps alive across uses (uniqued constants and types, metadata strings, the
+// target machine and library modules), and it is only freed when the context is destroyed.
+//
+// NOTE: The heap usage is that of the whole process, so a sample also includes whatever other threads allocate that
+// is not compiling with a pooled context (e.g. the application itself). A sample is only attributed to this context
+// if no other pooled context is in use; otherwise the estimate is approximate. This must be called with the
+// compiler's context pool locked.
+//
+// @param exclusive : Whether no other context is in use, so that heap growth can be attributed to this one
+void Context::beginMemorySample(bool exclusive) {
+  m_memorySampleValid = exclusive;
+  if (exclusive)
+    m_memorySampleStart = sys::Process::GetMallocUsage();
+}
+
+// =====================================================================================================================
+// Finish sampling heap usage for one use of this context, and update the estimate of retained memory. This must be
+// called after reset(). If another context was compiling at the same time, the heap delta cannot be attributed to this
+// context, so the average growth per use of the sampled uses is used instead.
+//
+// NOTE: This must be called with the compiler's context pool locked.
+//
+// @param [in/out] stats : Running totals over the sampled uses of the pooled contexts
+void Context::endMemorySample(ContextMemoryStats &stats) {
+  if (m_memorySampleValid) {
+    size_t memoryEnd = sys::Process::GetMallocUsage();
+    if (memoryEnd >= m_memorySampleStart) {
+      size_t growth = memoryEnd - m_memorySampleStart;
+      m_retainedMemory += growth;
+      stats.sampledGrowth += growth;
+      ++stats.sampledUseCount;
+    } else {
+      // The use freed memory retained by an earlier use (e.g. a GPURT library module was replaced).
+      m_retainedMemory -= std::min(m_retainedMemory, m_memorySampleStart - memoryEnd);
+    }
+  } else if (stats.sampledUseCount != 0) {
+    m_retainedMemory += stats.sampledGrowth / stats.sampledUseCount;
+  }
+  m_memorySampleValid = false;
+}
+
 // =====================================================================================================================
 // Get (create if necessary) LgcContext
 LgcContext *Context::getLgcContext() {
@@ -157,10 +201,68 @@ CodeGenOptLevel Context::getLastOptimizationLevel() const {
 }
 
 // =====================================================================================================================
-// Loads library from external LLVM library.
+// Materializes the functions of a lazily loaded module that are reachable from its entry points, and drops the rest
+// without ever parsing their bodies. The entry points are the functions named by the pipeline if the module has any of
+// them, otherwise its externally linked functions. A function is reachable if it is an entry point, or is referenced by
+// a materialized function or by a global initializer or alias.
+//
+// Metadata is not used to find roots, as it is only loaded along with the function bodies.
+//
+// @param [in/out] module : Module returned by getLazyBitcodeModule
+// @param entryNames : Names of the entry points that the pipeline references
+static Error materializeReachableFunctions(Module &module, ArrayRef<StringRef> entryNames) {
+  SmallVector<Function *> worklist;
+  for (StringRef entryName : entryNames) {
+    Function *func = module.getFunction(entryName);
+    if (func && func->isMaterializable() && !is_contained(worklist, func))
+      worklist.push_back(func);
+  }
+  if (worklist.empty()) {
+    for (Function &func : module) {
+      if (func.isMaterializable() && func.getLinkage() == GlobalValue::ExternalLinkage)
+        worklist.push_back(&func);
+    }
+  }
+
+  while (!worklist.empty()) {
+    while (!worklist.empty()) {
+      if (Error err = worklist.pop_back_val()->materialize())
+        return err;
+    }
+    // Uses only come from materialized code or from globals, so any function that is still not materialized but has
+    // a use has just become reachable.
+    for (Function &func : module) {
+      if (func.isMaterializable() && !func.use_empty())
+        worklist.push_back(&func);
+    }
+  }
+
+  // Whatever is left is unreachable. Turn it into a declaration so that materializeAll() skips it, and erase it once
+  // the module is fully loaded.
+  SmallVector<Function *> unreachableFuncs;
+  for (Function &func : module) {
+    if (func.isMaterializable()) {
+      func.deleteBody();
+      unreachableFuncs.push_back(&func);
+    }
+  }
+
+  if (Error err = module.materializeAll())
+    return err;
+
+  for (Function *func : unreachableFuncs)
+    func->eraseFromParent();
+  return Error::success();
+}
+
+// =====================================================================================================================
+// Loads library from external LLVM library. The bitcode is read lazily and only the functions reachable from the
+// entry points are materialized.
 //
 // @param lib : Bitcodes of external LLVM library
-std::unique_ptr<Module> Context::loadLibrary(const BinaryData *lib) {
+// @param entryNames : Names of the entry points that the pipeline references; if the library has none of them, its
+//                     externally linked functions are its entry points
+std::unique_ptr<Module> Context::loadLibrary(const BinaryData *lib, ArrayRef<StringRef> entryNames) {
   auto memBuffer =
       MemoryBuffer::getMemBuffer(StringRef(static_cast<const char *>(lib->pCode), lib->codeSize), "", false);
 
@@ -172,7 +274,7 @@ std::unique_ptr<Module> Context::loadLibrary(const BinaryData *lib) {
     LLPC_ERRS("Fails to load LLVM bitcode \n");
   } else {
     libModule = std::move(*moduleOrErr);
-    if (Error errCode = libModule->materializeAll()) {
+    if (Error errCode = materializeReachableFunctions(*libModule, entryNames)) {
       LLPC_ERRS("Fails to materialize \n");
       libModule = nullptr;
     }
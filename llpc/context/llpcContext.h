@@ -47,6 +47,8 @@ class DialectContext;
 
 namespace Llpc {
 
+struct ContextMemoryStats;
+
 // =====================================================================================================================
 // Represents LLPC context for pipeline compilation. Derived from the base class llvm::LLVMContext.
 class Context : public llvm::LLVMContext {
@@ -69,6 +71,15 @@ public:
   // Get the number of times this context is used.
   unsigned getUseCount() const { return m_useCount; }
 
+  void beginMemorySample(bool exclusive);
+  void endMemorySample(ContextMemoryStats &stats);
+
+  // Mark the current heap usage sample as unreliable, because another context started compiling concurrently.
+  void invalidateMemorySample() { m_memorySampleValid = false; }
+
+  // Get the estimated number of bytes retained by this context across resets.
+  size_t getRetainedMemory() const { return m_retainedMemory; }
+
   // Attaches pipeline context to LLPC context.
   void attachPipelineContext(PipelineContext *pipelineContext) { m_pipelineContext = pipelineContext; }
 
@@ -87,7 +98,7 @@ public:
   llvm::CodeGenOptLevel getOptimizationLevel();
   llvm::CodeGenOptLevel getLastOptimizationLevel() const;
 
-  std::unique_ptr<llvm::Module> loadLibrary(const BinaryData *lib);
+  std::unique_ptr<llvm::Module> loadLibrary(const BinaryData *lib, llvm::ArrayRef<llvm::StringRef> entryNames = {});
 
   // Wrappers of interfaces of pipeline context
   PipelineType getPipelineType() const { return m_pipelineContext->getPipelineType(); }
@@ -137,6 +148,10 @@ private:
 
   unsigned m_useCount = 0; // Number of times this context is used.
 
+  size_t m_retainedMemory = 0;      // Estimated bytes retained by this context (uniqued constants, types, etc.)
+  size_t m_memorySampleStart = 0;   // Heap usage when the current use of this context started
+  bool m_memorySampleValid = false; // Whether the current heap usage sample is attributable to this context
+
   GpurtKey m_currentGpurtKey;
 };
 
@@ -61,6 +61,9 @@ using namespace lgc;
 using namespace llvm;
 using namespace Vkgc;
 
+static_assert(lgc::BlockCounterBufferBindingId == Vkgc::BlockCounterBufferBindingId,
+              "Block counter buffer binding mismatch between LGC and Vkgc");
+
 // -include-llvm-ir: include LLVM IR as a separate section in the ELF binary
 static cl::opt<bool> IncludeLlvmIr("include-llvm-ir",
                                    cl::desc("Include LLVM IR as a separate section in the ELF binary"),
@@ -38,6 +38,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Type.h"
+#include <chrono>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -195,6 +196,9 @@ public:
   // Get the current cache hash code without compacting it.
   MetroHash::Hash getCacheHashCodeWithoutCompact() const { return m_cacheHash; }
 
+  // Get the pipeline hash code without compacting it.
+  MetroHash::Hash getPipelineHashCodeWithoutCompact() const { return m_pipelineHash; }
+
   // Sets pipeline hash code
   void setPipelineHashCode(const MetroHash::Hash &hash) { m_pipelineHash = hash; }
 
@@ -216,6 +220,18 @@ public:
   // Get whether we are building a relocatable (unlinked) ElF
   bool isUnlinked() const { return m_unlinked; }
 
+  // Gets the time in microseconds since this pipeline context was created, i.e. since the compile started
+  uint64_t getCompileTimeUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_compileStartTime)
+        .count();
+  }
+
+  // Set whether the pipeline is being compiled with reduced optimization because it ran over its compile-time budget
+  void setReducedOptimization(bool reduced) { m_reducedOptimization = reduced; }
+
+  // Get whether the pipeline is being compiled with reduced optimization
+  bool isReducedOptimization() const { return m_reducedOptimization; }
+
   // Gets pipeline resource mapping data
   const ResourceMappingData *getResourceMapping() const { return &m_resourceMapping; }
 
@@ -275,6 +291,8 @@ private:
 
   ShaderFpMode m_shaderFpModes[ShaderStageCountInternal] = {};
   bool m_unlinked = false; // Whether we are building an "unlinked" shader ELF
+  std::chrono::steady_clock::time_point m_compileStartTime = std::chrono::steady_clock::now(); // When compile started
+  bool m_reducedOptimization = false; // Whether the compile ran over budget and uses reduced optimization
   Vkgc::RtState m_rtState = {};
 };
 
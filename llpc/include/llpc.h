@@ -141,6 +141,8 @@ struct GraphicsPipelineBuildOut {
   unsigned fsOutputMetaDataSize;       ///< Meta data size
   CacheAccessInfo pipelineCacheAccess; ///< Pipeline cache access status i.e., hit, miss, or not checked
   CacheAccessInfo stageCacheAccesses[ShaderStageCount]; ///< Shader cache access status i.e., hit, miss, or not checked
+  bool reducedOptimization; ///< Output whether the pipeline was compiled with reduced optimization because it ran over
+                            ///< options.compileTimeBudgetMs; the client should recompile it later without a budget
 };
 
 /// Represents output of building a compute pipeline.
@@ -148,6 +150,8 @@ struct ComputePipelineBuildOut {
   BinaryData pipelineBin;              ///< Output pipeline binary data
   CacheAccessInfo pipelineCacheAccess; ///< Pipeline cache access status i.e., hit, miss, or not checked
   CacheAccessInfo stageCacheAccess;    ///< Shader cache access status i.e., hit, miss, or not checked
+  bool reducedOptimization; ///< Output whether the pipeline was compiled with reduced optimization because it ran over
+                            ///< options.compileTimeBudgetMs; the client should recompile it later without a budget
 };
 
 /// Represents output of building a ray tracing pipeline.
@@ -163,6 +167,34 @@ struct RayTracingPipelineBuildOut {
   bool hasKernelEntry; ///< Output whether the output pipeline binaries contain kernel entry
 };
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 77
+/// Enumerates the types of pipeline that can be built as part of a pipeline batch.
+enum class PipelineBatchEntryType : unsigned {
+  Graphics,   ///< Graphics pipeline
+  Compute,    ///< Compute pipeline
+  RayTracing, ///< Ray tracing pipeline
+};
+
+/// Represents one pipeline of a batch build.
+struct PipelineBatchEntry {
+  PipelineBatchEntryType type; ///< Pipeline type, selects the active members of the unions below
+  union {
+    const GraphicsPipelineBuildInfo *pGraphicsInfo;     ///< Info to build a graphics pipeline
+    const ComputePipelineBuildInfo *pComputeInfo;       ///< Info to build a compute pipeline
+    const RayTracingPipelineBuildInfo *pRayTracingInfo; ///< Info to build a ray tracing pipeline
+  };
+  union {
+    GraphicsPipelineBuildOut *pGraphicsOut;     ///< Output of building a graphics pipeline
+    ComputePipelineBuildOut *pComputeOut;       ///< Output of building a compute pipeline
+    RayTracingPipelineBuildOut *pRayTracingOut; ///< Output of building a ray tracing pipeline
+  };
+  void *pPipelineDumpFile; ///< Handle of pipeline dump file (optional)
+  Result result;           ///< Output result of building this pipeline
+  uint64_t elapsedTimeUs;  ///< Output wall-clock time spent on this pipeline, in microseconds
+  bool deduplicated;       ///< Output whether the binary was copied from an identical pipeline earlier in the batch
+};
+#endif
+
 // Users of LLPC may implement this interface to allow the compiler to request additional threads.
 //
 // Lifetime of this object:
@@ -299,6 +331,18 @@ public:
                                          RayTracingPipelineBuildOut *pPipelineOut, void *pPipelineDumpFile = nullptr,
                                          IHelperThreadProvider *pHelperThreadProvider = nullptr) = 0;
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 77
+  /// Build a batch of pipelines. The pipelines are scheduled across worker threads by the compiler, and pipelines with
+  /// identical cache hashes are only compiled once, with the binary copied to the other entries.
+  ///
+  /// @param [in]     entryCount  Count of pipelines in the batch
+  /// @param [in,out] pEntries    Pipelines to build; per-pipeline results and timings are written back to each entry
+  ///
+  /// @returns : Result::Success if all pipelines were built successfully. Otherwise, the result of the first failing
+  ///            entry in batch order.
+  virtual Result BuildPipelineBatch(unsigned entryCount, PipelineBatchEntry *pEntries) = 0;
+#endif
+
 protected:
   ICompiler() {}
   /// Destructor
@@ -34,7 +34,9 @@
 #endif
 
 #include "llpc.h"
+#include "llpcAutotune.h"
 #include "llpcCompilationUtils.h"
+#include "llpcComputePipelineBuilder.h"
 #include "llpcDebug.h"
 #include "llpcError.h"
 #include "llpcFile.h"
@@ -53,6 +55,7 @@
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 
@@ -111,6 +114,7 @@ cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore, cl::ValueRequired,
                                        "  .frag     GLSL fragment shader\n"
                                        "  .comp     GLSL compute shader\n"
                                        "  .pipe     Pipeline info file\n"
+                                       "  .pipecap  Binary pipeline capture file\n"
                                        "  .ll       LLVM IR assembly text"));
 
 // -o: output
@@ -145,6 +149,47 @@ cl::opt<unsigned> NumThreads("num-threads",
                                       "k: Spawn <k> compiler threads"),
                              cl::value_desc("integer"), cl::init(1));
 
+// -dedup-shader-modules: build each unique shader module once, and share it across the input pipelines
+cl::opt<bool> DedupShaderModules("dedup-shader-modules",
+                                 cl::desc("Build each unique shader module once, and share it across the input "
+                                          "pipelines"),
+                                 cl::init(true));
+
+// -pipeline-batch: build the compute pipelines with a single ICompiler::BuildPipelineBatch call
+cl::opt<bool> PipelineBatch("pipeline-batch",
+                            cl::desc("Read all the input compute pipelines, then build them with a single "
+                                     "ICompiler::BuildPipelineBatch call, which builds identical pipelines once"),
+                            cl::init(false));
+
+// -wave-size-trial: compile graphics and compute pipelines with wave32 and with wave64, and keep the better one
+cl::opt<bool> WaveSizeTrial("wave-size-trial",
+                            cl::desc("Compile each graphics or compute pipeline with all shaders in wave32 and in "
+                                     "wave64, and keep the one with more lanes resident by its VGPR counts"),
+                            cl::init(false));
+
+// -autotune: sweep a search space of shader options for each graphics or compute pipeline, and report the best
+cl::opt<bool> Autotune("autotune",
+                       cl::desc("Build each graphics or compute pipeline with every configuration of the shader "
+                                "options in -autotune-space, and report the best configurations in -autotune-out"),
+                       cl::init(false));
+
+// -autotune-space: search space of shader options for -autotune
+cl::opt<std::string> AutotuneSpace("autotune-space",
+                                   cl::desc("Search space of shader options for -autotune, as "
+                                            "\"knob=value,value;knob=value,...\""),
+                                   cl::value_desc("space"),
+                                   cl::init("waveSize=0,32,64;unrollThreshold=0,100,300;scheduleStrategy=0,1,2"));
+
+// -autotune-threads: number of CPU threads to build the configurations of one pipeline on
+cl::opt<unsigned> AutotuneThreads("autotune-threads",
+                                  cl::desc("Number of CPU threads to build the configurations of one pipeline on for "
+                                           "-autotune (0: use all logical CPUs). Only used with -num-threads=1"),
+                                  cl::value_desc("integer"), cl::init(0));
+
+// -autotune-out: JSON file to write the -autotune reports to
+cl::opt<std::string> AutotuneOut("autotune-out", cl::desc("JSON file to write the -autotune reports to"),
+                                 cl::value_desc("filename"), cl::init("autotune.json"));
+
 // -enable-ngg: enable NGG mode
 cl::opt<bool> EnableNgg("enable-ngg", cl::desc("Enable implicit primitive shader (NGG) mode"), cl::init(true));
 
@@ -307,6 +352,23 @@ cl::opt<bool> DumpDuplicatePipelines(
     "dump-duplicate-pipelines",
     cl::desc("If TRUE, duplicate pipelines will be dumped to a file with a numeric suffix attached"), cl::init(false));
 
+// -dump-pipeline-capture: dump a binary pipeline capture alongside each .pipe file
+cl::opt<bool> DumpPipelineCapture("dump-pipeline-capture",
+                                  cl::desc("Dump a binary pipeline capture (.pipecap) alongside each .pipe file"),
+                                  cl::init(false));
+
+// -pipeline-capture-out: convert the input pipeline to a binary pipeline capture instead of compiling it
+cl::opt<std::string> PipelineCaptureOut("pipeline-capture-out",
+                                        cl::desc("Convert the input pipeline to a binary pipeline capture file instead "
+                                                 "of compiling it"),
+                                        cl::value_desc("filename"));
+
+// -pipeline-text-out-dir: convert the input pipeline to .pipe text instead of compiling it
+cl::opt<std::string> PipelineTextOutDir("pipeline-text-out-dir",
+                                        cl::desc("Convert the input pipeline to a .pipe file, and its SPIR-V files, in "
+                                                 "the given directory instead of compiling it"),
+                                        cl::value_desc("dir"));
+
 // -llpc_opt: Override the optimization level passed in to LGC with the given one.  This options is the same as the
 // `-opt` option in lgc.  The reason for the second option is to be able to test the LLPC API.  If both options are set
 // then `-opt` wins.
@@ -362,6 +424,7 @@ namespace llvm {
 namespace cl {
 
 extern opt<bool> EnablePipelineDump;
+extern opt<bool> AsyncPipelineDump;
 extern opt<std::string> PipelineDumpDir;
 extern opt<bool> EnableTimerProfile;
 extern opt<bool> BuildShaderCache;
@@ -668,22 +731,44 @@ static Error fixupRtState(RtState &rtState, std::vector<char> &shaderLibraryStor
 }
 
 // =====================================================================================================================
-// Process one pipeline. This can either be a single .pipe file or a set of shader stages.
+// Represents one pipeline on its way through amdllpc: its inputs are read, then it is compiled, then its outputs are
+// written. The compile info is referenced from its own members, so a job is never moved.
+struct PipelineJob {
+  PipelineJob() : compileInfo() {}
+  ~PipelineJob() {
+    builder.reset();
+    cleanupCompileInfo(&compileInfo);
+  }
+  PipelineJob(const PipelineJob &) = delete;
+  PipelineJob &operator=(const PipelineJob &) = delete;
+
+  CompileInfo compileInfo;                             // Compilation info of the pipeline
+  std::vector<PipelineShaderInfo> standaloneRtShaders; // Ray tracing shader infos, for shader stage inputs
+  std::vector<char> gpurtShaderLibraryStorage;         // GPURT shader library, if overridden
+  std::unique_ptr<PipelineBuilder> builder;            // Builder holding the compiled pipeline
+  bool convertOnly = false;                            // Whether the pipeline is converted rather than compiled
+  std::optional<json::Object> autotuneReport;          // Autotuning report of the pipeline, if it was autotuned
+  // Jobs of the libraries of a graphics library pipeline, compiled with the pipeline and written in order after it
+  std::vector<std::unique_ptr<PipelineJob>> libraryJobs;
+};
+
+// =====================================================================================================================
+// Reads the inputs of one pipeline. This can either be a single .pipe file or a set of shader stages.
 //
 // @param compiler : LLPC compiler
-// @param inFiles : Input filename(s)
+// @param inputSpecs : Input filename(s)
 // @param isGraphicsLibrary : Whether compiled pipeline is library
-// @returns : `ErrorSuccess` on success, `ResultError` on failure
-static Error processInputs(ICompiler *compiler, InputSpecGroup &inputSpecs, bool isGraphicsLibrary) {
+// @returns : The pipeline job on success, `ResultError` on failure
+static Expected<std::unique_ptr<PipelineJob>> readInputs(ICompiler *compiler, InputSpecGroup &inputSpecs,
+                                                         bool isGraphicsLibrary) {
   assert(!inputSpecs.empty());
-  CompileInfo compileInfo = {};
+  auto job = std::make_unique<PipelineJob>();
+  CompileInfo &compileInfo = job->compileInfo;
   compileInfo.isGraphicsLibrary = isGraphicsLibrary;
   compileInfo.unlinked = true;
   compileInfo.doAutoLayout = true;
-  std::vector<PipelineShaderInfo> standaloneRtShaders;
+  std::vector<PipelineShaderInfo> &standaloneRtShaders = job->standaloneRtShaders;
 
-  // Clean code that gets run automatically before returning.
-  auto onExit = make_scope_exit([&compileInfo] { cleanupCompileInfo(&compileInfo); });
   initCompileInfo(&compileInfo);
 
   const InputSpec &firstInput = inputSpecs.front();
@@ -697,22 +782,17 @@ static Error processInputs(ICompiler *compiler, InputSpecGroup &inputSpecs, bool
 
     compileInfo.autoLayoutDesc = false;
     if (Error err = processInputPipeline(compiler, compileInfo, firstInput, unlinked, IgnoreColorAttachmentFormats))
-      return err;
-
-    if (compileInfo.pipelineType == VfxPipelineTypeGraphicsLibrary) {
-      // All input shaders form one group.
-      SmallVector<InputSpecGroup, 3> groups;
-      append_range(groups,
-                   map_range(compileInfo.inputSpecs, [](const InputSpec &spec) { return InputSpecGroup{spec}; }));
+      return std::move(err);
 
-      if (Error err = parallelFor(NumThreads, groups, [compiler](InputSpecGroup &inputGroup) {
-            return processInputs(compiler, inputGroup, true);
-          })) {
-        return err;
-      }
-      return Error::success();
+    if (!PipelineCaptureOut.empty() || !PipelineTextOutDir.empty()) {
+      job->convertOnly = true;
+      return std::move(job);
     }
 
+    // The libraries of a graphics library pipeline are read when it is compiled.
+    if (compileInfo.pipelineType == VfxPipelineTypeGraphicsLibrary)
+      return std::move(job);
+
     if (isRayTracingPipeline(compileInfo.stageMask)) {
       if (LlpcRaytracingModeSetting.getNumOccurrences())
         compileInfo.rayTracePipelineInfo.mode = LlpcRaytracingModeSetting;
@@ -720,7 +800,7 @@ static Error processInputs(ICompiler *compiler, InputSpecGroup &inputSpecs, bool
   } else {
     compileInfo.autoLayoutDesc = true;
     if (Error err = processInputStages(compileInfo, inputSpecs, ValidateSpirv, NumThreads))
-      return err;
+      return std::move(err);
 
     if (isRayTracingPipeline(compileInfo.stageMask)) {
       compileInfo.pipelineType = VfxPipelineTypeRayTracing;
@@ -786,15 +866,139 @@ static Error processInputs(ICompiler *compiler, InputSpecGroup &inputSpecs, bool
     break;
   }
 
-  std::vector<char> gpurtShaderLibraryStorage;
-  if (Error err = fixupRtState(*rtState, gpurtShaderLibraryStorage))
+  if (Error err = fixupRtState(*rtState, job->gpurtShaderLibraryStorage))
+    return std::move(err);
+
+  return std::move(job);
+}
+
+// =====================================================================================================================
+// Builds a graphics or compute pipeline for -wave-size-trial: once with all its shaders requesting wave32 and once
+// with all requesting wave64. The build with the higher occupancy in lanes per SIMD, estimated from the VGPR counts in
+// its PAL metadata, is kept; a tie keeps wave64. Comparing waves instead would favor wave32, which fits twice as many
+// waves in the same VGPRs but keeps no more lanes in flight.
+//
+// @param compiler : LLPC compiler
+// @param [in/out] job : Pipeline job
+// @param dumpOptions : Pipeline dump options, or `std::nullopt`
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+static Error buildWithWaveSizeTrial(ICompiler *compiler, PipelineJob &job,
+                                    const std::optional<PipelineDumpOptions> &dumpOptions) {
+  CompileInfo &compileInfo = job.compileInfo;
+  const bool isCompute = compileInfo.pipelineType == VfxPipelineTypeCompute;
+  SmallVector<PipelineShaderInfo *, 8> shaderInfos;
+  if (isCompute) {
+    shaderInfos.push_back(&compileInfo.compPipelineInfo.cs);
+  } else {
+    GraphicsPipelineBuildInfo &info = compileInfo.gfxPipelineInfo;
+    shaderInfos.append({&info.task, &info.vs, &info.tcs, &info.tes, &info.gs, &info.mesh, &info.fs});
+  }
+
+  // Gets the occupancy of the pipeline just built in lanes per SIMD, as that of its most constrained ELF.
+  auto getOccupancy = [&] {
+    PipelineMetrics metrics;
+    if (isCompute) {
+      metrics = getPipelineMetrics(compileInfo.compPipelineOut.pipelineBin, compileInfo.gfxIp);
+    } else {
+      for (const GraphicsPipelineBuildOut &pipelineOut : compileInfo.gfxPipelineOut)
+        metrics.merge(getPipelineMetrics(pipelineOut.pipelineBin, compileInfo.gfxIp));
+    }
+    return metrics.laneOccupancy;
+  };
+
+  // The ELFs of the wave32 build stay allocated in the compile info, so only its outputs need keeping.
+  for (PipelineShaderInfo *shaderInfo : shaderInfos)
+    shaderInfo->options.waveSize = 32;
+  std::unique_ptr<PipelineBuilder> wave32Builder =
+      createPipelineBuilder(*compiler, compileInfo, dumpOptions, TimePassesIsEnabled || cl::EnableTimerProfile);
+  if (Error err = wave32Builder->build())
+    return err;
+  const unsigned wave32Occupancy = getOccupancy();
+  ComputePipelineBuildOut wave32CompOut = compileInfo.compPipelineOut;
+  SmallVector<GraphicsPipelineBuildOut> wave32GfxOut = std::move(compileInfo.gfxPipelineOut);
+  compileInfo.gfxPipelineOut.clear();
+
+  for (PipelineShaderInfo *shaderInfo : shaderInfos)
+    shaderInfo->options.waveSize = 64;
+  job.builder =
+      createPipelineBuilder(*compiler, compileInfo, dumpOptions, TimePassesIsEnabled || cl::EnableTimerProfile);
+  if (Error err = job.builder->build())
     return err;
+  const unsigned wave64Occupancy = getOccupancy();
+
+  const bool chooseWave32 = wave32Occupancy > wave64Occupancy;
+  if (chooseWave32) {
+    compileInfo.compPipelineOut = wave32CompOut;
+    compileInfo.gfxPipelineOut = std::move(wave32GfxOut);
+    job.builder = std::move(wave32Builder);
+  }
+
+  LLPC_OUTS("Wave size trial: wave32 occupancy " << wave32Occupancy << " lanes, wave64 occupancy " << wave64Occupancy
+                                                 << " lanes, chose wave" << (chooseWave32 ? 32 : 64) << "\n");
+  return Error::success();
+}
+
+// =====================================================================================================================
+// Gets the pipeline dump options from the command line.
+//
+// @param [out] dumpOptions : Pipeline dump options, or `std::nullopt` if pipelines are not dumped
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+static Error getDumpOptions(std::optional<PipelineDumpOptions> &dumpOptions) {
+  if (!cl::EnablePipelineDump)
+    return Error::success();
+
+  if (codegen::getFileType() != CodeGenFileType::ObjectFile)
+    return createResultError(Result::ErrorInvalidValue, "Pipeline dumps require the default (ELF) -filetype");
+
+  dumpOptions.emplace();
+  dumpOptions->pDumpDir = cl::PipelineDumpDir.c_str();
+  dumpOptions->filterPipelineDumpByType = FilterPipelineDumpByType;
+  dumpOptions->filterPipelineDumpByHash = FilterPipelineDumpByHash;
+  dumpOptions->dumpDuplicatePipelines = DumpDuplicatePipelines;
+  dumpOptions->asyncDump = cl::AsyncPipelineDump;
+  dumpOptions->dumpCapture = DumpPipelineCapture;
+  return Error::success();
+}
+
+// =====================================================================================================================
+// Compiles one pipeline whose inputs have been read. The graphics libraries of a graphics library pipeline are read
+// and compiled here, one after the other; their outputs are written with those of the pipeline.
+//
+// @param compiler : LLPC compiler
+// @param moduleCache : Cache to share the built shader modules through, or null
+// @param tuningSpace : Search space to autotune the pipeline over, or null
+// @param [in/out] job : Pipeline job
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+static Error compileInputs(ICompiler *compiler, ShaderModuleCache *moduleCache, const TuningSpace *tuningSpace,
+                           PipelineJob &job) {
+  CompileInfo &compileInfo = job.compileInfo;
+  if (job.convertOnly)
+    return Error::success();
+
+  if (tuningSpace && !isTunablePipeline(compileInfo)) {
+    LLPC_WARN("Not autotuning " << compileInfo.inputSpecs.front().filename
+                                << ": only whole graphics and compute pipelines can be autotuned\n");
+    tuningSpace = nullptr;
+  }
+
+  if (compileInfo.pipelineType == VfxPipelineTypeGraphicsLibrary) {
+    for (const InputSpec &spec : compileInfo.inputSpecs) {
+      InputSpecGroup group = {spec};
+      Expected<std::unique_ptr<PipelineJob>> libraryJobOrErr = readInputs(compiler, group, true);
+      if (Error err = libraryJobOrErr.takeError())
+        return err;
+      if (Error err = compileInputs(compiler, moduleCache, nullptr, **libraryJobOrErr))
+        return err;
+      job.libraryJobs.push_back(std::move(*libraryJobOrErr));
+    }
+    return Error::success();
+  }
 
   //
   // Build shader modules
   //
   if (compileInfo.stageMask != 0)
-    if (Error err = buildShaderModules(compiler, &compileInfo))
+    if (Error err = buildShaderModules(compiler, &compileInfo, moduleCache))
       return err;
 
   if (!ToLink)
@@ -804,23 +1008,142 @@ static Error processInputs(ICompiler *compiler, InputSpecGroup &inputSpecs, bool
   // Build pipeline
   //
   std::optional<PipelineDumpOptions> dumpOptions;
-  if (cl::EnablePipelineDump) {
-    dumpOptions.emplace();
-    dumpOptions->pDumpDir = cl::PipelineDumpDir.c_str();
-    dumpOptions->filterPipelineDumpByType = FilterPipelineDumpByType;
-    dumpOptions->filterPipelineDumpByHash = FilterPipelineDumpByHash;
-    dumpOptions->dumpDuplicatePipelines = DumpDuplicatePipelines;
+  if (Error err = getDumpOptions(dumpOptions))
+    return err;
 
+  if (tuningSpace && codegen::getFileType() != CodeGenFileType::ObjectFile)
+    return createResultError(Result::ErrorInvalidValue, "-autotune requires the default (ELF) -filetype");
+
+  if (WaveSizeTrial &&
+      (compileInfo.pipelineType == VfxPipelineTypeGraphics || compileInfo.pipelineType == VfxPipelineTypeCompute)) {
     if (codegen::getFileType() != CodeGenFileType::ObjectFile)
-      return createResultError(Result::ErrorInvalidValue, "Pipeline dumps require the default (ELF) -filetype");
+      return createResultError(Result::ErrorInvalidValue, "-wave-size-trial requires the default (ELF) -filetype");
+    if (Error err = buildWithWaveSizeTrial(compiler, job, dumpOptions))
+      return err;
+  } else {
+    job.builder =
+        createPipelineBuilder(*compiler, compileInfo, dumpOptions, TimePassesIsEnabled || cl::EnableTimerProfile);
+    if (Error err = job.builder->build())
+      return err;
   }
 
-  std::unique_ptr<PipelineBuilder> builder =
-      createPipelineBuilder(*compiler, compileInfo, dumpOptions, TimePassesIsEnabled || cl::EnableTimerProfile);
-  if (Error err = builder->build())
+  // The build above has completed the build info, so the configurations can be built from it directly.
+  if (tuningSpace) {
+    // With -num-threads other than 1, the pipelines are already compiled concurrently, so the configurations of each
+    // are built on its own worker thread rather than on nested threads that would oversubscribe the CPUs.
+    const unsigned tuningThreads = NumThreads == 1 ? AutotuneThreads.getValue() : 1;
+    Expected<json::Object> reportOrErr = autotunePipeline(compiler, compileInfo, *tuningSpace, tuningThreads);
+    if (Error err = reportOrErr.takeError())
+      return err;
+    job.autotuneReport = std::move(*reportOrErr);
+  }
+  return Error::success();
+}
+
+// =====================================================================================================================
+// Writes the outputs of one compiled pipeline. For a graphics library pipeline, those are the outputs of its libraries.
+//
+// @param [in/out] job : Pipeline job
+// @param [in/out] autotuneReports : Array to append the autotuning report of the pipeline to, or null
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+static Error writeOutputs(PipelineJob &job, json::Array *autotuneReports) {
+  if (job.convertOnly)
+    return convertInputPipeline(job.compileInfo, PipelineCaptureOut, PipelineTextOutDir);
+
+  for (std::unique_ptr<PipelineJob> &libraryJob : job.libraryJobs) {
+    if (Error err = writeOutputs(*libraryJob, nullptr))
+      return err;
+  }
+
+  if (!job.builder)
+    return Error::success();
+
+  if (autotuneReports && job.autotuneReport)
+    autotuneReports->push_back(std::move(*job.autotuneReport));
+
+  return job.builder->outputElfs(OutFile);
+}
+
+// =====================================================================================================================
+// Processes a list of pipelines. Their inputs are read ahead on a reader thread, they are compiled by up to
+// -num-threads worker threads sharing the compiler, and their outputs are written in input order, so that the outputs,
+// and the error reported on failure, are the same whatever the number of threads.
+//
+// @param compiler : LLPC compiler
+// @param moduleCache : Cache to share the built shader modules through, or null
+// @param tuningSpace : Search space to autotune the pipelines over, or null
+// @param [in/out] autotuneReports : Array to append the autotuning reports of the pipelines to, or null
+// @param inputGroups : Input filename(s) of each pipeline
+// @param isGraphicsLibrary : Whether compiled pipelines are libraries
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+static Error processInputGroups(ICompiler *compiler, ShaderModuleCache *moduleCache, const TuningSpace *tuningSpace,
+                                json::Array *autotuneReports, MutableArrayRef<InputSpecGroup> inputGroups,
+                                bool isGraphicsLibrary) {
+  return parallelPipeline<PipelineJob>(
+      NumThreads, inputGroups,
+      [compiler, isGraphicsLibrary](InputSpecGroup &inputGroup) {
+        return readInputs(compiler, inputGroup, isGraphicsLibrary);
+      },
+      [compiler, moduleCache, tuningSpace](PipelineJob &job) {
+        return compileInputs(compiler, moduleCache, tuningSpace, job);
+      },
+      [autotuneReports](PipelineJob &job) { return writeOutputs(job, autotuneReports); });
+}
+
+// =====================================================================================================================
+// Processes a list of compute pipelines for -pipeline-batch. All their inputs are read and their shader modules built
+// first, then the pipelines are built with a single ICompiler::BuildPipelineBatch call, and their outputs are written
+// in input order.
+//
+// @param compiler : LLPC compiler
+// @param moduleCache : Cache to share the built shader modules through, or null
+// @param inputGroups : Input filename(s) of each pipeline
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+static Error processPipelineBatch(ICompiler *compiler, ShaderModuleCache *moduleCache,
+                                  MutableArrayRef<InputSpecGroup> inputGroups) {
+  std::optional<PipelineDumpOptions> dumpOptions;
+  if (Error err = getDumpOptions(dumpOptions))
     return err;
 
-  return builder->outputElfs(OutFile);
+  std::vector<std::unique_ptr<PipelineJob>> jobs;
+  std::vector<void *> pipelineDumpHandles;
+  std::vector<PipelineBatchEntry> entries;
+  for (InputSpecGroup &inputGroup : inputGroups) {
+    Expected<std::unique_ptr<PipelineJob>> jobOrErr = readInputs(compiler, inputGroup, false);
+    if (Error err = jobOrErr.takeError())
+      return err;
+    std::unique_ptr<PipelineJob> job = std::move(*jobOrErr);
+    CompileInfo &compileInfo = job->compileInfo;
+    if (job->convertOnly || compileInfo.pipelineType != VfxPipelineTypeCompute)
+      return createResultError(Result::ErrorInvalidValue, "-pipeline-batch only builds compute pipelines");
+
+    if (Error err = buildShaderModules(compiler, &compileInfo, moduleCache))
+      return err;
+
+    job->builder =
+        createPipelineBuilder(*compiler, compileInfo, dumpOptions, TimePassesIsEnabled || cl::EnableTimerProfile);
+    pipelineDumpHandles.push_back(static_cast<ComputePipelineBuilder &>(*job->builder).prepareComputePipeline());
+
+    PipelineBatchEntry entry = {};
+    entry.type = PipelineBatchEntryType::Compute;
+    entry.pComputeInfo = &compileInfo.compPipelineInfo;
+    entry.pComputeOut = &compileInfo.compPipelineOut;
+    entry.pPipelineDumpFile = pipelineDumpHandles.back();
+    entries.push_back(entry);
+    jobs.push_back(std::move(job));
+  }
+
+  // The per-entry results are checked below, in input order.
+  (void)compiler->BuildPipelineBatch(entries.size(), entries.data());
+
+  for (auto [job, pipelineDumpHandle, entry] : zip(jobs, pipelineDumpHandles, entries)) {
+    auto &builder = static_cast<ComputePipelineBuilder &>(*job->builder);
+    if (Error err = builder.finishComputePipeline(pipelineDumpHandle, entry.result))
+      return err;
+    if (Error err = writeOutputs(*job, nullptr))
+      return err;
+  }
+  return Error::success();
 }
 
 #ifdef WIN_OS
@@ -924,13 +1247,46 @@ int main(int argc, char *argv[]) {
     return EXIT_FAILURE;
   }
 
-  if (Error err = parallelFor(NumThreads, *inputGroupsOrErr, [compiler](InputSpecGroup &inputGroup) {
-        return processInputs(compiler, inputGroup, false);
-      })) {
+  std::optional<TuningSpace> tuningSpace;
+  if (Autotune) {
+    auto tuningSpaceOrErr = parseTuningSpace(AutotuneSpace);
+    if (Error err = tuningSpaceOrErr.takeError()) {
+      result = reportError(std::move(err));
+      return EXIT_FAILURE;
+    }
+    tuningSpace = std::move(*tuningSpaceOrErr);
+  }
+
+  // The shader modules are shared by all the pipelines, so the cache lives for the whole run.
+  ShaderModuleCache moduleCache;
+  json::Array autotuneReports;
+  if (PipelineBatch) {
+    if (Error err = processPipelineBatch(compiler, DedupShaderModules ? &moduleCache : nullptr, *inputGroupsOrErr)) {
+      result = reportError(std::move(err));
+      return EXIT_FAILURE;
+    }
+  } else if (Error err = processInputGroups(compiler, DedupShaderModules ? &moduleCache : nullptr,
+                                            tuningSpace ? &*tuningSpace : nullptr, &autotuneReports,
+                                            *inputGroupsOrErr, false)) {
     result = reportError(std::move(err));
     return EXIT_FAILURE;
   }
 
+  if (tuningSpace) {
+    if (Error err = writeAutotuneReports(AutotuneOut, std::move(autotuneReports))) {
+      result = reportError(std::move(err));
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (moduleCache.getRequestCount() != 0) {
+    LLPC_OUTS("Shader module dedup: " << moduleCache.getBuildCount() << " built for "
+                                      << moduleCache.getRequestCount() << " uses, ratio "
+                                      << format("%.2f", double(moduleCache.getRequestCount()) /
+                                                            moduleCache.getBuildCount())
+                                      << "\n");
+  }
+
   assert(result == Result::Success);
   return EXIT_SUCCESS;
 }
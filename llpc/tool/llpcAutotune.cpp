@@ -0,0 +1,472 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcAutotune.cpp
+ * @brief LLPC source file: offline autotuning of pipeline shader options for standalone LLPC compilers.
+ ***********************************************************************************************************************
+ */
+#include "llpcAutotune.h"
+#include "llpcError.h"
+#include "llpcThreading.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <tuple>
+
+using namespace llvm;
+
+namespace Llpc {
+namespace StandaloneCompiler {
+
+namespace {
+
+// Represents a field of PipelineShaderOptions that can be tuned.
+struct TuningKnob {
+  const char *name;                                              // Name of the field, as in .pipe files
+  ArrayRef<const char *> valueNames;                             // Names of the values of an enum field, or empty
+  ArrayRef<unsigned> validValues;                                // Valid values, or empty if any value is valid
+  void (*apply)(PipelineShaderOptions &options, unsigned value); // Sets the field to a value
+};
+
+const char *const ScheduleStrategyNames[] = {"None", "MaxMemoryClause", "MaxIlp"};
+const unsigned WaveSizeValues[] = {0, 32, 64};
+
+const TuningKnob TuningKnobs[] = {
+    {"waveSize", {}, WaveSizeValues, [](PipelineShaderOptions &options, unsigned value) { options.waveSize = value; }},
+    {"unrollThreshold", {}, {},
+     [](PipelineShaderOptions &options, unsigned value) { options.unrollThreshold = value; }},
+    {"scalarThreshold", {}, {},
+     [](PipelineShaderOptions &options, unsigned value) { options.scalarThreshold = value; }},
+    {"scheduleStrategy", ScheduleStrategyNames, {},
+     [](PipelineShaderOptions &options, unsigned value) {
+       options.scheduleStrategy = static_cast<Vkgc::LlvmScheduleStrategy>(value);
+     }},
+    {"promoteAllocaRegLimit", {}, {},
+     [](PipelineShaderOptions &options, unsigned value) { options.promoteAllocaRegLimit = value; }},
+    {"nsaThreshold", {}, {}, [](PipelineShaderOptions &options, unsigned value) { options.nsaThreshold = value; }},
+    {"vgprLimit", {}, {}, [](PipelineShaderOptions &options, unsigned value) { options.vgprLimit = value; }},
+    {"sgprLimit", {}, {}, [](PipelineShaderOptions &options, unsigned value) { options.sgprLimit = value; }},
+};
+
+// Represents the shader info of one stage of a pipeline, with the name of its section in .pipe files.
+struct TunedShader {
+  PipelineShaderInfo *shaderInfo; // Shader info of the stage
+  const char *sectionName;        // Name of the section of the stage in .pipe files
+};
+
+// =====================================================================================================================
+// Parses one value of a knob, either as a name of its enum or as an integer.
+//
+// @param knob : Knob the value is for
+// @param text : Text of the value
+// @returns : The value on success, `ResultError` on failure
+Expected<unsigned> parseTuningValue(const TuningKnob &knob, StringRef text) {
+  unsigned value = 0;
+  auto nameIt = find(knob.valueNames, text);
+  if (nameIt != knob.valueNames.end())
+    value = nameIt - knob.valueNames.begin();
+  else if (text.getAsInteger(0, value))
+    return createResultError(Result::ErrorInvalidValue,
+                             Twine("Invalid value '") + text + "' of autotuning knob '" + knob.name + "'");
+
+  if ((!knob.valueNames.empty() && value >= knob.valueNames.size()) ||
+      (!knob.validValues.empty() && !is_contained(knob.validValues, value)))
+    return createResultError(Result::ErrorInvalidValue,
+                             Twine("Invalid value '") + text + "' of autotuning knob '" + knob.name + "'");
+  return value;
+}
+
+// =====================================================================================================================
+// Formats one value of a knob for a .pipe file.
+//
+// @param knob : Knob the value is for
+// @param value : Value to format
+// @returns : The name of the value for an enum knob, otherwise the value in decimal
+std::string formatTuningValue(const TuningKnob &knob, unsigned value) {
+  if (!knob.valueNames.empty())
+    return knob.valueNames[value];
+  return std::to_string(value);
+}
+
+// =====================================================================================================================
+// Converts a configuration to JSON, as an object of the value of each knob.
+//
+// @param space : Search space of the configuration
+// @param config : Configuration to convert
+// @returns : JSON object of the configuration
+json::Object tuningConfigToJson(const TuningSpace &space, const TuningConfig &config) {
+  json::Object object;
+  for (auto [dimension, value] : zip(space, config)) {
+    const TuningKnob &knob = TuningKnobs[dimension.knob];
+    if (knob.valueNames.empty())
+      object[knob.name] = value;
+    else
+      object[knob.name] = knob.valueNames[value];
+  }
+  return object;
+}
+
+// =====================================================================================================================
+// Converts the metrics of a pipeline to JSON.
+//
+// @param metrics : Metrics to convert
+// @returns : JSON object of the metrics
+json::Object metricsToJson(const PipelineMetrics &metrics) {
+  return json::Object{{"vgprCount", metrics.vgprCount},       {"sgprCount", metrics.sgprCount},
+                      {"scratchBytes", metrics.scratchBytes}, {"ldsBytes", metrics.ldsBytes},
+                      {"codeBytes", metrics.codeBytes},       {"occupancy", metrics.occupancy},
+                      {"laneOccupancy", metrics.laneOccupancy}};
+}
+
+// =====================================================================================================================
+// Gets all the metrics of a pipeline as a tuple, for comparing them.
+//
+// @param metrics : Metrics of a pipeline
+// @returns : Tuple of the metrics
+auto getMetricsTuple(const PipelineMetrics &metrics) {
+  return std::make_tuple(metrics.laneOccupancy, metrics.occupancy, metrics.vgprCount, metrics.sgprCount,
+                         metrics.scratchBytes, metrics.ldsBytes, metrics.codeBytes);
+}
+
+// =====================================================================================================================
+// Gets the shader infos of the stages present in a pipeline build info.
+//
+// @param isCompute : Whether the pipeline is a compute pipeline
+// @param gfxPipelineInfo : Graphics pipeline build info, used if not compute
+// @param compPipelineInfo : Compute pipeline build info, used if compute
+// @returns : The shader infos of the stages with a shader module, in stage order
+SmallVector<TunedShader, 8> getTunedShaders(bool isCompute, GraphicsPipelineBuildInfo &gfxPipelineInfo,
+                                            ComputePipelineBuildInfo &compPipelineInfo) {
+  SmallVector<TunedShader, 8> shaders;
+  if (isCompute) {
+    shaders.push_back({&compPipelineInfo.cs, "CsInfo"});
+  } else {
+    shaders.append({{&gfxPipelineInfo.task, "TaskInfo"},
+                    {&gfxPipelineInfo.vs, "VsInfo"},
+                    {&gfxPipelineInfo.tcs, "TcsInfo"},
+                    {&gfxPipelineInfo.tes, "TesInfo"},
+                    {&gfxPipelineInfo.gs, "GsInfo"},
+                    {&gfxPipelineInfo.mesh, "MeshInfo"},
+                    {&gfxPipelineInfo.fs, "FsInfo"}});
+  }
+  erase_if(shaders, [](const TunedShader &shader) { return !shader.shaderInfo->pModuleData; });
+  return shaders;
+}
+
+// =====================================================================================================================
+// Callback function to allocate the output buffer of one autotuning build.
+//
+// @param instance : Unused
+// @param userData : Vector of the buffers of the build
+// @param size : Size of the buffer
+// @returns : The buffer
+void *VKAPI_CALL allocateTuningBuffer(void *instance, void *userData, size_t size) {
+  (void)instance;
+  auto *buffers = reinterpret_cast<SmallVector<std::unique_ptr<char[]>, 1> *>(userData);
+  buffers->push_back(std::make_unique<char[]>(size));
+  memset(buffers->back().get(), 0, size);
+  return buffers->back().get();
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+// Parses a search space of the form "knob=value,value;knob=value,...". Each knob is a field of PipelineShaderOptions,
+// and each value is an integer or, for an enum field, the name of one of its values.
+//
+// @param text : Text of the search space
+// @returns : The search space on success, `ResultError` on failure
+Expected<TuningSpace> parseTuningSpace(StringRef text) {
+  TuningSpace space;
+  SmallVector<StringRef> dimensionTexts;
+  text.split(dimensionTexts, ';', -1, false);
+  uint64_t configCount = 1;
+  for (StringRef dimensionText : dimensionTexts) {
+    auto [name, valuesText] = dimensionText.split('=');
+    name = name.trim();
+    auto knobIt = find_if(TuningKnobs, [name](const TuningKnob &knob) { return name == knob.name; });
+    if (knobIt == std::end(TuningKnobs))
+      return createResultError(Result::ErrorInvalidValue, Twine("Unknown autotuning knob '") + name + "'");
+
+    TuningDimension dimension = {};
+    dimension.knob = knobIt - std::begin(TuningKnobs);
+    if (any_of(space, [&](const TuningDimension &other) { return other.knob == dimension.knob; }))
+      return createResultError(Result::ErrorInvalidValue, Twine("Duplicate autotuning knob '") + name + "'");
+
+    SmallVector<StringRef> valueTexts;
+    valuesText.split(valueTexts, ',', -1, false);
+    for (StringRef valueText : valueTexts) {
+      Expected<unsigned> valueOrErr = parseTuningValue(*knobIt, valueText.trim());
+      if (Error err = valueOrErr.takeError())
+        return std::move(err);
+      dimension.values.push_back(*valueOrErr);
+    }
+    if (dimension.values.empty())
+      return createResultError(Result::ErrorInvalidValue, Twine("No values for autotuning knob '") + name + "'");
+
+    configCount *= dimension.values.size();
+    if (configCount > MaxTuningConfigs)
+      return createResultError(Result::ErrorInvalidValue, Twine("Autotuning search space has more than ") +
+                                                              Twine(MaxTuningConfigs) + " configurations");
+    space.push_back(std::move(dimension));
+  }
+
+  if (space.empty())
+    return createResultError(Result::ErrorInvalidValue, "Autotuning search space is empty");
+  return space;
+}
+
+// =====================================================================================================================
+// Gets the number of configurations of a search space.
+//
+// @param space : Search space
+// @returns : Product of the numbers of values of the dimensions
+unsigned getTuningConfigCount(const TuningSpace &space) {
+  unsigned count = 1;
+  for (const TuningDimension &dimension : space)
+    count *= dimension.values.size();
+  return count;
+}
+
+// =====================================================================================================================
+// Gets the configuration with the given index. Configurations are numbered with the last dimension varying fastest,
+// so configuration 0 has the first value of every dimension.
+//
+// @param space : Search space
+// @param index : Index of the configuration, in [0, getTuningConfigCount(space))
+// @returns : The value of each dimension
+TuningConfig getTuningConfig(const TuningSpace &space, unsigned index) {
+  TuningConfig config(space.size());
+  for (unsigned dimensionIdx = space.size(); dimensionIdx-- != 0;) {
+    ArrayRef<unsigned> values = space[dimensionIdx].values;
+    config[dimensionIdx] = values[index % values.size()];
+    index /= values.size();
+  }
+  return config;
+}
+
+// =====================================================================================================================
+// Sets the fields of the shader options to the values of a configuration.
+//
+// @param space : Search space of the configuration
+// @param config : Configuration to apply
+// @param [in/out] options : Shader options to set the fields of
+void applyTuningConfig(const TuningSpace &space, const TuningConfig &config, PipelineShaderOptions &options) {
+  for (auto [dimension, value] : zip(space, config))
+    TuningKnobs[dimension.knob].apply(options, value);
+}
+
+// =====================================================================================================================
+// Checks whether the metrics of one build dominate another's: at least the occupancy in lanes, and at most the
+// register, memory and code sizes, with at least one of them strictly better. Occupancy in waves is not compared, as
+// a wave64 build with fewer waves resident than a wave32 build may still have more lanes resident.
+//
+// @param lhs : Metrics of one build
+// @param rhs : Metrics of the other build
+// @returns : True if lhs dominates rhs
+bool dominatesMetrics(const PipelineMetrics &lhs, const PipelineMetrics &rhs) {
+  if (lhs.laneOccupancy < rhs.laneOccupancy || lhs.vgprCount > rhs.vgprCount || lhs.sgprCount > rhs.sgprCount ||
+      lhs.scratchBytes > rhs.scratchBytes || lhs.ldsBytes > rhs.ldsBytes || lhs.codeBytes > rhs.codeBytes)
+    return false;
+  return getMetricsTuple(lhs) != getMetricsTuple(rhs);
+}
+
+// =====================================================================================================================
+// Checks whether the metrics of one build are preferred to another's when choosing the best build: the higher
+// occupancy in lanes, then the less scratch, the fewer VGPRs, the smaller code, the fewer SGPRs and the less LDS.
+//
+// @param lhs : Metrics of one build
+// @param rhs : Metrics of the other build
+// @returns : True if lhs is preferred to rhs
+bool isPreferredMetrics(const PipelineMetrics &lhs, const PipelineMetrics &rhs) {
+  return std::make_tuple(rhs.laneOccupancy, lhs.scratchBytes, lhs.vgprCount, lhs.codeBytes, lhs.sgprCount,
+                         lhs.ldsBytes) <
+         std::make_tuple(lhs.laneOccupancy, rhs.scratchBytes, rhs.vgprCount, rhs.codeBytes, rhs.sgprCount,
+                         rhs.ldsBytes);
+}
+
+// =====================================================================================================================
+// Gets the successful results that no other successful result dominates. Many configurations build the same code, so
+// of the results with the same metrics only the first is kept.
+//
+// @param results : Results of all the configurations, in configuration order
+// @returns : Indices of the results on the Pareto front, the preferred one first
+SmallVector<unsigned> getParetoFront(ArrayRef<TuningResult> results) {
+  SmallVector<unsigned> front;
+  for (unsigned idx = 0; idx != results.size(); ++idx) {
+    const PipelineMetrics &metrics = results[idx].metrics;
+    if (!results[idx].succeeded)
+      continue;
+    if (any_of(results, [&](const TuningResult &other) {
+          return other.succeeded && dominatesMetrics(other.metrics, metrics);
+        }))
+      continue;
+    if (any_of(front, [&](unsigned frontIdx) {
+          return getMetricsTuple(results[frontIdx].metrics) == getMetricsTuple(metrics);
+        }))
+      continue;
+    front.push_back(idx);
+  }
+  std::stable_sort(front.begin(), front.end(), [results](unsigned lhsIdx, unsigned rhsIdx) {
+    return isPreferredMetrics(results[lhsIdx].metrics, results[rhsIdx].metrics);
+  });
+  return front;
+}
+
+// =====================================================================================================================
+// Checks whether a pipeline can be autotuned. Only whole graphics and compute pipelines can: graphics libraries and
+// pipelines built in parts with a color export shader are built by several calls, and ray tracing pipelines are
+// built from shader libraries that the options of one pipeline do not cover.
+//
+// @param compileInfo : Compilation info of the pipeline
+// @returns : True if the pipeline can be autotuned
+bool isTunablePipeline(const CompileInfo &compileInfo) {
+  if (compileInfo.pipelineType == VfxPipelineTypeCompute)
+    return true;
+  return compileInfo.pipelineType == VfxPipelineTypeGraphics && !compileInfo.isGraphicsLibrary &&
+         !compileInfo.enableColorExportShader && !compileInfo.gfxPipelineInfo.enableColorExportShader;
+}
+
+// =====================================================================================================================
+// Builds a compiled pipeline with every configuration of a search space, applied to the shader options of all its
+// stages, and reports the best configurations as JSON. The pipeline must have been built once already, so that its
+// build info is complete; the metrics of that build are reported as the baseline. A configuration that fails to build
+// is counted, but is not an error.
+//
+// @param compiler : LLPC compiler
+// @param compileInfo : Compilation info of the built pipeline
+// @param space : Search space
+// @param numThreads : Number of threads to build the configurations on, 0 for all the cores
+// @returns : The JSON report of the pipeline on success, `ResultError` on failure
+Expected<json::Object> autotunePipeline(ICompiler *compiler, const CompileInfo &compileInfo, const TuningSpace &space,
+                                        unsigned numThreads) {
+  assert(isTunablePipeline(compileInfo));
+  const bool isCompute = compileInfo.pipelineType == VfxPipelineTypeCompute;
+
+  PipelineMetrics baseline;
+  if (isCompute) {
+    baseline = getPipelineMetrics(compileInfo.compPipelineOut.pipelineBin, compileInfo.gfxIp);
+  } else {
+    for (const GraphicsPipelineBuildOut &pipelineOut : compileInfo.gfxPipelineOut)
+      baseline.merge(getPipelineMetrics(pipelineOut.pipelineBin, compileInfo.gfxIp));
+  }
+
+  SmallVector<TuningResult> results(getTuningConfigCount(space));
+  for (auto [idx, result] : enumerate(results))
+    result.config = getTuningConfig(space, idx);
+
+  // Each build gets its own copy of the build info, and its own buffers, so the builds can run concurrently.
+  Error err = parallelFor(numThreads, results, [&](TuningResult &result) -> Error {
+    GraphicsPipelineBuildInfo gfxPipelineInfo = compileInfo.gfxPipelineInfo;
+    ComputePipelineBuildInfo compPipelineInfo = compileInfo.compPipelineInfo;
+    for (const TunedShader &shader : getTunedShaders(isCompute, gfxPipelineInfo, compPipelineInfo))
+      applyTuningConfig(space, result.config, shader.shaderInfo->options);
+
+    SmallVector<std::unique_ptr<char[]>, 1> buffers;
+    BinaryData pipelineBin = {};
+    Result buildResult = Result::Success;
+    if (isCompute) {
+      compPipelineInfo.pUserData = &buffers;
+      compPipelineInfo.pfnOutputAlloc = allocateTuningBuffer;
+      ComputePipelineBuildOut pipelineOut = {};
+      buildResult = compiler->BuildComputePipeline(&compPipelineInfo, &pipelineOut);
+      pipelineBin = pipelineOut.pipelineBin;
+    } else {
+      gfxPipelineInfo.pUserData = &buffers;
+      gfxPipelineInfo.pfnOutputAlloc = allocateTuningBuffer;
+      GraphicsPipelineBuildOut pipelineOut = {};
+      buildResult = compiler->BuildGraphicsPipeline(&gfxPipelineInfo, &pipelineOut);
+      pipelineBin = pipelineOut.pipelineBin;
+    }
+
+    result.succeeded = buildResult == Result::Success;
+    if (result.succeeded)
+      result.metrics = getPipelineMetrics(pipelineBin, compileInfo.gfxIp);
+    return Error::success();
+  });
+  if (err)
+    return std::move(err);
+
+  json::Object report;
+  report["pipeline"] = compileInfo.inputSpecs.front().filename;
+  report["configCount"] = results.size();
+  report["failedCount"] = count_if(results, [](const TuningResult &result) { return !result.succeeded; });
+  report["baseline"] = metricsToJson(baseline);
+
+  SmallVector<unsigned> front = getParetoFront(results);
+  json::Array pareto;
+  for (unsigned idx : front) {
+    pareto.push_back(json::Object{{"options", tuningConfigToJson(space, results[idx].config)},
+                                  {"metrics", metricsToJson(results[idx].metrics)}});
+  }
+  report["pareto"] = std::move(pareto);
+
+  if (front.empty()) {
+    report["best"] = nullptr;
+    return report;
+  }
+
+  // The override of the best configuration, as the option lines of each stage section of a .pipe file.
+  const TuningResult &best = results[front.front()];
+  GraphicsPipelineBuildInfo gfxPipelineInfo = compileInfo.gfxPipelineInfo;
+  ComputePipelineBuildInfo compPipelineInfo = compileInfo.compPipelineInfo;
+  std::string pipeOverride;
+  raw_string_ostream pipeOverrideStream(pipeOverride);
+  for (const TunedShader &shader : getTunedShaders(isCompute, gfxPipelineInfo, compPipelineInfo)) {
+    pipeOverrideStream << "[" << shader.sectionName << "]\n";
+    for (auto [dimension, value] : zip(space, best.config)) {
+      const TuningKnob &knob = TuningKnobs[dimension.knob];
+      pipeOverrideStream << "options." << knob.name << " = " << formatTuningValue(knob, value) << "\n";
+    }
+  }
+
+  report["best"] = json::Object{{"options", tuningConfigToJson(space, best.config)},
+                                {"metrics", metricsToJson(best.metrics)},
+                                {"pipeOverride", std::move(pipeOverride)}};
+  return report;
+}
+
+// =====================================================================================================================
+// Writes the autotuning reports of all the pipelines to a JSON file, as an array in input order.
+//
+// @param filename : Name of the file to write
+// @param reports : Reports of the pipelines
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+Error writeAutotuneReports(StringRef filename, json::Array reports) {
+  std::error_code errorCode;
+  raw_fd_ostream outStream(filename, errorCode, sys::fs::OF_Text);
+  if (errorCode)
+    return createResultError(Result::ErrorUnavailable,
+                             Twine("Failed to open autotuning output file '") + filename + "': " + errorCode.message());
+
+  outStream << formatv("{0:2}", json::Value(std::move(reports))) << "\n";
+  return Error::success();
+}
+
+} // namespace StandaloneCompiler
+} // namespace Llpc
@@ -0,0 +1,98 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcAutotune.h
+ * @brief LLPC header file: offline autotuning of pipeline shader options for standalone LLPC compilers.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llpc.h"
+#include "llpcCompilationUtils.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include <string>
+
+namespace Llpc {
+namespace StandaloneCompiler {
+
+// Maximum number of configurations in an autotuning search space.
+constexpr unsigned MaxTuningConfigs = 4096;
+
+// Represents one dimension of an autotuning search space: a field of PipelineShaderOptions and the values to try.
+struct TuningDimension {
+  unsigned knob;                      // Index of the field in the table of tunable fields
+  llvm::SmallVector<unsigned> values; // Values to try, in the order given
+};
+
+using TuningSpace = llvm::SmallVector<TuningDimension>;
+
+// One configuration of a search space: the value of each of its dimensions.
+using TuningConfig = llvm::SmallVector<unsigned>;
+
+// Represents the outcome of building a pipeline with one configuration.
+struct TuningResult {
+  TuningConfig config;     // Configuration the pipeline was built with
+  bool succeeded = false;  // Whether the build succeeded
+  PipelineMetrics metrics; // Metrics of the build, if it succeeded
+};
+
+// Parses a search space of the form "knob=value,value;knob=value,...".
+llvm::Expected<TuningSpace> parseTuningSpace(llvm::StringRef text);
+
+// Gets the number of configurations of a search space.
+unsigned getTuningConfigCount(const TuningSpace &space);
+
+// Gets the configuration with the given index, in [0, getTuningConfigCount(space)).
+TuningConfig getTuningConfig(const TuningSpace &space, unsigned index);
+
+// Sets the fields of the shader options to the values of a configuration.
+void applyTuningConfig(const TuningSpace &space, const TuningConfig &config, PipelineShaderOptions &options);
+
+// Checks whether the metrics of one build are at least as good as another's in every respect, and better in one.
+bool dominatesMetrics(const PipelineMetrics &lhs, const PipelineMetrics &rhs);
+
+// Checks whether the metrics of one build are preferred to another's when choosing the best build.
+bool isPreferredMetrics(const PipelineMetrics &lhs, const PipelineMetrics &rhs);
+
+// Gets the indices of the successful results on the Pareto front, one per distinct set of metrics, best first.
+llvm::SmallVector<unsigned> getParetoFront(llvm::ArrayRef<TuningResult> results);
+
+// Checks whether a pipeline can be autotuned.
+bool isTunablePipeline(const CompileInfo &compileInfo);
+
+// Builds a compiled pipeline with every configuration of a search space, and reports the best ones as JSON.
+llvm::Expected<llvm::json::Object> autotunePipeline(ICompiler *compiler, const CompileInfo &compileInfo,
+                                                    const TuningSpace &space, unsigned numThreads);
+
+// Writes the autotuning reports of all the pipelines to a JSON file.
+llvm::Error writeAutotuneReports(llvm::StringRef filename, llvm::json::Array reports);
+
+} // namespace StandaloneCompiler
+} // namespace Llpc
@@ -71,6 +71,9 @@
 #endif
 #include "vfx.h"
 #include "vkgcElfReader.h"
+#include "vkgcMetroHash.h"
+#include "vkgcPipelineCapture.h"
+#include "lgc/Occupancy.h"
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
@@ -112,9 +115,9 @@ void *VKAPI_CALL allocateBuffer(void *instance, void *userData, size_t size) {
 // @param [in/out] compileInfo : Compilation info of LLPC standalone tool
 void cleanupCompileInfo(CompileInfo *compileInfo) {
   for (unsigned i = 0; i < compileInfo->shaderModuleDatas.size(); ++i) {
-    // NOTE: We do not have to free SPIR-V binary for pipeline info file.
-    // It will be freed when we close the VFX doc.
-    if (!compileInfo->pipelineInfoFile)
+    // NOTE: We do not have to free SPIR-V binary for pipeline info file or pipeline capture.
+    // It will be freed when we close the VFX doc or release the capture.
+    if (!compileInfo->pipelineInfoFile && !compileInfo->pipelineCapture)
       delete[] reinterpret_cast<const char *>(compileInfo->shaderModuleDatas[i].spirvBin.pCode);
   }
 
@@ -122,6 +125,7 @@ void cleanupCompileInfo(CompileInfo *compileInfo) {
 
   if (compileInfo->pipelineInfoFile)
     Vfx::vfxCloseDoc(compileInfo->pipelineInfoFile);
+  compileInfo->pipelineCapture.reset();
 }
 
 #ifndef LLPC_DISABLE_SPVGEN
@@ -335,13 +339,143 @@ Result decodePipelineBinary(const BinaryData *pipelineBin, CompileInfo *compileI
   return Result::Success;
 }
 
+// =====================================================================================================================
+// Merges the metrics of another ELF of the same pipeline into these.
+//
+// @param other : Metrics to merge
+void PipelineMetrics::merge(const PipelineMetrics &other) {
+  vgprCount = std::max(vgprCount, other.vgprCount);
+  sgprCount = std::max(sgprCount, other.sgprCount);
+  scratchBytes = std::max(scratchBytes, other.scratchBytes);
+  ldsBytes = std::max(ldsBytes, other.ldsBytes);
+  codeBytes += other.codeBytes;
+  if (other.occupancy != 0)
+    occupancy = occupancy == 0 ? other.occupancy : std::min(occupancy, other.occupancy);
+  if (other.laneOccupancy != 0)
+    laneOccupancy = laneOccupancy == 0 ? other.laneOccupancy : std::min(laneOccupancy, other.laneOccupancy);
+}
+
+// =====================================================================================================================
+// Reads the static metrics of a pipeline ELF from the PAL metadata of its hardware stages and the size of its code.
+//
+// The occupancy, in waves and in lanes per SIMD, is estimated from the VGPR count and wave size of each hardware stage
+// by lgc::getWavesPerSimd. This is an estimate only: it assumes the VGPR file of the smallest GPU of the generation,
+// and ignores SGPRs and LDS.
+//
+// @param pipelineBin : Pipeline binary
+// @param gfxIp : Graphics IP version
+// @returns : Metrics of the pipeline, all 0 if the binary is not an ELF with PAL metadata
+PipelineMetrics getPipelineMetrics(const BinaryData &pipelineBin, GfxIpVersion gfxIp) {
+  PipelineMetrics metrics;
+  ElfReader<Elf64> reader(gfxIp);
+  size_t readSize = 0;
+  if (reader.ReadFromBuffer(pipelineBin.pCode, &readSize) != Result::Success || !reader.isSectionPresent(".note"))
+    return metrics;
+
+  const ElfReader<Elf64>::SectionBuffer *textSection = nullptr;
+  if (reader.isSectionPresent(".text") && reader.getTextSectionData(&textSection) == Result::Success)
+    metrics.codeBytes = textSection->secHead.sh_size;
+
+  ElfNote metaNote = reader.getNote(Util::Abi::MetadataNoteType);
+  msgpack::Document document;
+  if (!metaNote.data ||
+      !document.readFromBlob(StringRef(reinterpret_cast<const char *>(metaNote.data), metaNote.hdr.descSize), false))
+    return metrics;
+
+  auto &pipeline = document.getRoot().getMap(true)[Util::PalAbi::CodeObjectMetadataKey::Pipelines].getArray(true)[0];
+  auto &hwStages = pipeline.getMap(true)[Util::PalAbi::PipelineMetadataKey::HardwareStages].getMap(true);
+  for (auto &hwStage : hwStages) {
+    auto &stageMap = hwStage.second.getMap(true);
+    auto getUInt = [&](StringRef key) -> unsigned {
+      auto it = stageMap.find(key);
+      return it != stageMap.end() && it->second.getKind() == msgpack::Type::UInt ? it->second.getUInt() : 0;
+    };
+    unsigned waveSize = getUInt(Util::PalAbi::HardwareStageMetadataKey::WavefrontSize);
+    unsigned vgprCount = getUInt(Util::PalAbi::HardwareStageMetadataKey::VgprCount);
+    metrics.vgprCount = std::max(metrics.vgprCount, vgprCount);
+    metrics.sgprCount = std::max(metrics.sgprCount, getUInt(Util::PalAbi::HardwareStageMetadataKey::SgprCount));
+    metrics.scratchBytes =
+        std::max(metrics.scratchBytes, getUInt(Util::PalAbi::HardwareStageMetadataKey::ScratchMemorySize));
+    metrics.ldsBytes = std::max(metrics.ldsBytes, getUInt(Util::PalAbi::HardwareStageMetadataKey::LdsSize));
+    if (waveSize == 0)
+      continue;
+
+    unsigned waves = lgc::getWavesPerSimd(gfxIp.major, gfxIp.minor, vgprCount, waveSize);
+    metrics.occupancy = metrics.occupancy == 0 ? waves : std::min(metrics.occupancy, waves);
+    unsigned lanes = waves * waveSize;
+    metrics.laneOccupancy = metrics.laneOccupancy == 0 ? lanes : std::min(metrics.laneOccupancy, lanes);
+  }
+  return metrics;
+}
+
+// =====================================================================================================================
+// Callback function to allocate the buffer of a shader module owned by the shader module cache.
+//
+// @param instance : Placeholder instance object, unused
+// @param userData : Cache entry of the shader module
+// @param size : Requested allocation size
+// @returns : Pointer to the allocated memory
+void *VKAPI_CALL ShaderModuleCache::allocateBuffer(void *instance, void *userData, size_t size) {
+  (void)instance;
+  auto *entry = reinterpret_cast<Entry *>(userData);
+  assert(!entry->buffer && "Shader module allocated twice");
+  entry->buffer = std::make_unique<char[]>(size);
+  memset(entry->buffer.get(), 0, size);
+  return entry->buffer.get();
+}
+
+// =====================================================================================================================
+// Builds a shader module, or reuses the one already built from the same SPIR-V and module options.
+//
+// @param compiler : LLPC compiler object
+// @param shaderInfo : Info to build the shader module
+// @param [out] shaderOut : Output of building the shader module, valid for the lifetime of the cache
+// @returns : Result of building the shader module
+Result ShaderModuleCache::buildShaderModule(ICompiler *compiler, const ShaderModuleBuildInfo *shaderInfo,
+                                            ShaderModuleBuildOut *shaderOut) {
+  const ShaderModuleOptions &options = shaderInfo->options;
+  MetroHash::Hash spirvHash = {};
+  MetroHash64::Hash(reinterpret_cast<const uint8_t *>(shaderInfo->shaderBin.pCode), shaderInfo->shaderBin.codeSize,
+                    spirvHash.bytes);
+  MetroHash64 hasher;
+  hasher.Update(spirvHash);
+  hasher.Update(options.pipelineOptions.internalRtShaders);
+  hasher.Update(options.pipelineOptions.getGlState().buildResourcesDataForShaderModule);
+  hasher.Update(options.mergeLocationAndBinding);
+  hasher.Update(options.resourceBindingOffset);
+  MetroHash::Hash key = {};
+  hasher.Finalize(key.bytes);
+
+  Entry *entry = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_requestCount;
+    std::unique_ptr<Entry> &slot = m_entries[key];
+    if (!slot)
+      slot = std::make_unique<Entry>();
+    entry = slot.get();
+  }
+
+  // Other threads requesting the same module wait here until it is built.
+  std::call_once(entry->built, [compiler, shaderInfo, entry] {
+    ShaderModuleBuildInfo cachedShaderInfo = *shaderInfo;
+    cachedShaderInfo.pUserData = entry;
+    cachedShaderInfo.pfnOutputAlloc = allocateBuffer;
+    entry->result = compiler->BuildShaderModule(&cachedShaderInfo, &entry->shaderOut);
+  });
+
+  *shaderOut = entry->shaderOut;
+  return entry->result;
+}
+
 // =====================================================================================================================
 // Builds shader module based on the specified SPIR-V binary.
 //
 // @param compiler : LLPC compiler object
 // @param [in/out] compileInfo : Compilation info of LLPC standalone tool
+// @param moduleCache : Cache to share the built shader modules through, or null to build them for this pipeline only
 // @returns : `ErrorSuccess` on success, `ResultError` on failure
-Error buildShaderModules(ICompiler *compiler, CompileInfo *compileInfo) {
+Error buildShaderModules(ICompiler *compiler, CompileInfo *compileInfo, ShaderModuleCache *moduleCache) {
   for (ShaderModuleData &shaderModuleData : compileInfo->shaderModuleDatas) {
     ShaderModuleBuildInfo *shaderInfo = &shaderModuleData.shaderInfo;
     ShaderModuleBuildOut *shaderOut = &shaderModuleData.shaderOut;
@@ -351,7 +485,8 @@ Error buildShaderModules(ICompiler *compiler, CompileInfo *compileInfo) {
     shaderInfo->pfnOutputAlloc = allocateBuffer;
     shaderInfo->shaderBin = shaderModuleData.spirvBin;
 
-    Result result = compiler->BuildShaderModule(shaderInfo, shaderOut);
+    Result result = moduleCache ? moduleCache->buildShaderModule(compiler, shaderInfo, shaderOut)
+                                : compiler->BuildShaderModule(shaderInfo, shaderOut);
     if (result != Result::Success && result != Result::Delayed)
       return createResultError(result, Twine("Failed to build ") + getShaderStageName(shaderModuleData.shaderStage) +
                                            " shader module");
@@ -360,6 +495,36 @@ Error buildShaderModules(ICompiler *compiler, CompileInfo *compileInfo) {
   return Error::success();
 }
 
+// =====================================================================================================================
+// Loads a binary pipeline capture file into the compile info.
+//
+// @param [in/out] compileInfo : Compilation info of LLPC standalone tool
+// @param inFile : Name of the capture file
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+static Error loadPipelineCapture(CompileInfo &compileInfo, const std::string &inFile) {
+  std::string errorMsg;
+  Result result = Vkgc::PipelineCapture::load(inFile.c_str(), compileInfo.pipelineCapture, errorMsg);
+  if (result != Result::Success)
+    return createResultError(result, Twine("Failed to load pipeline capture: ") + inFile + ": " + errorMsg);
+
+  LLPC_OUTS("===============================================================================\n");
+  LLPC_OUTS("// Pipeline capture info for " << inFile << " \n\n");
+
+  // The build infos are decoded into memory owned by the capture, so they may be modified like those of a .pipe file.
+  const PipelineBuildInfo pipelineInfo = compileInfo.pipelineCapture->getPipelineInfo();
+  if (pipelineInfo.pGraphicsInfo) {
+    compileInfo.gfxPipelineInfo = *pipelineInfo.pGraphicsInfo;
+    compileInfo.pipelineType = VfxPipelineTypeGraphics;
+  } else if (pipelineInfo.pComputeInfo) {
+    compileInfo.compPipelineInfo = *pipelineInfo.pComputeInfo;
+    compileInfo.pipelineType = VfxPipelineTypeCompute;
+  } else {
+    compileInfo.rayTracePipelineInfo = *pipelineInfo.pRayTracingInfo;
+    compileInfo.pipelineType = VfxPipelineTypeRayTracing;
+  }
+  return Error::success();
+}
+
 // =====================================================================================================================
 // Process one pipeline input file.
 //
@@ -371,49 +536,63 @@ Error buildShaderModules(ICompiler *compiler, CompileInfo *compileInfo) {
 Error processInputPipeline(ICompiler *compiler, CompileInfo &compileInfo, const InputSpec &inputSpec, bool unlinked,
                            bool ignoreColorAttachmentFormats) {
   const std::string &inFile = inputSpec.filename;
-  const char *log = nullptr;
-  const bool vfxResult =
-      Vfx::vfxParseFile(inFile.c_str(), 0, nullptr, VfxDocTypePipeline, &compileInfo.pipelineInfoFile, &log);
-  if (!vfxResult)
-    return createResultError(Result::ErrorInvalidShader, Twine("Failed to parse input file: ") + inFile + "\n" + log);
+  SmallVector<Vkgc::PipelineCaptureStage> stages;
+  if (isPipelineCaptureFile(inFile)) {
+    if (Error err = loadPipelineCapture(compileInfo, inFile))
+      return err;
+    append_range(stages, compileInfo.pipelineCapture->getStages());
+  } else {
+    const char *log = nullptr;
+    const bool vfxResult =
+        Vfx::vfxParseFile(inFile.c_str(), 0, nullptr, VfxDocTypePipeline, &compileInfo.pipelineInfoFile, &log);
+    if (!vfxResult)
+      return createResultError(Result::ErrorInvalidShader,
+                               Twine("Failed to parse input file: ") + inFile + "\n" + log);
 
-  VfxPipelineStatePtr pipelineState = nullptr;
-  Vfx::vfxGetPipelineDoc(compileInfo.pipelineInfoFile, &pipelineState);
+    VfxPipelineStatePtr pipelineState = nullptr;
+    Vfx::vfxGetPipelineDoc(compileInfo.pipelineInfoFile, &pipelineState);
 
-  if (pipelineState->version != Vkgc::Version) {
-    std::string errMsg;
-    raw_string_ostream os(errMsg);
-    os << "Version incompatible, SPVGEN::Version = " << pipelineState->version << " LLPC::Version = " << Vkgc::Version;
-    return createResultError(Result::ErrorInvalidShader, os.str());
-  }
+    if (pipelineState->version != Vkgc::Version) {
+      std::string errMsg;
+      raw_string_ostream os(errMsg);
+      os << "Version incompatible, SPVGEN::Version = " << pipelineState->version
+         << " LLPC::Version = " << Vkgc::Version;
+      return createResultError(Result::ErrorInvalidShader, os.str());
+    }
 
-  LLPC_OUTS("===============================================================================\n");
-  LLPC_OUTS("// Pipeline file info for " << inFile << " \n\n");
-
-  if (log && strlen(log) > 0)
-    LLPC_OUTS("Pipeline file parse warning:\n" << log << "\n");
-
-  compileInfo.compPipelineInfo = pipelineState->compPipelineInfo;
-  compileInfo.gfxPipelineInfo = pipelineState->gfxPipelineInfo;
-  compileInfo.rayTracePipelineInfo = pipelineState->rayPipelineInfo;
-  compileInfo.pipelineType = pipelineState->pipelineType;
-
-  if (pipelineState->pipelineType == VfxPipelineTypeGraphicsLibrary) {
-    LLPC_OUTS("// Pipeline type is Graphics library, compile each stage library:\n");
-    for (auto &libFileName : pipelineState->graphicsLibFileName) {
-      if (!libFileName.empty()) {
-        LLPC_OUTS(libFileName + "\n");
-        InputSpec inputSpec = cantFail(parseInputFileSpec(libFileName));
-        compileInfo.inputSpecs.push_back(std::move(inputSpec));
+    LLPC_OUTS("===============================================================================\n");
+    LLPC_OUTS("// Pipeline file info for " << inFile << " \n\n");
+
+    if (log && strlen(log) > 0)
+      LLPC_OUTS("Pipeline file parse warning:\n" << log << "\n");
+
+    compileInfo.compPipelineInfo = pipelineState->compPipelineInfo;
+    compileInfo.gfxPipelineInfo = pipelineState->gfxPipelineInfo;
+    compileInfo.rayTracePipelineInfo = pipelineState->rayPipelineInfo;
+    compileInfo.pipelineType = pipelineState->pipelineType;
+
+    if (pipelineState->pipelineType == VfxPipelineTypeGraphicsLibrary) {
+      LLPC_OUTS("// Pipeline type is Graphics library, compile each stage library:\n");
+      for (auto &libFileName : pipelineState->graphicsLibFileName) {
+        if (!libFileName.empty()) {
+          LLPC_OUTS(libFileName + "\n");
+          InputSpec inputSpec = cantFail(parseInputFileSpec(libFileName));
+          compileInfo.inputSpecs.push_back(std::move(inputSpec));
+        }
       }
+      return Error::success();
     }
-    return Error::success();
-  }
 
-  if (!pipelineState->fsOutputs.empty()) {
-    // Color export shader
-    compileInfo.fsOutputs = pipelineState->fsOutputs;
-    compileInfo.isGraphicsLibrary = true;
+    if (!pipelineState->fsOutputs.empty()) {
+      // Color export shader
+      compileInfo.fsOutputs = pipelineState->fsOutputs;
+      compileInfo.isGraphicsLibrary = true;
+    }
+
+    for (unsigned stage = 0; stage < pipelineState->numStages; ++stage) {
+      const Vfx::ShaderSource &source = pipelineState->stages[stage];
+      stages.push_back({source.stage, {source.dataSize, source.pData}});
+    }
   }
 
   if (ignoreColorAttachmentFormats) {
@@ -429,19 +608,18 @@ Error processInputPipeline(ICompiler *compiler, CompileInfo &compileInfo, const
   if (EnableOuts() && !InitSpvGen())
     LLPC_OUTS("Failed to load SPVGEN -- cannot disassemble and validate SPIR-V\n");
 #endif
-  for (unsigned stage = 0; stage < pipelineState->numStages; ++stage) {
-    if (pipelineState->stages[stage].dataSize > 0) {
+  for (const Vkgc::PipelineCaptureStage &stage : stages) {
+    if (stage.spirv.codeSize > 0) {
       StandaloneCompiler::ShaderModuleData shaderModuleData = {};
-      shaderModuleData.spirvBin.codeSize = pipelineState->stages[stage].dataSize;
-      shaderModuleData.spirvBin.pCode = pipelineState->stages[stage].pData;
-      shaderModuleData.shaderStage = pipelineState->stages[stage].stage;
+      shaderModuleData.spirvBin = stage.spirv;
+      shaderModuleData.shaderStage = stage.stage;
 
       compileInfo.shaderModuleDatas.push_back(shaderModuleData);
-      compileInfo.stageMask |= shaderStageToMask(pipelineState->stages[stage].stage);
+      compileInfo.stageMask |= shaderStageToMask(stage.stage);
 #ifndef LLPC_DISABLE_SPVGEN
       if (EnableOuts())
-        disassembleSpirv(pipelineState->stages[stage].dataSize, shaderModuleData.spirvBin.pCode,
-                         Twine(getShaderStageName(pipelineState->stages[stage].stage)) + " shader module");
+        disassembleSpirv(stage.spirv.codeSize, stage.spirv.pCode,
+                         Twine(getShaderStageName(stage.stage)) + " shader module");
 #endif
     }
   }
@@ -461,6 +639,94 @@ Error processInputPipeline(ICompiler *compiler, CompileInfo &compileInfo, const
   return Error::success();
 }
 
+// =====================================================================================================================
+// Converts one pipeline input file, already processed by processInputPipeline, to a binary pipeline capture and/or to
+// a .pipe text dump, instead of compiling it.
+//
+// @param compileInfo : Compilation info of LLPC standalone tool
+// @param captureFile : Name of the pipeline capture file to write, or empty
+// @param textDumpDir : Directory to dump the pipeline as .pipe text into, or empty
+// @returns : `ErrorSuccess` on success, `ResultError` on failure
+Error convertInputPipeline(CompileInfo &compileInfo, StringRef captureFile, StringRef textDumpDir) {
+  if (compileInfo.pipelineType == VfxPipelineTypeGraphicsLibrary || !compileInfo.fsOutputs.empty())
+    return createResultError(Result::Unsupported, "Graphics library pipelines cannot be converted");
+
+  GraphicsPipelineBuildInfo gfxPipelineInfo = compileInfo.gfxPipelineInfo;
+  ComputePipelineBuildInfo compPipelineInfo = compileInfo.compPipelineInfo;
+  RayTracingPipelineBuildInfo rayTracePipelineInfo = compileInfo.rayTracePipelineInfo;
+  PipelineBuildInfo pipelineInfo = {};
+  if (compileInfo.pipelineType == VfxPipelineTypeGraphics)
+    pipelineInfo.pGraphicsInfo = &gfxPipelineInfo;
+  else if (compileInfo.pipelineType == VfxPipelineTypeCompute)
+    pipelineInfo.pComputeInfo = &compPipelineInfo;
+  else
+    pipelineInfo.pRayTracingInfo = &rayTracePipelineInfo;
+
+  if (!captureFile.empty()) {
+    SmallVector<Vkgc::PipelineCaptureStage> stages;
+    for (const StandaloneCompiler::ShaderModuleData &moduleData : compileInfo.shaderModuleDatas)
+      stages.push_back({moduleData.shaderStage, moduleData.spirvBin});
+
+    std::string capture;
+    std::string errorMsg;
+    Result result = Vkgc::PipelineCapture::write(pipelineInfo, stages, capture, errorMsg);
+    if (result != Result::Success)
+      return createResultError(result, Twine("Failed to write pipeline capture: ") + errorMsg);
+    if (Error err = writeFile({capture.size(), capture.data()}, captureFile))
+      return err;
+    LLPC_OUTS("Pipeline capture written to " << captureFile << "\n");
+  }
+
+  if (!textDumpDir.empty()) {
+    const std::string dumpDir = textDumpDir.str();
+    // The pipeline dumper names the SPIR-V files after the shader module hash, so give each shader a module, hashed
+    // from its SPIR-V, the same way the compiler does for a SPIR-V shader module.
+    SmallVector<Vkgc::ShaderModuleData> moduleDatas(compileInfo.shaderModuleDatas.size());
+    std::vector<PipelineShaderInfo> rtShaders;
+    if (rayTracePipelineInfo.pShaders) {
+      rtShaders.assign(rayTracePipelineInfo.pShaders, rayTracePipelineInfo.pShaders + rayTracePipelineInfo.shaderCount);
+      rayTracePipelineInfo.pShaders = rtShaders.data();
+    }
+    PipelineShaderInfo *gfxShaderInfos[ShaderStageGfxCount] = {
+        &gfxPipelineInfo.task, &gfxPipelineInfo.vs,   &gfxPipelineInfo.tcs, &gfxPipelineInfo.tes,
+        &gfxPipelineInfo.gs,   &gfxPipelineInfo.mesh, &gfxPipelineInfo.fs,
+    };
+
+    for (unsigned i = 0; i < compileInfo.shaderModuleDatas.size(); ++i) {
+      const StandaloneCompiler::ShaderModuleData &shaderModuleData = compileInfo.shaderModuleDatas[i];
+      Vkgc::ShaderModuleData &moduleData = moduleDatas[i];
+      MetroHash::Hash hash = {};
+      MetroHash64::Hash(reinterpret_cast<const uint8_t *>(shaderModuleData.spirvBin.pCode),
+                        shaderModuleData.spirvBin.codeSize, hash.bytes);
+      static_assert(sizeof(moduleData.hash) == sizeof(hash), "Unexpected shader module hash size");
+      memcpy(moduleData.hash, hash.dwords, sizeof(hash));
+      moduleData.binType = BinaryType::Spirv;
+      moduleData.binCode = shaderModuleData.spirvBin;
+
+      PipelineShaderInfo *shaderInfo = nullptr;
+      if (pipelineInfo.pGraphicsInfo)
+        shaderInfo = gfxShaderInfos[shaderModuleData.shaderStage];
+      else if (pipelineInfo.pComputeInfo)
+        shaderInfo = &compPipelineInfo.cs;
+      else
+        shaderInfo = &rtShaders[i];
+      shaderInfo->pModuleData = &moduleData;
+      shaderInfo->entryStage = shaderModuleData.shaderStage;
+
+      IPipelineDumper::DumpSpirvBinary(dumpDir.c_str(), &shaderModuleData.spirvBin);
+    }
+
+    PipelineDumpOptions dumpOptions = {};
+    dumpOptions.pDumpDir = dumpDir.c_str();
+    void *dumpFile = IPipelineDumper::BeginPipelineDump(&dumpOptions, pipelineInfo);
+    if (!dumpFile)
+      return createResultError(Result::ErrorUnavailable, Twine("Failed to dump pipeline into: ") + textDumpDir);
+    IPipelineDumper::EndPipelineDump(dumpFile);
+    LLPC_OUTS("Pipeline text dumped into " << textDumpDir << "\n");
+  }
+  return Error::success();
+}
+
 // =====================================================================================================================
 // Processes a single SPIR-V input file (text or binary).
 //
@@ -57,12 +57,17 @@
 #include "llpc.h"
 #include "llpcInputUtils.h"
 #include "vfx.h"
+#include "vkgcMetroHash.h"
+#include "vkgcPipelineCapture.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 
 namespace Llpc {
 namespace StandaloneCompiler {
@@ -79,6 +84,50 @@ struct ShaderModuleData {
   bool disableDoAutoLayout;               // Indicates whether to disable auto layout of descriptors
 };
 
+// =====================================================================================================================
+// Shares built shader modules across the pipelines of one run of the standalone compiler. A module is keyed by the
+// MetroHash of its SPIR-V, the same content hash the compiler gives the shader module, combined with the module
+// options that change the built module data, so each unique module is built only once. The built modules are owned
+// by the cache, so must not outlive it. This is thread safe.
+class ShaderModuleCache {
+public:
+  Llpc::Result buildShaderModule(ICompiler *compiler, const Llpc::ShaderModuleBuildInfo *shaderInfo,
+                                 Llpc::ShaderModuleBuildOut *shaderOut);
+
+  // Gets the number of shader modules requested, and the number of them actually built.
+  unsigned getRequestCount() const { return m_requestCount; }
+  unsigned getBuildCount() const { return m_entries.size(); }
+
+private:
+  // Represents one unique shader module.
+  struct Entry {
+    std::once_flag built;                 // Flag to build the module once
+    Llpc::Result result;                  // Result of building the module
+    Llpc::ShaderModuleBuildOut shaderOut; // Output of building the module
+    std::unique_ptr<char[]> buffer;       // Allocation buffer of the module
+  };
+
+  static void *VKAPI_CALL allocateBuffer(void *instance, void *userData, size_t size);
+
+  std::mutex m_mutex;                                                    // Mutex guarding the map and count
+  std::unordered_map<MetroHash::Hash, std::unique_ptr<Entry>> m_entries; // Modules keyed by content hash
+  unsigned m_requestCount = 0;                                           // Number of modules requested
+};
+
+// Represents the static metrics of a compiled pipeline, read from its ELFs.
+struct PipelineMetrics {
+  unsigned vgprCount = 0;    // Highest VGPR count of a hardware stage
+  unsigned sgprCount = 0;    // Highest SGPR count of a hardware stage
+  unsigned scratchBytes = 0; // Highest scratch memory size of a hardware stage
+  unsigned ldsBytes = 0;     // Highest LDS size of a hardware stage
+  unsigned codeBytes = 0;    // Total size of the code
+  unsigned occupancy = 0;    // Estimated waves per SIMD of the most constrained hardware stage, or 0 if unknown
+  // Estimated lanes per SIMD, that is waves times wave size, of the most constrained hardware stage, or 0 if unknown
+  unsigned laneOccupancy = 0;
+
+  void merge(const PipelineMetrics &other);
+};
+
 // Represents a single compilation context of a pipeline or a group of shaders.
 // This is only used by the standalone compiler tool.
 struct CompileInfo {
@@ -97,6 +146,7 @@ struct CompileInfo {
   unsigned bvhNodeStride;
   llvm::SmallVector<std::unique_ptr<char[]>> pipelineBufs; // Allocation buffers of building pipeline
   void *pipelineInfoFile;                                  // VFX-style file containing pipeline info
+  std::unique_ptr<Vkgc::PipelineCapture> pipelineCapture;  // Binary pipeline capture containing pipeline info
   bool unlinked;                                           // Whether to generate unlinked shader/part-pipeline ELF
   optional_bool relocatableShaderElf;                      // Whether to enable relocatable shader compilation
   optional_bool scalarBlockLayout;                         // Whether to enable scalar block layout
@@ -128,13 +178,19 @@ llvm::Expected<BinaryData> assembleSpirv(const std::string &inFilename);
 // Decodes the binary after building a pipeline and outputs the decoded info.
 LLPC_NODISCARD Result decodePipelineBinary(const BinaryData *pipelineBin, CompileInfo *compileInfo);
 
+// Reads the static metrics of a pipeline ELF from its PAL metadata and sections.
+LLPC_NODISCARD PipelineMetrics getPipelineMetrics(const BinaryData &pipelineBin, GfxIpVersion gfxIp);
+
 // Builds shader module based on the specified SPIR-V binary.
-llvm::Error buildShaderModules(ICompiler *compiler, CompileInfo *compileInfo);
+llvm::Error buildShaderModules(ICompiler *compiler, CompileInfo *compileInfo, ShaderModuleCache *moduleCache = nullptr);
 
 // Processes and compiles one pipeline input file.
 llvm::Error processInputPipeline(ICompiler *compiler, CompileInfo &compileInfo, const InputSpec &inputSpec,
                                  bool unlinked, bool ignoreColorAttachmentFormats);
 
+// Converts one pipeline input file to a binary pipeline capture and/or to a .pipe text dump.
+llvm::Error convertInputPipeline(CompileInfo &compileInfo, llvm::StringRef captureFile, llvm::StringRef textDumpDir);
+
 // Processes and compiles multiple shader stage input files.
 llvm::Error processInputStages(CompileInfo &compileInfo, llvm::ArrayRef<InputSpec> inputSpecs, bool validateSpirv,
                                unsigned numThreads);
@@ -94,6 +94,24 @@ Error ComputePipelineBuilder::build() {
 //
 // @returns : Pipeline binary data on success, `llvm::ResultError` on failure.
 Expected<BinaryData> ComputePipelineBuilder::buildComputePipeline() {
+  CompileInfo &compileInfo = getCompileInfo();
+  ComputePipelineBuildOut *pipelineOut = &compileInfo.compPipelineOut;
+  void *pipelineDumpHandle = prepareComputePipeline();
+  auto onExit = make_scope_exit([&] { runPostBuildActions(pipelineDumpHandle, {pipelineOut->pipelineBin}); });
+
+  Result result = getCompiler().BuildComputePipeline(&compileInfo.compPipelineInfo, pipelineOut, pipelineDumpHandle);
+  if (result != Result::Success)
+    return createResultError(result, "Compute pipeline compilation failed");
+
+  return pipelineOut->pipelineBin;
+}
+
+// =====================================================================================================================
+// Sets up the build info of the compute pipeline and starts its pipeline dump, for a pipeline that the caller builds,
+// for example as part of a pipeline batch.
+//
+// @returns : Pipeline dump handle, or null if the pipeline is not dumped.
+void *ComputePipelineBuilder::prepareComputePipeline() {
   CompileInfo &compileInfo = getCompileInfo();
   assert(compileInfo.shaderModuleDatas.size() == 1);
 
@@ -101,7 +119,6 @@ Expected<BinaryData> ComputePipelineBuilder::buildComputePipeline() {
   assert(moduleData.shaderStage == ShaderStageCompute);
 
   ComputePipelineBuildInfo *pipelineInfo = &compileInfo.compPipelineInfo;
-  ComputePipelineBuildOut *pipelineOut = &compileInfo.compPipelineOut;
 
   PipelineShaderInfo *shaderInfo = &pipelineInfo->cs;
   const ShaderModuleBuildOut *shaderOut = &moduleData.shaderOut;
@@ -150,14 +167,26 @@ Expected<BinaryData> ComputePipelineBuilder::buildComputePipeline() {
 
   PipelineBuildInfo localPipelineInfo = {};
   localPipelineInfo.pComputeInfo = pipelineInfo;
-  void *pipelineDumpHandle = runPreBuildActions(localPipelineInfo);
-  auto onExit = make_scope_exit([&] { runPostBuildActions(pipelineDumpHandle, {pipelineOut->pipelineBin}); });
+  return runPreBuildActions(localPipelineInfo);
+}
 
-  Result result = getCompiler().BuildComputePipeline(pipelineInfo, pipelineOut, pipelineDumpHandle);
+// =====================================================================================================================
+// Ends the pipeline dump of a compute pipeline that the caller built, and decodes its binary.
+//
+// @param pipelineDumpHandle : Pipeline dump handle returned by prepareComputePipeline
+// @param result : Result of building the pipeline
+// @returns : `llvm::ErrorSuccess` on success, `llpc::ResultError` on failure.
+Error ComputePipelineBuilder::finishComputePipeline(void *pipelineDumpHandle, Result result) {
+  CompileInfo &compileInfo = getCompileInfo();
+  runPostBuildActions(pipelineDumpHandle, {compileInfo.compPipelineOut.pipelineBin});
   if (result != Result::Success)
     return createResultError(result, "Compute pipeline compilation failed");
 
-  return pipelineOut->pipelineBin;
+  result = decodePipelineBinary(&compileInfo.compPipelineOut.pipelineBin, &compileInfo);
+  if (result != Result::Success)
+    return createResultError(result, "Failed to decode pipeline");
+
+  return Error::success();
 }
 
 // =====================================================================================================================
@@ -45,6 +45,12 @@ public:
 
   // Builds compute pipeline and does linking. Returns the pipeline Elf.
   llvm::Expected<Vkgc::BinaryData> buildComputePipeline();
+
+  // Sets up the build info and starts the pipeline dump, for a pipeline that is built by the caller. Returns the
+  // pipeline dump handle.
+  void *prepareComputePipeline();
+  // Ends the pipeline dump and decodes the binary of a pipeline that was built by the caller.
+  llvm::Error finishComputePipeline(void *pipelineDumpHandle, Vkgc::Result result);
   llvm::Error outputElfs(const llvm::StringRef suppliedOutFile) override;
 };
 
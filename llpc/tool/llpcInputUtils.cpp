@@ -250,12 +250,21 @@ bool isLlvmIrFile(StringRef fileName) {
 }
 
 // =====================================================================================================================
-// Checks whether the specified file name represents an LLPC pipeline info file (.pipe).
+// Checks whether the specified file name represents an LLPC pipeline info file (.pipe or .pipecap).
 //
 // @param fileName : File path to check
 // @returns : true when `fileName` is a pipeline info file
 bool isPipelineInfoFile(StringRef fileName) {
-  return fileName.ends_with(Ext::PipelineInfo);
+  return fileName.ends_with(Ext::PipelineInfo) || isPipelineCaptureFile(fileName);
+}
+
+// =====================================================================================================================
+// Checks whether the input file is a binary pipeline capture file.
+//
+// @param fileName : File path to check
+// @returns : true when `fileName` is a binary pipeline capture file
+bool isPipelineCaptureFile(StringRef fileName) {
+  return fileName.ends_with(Ext::PipelineCapture);
 }
 
 // =====================================================================================================================
@@ -0,0 +1,101 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "llpcContext.h"
+#include "lgc/LgcContext.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include "gmock/gmock.h"
+
+using namespace lgc;
+using namespace llvm;
+
+namespace Llpc {
+namespace {
+
+constexpr GfxIpVersion GfxIp = {10, 1, 0};
+
+// Writes the bitcode of a module with two entry points, "main" calling the internal "helper", and "other", and an
+// internal function "unused" that nothing calls.
+std::string createLibraryBitcode() {
+  LLVMContext context;
+  Module module("library", context);
+  IRBuilder<> builder(context);
+  FunctionType *funcTy = FunctionType::get(builder.getVoidTy(), false);
+  auto createFunc = [&](StringRef name, GlobalValue::LinkageTypes linkage, Function *callee) {
+    Function *func = Function::Create(funcTy, linkage, name, module);
+    builder.SetInsertPoint(BasicBlock::Create(context, "", func));
+    if (callee)
+      builder.CreateCall(callee);
+    builder.CreateRetVoid();
+    return func;
+  };
+  Function *helper = createFunc("helper", GlobalValue::InternalLinkage, nullptr);
+  createFunc("main", GlobalValue::ExternalLinkage, helper);
+  createFunc("other", GlobalValue::ExternalLinkage, nullptr);
+  createFunc("unused", GlobalValue::InternalLinkage, nullptr);
+
+  std::string bitcode;
+  raw_string_ostream stream(bitcode);
+  WriteBitcodeToFile(module, stream);
+  return bitcode;
+}
+
+// cppcheck-suppress syntaxError
+TEST(LlpcContextTests, LoadLibraryMaterializesOnlyNamedEntryPoints) {
+  LgcContext::initialize();
+  Context context(GfxIp);
+  std::string bitcode = createLibraryBitcode();
+  BinaryData lib = {bitcode.size(), bitcode.data()};
+
+  std::unique_ptr<Module> module = context.loadLibrary(&lib, {"main"});
+  ASSERT_NE(module, nullptr);
+  ASSERT_NE(module->getFunction("main"), nullptr);
+  EXPECT_FALSE(module->getFunction("main")->isDeclaration());
+  ASSERT_NE(module->getFunction("helper"), nullptr);
+  EXPECT_FALSE(module->getFunction("helper")->isDeclaration());
+  // Neither the entry point that the pipeline does not name, nor the function that nothing calls, is materialized.
+  EXPECT_EQ(module->getFunction("other"), nullptr);
+  EXPECT_EQ(module->getFunction("unused"), nullptr);
+}
+
+TEST(LlpcContextTests, LoadLibraryFallsBackToExternalEntryPoints) {
+  LgcContext::initialize();
+  Context context(GfxIp);
+  std::string bitcode = createLibraryBitcode();
+  BinaryData lib = {bitcode.size(), bitcode.data()};
+
+  // None of the names is in the library, so its externally linked functions are the entry points.
+  std::unique_ptr<Module> module = context.loadLibrary(&lib, {"notInLibrary"});
+  ASSERT_NE(module, nullptr);
+  EXPECT_NE(module->getFunction("main"), nullptr);
+  EXPECT_NE(module->getFunction("helper"), nullptr);
+  EXPECT_NE(module->getFunction("other"), nullptr);
+  EXPECT_EQ(module->getFunction("unused"), nullptr);
+}
+
+} // namespace
+} // namespace Llpc
@@ -0,0 +1,150 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "llpcAutotune.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+namespace Llpc {
+namespace StandaloneCompiler {
+namespace {
+
+// Makes the metrics of a wave64 build with the given occupancy in lanes and VGPR count, and otherwise all the same.
+PipelineMetrics makeMetrics(unsigned laneOccupancy, unsigned vgprCount) {
+  PipelineMetrics metrics;
+  metrics.occupancy = laneOccupancy / 64;
+  metrics.laneOccupancy = laneOccupancy;
+  metrics.vgprCount = vgprCount;
+  metrics.sgprCount = 32;
+  metrics.codeBytes = 1024;
+  return metrics;
+}
+
+// Makes the result of a successful wave64 build with the given occupancy in lanes and VGPR count.
+TuningResult makeResult(unsigned laneOccupancy, unsigned vgprCount) {
+  TuningResult result;
+  result.succeeded = true;
+  result.metrics = makeMetrics(laneOccupancy, vgprCount);
+  return result;
+}
+
+TEST(AutotuneTest, ParseTuningSpace) {
+  auto spaceOrErr = parseTuningSpace(" waveSize = 32, 64 ; scheduleStrategy=None,MaxIlp,1;unrollThreshold=0x100");
+  ASSERT_THAT_EXPECTED(spaceOrErr, Succeeded());
+  const TuningSpace &space = *spaceOrErr;
+  ASSERT_EQ(space.size(), 3u);
+  EXPECT_THAT(space[0].values, ElementsAre(32, 64));
+  EXPECT_THAT(space[1].values, ElementsAre(0, 2, 1));
+  EXPECT_THAT(space[2].values, ElementsAre(256));
+  EXPECT_EQ(getTuningConfigCount(space), 6u);
+}
+
+TEST(AutotuneTest, ParseTuningSpaceErrors) {
+  EXPECT_THAT_EXPECTED(parseTuningSpace(""), FailedWithMessage(HasSubstr("empty")));
+  EXPECT_THAT_EXPECTED(parseTuningSpace("waveSz=32"), FailedWithMessage(HasSubstr("Unknown autotuning knob")));
+  EXPECT_THAT_EXPECTED(parseTuningSpace("waveSize=32;waveSize=64"),
+                       FailedWithMessage(HasSubstr("Duplicate autotuning knob")));
+  EXPECT_THAT_EXPECTED(parseTuningSpace("waveSize="), FailedWithMessage(HasSubstr("No values")));
+  EXPECT_THAT_EXPECTED(parseTuningSpace("waveSize=48"), FailedWithMessage(HasSubstr("Invalid value '48'")));
+  EXPECT_THAT_EXPECTED(parseTuningSpace("scheduleStrategy=3"), FailedWithMessage(HasSubstr("Invalid value '3'")));
+  EXPECT_THAT_EXPECTED(parseTuningSpace("vgprLimit=many"), FailedWithMessage(HasSubstr("Invalid value 'many'")));
+  EXPECT_THAT_EXPECTED(parseTuningSpace("vgprLimit=1,2,3,4,5,6,7,8;sgprLimit=1,2,3,4,5,6,7,8;"
+                                        "unrollThreshold=1,2,3,4,5,6,7,8;nsaThreshold=1,2,3,4,5,6,7,8,9"),
+                       FailedWithMessage(HasSubstr("more than 4096 configurations")));
+}
+
+TEST(AutotuneTest, EnumerateTuningConfigs) {
+  auto spaceOrErr = parseTuningSpace("waveSize=32,64;unrollThreshold=0,100,300");
+  ASSERT_THAT_EXPECTED(spaceOrErr, Succeeded());
+  const TuningSpace &space = *spaceOrErr;
+  ASSERT_EQ(getTuningConfigCount(space), 6u);
+  EXPECT_THAT(getTuningConfig(space, 0), ElementsAre(32, 0));
+  EXPECT_THAT(getTuningConfig(space, 1), ElementsAre(32, 100));
+  EXPECT_THAT(getTuningConfig(space, 2), ElementsAre(32, 300));
+  EXPECT_THAT(getTuningConfig(space, 3), ElementsAre(64, 0));
+  EXPECT_THAT(getTuningConfig(space, 5), ElementsAre(64, 300));
+}
+
+TEST(AutotuneTest, ApplyTuningConfig) {
+  auto spaceOrErr = parseTuningSpace("waveSize=32;scheduleStrategy=MaxIlp;vgprLimit=64");
+  ASSERT_THAT_EXPECTED(spaceOrErr, Succeeded());
+  PipelineShaderOptions options = {};
+  options.sgprLimit = 48;
+  applyTuningConfig(*spaceOrErr, getTuningConfig(*spaceOrErr, 0), options);
+  EXPECT_EQ(options.waveSize, 32u);
+  EXPECT_EQ(options.scheduleStrategy, Vkgc::LlvmScheduleStrategy::MaxIlp);
+  EXPECT_EQ(options.vgprLimit, 64u);
+  EXPECT_EQ(options.sgprLimit, 48u);
+}
+
+TEST(AutotuneTest, CompareMetrics) {
+  EXPECT_TRUE(dominatesMetrics(makeMetrics(512, 64), makeMetrics(512, 96)));
+  EXPECT_TRUE(dominatesMetrics(makeMetrics(640, 64), makeMetrics(512, 64)));
+  EXPECT_FALSE(dominatesMetrics(makeMetrics(512, 64), makeMetrics(512, 64)));
+  EXPECT_FALSE(dominatesMetrics(makeMetrics(640, 96), makeMetrics(512, 64)));
+
+  EXPECT_TRUE(isPreferredMetrics(makeMetrics(640, 96), makeMetrics(512, 64)));
+  EXPECT_TRUE(isPreferredMetrics(makeMetrics(512, 64), makeMetrics(512, 96)));
+  EXPECT_FALSE(isPreferredMetrics(makeMetrics(512, 64), makeMetrics(512, 64)));
+
+  PipelineMetrics moreScratch = makeMetrics(512, 64);
+  moreScratch.scratchBytes = 256;
+  EXPECT_TRUE(isPreferredMetrics(makeMetrics(512, 96), moreScratch));
+  EXPECT_FALSE(dominatesMetrics(makeMetrics(512, 96), moreScratch));
+}
+
+TEST(AutotuneTest, CompareMetricsByLanes) {
+  // A wave32 build with 16 waves resident has fewer lanes resident than a wave64 build with 10.
+  PipelineMetrics wave32 = makeMetrics(512, 64);
+  wave32.occupancy = 16;
+  PipelineMetrics wave64 = makeMetrics(640, 64);
+  ASSERT_EQ(wave64.occupancy, 10u);
+  EXPECT_TRUE(isPreferredMetrics(wave64, wave32));
+  EXPECT_FALSE(isPreferredMetrics(wave32, wave64));
+  EXPECT_TRUE(dominatesMetrics(wave64, wave32));
+  EXPECT_FALSE(dominatesMetrics(wave32, wave64));
+}
+
+TEST(AutotuneTest, ParetoFront) {
+  SmallVector<TuningResult> results;
+  results.push_back(makeResult(512, 96)); // Dominated by 3
+  results.push_back(makeResult(640, 96)); // Best occupancy
+  results.push_back(TuningResult());      // Failed, however good its metrics
+  results.back().metrics = makeMetrics(1024, 8);
+  results.push_back(makeResult(512, 64)); // Fewest VGPRs
+  results.push_back(makeResult(640, 96)); // Same metrics as 1
+  results.push_back(makeResult(576, 80)); // Between 1 and 3
+  EXPECT_THAT(getParetoFront(results), ElementsAre(1, 5, 3));
+  EXPECT_THAT(getParetoFront({}), ElementsAre());
+}
+
+} // namespace
+} // namespace StandaloneCompiler
+} // namespace Llpc
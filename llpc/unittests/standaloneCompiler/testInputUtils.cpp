@@ -282,6 +282,7 @@ TEST(InputUtilsTest, IsPipelineInfoFile) {
   // Good inputs.
   EXPECT_TRUE(isPipelineInfoFile("file.pipe"));
   EXPECT_TRUE(isPipelineInfoFile("/some/long/path/./file.test_1.pipe"));
+  EXPECT_TRUE(isPipelineInfoFile("file.pipecap"));
 
   // Bad inputs.
   EXPECT_FALSE(isPipelineInfoFile("file.pipeline"));
@@ -291,6 +292,19 @@ TEST(InputUtilsTest, IsPipelineInfoFile) {
   EXPECT_FALSE(isPipelineInfoFile(""));
 }
 
+TEST(InputUtilsTest, IsPipelineCaptureFile) {
+  // Good inputs.
+  EXPECT_TRUE(isPipelineCaptureFile("file.pipecap"));
+  EXPECT_TRUE(isPipelineCaptureFile("/some/long/path/./file.test_1.pipecap"));
+
+  // Bad inputs.
+  EXPECT_FALSE(isPipelineCaptureFile("file.pipe"));
+  EXPECT_FALSE(isPipelineCaptureFile("file.pipecapture"));
+  EXPECT_FALSE(isPipelineCaptureFile("file."));
+  EXPECT_FALSE(isPipelineCaptureFile("file"));
+  EXPECT_FALSE(isPipelineCaptureFile(""));
+}
+
 TEST(InputUtilsTest, FileExtFromBinaryElf) {
   SmallVector<uint8_t> header(ElfMagic.begin(), ElfMagic.end());
   header.resize(ElfHeaderLength);
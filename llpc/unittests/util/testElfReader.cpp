@@ -0,0 +1,187 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "vkgcElfReader.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Vkgc;
+using namespace llvm;
+
+namespace Llpc {
+namespace {
+
+// =====================================================================================================================
+// Builds a minimal 64-bit AMDGPU ELF whose sections have the given names and one byte of content each. Section 0 is
+// the null section and section 1 is the section name string table.
+//
+// @param names : Names of the sections after the null and string table sections
+std::vector<uint8_t> buildElf(ArrayRef<const char *> names) {
+  std::string strTab(1, '\0');
+  std::vector<unsigned> nameOffsets = {0, static_cast<unsigned>(strTab.size())};
+  strTab += ShStrTabName;
+  strTab += '\0';
+  for (const char *name : names) {
+    nameOffsets.push_back(strTab.size());
+    strTab += name;
+    strTab += '\0';
+  }
+
+  const unsigned numSections = nameOffsets.size();
+  std::vector<uint8_t> elf(sizeof(Elf64::FormatHeader));
+  std::vector<Elf64::SectionHeader> sectionHeaders(numSections);
+  for (unsigned idx = 1; idx != numSections; ++idx) {
+    sectionHeaders[idx].sh_name = nameOffsets[idx];
+    sectionHeaders[idx].sh_type = idx == 1 ? SHT_STRTAB : SHT_PROGBITS;
+    sectionHeaders[idx].sh_offset = elf.size();
+    if (idx == 1) {
+      sectionHeaders[idx].sh_size = strTab.size();
+      elf.insert(elf.end(), strTab.begin(), strTab.end());
+    } else {
+      sectionHeaders[idx].sh_size = 1;
+      elf.push_back(static_cast<uint8_t>(idx));
+    }
+  }
+
+  Elf64::FormatHeader header = {};
+  header.e_ident32[EI_MAG0] = ElfMagic;
+  header.e_ident[EI_CLASS] = ELFCLASS64;
+  header.e_ident[EI_DATA] = ELFDATA2LSB;
+  header.e_machine = EM_AMDGPU;
+  header.e_shoff = elf.size();
+  header.e_ehsize = sizeof(Elf64::FormatHeader);
+  header.e_shentsize = sizeof(Elf64::SectionHeader);
+  header.e_shnum = numSections;
+  header.e_shstrndx = 1;
+  memcpy(elf.data(), &header, sizeof(header));
+  const uint8_t *headerBytes = reinterpret_cast<const uint8_t *>(sectionHeaders.data());
+  elf.insert(elf.end(), headerBytes, headerBytes + numSections * sizeof(Elf64::SectionHeader));
+  return elf;
+}
+
+// cppcheck-suppress syntaxError
+TEST(ElfReaderTest, SectionIndexByName) {
+  std::vector<uint8_t> elf = buildElf({".text", ".note", ".data"});
+  ElfReader<Elf64> reader(GfxIpVersion{10, 3, 0});
+  size_t readSize = 0;
+  ASSERT_EQ(reader.ReadFromBuffer(elf.data(), &readSize), Result::Success);
+
+  EXPECT_EQ(reader.getSectionCount(), 5u);
+  EXPECT_EQ(reader.GetSectionIndex(ShStrTabName), 1);
+  EXPECT_EQ(reader.GetSectionIndex(TextName), 2);
+  EXPECT_EQ(reader.GetSectionIndex(NoteName), 3);
+  EXPECT_EQ(reader.GetSectionIndex(DataName), 4);
+  EXPECT_LT(reader.GetSectionIndex(RoDataName), 0);
+  EXPECT_TRUE(reader.isSectionPresent(TextName));
+  EXPECT_FALSE(reader.isSectionPresent(".tex"));
+  EXPECT_FALSE(reader.isSectionPresent(".text2"));
+}
+
+TEST(ElfReaderTest, SectionDataReferencesInputBuffer) {
+  std::vector<uint8_t> elf = buildElf({".text", ".data"});
+  ElfReader<Elf64> reader(GfxIpVersion{10, 3, 0});
+  size_t readSize = 0;
+  ASSERT_EQ(reader.ReadFromBuffer(elf.data(), &readSize), Result::Success);
+
+  const void *data = nullptr;
+  size_t dataLength = 0;
+  ASSERT_EQ(reader.GetSectionData(DataName, &data, &dataLength), Result::Success);
+  EXPECT_EQ(dataLength, 1u);
+  EXPECT_GE(static_cast<const uint8_t *>(data), elf.data());
+  EXPECT_LT(static_cast<const uint8_t *>(data), elf.data() + elf.size());
+  EXPECT_EQ(*static_cast<const uint8_t *>(data), 3);
+
+  const ElfReader<Elf64>::SectionBuffer *section = nullptr;
+  ASSERT_EQ(reader.getTextSectionData(&section), Result::Success);
+  EXPECT_STREQ(section->name, TextName);
+  EXPECT_EQ(*section->data, 2);
+}
+
+TEST(ElfReaderTest, SortingIndexFollowsNameOrder) {
+  std::vector<uint8_t> elf = buildElf({".text", ".data", ".note"});
+  ElfReader<Elf64> reader(GfxIpVersion{10, 3, 0});
+  size_t readSize = 0;
+  ASSERT_EQ(reader.ReadFromBuffer(elf.data(), &readSize), Result::Success);
+
+  // The null section has the empty name, which sorts first.
+  std::vector<std::string> sortedNames;
+  for (unsigned sortIdx = 0; sortIdx != reader.getSectionNameIndex().size(); ++sortIdx) {
+    unsigned secIdx = 0;
+    const ElfReader<Elf64>::SectionBuffer *section = nullptr;
+    ASSERT_EQ(reader.getSectionDataBySortingIndex(sortIdx, &secIdx, &section), Result::Success);
+    EXPECT_EQ(section, &reader.getSectionBuffers()[secIdx]);
+    sortedNames.push_back(section->name);
+  }
+  EXPECT_THAT(sortedNames, ::testing::ElementsAre("", ".data", ".note", ".shstrtab", ".text"));
+}
+
+TEST(ElfReaderTest, DuplicateNameFindsLastSection) {
+  std::vector<uint8_t> elf = buildElf({".text", ".AMDGPU.disasm", ".text"});
+  ElfReader<Elf64> reader(GfxIpVersion{10, 3, 0});
+  size_t readSize = 0;
+  ASSERT_EQ(reader.ReadFromBuffer(elf.data(), &readSize), Result::Success);
+
+  EXPECT_EQ(reader.getSectionCount(), 5u);
+  EXPECT_EQ(reader.getSectionNameIndex().size(), 4u);
+  EXPECT_EQ(reader.GetSectionIndex(TextName), 4);
+  EXPECT_EQ(reader.GetSectionIndex(AmdGpuDisasmName), 3);
+}
+
+TEST(ElfReaderTest, OlderAccessorsMatchSectionNameIndex) {
+  std::vector<uint8_t> elf = buildElf({".text", ".data", ".text"});
+  ElfReader<Elf64> reader(GfxIpVersion{10, 3, 0});
+  size_t readSize = 0;
+  ASSERT_EQ(reader.ReadFromBuffer(elf.data(), &readSize), Result::Success);
+
+  const std::map<std::string, uint32_t> &map = reader.getMap();
+  ASSERT_EQ(map.size(), reader.getSectionNameIndex().size());
+  for (const auto &nameEntry : reader.getSectionNameIndex())
+    EXPECT_EQ(map.at(nameEntry.first.str()), nameEntry.second);
+
+  const std::vector<ElfReader<Elf64>::SectionBuffer *> &sections = reader.getSections();
+  ASSERT_EQ(sections.size(), reader.getSectionCount());
+  ElfReader<Elf64>::SectionBuffer *section = nullptr;
+  ASSERT_EQ(reader.getSectionDataBySectionIndex(reader.GetSectionIndex(DataName), &section), Result::Success);
+  EXPECT_EQ(section, sections[reader.GetSectionIndex(DataName)]);
+  EXPECT_EQ(*section->data, 3);
+}
+
+TEST(ElfReaderTest, MissingNoteSectionGivesEmptyNote) {
+  std::vector<uint8_t> elf = buildElf({".text", ".data"});
+  ElfReader<Elf64> reader(GfxIpVersion{10, 3, 0});
+  size_t readSize = 0;
+  ASSERT_EQ(reader.ReadFromBuffer(elf.data(), &readSize), Result::Success);
+
+  ElfNote note = reader.getNote(Util::Abi::MetadataNoteType);
+  EXPECT_EQ(note.data, nullptr);
+  EXPECT_EQ(note.hdr.descSize, 0u);
+}
+
+} // namespace
+} // namespace Llpc
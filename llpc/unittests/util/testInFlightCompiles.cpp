@@ -0,0 +1,166 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+
+#include "llpcInFlightCompiles.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+namespace Llpc {
+namespace {
+
+MetroHash::Hash makeHash(uint64_t value) {
+  MetroHash::Hash hash = {};
+  hash.qwords[0] = value;
+  return hash;
+}
+
+// cppcheck-suppress syntaxError
+TEST(InFlightCompilesTest, SingleCompile) {
+  InFlightCompiles inFlight;
+  Vkgc::ElfPackage elf;
+  bool ranCompile = false;
+  Result result = inFlight.run(
+      makeHash(1), elf, {},
+      [](Vkgc::ElfPackage &out) {
+        out = "elf";
+        return Result::Success;
+      },
+      &ranCompile);
+  EXPECT_EQ(result, Result::Success);
+  EXPECT_EQ(elf.str(), "elf");
+  EXPECT_TRUE(ranCompile);
+  EXPECT_EQ(inFlight.getCollapsedCount(), 0u);
+}
+
+TEST(InFlightCompilesTest, SequentialCompilesAreNotCollapsed) {
+  InFlightCompiles inFlight;
+  unsigned numCompiles = 0;
+  for (unsigned i = 0; i < 3; ++i) {
+    Vkgc::ElfPackage elf;
+    inFlight.run(makeHash(1), elf, {}, [&numCompiles](Vkgc::ElfPackage &) {
+      ++numCompiles;
+      return Result::Success;
+    });
+  }
+  EXPECT_EQ(numCompiles, 3u);
+  EXPECT_EQ(inFlight.getCollapsedCount(), 0u);
+}
+
+TEST(InFlightCompilesTest, ConcurrentDuplicatesAreCollapsed) {
+  constexpr unsigned NumWaiters = 4;
+  InFlightCompiles inFlight;
+  std::atomic<unsigned> numCompiles(0);
+  std::atomic<bool> releaseCompile(false);
+
+  Vkgc::ElfPackage ownerElf;
+  Vkgc::CacheAccessInfo ownerStageCacheAccesses[2] = {Vkgc::CacheAccessInfo::CacheNotChecked,
+                                                      Vkgc::CacheAccessInfo::CacheNotChecked};
+  bool ownerRanCompile = false;
+  std::thread owner([&] {
+    inFlight.run(
+        makeHash(7), ownerElf, ownerStageCacheAccesses,
+        [&](Vkgc::ElfPackage &out) {
+          ++numCompiles;
+          // Hold the compile until all waiters have joined.
+          while (!releaseCompile)
+            std::this_thread::yield();
+          out = "shared";
+          ownerStageCacheAccesses[0] = Vkgc::CacheAccessInfo::CacheMiss;
+          ownerStageCacheAccesses[1] = Vkgc::CacheAccessInfo::InternalCacheHit;
+          return Result::ErrorUnavailable;
+        },
+        &ownerRanCompile);
+  });
+
+  while (numCompiles == 0)
+    std::this_thread::yield();
+
+  std::vector<std::thread> waiters;
+  std::vector<Vkgc::ElfPackage> waiterElfs(NumWaiters);
+  std::vector<Result> waiterResults(NumWaiters, Result::Success);
+  std::vector<std::array<Vkgc::CacheAccessInfo, 2>> waiterStageCacheAccesses(NumWaiters);
+  std::vector<char> waiterRanCompiles(NumWaiters, true);
+  for (unsigned i = 0; i < NumWaiters; ++i) {
+    waiterStageCacheAccesses[i].fill(Vkgc::CacheAccessInfo::CacheNotChecked);
+    waiters.emplace_back([&, i] {
+      bool ranCompile = true;
+      waiterResults[i] = inFlight.run(
+          makeHash(7), waiterElfs[i], waiterStageCacheAccesses[i],
+          [&](Vkgc::ElfPackage &) {
+            ++numCompiles;
+            return Result::Success;
+          },
+          &ranCompile);
+      waiterRanCompiles[i] = ranCompile;
+    });
+  }
+
+  while (inFlight.getCollapsedCount() != NumWaiters)
+    std::this_thread::yield();
+  releaseCompile = true;
+
+  owner.join();
+  for (std::thread &waiter : waiters)
+    waiter.join();
+
+  EXPECT_EQ(numCompiles, 1u);
+  EXPECT_EQ(inFlight.getCollapsedCount(), NumWaiters);
+  EXPECT_EQ(ownerElf.str(), "shared");
+  EXPECT_TRUE(ownerRanCompile);
+  for (unsigned i = 0; i < NumWaiters; ++i) {
+    EXPECT_EQ(waiterResults[i], Result::ErrorUnavailable);
+    EXPECT_EQ(waiterElfs[i].str(), "shared");
+    // Waiters get the stage cache accesses of the compile, and must not store its ELF in the cache themselves.
+    EXPECT_EQ(waiterStageCacheAccesses[i][0], Vkgc::CacheAccessInfo::CacheMiss);
+    EXPECT_EQ(waiterStageCacheAccesses[i][1], Vkgc::CacheAccessInfo::InternalCacheHit);
+    EXPECT_FALSE(waiterRanCompiles[i]);
+  }
+}
+
+TEST(InFlightCompilesTest, DifferentHashesAreNotCollapsed) {
+  InFlightCompiles inFlight;
+  Vkgc::ElfPackage outerElf;
+  unsigned numCompiles = 0;
+  inFlight.run(makeHash(1), outerElf, {}, [&](Vkgc::ElfPackage &) {
+    ++numCompiles;
+    Vkgc::ElfPackage innerElf;
+    inFlight.run(makeHash(2), innerElf, {}, [&](Vkgc::ElfPackage &) {
+      ++numCompiles;
+      return Result::Success;
+    });
+    return Result::Success;
+  });
+  EXPECT_EQ(numCompiles, 2u);
+  EXPECT_EQ(inFlight.getCollapsedCount(), 0u);
+}
+
+} // namespace
+} // namespace Llpc
@@ -154,5 +154,63 @@ TEST(ThreadingTest, SingleError) {
   }
 }
 
+TEST(ThreadingTest, PipelineWritesInOrder) {
+  const auto data = seq(0u, 32u);
+
+  for (size_t numThreads : {0, 1, 2, 7, 16}) {
+    SmallVector<unsigned> written;
+    std::atomic<unsigned> numProcessed(0);
+
+    Error err = parallelPipeline<unsigned>(
+        numThreads, data,
+        [](unsigned datum) -> Expected<std::unique_ptr<unsigned>> { return std::make_unique<unsigned>(datum); },
+        [&numProcessed](unsigned &state) {
+          state *= 2;
+          ++numProcessed;
+          return Error::success();
+        },
+        [&written](unsigned &state) {
+          written.push_back(state);
+          return Error::success();
+        });
+
+    EXPECT_THAT_ERROR(std::move(err), Succeeded());
+    EXPECT_EQ(numProcessed, data.size());
+    ASSERT_EQ(written.size(), data.size());
+    for (unsigned i = 0; i < written.size(); ++i)
+      EXPECT_EQ(written[i], 2 * i);
+  }
+}
+
+TEST(ThreadingTest, PipelineReturnsFirstError) {
+  const auto data = seq(0u, 32u);
+
+  for (size_t numThreads : {0, 1, 2, 7, 16}) {
+    SmallVector<unsigned> written;
+
+    // Fail to process 13 and 20, and to read 17. Whatever order the failures happen in, the error of 13 is reported
+    // and exactly the inputs before it are written.
+    Error err = parallelPipeline<unsigned>(
+        numThreads, data,
+        [](unsigned datum) -> Expected<std::unique_ptr<unsigned>> {
+          if (datum == 17)
+            return createResultError(Vkgc::Result::ErrorUnavailable, "Unreadable 17");
+          return std::make_unique<unsigned>(datum);
+        },
+        [](unsigned &state) -> Error {
+          if (state == 13 || state == 20)
+            return createResultError(Vkgc::Result::Unsupported, "Unlucky " + Twine(state));
+          return Error::success();
+        },
+        [&written](unsigned &state) {
+          written.push_back(state);
+          return Error::success();
+        });
+
+    EXPECT_THAT_ERROR(std::move(err), FailedWithMessage(::testing::HasSubstr("Unlucky 13")));
+    EXPECT_TRUE(equal(written, seq(0u, 13u)));
+  }
+}
+
 } // namespace
 } // namespace Llpc
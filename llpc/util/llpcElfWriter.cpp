@@ -446,107 +446,56 @@ template <class Elf> void ElfWriter<Elf>::setSection(unsigned secIndex, SectionB
 }
 
 // =====================================================================================================================
-// Determines the size needed for a memory buffer to store this ELF.
-template <class Elf> size_t ElfWriter<Elf>::getRequiredBufferSizeBytes() {
-  // Update offsets and size values
-  calcSectionHeaderOffset();
-
-  size_t totalBytes = sizeof(typename Elf::FormatHeader);
-
-  // Iterate through the section list
-  for (auto &section : m_sections)
-    totalBytes += alignTo(section.secHead.sh_size, sizeof(unsigned));
-
-  totalBytes += m_header.e_shentsize * m_header.e_shnum;
-  totalBytes += m_header.e_phentsize * m_header.e_phnum;
-
-  return totalBytes;
-}
-
-// =====================================================================================================================
-// Assembles ELF notes and add them to .note section
-template <class Elf> void ElfWriter<Elf>::assembleNotes() {
-  if (m_noteSecIdx == InvalidValue)
-    return;
-  auto noteSection = &m_sections[m_noteSecIdx];
+// Gets the byte size of the .note section that writeNotes() will produce from the notes in this ELF.
+template <class Elf> size_t ElfWriter<Elf>::getNotesSize() const {
   const unsigned noteHeaderSize = sizeof(NoteHeader) - 8;
-  unsigned noteSize = 0;
+  size_t noteSize = 0;
   for (auto &note : m_notes) {
     const unsigned noteNameSize = alignTo(note.hdr.nameSize, sizeof(unsigned));
     noteSize += noteHeaderSize + noteNameSize + alignTo(note.hdr.descSize, sizeof(unsigned));
   }
+  return noteSize;
+}
 
-  delete[] noteSection->data;
-  uint8_t *data = new uint8_t[std::max(noteSize, noteHeaderSize)];
-  assert(data);
-  memset(data, 0, std::max(noteSize, noteHeaderSize));
-  noteSection->data = data;
-  noteSection->secHead.sh_size = noteSize;
-
+// =====================================================================================================================
+// Writes the ELF notes as the contents of the .note section. The buffer must be zero-initialized and at least
+// getNotesSize() bytes long.
+//
+// @param [out] buffer : Buffer to write the .note section contents to
+template <class Elf> void ElfWriter<Elf>::writeNotes(uint8_t *buffer) const {
+  const unsigned noteHeaderSize = sizeof(NoteHeader) - 8;
   for (auto &note : m_notes) {
-    memcpy(data, &note.hdr, noteHeaderSize);
-    data += noteHeaderSize;
-    memcpy(data, &note.hdr.name, note.hdr.nameSize);
-    data += alignTo(note.hdr.nameSize, sizeof(unsigned));
-    memcpy(data, note.data, note.hdr.descSize);
-    data += alignTo(note.hdr.descSize, sizeof(unsigned));
+    memcpy(buffer, &note.hdr, noteHeaderSize);
+    buffer += noteHeaderSize;
+    memcpy(buffer, &note.hdr.name, note.hdr.nameSize);
+    buffer += alignTo(note.hdr.nameSize, sizeof(unsigned));
+    memcpy(buffer, note.data, note.hdr.descSize);
+    buffer += alignTo(note.hdr.descSize, sizeof(unsigned));
   }
-
-  assert(noteSection->secHead.sh_size == static_cast<unsigned>(data - noteSection->data));
 }
 
 // =====================================================================================================================
-// Assembles ELF symbols and symbol info to .symtab section
-template <class Elf> void ElfWriter<Elf>::assembleSymbols() {
-  if (m_symSecIdx == InvalidValue)
-    return;
-  auto strTabSection = &m_sections[m_strtabSecIdx];
-  auto newStrTabSize = 0;
-  unsigned symbolCount = 0;
+// Writes the ELF symbols as the contents of the .symtab section, and the names of symbols that are not yet in the
+// string table as the tail of the .strtab section. New names are given string table offsets in symbol order, starting
+// at the current end of the string table.
+//
+// @param [out] symTab : Buffer to write the .symtab section contents to
+// @param [out] newStrings : Buffer to write the new .strtab names to
+template <class Elf> void ElfWriter<Elf>::writeSymbols(uint8_t *symTab, uint8_t *newStrings) const {
+  unsigned strTabOffset = m_sections[m_strtabSecIdx].secHead.sh_size;
+  auto symbolToWrite = reinterpret_cast<typename Elf::Symbol *>(symTab);
   for (auto &symbol : m_symbols) {
-    if (symbol.nameOffset == InvalidValue)
-      newStrTabSize += strlen(symbol.pSymName) + 1;
-
-    if (symbol.secIdx != InvalidValue)
-      symbolCount++;
-  }
-
-  if (newStrTabSize > 0) {
-    unsigned strTabOffset = strTabSection->secHead.sh_size;
-    auto strTabBuffer = new uint8_t[strTabSection->secHead.sh_size + newStrTabSize];
-    memcpy(strTabBuffer, strTabSection->data, strTabSection->secHead.sh_size);
-    delete[] strTabSection->data;
-
-    strTabSection->data = strTabBuffer;
-    strTabSection->secHead.sh_size += newStrTabSize;
-
-    for (auto &symbol : m_symbols) {
-      if (symbol.nameOffset == InvalidValue) {
-        auto symNameSize = strlen(symbol.pSymName) + 1;
-        memcpy(strTabBuffer + strTabOffset, symbol.pSymName, symNameSize);
-        symbol.nameOffset = strTabOffset;
-        delete[] symbol.pSymName;
-        symbol.pSymName = reinterpret_cast<const char *>(strTabBuffer + strTabOffset);
-        strTabOffset += symNameSize;
-      }
+    unsigned nameOffset = symbol.nameOffset;
+    if (nameOffset == InvalidValue) {
+      auto symNameSize = strlen(symbol.pSymName) + 1;
+      memcpy(newStrings, symbol.pSymName, symNameSize);
+      newStrings += symNameSize;
+      nameOffset = strTabOffset;
+      strTabOffset += symNameSize;
     }
-  }
-
-  auto symSectionSize = sizeof(typename Elf::Symbol) * symbolCount;
-  auto symbolSection = &m_sections[m_symSecIdx];
-
-  if (!symbolSection->data)
-    symbolSection->data = new uint8_t[symSectionSize];
-  else if (symSectionSize > symbolSection->secHead.sh_size) {
-    delete[] symbolSection->data;
-    symbolSection->data = new uint8_t[symSectionSize];
-  }
-  symbolSection->secHead.sh_size = symSectionSize;
 
-  auto symbolToWrite = reinterpret_cast<typename Elf::Symbol *>(const_cast<uint8_t *>(symbolSection->data));
-  for (auto &symbol : m_symbols) {
     if (symbol.secIdx != InvalidValue) {
-      symbolToWrite->st_name = symbol.nameOffset;
+      symbolToWrite->st_name = nameOffset;
       symbolToWrite->st_info.all = symbol.info.all;
       symbolToWrite->st_other = 0;
       symbolToWrite->st_shndx = symbol.secIdx;
@@ -555,72 +504,92 @@ template <class Elf> void ElfWriter<Elf>::assembleSymbols() {
       ++symbolToWrite;
     }
   }
-
-  assert(symbolSection->secHead.sh_size ==
-         static_cast<unsigned>(reinterpret_cast<uint8_t *>(symbolToWrite) - symbolSection->data));
 }
 
 // =====================================================================================================================
-// Determines the offset of the section header table by totaling the sizes of each binary chunk written to the ELF file,
-// accounting for alignment.
-template <class Elf> void ElfWriter<Elf>::calcSectionHeaderOffset() {
-  unsigned sharedHdrOffset = 0;
+// Writes the data out to the given buffer in ELF format.
+//
+// The final layout is computed up front, so the buffer is sized once and each section is written straight into it.
+// The .note, .symtab and the new tail of .strtab are generated from the writer's notes and symbols directly into
+// the output, rather than first being assembled into section buffers and then copied.
+//
+// @param pElf : Output buffer to write ELF data
+template <class Elf> void ElfWriter<Elf>::writeToBuffer(ElfPackage *pElf) {
+  assert(pElf);
+  assert(m_header.e_phnum == 0);
 
-  const unsigned elfHdrSize = sizeof(typename Elf::FormatHeader);
-  const unsigned hdrSize = sizeof(typename Elf::Phdr);
+  // Work out the final size of each section.
+  SmallVector<size_t, 16> sectionSizes;
+  for (auto &section : m_sections)
+    sectionSizes.push_back(section.secHead.sh_size);
 
-  sharedHdrOffset += elfHdrSize;
-  sharedHdrOffset += m_header.e_phnum * hdrSize;
+  if (m_noteSecIdx != InvalidValue)
+    sectionSizes[m_noteSecIdx] = getNotesSize();
 
-  for (auto &section : m_sections) {
-    const unsigned secSzBytes = alignTo(section.secHead.sh_size, sizeof(unsigned));
-    sharedHdrOffset += secSzBytes;
+  if (m_symSecIdx != InvalidValue) {
+    size_t newStrTabSize = 0;
+    unsigned symbolCount = 0;
+    for (auto &symbol : m_symbols) {
+      if (symbol.nameOffset == InvalidValue)
+        newStrTabSize += strlen(symbol.pSymName) + 1;
+      if (symbol.secIdx != InvalidValue)
+        symbolCount++;
+    }
+    sectionSizes[m_strtabSecIdx] += newStrTabSize;
+    sectionSizes[m_symSecIdx] = sizeof(typename Elf::Symbol) * symbolCount;
   }
 
-  m_header.e_phoff = m_header.e_phnum > 0 ? elfHdrSize : 0;
-  m_header.e_shoff = sharedHdrOffset;
+  // Lay out the ELF header, then each section aligned to a dword, then the section header table.
+  const unsigned elfHdrSize = sizeof(typename Elf::FormatHeader);
+  const unsigned secHdrSize = sizeof(typename Elf::SectionHeader);
+  size_t sectionHeaderOffset = elfHdrSize;
+  for (size_t sectionSize : sectionSizes)
+    sectionHeaderOffset += alignTo(sectionSize, sizeof(unsigned));
+
+  m_header.e_phoff = 0;
+  m_header.e_shoff = sectionHeaderOffset;
   m_header.e_shstrndx = m_strtabSecIdx;
   m_header.e_shnum = m_sections.size();
-}
 
-// =====================================================================================================================
-// Writes the data out to the given buffer in ELF format. Assumes the buffer has been pre-allocated with adequate
-// space, which can be determined with a call to "GetRequireBufferSizeBytes()".
-//
-// @param pElf : Output buffer to write ELF data
-template <class Elf> void ElfWriter<Elf>::writeToBuffer(ElfPackage *pElf) {
-  assert(pElf);
-
-  // Update offsets and size values
-  assembleNotes();
-  assembleSymbols();
-
-  const size_t reqSize = getRequiredBufferSizeBytes();
+  const size_t reqSize = sectionHeaderOffset + secHdrSize * m_sections.size();
   pElf->resize(reqSize);
   auto data = pElf->data();
   memset(data, 0, reqSize);
 
-  char *buffer = static_cast<char *>(data);
-
   // ELF header comes first
-  const unsigned elfHdrSize = sizeof(typename Elf::FormatHeader);
+  char *buffer = static_cast<char *>(data);
   memcpy(buffer, &m_header, elfHdrSize);
   buffer += elfHdrSize;
 
-  assert(m_header.e_phnum == 0);
-
-  // Write each section buffer
-  for (auto &section : m_sections) {
+  // Write each section, recording where the generated .symtab and .strtab tail go.
+  uint8_t *symTab = nullptr;
+  uint8_t *newStrings = nullptr;
+  for (unsigned secIdx = 0; secIdx != m_sections.size(); ++secIdx) {
+    auto &section = m_sections[secIdx];
+    uint8_t *sectionData = reinterpret_cast<uint8_t *>(buffer);
     section.secHead.sh_offset = static_cast<unsigned>(buffer - data);
-    const unsigned sizeBytes = section.secHead.sh_size;
-    if (sizeBytes > 0)
-      memcpy(buffer, section.data, sizeBytes);
-    buffer += alignTo(sizeBytes, sizeof(unsigned));
+    if (static_cast<int>(secIdx) == m_noteSecIdx) {
+      writeNotes(sectionData);
+    } else if (static_cast<int>(secIdx) == m_symSecIdx) {
+      symTab = sectionData;
+    } else if (section.secHead.sh_size > 0) {
+      memcpy(sectionData, section.data, section.secHead.sh_size);
+      if (static_cast<int>(secIdx) == m_strtabSecIdx)
+        newStrings = sectionData + section.secHead.sh_size;
+    } else if (static_cast<int>(secIdx) == m_strtabSecIdx) {
+      newStrings = sectionData;
+    }
+    buffer += alignTo(sectionSizes[secIdx], sizeof(unsigned));
   }
 
-  const unsigned secHdrSize = sizeof(typename Elf::SectionHeader);
-  for (auto &section : m_sections) {
-    memcpy(buffer, &section.secHead, secHdrSize);
+  if (m_symSecIdx != InvalidValue)
+    writeSymbols(symTab, newStrings);
+
+  // Write the section header table, with the final section sizes.
+  for (unsigned secIdx = 0; secIdx != m_sections.size(); ++secIdx) {
+    typename Elf::SectionHeader secHead = m_sections[secIdx].secHead;
+    secHead.sh_size = sectionSizes[secIdx];
+    memcpy(buffer, &secHead, secHdrSize);
     buffer += secHdrSize;
   }
 
@@ -707,18 +676,19 @@ void ElfWriter<Elf>::fixupRelocation(unsigned relocIdx, unsigned relocValue, uns
 template <class Elf> Result ElfWriter<Elf>::copyFromReader(const ElfReader<Elf> &reader) {
   Result result = Result::Success;
   m_header = reader.getHeader();
-  m_sections.resize(reader.getSections().size());
-  for (size_t i = 0; i < reader.getSections().size(); ++i) {
-    auto section = reader.getSections()[i];
-    m_sections[i].secHead = section->secHead;
-    m_sections[i].name = section->name;
-    auto data = new uint8_t[section->secHead.sh_size + 1];
-    memcpy(data, section->data, section->secHead.sh_size);
-    data[section->secHead.sh_size] = 0;
+  m_sections.resize(reader.getSectionBuffers().size());
+  for (size_t i = 0; i < reader.getSectionBuffers().size(); ++i) {
+    auto &section = reader.getSectionBuffers()[i];
+    m_sections[i].secHead = section.secHead;
+    m_sections[i].name = section.name;
+    auto data = new uint8_t[section.secHead.sh_size + 1];
+    memcpy(data, section.data, section.secHead.sh_size);
+    data[section.secHead.sh_size] = 0;
     m_sections[i].data = data;
   }
 
-  m_map = reader.getMap();
+  for (const auto &nameEntry : reader.getSectionNameIndex())
+    m_map[nameEntry.first.str()] = nameEntry.second;
   assert(m_header.e_phnum == 0);
 
   m_noteSecIdx = m_map[NoteName];
@@ -844,7 +814,7 @@ template <class Elf> size_t ElfWriter<Elf>::getRelocPsStartPos(const SectionBuff
 // @returns : New section
 template <class Elf>
 typename ElfWriter<Elf>::SectionBuffer ElfWriter<Elf>::createNewSection(const char *sectionName,
-                                                                        SectionBuffer *inputSection) {
+                                                                        const SectionBuffer *inputSection) {
   SectionBuffer newSection = {};
   newSection.secHead = inputSection->secHead;
 
@@ -897,7 +867,7 @@ template <class Elf> void ElfWriter<Elf>::addRelocSymbols(const ElfReader<Elf> &
   }
 
   // If the section does not exist, create a new section and update the related symbols.
-  SectionBuffer *inputRodataSection = nullptr;
+  const SectionBuffer *inputRodataSection = nullptr;
   std::vector<ElfSymbol> inputRodataSymbols;
   auto inputRodataSecIndex = reader.GetSectionIndex(relocSym.secName);
   Result result = reader.getSectionDataBySectionIndex(inputRodataSecIndex, &inputRodataSection);
@@ -1048,7 +1018,7 @@ ElfWriter<Elf>::mergeRelocSection(const ElfReader<Elf> &reader, const SectionBuf
 template <class Elf>
 void ElfWriter<Elf>::processRelocSection(const ElfReader<Elf> &reader, size_t nonFragmentPsIsaOffset,
                                          size_t fragmentPsIsaOffset) {
-  SectionBuffer *fragmentRelocSection = nullptr;
+  const SectionBuffer *fragmentRelocSection = nullptr;
   const SectionBuffer *nonFragmentRelocSection = nullptr;
 
   auto fragmentRelocSecIndex = reader.GetSectionIndex(RelocName);
@@ -1091,7 +1061,7 @@ void ElfWriter<Elf>::processRelocSection(const ElfReader<Elf> &reader, size_t no
 
     // If the input fragment elf bin does not have relocs used by PS,
     // no need to merge any reloc from the input fragment elf bin.
-    SectionBuffer *tmpFragmentRelocSection = isFragmentRelocUsedInPs ? fragmentRelocSection : nullptr;
+    const SectionBuffer *tmpFragmentRelocSection = isFragmentRelocUsedInPs ? fragmentRelocSection : nullptr;
 
     int64_t diffOfPsOffset = nonFragmentPsIsaOffset - fragmentPsIsaOffset;
 
@@ -1200,7 +1170,7 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
 
   // Merge GPU ISA code
   const ElfSectionBuffer<Elf64::SectionHeader> *nonFragmentTextSection = nullptr;
-  ElfSectionBuffer<Elf64::SectionHeader> *fragmentTextSection = nullptr;
+  const ElfSectionBuffer<Elf64::SectionHeader> *fragmentTextSection = nullptr;
   std::vector<ElfSymbol> fragmentSymbols;
   std::vector<ElfSymbol *> nonFragmentSymbols;
 
@@ -1273,7 +1243,7 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   auto fragmentDisassemblySecIndex = reader.GetSectionIndex(Util::Abi::AmdGpuDisassemblyName);
   auto nonFragmentDisassemblySecIndex = GetSectionIndex(Util::Abi::AmdGpuDisassemblyName);
   if (fragmentDisassemblySecIndex != InvalidValue && nonFragmentDisassemblySecIndex != InvalidValue) {
-    ElfSectionBuffer<Elf64::SectionHeader> *fragmentDisassemblySection = nullptr;
+    const ElfSectionBuffer<Elf64::SectionHeader> *fragmentDisassemblySection = nullptr;
     const ElfSectionBuffer<Elf64::SectionHeader> *nonFragmentDisassemblySection = nullptr;
     mustSucceed(reader.getSectionDataBySectionIndex(fragmentDisassemblySecIndex, &fragmentDisassemblySection));
     mustSucceed(getSectionDataBySectionIndex(nonFragmentDisassemblySecIndex, &nonFragmentDisassemblySection));
@@ -1309,7 +1279,7 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   auto fragmentLlvmIrSecIndex = reader.GetSectionIndex(Util::Abi::AmdGpuCommentLlvmIrName);
   auto nonFragmentLlvmIrSecIndex = GetSectionIndex(Util::Abi::AmdGpuCommentLlvmIrName);
   if (fragmentLlvmIrSecIndex != InvalidValue && nonFragmentLlvmIrSecIndex != InvalidValue) {
-    ElfSectionBuffer<Elf64::SectionHeader> *fragmentLlvmIrSection = nullptr;
+    const ElfSectionBuffer<Elf64::SectionHeader> *fragmentLlvmIrSection = nullptr;
     const ElfSectionBuffer<Elf64::SectionHeader> *nonFragmentLlvmIrSection = nullptr;
     mustSucceed(reader.getSectionDataBySectionIndex(fragmentLlvmIrSecIndex, &fragmentLlvmIrSection));
     mustSucceed(getSectionDataBySectionIndex(nonFragmentLlvmIrSecIndex, &nonFragmentLlvmIrSection));
@@ -1345,6 +1315,7 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   ElfNote fragmentMetaNote = {};
   ElfNote newMetaNote = {};
   fragmentMetaNote = reader.getNote(Util::Abi::MetadataNoteType);
+  assert(fragmentMetaNote.data);
   mergeMetaNote(pContext, &nonFragmentMetaNote, &fragmentMetaNote, &newMetaNote);
   setNote(&newMetaNote);
 
@@ -78,7 +78,7 @@ public:
 
   LLPC_NODISCARD static size_t getRelocPsStartPos(const SectionBuffer *relocSection, size_t psIsaOffset);
 
-  SectionBuffer createNewSection(const char *sectionName, SectionBuffer *inputSection);
+  SectionBuffer createNewSection(const char *sectionName, const SectionBuffer *inputSection);
 
   SectionBuffer mergeRelocSection(const ElfReader<Elf> &reader, const SectionBuffer *section1,
                                   size_t section1RelocsCount, const SectionBuffer *section2,
@@ -132,13 +132,11 @@ private:
 
   static void mergeMapItem(llvm::msgpack::MapDocNode &destMap, llvm::msgpack::MapDocNode &srcMap, llvm::StringRef key);
 
-  LLPC_NODISCARD size_t getRequiredBufferSizeBytes();
+  LLPC_NODISCARD size_t getNotesSize() const;
 
-  void calcSectionHeaderOffset();
+  void writeNotes(uint8_t *buffer) const;
 
-  void assembleNotes();
-
-  void assembleSymbols();
+  void writeSymbols(uint8_t *symTab, uint8_t *newStrings) const;
 
   void reinitialize();
 
@@ -0,0 +1,98 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcInFlightCompiles.cpp
+ * @brief LLPC source file: contains the implementation of class Llpc::InFlightCompiles
+ ***********************************************************************************************************************
+ */
+#include "llpcInFlightCompiles.h"
+#include "llvm/ADT/STLExtras.h"
+
+using namespace llvm;
+
+namespace Llpc {
+
+// =====================================================================================================================
+// Runs the compile for the given hash, unless an identical compile is already in progress on another thread. In that
+// case, waits for it to finish and returns a copy of its result, ELF and stage cache accesses instead.
+//
+// Only the given stage cache accesses are read or written here: they must be the entries for the shader stages that
+// the compile covers, and no other thread may write them while it runs, as concurrent compiles of other parts of the
+// same pipeline write the other entries.
+//
+// The compile function must not call run() on the same object with the same hash, as it would wait for itself. Only
+// the request that ran the compile should store its ELF in the caches.
+//
+// @param hash : Cache hash identifying the compile
+// @param [out] elf : ELF produced by the compile
+// @param [in/out] stageCacheAccesses : Stage cache accesses of the shader stages of the compile, which the compile
+//                                      function sets
+// @param compileFunc : Function that does the compile
+// @param [out] ranCompile : If not null, set to whether this request ran the compile rather than waiting for one
+// @returns : Result of the compile
+Result InFlightCompiles::run(const MetroHash::Hash &hash, Vkgc::ElfPackage &elf,
+                             MutableArrayRef<Vkgc::CacheAccessInfo> stageCacheAccesses,
+                             function_ref<Result(Vkgc::ElfPackage &)> compileFunc, bool *ranCompile) {
+  std::shared_ptr<Flight> flight;
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_flights.find(hash);
+    if (it != m_flights.end()) {
+      flight = it->second;
+      ++m_collapsedCount;
+      m_flightDone.wait(lock, [&flight] { return flight->done; });
+      elf = flight->elf;
+      // Both requests are for the same kind of compile, so they own the entries of the same stages.
+      assert(flight->stageCacheAccesses.size() == stageCacheAccesses.size());
+      copy(flight->stageCacheAccesses, stageCacheAccesses.begin());
+      if (ranCompile)
+        *ranCompile = false;
+      return flight->result;
+    }
+    flight = std::make_shared<Flight>();
+    m_flights.emplace(hash, flight);
+  }
+
+  if (ranCompile)
+    *ranCompile = true;
+  Result result = compileFunc(elf);
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // One reference is held by m_flights and one by this function; any more belong to waiters.
+    if (flight.use_count() > 2) {
+      flight->elf = elf;
+      flight->stageCacheAccesses.assign(stageCacheAccesses.begin(), stageCacheAccesses.end());
+    }
+    flight->result = result;
+    flight->done = true;
+    m_flights.erase(hash);
+  }
+  m_flightDone.notify_all();
+  return result;
+}
+
+} // namespace Llpc
@@ -0,0 +1,84 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcInFlightCompiles.h
+ * @brief LLPC header file: contains the declaration of class Llpc::InFlightCompiles
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llpc.h"
+#include "vkgcElfReader.h"
+#include "vkgcMetroHash.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace Llpc {
+
+// =====================================================================================================================
+// Collapses concurrent compiles of the same cache hash into a single compile.
+//
+// The first request for a hash runs the compile. Requests for the same hash that arrive while that compile is running
+// wait for it and receive a copy of its result, ELF and stage cache accesses. The entry is removed as soon as the
+// compile finishes, so later requests go through the caches as usual. This covers the case where the client cache is
+// absent, or does not block in WaitForEntry, and concurrent duplicate requests would otherwise all run the full
+// compile.
+class InFlightCompiles {
+public:
+  InFlightCompiles() = default;
+  InFlightCompiles(const InFlightCompiles &) = delete;
+  InFlightCompiles &operator=(const InFlightCompiles &) = delete;
+
+  Result run(const MetroHash::Hash &hash, Vkgc::ElfPackage &elf,
+             llvm::MutableArrayRef<Vkgc::CacheAccessInfo> stageCacheAccesses,
+             llvm::function_ref<Result(Vkgc::ElfPackage &)> compileFunc, bool *ranCompile = nullptr);
+
+  // Gets the number of requests that were satisfied by waiting for an identical in-flight compile.
+  uint64_t getCollapsedCount() const { return m_collapsedCount; }
+
+private:
+  // A compile that is in progress.
+  struct Flight {
+    bool done = false;                    // Whether the compile has finished
+    Result result = Result::ErrorUnknown; // Result of the compile
+    Vkgc::ElfPackage elf;                 // ELF produced by the compile, only filled in if there are waiters
+    // Stage cache accesses of the shader stages of the compile, only filled in if there are waiters
+    llvm::SmallVector<Vkgc::CacheAccessInfo, Vkgc::ShaderStageCount> stageCacheAccesses;
+  };
+
+  std::mutex m_mutex;                                           // Mutex for m_flights and the Flight objects
+  std::condition_variable m_flightDone;                         // Signalled when a compile finishes
+  std::map<MetroHash::Hash, std::shared_ptr<Flight>> m_flights; // Compiles in progress, by cache hash
+  std::atomic<uint64_t> m_collapsedCount{0};                    // Number of requests collapsed into another compile
+};
+
+} // namespace Llpc
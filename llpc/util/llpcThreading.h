@@ -34,7 +34,11 @@
 #include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/Support/Error.h"
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <vector>
 
@@ -180,4 +184,148 @@ template <typename RangeT, typename FuncT> llvm::Error parallelFor(size_t numThr
   return firstErr;
 }
 
+// =====================================================================================================================
+// An ordered, three-stage parallel pipeline. A reader thread applies `read` to each input in order, worker threads
+// apply `process` to the read states, and the calling thread applies `write` to the processed states in input order.
+// Reading runs a bounded number of inputs ahead of writing, so that loading the next inputs overlaps processing
+// without holding on to the states of all the inputs.
+//
+// The outcome is the same as handling the inputs one at a time: every input before the first failing one is written,
+// in order, and the error of the first failing input is returned. Inputs after it may have been read or processed,
+// but are never written.
+//
+// @param numThreads : Number of requested processing threads. Pass 0 to indicate that all available cores are
+//                     preferred. The implementation may spawn a different number of threads than requested.
+// @param inputs : Random-access range with inputs that will be passed to `read`.
+// @param read : Function object that reads an input. Must return `llvm::Expected<std::unique_ptr<StateT>>`.
+// @param process : Function object that will be applied to each read state. Must return `llvm::Error`.
+// @param write : Function object that will be applied to each processed state, in order. Must return `llvm::Error`.
+// @returns : `llvm::ErrorSuccess` on success, the error of the first failing input on failure.
+template <typename StateT, typename RangeT, typename ReadFuncT, typename ProcessFuncT, typename WriteFuncT>
+llvm::Error parallelPipeline(size_t numThreads, RangeT &&inputs, ReadFuncT read, ProcessFuncT process,
+                             WriteFuncT write) {
+  const auto inputsBegin = llvm::adl_begin(inputs);
+  const auto inputsEnd = llvm::adl_end(inputs);
+  const size_t numTasks = std::distance(inputsBegin, inputsEnd);
+  const size_t numWorkers =
+      detail::decideNumConcurrentThreads(numThreads, numTasks, std::thread::hardware_concurrency());
+
+  // No need to spawn any threads if the work requires only one worker. This makes stack traces nicer.
+  if (numWorkers == 1) {
+    for (auto &&input : inputs) {
+      llvm::Expected<std::unique_ptr<StateT>> stateOrErr = read(std::forward<decltype(input)>(input));
+      if (llvm::Error err = stateOrErr.takeError())
+        return err;
+      if (llvm::Error err = process(**stateOrErr))
+        return err;
+      if (llvm::Error err = write(**stateOrErr))
+        return err;
+    }
+    return llvm::Error::success();
+  }
+
+  // A task is owned by the reader until it is queued, then by a worker until it is marked processed, then by the
+  // writer. Its error is kept until the writer reaches it.
+  struct Task {
+    std::unique_ptr<StateT> state;
+    std::optional<llvm::Error> err;
+    bool processed = false;
+  };
+  std::vector<Task> tasks(numTasks);
+  std::deque<size_t> queuedTasks;          // Tasks read but not yet picked up by a worker
+  size_t nextWriteIdx = 0;                 // Next task to write
+  size_t firstErrIdx = numTasks;           // First task known to have failed; later tasks are not needed
+  bool readerDone = false;                 // Whether the reader has stopped queueing tasks
+  const size_t readAhead = 2 * numWorkers; // Number of tasks the reader may run ahead of the writer
+  std::mutex mutex;
+  std::condition_variable changed;
+
+  std::thread reader([&] {
+    for (size_t idx = 0; idx < numTasks; ++idx) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return idx < nextWriteIdx + readAhead || idx > firstErrIdx; });
+        if (idx > firstErrIdx)
+          break;
+      }
+      llvm::Expected<std::unique_ptr<StateT>> stateOrErr = read(*(inputsBegin + idx));
+      std::lock_guard<std::mutex> lock(mutex);
+      if (stateOrErr) {
+        tasks[idx].state = std::move(*stateOrErr);
+        queuedTasks.push_back(idx);
+      } else {
+        tasks[idx].err = stateOrErr.takeError();
+        tasks[idx].processed = true;
+        firstErrIdx = std::min(firstErrIdx, idx);
+      }
+      changed.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    readerDone = true;
+    changed.notify_all();
+  });
+
+  std::vector<std::thread> workers(numWorkers);
+  for (std::thread &worker : workers) {
+    worker = std::thread([&] {
+      for (;;) {
+        size_t idx = 0;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          changed.wait(lock, [&] { return !queuedTasks.empty() || readerDone; });
+          if (queuedTasks.empty())
+            return;
+          idx = queuedTasks.front();
+          queuedTasks.pop_front();
+          if (idx > firstErrIdx) {
+            // The task will never be written, so skip processing it.
+            tasks[idx].processed = true;
+            continue;
+          }
+        }
+        llvm::Error err = process(*tasks[idx].state);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (err)
+          firstErrIdx = std::min(firstErrIdx, idx);
+        tasks[idx].err = std::move(err);
+        tasks[idx].processed = true;
+        changed.notify_all();
+      }
+    });
+  }
+
+  llvm::Error firstErr = llvm::Error::success();
+  for (size_t idx = 0; idx < numTasks; ++idx) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&] { return tasks[idx].processed; });
+    }
+    Task &task = tasks[idx];
+    llvm::Error err = task.err && *task.err ? std::move(*task.err) : write(*task.state);
+    task.state.reset();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (err) {
+      // Stop the reader and the workers from picking up any more tasks.
+      firstErrIdx = std::min(firstErrIdx, idx);
+      firstErr = llvm::joinErrors(std::move(firstErr), std::move(err));
+      changed.notify_all();
+      break;
+    }
+    nextWriteIdx = idx + 1;
+    changed.notify_all();
+  }
+
+  // Wait for all threads to finish, and drop the errors of tasks that were not reached.
+  reader.join();
+  for (std::thread &worker : workers)
+    worker.join();
+  for (Task &task : tasks) {
+    if (task.err)
+      llvm::consumeError(std::move(*task.err));
+  }
+
+  return firstErr;
+}
+
 } // namespace Llpc
@@ -172,4 +172,97 @@ const StringMap<TimeRecord> &TimerProfiler::getDummyTimeRecords() {
   return DummyTimeRecords;
 }
 
+// =====================================================================================================================
+// Returns true if the report functions below output anything. They report alongside the timer reports, so they do
+// nothing unless timer profiling is enabled.
+static bool isReportEnabled() {
+  return TimePassesIsEnabled || cl::EnableTimerProfile;
+}
+
+// =====================================================================================================================
+// Reports the estimated memory retained by a compiler context after it has been released.
+//
+// @param hash64 : Hash code of the pipeline the context was last used for
+// @param retainedBytes : Estimated bytes retained by the context
+// @param useCount : Number of times the context has been used
+void TimerProfiler::reportContextMemory(uint64_t hash64, size_t retainedBytes, unsigned useCount) {
+  if (!isReportEnabled())
+    return;
+
+  auto outStream = CreateInfoOutputFile();
+  *outStream << "LLPC Context retained memory " << format("0x%016" PRIX64, hash64) << ": " << (retainedBytes >> 10)
+             << " KB after " << useCount << " use(s)\n";
+}
+
+// =====================================================================================================================
+// Reports that a compiler context has been destroyed and recreated by the context pool.
+//
+// @param retainedBytes : Estimated bytes retained by the context
+// @param useCount : Number of times the context has been used
+// @param reason : The recycling policy that triggered
+void TimerProfiler::reportContextRecycle(size_t retainedBytes, unsigned useCount, const char *reason) {
+  if (!isReportEnabled())
+    return;
+
+  auto outStream = CreateInfoOutputFile();
+  *outStream << "LLPC Context recycled (" << reason << "): " << (retainedBytes >> 10) << " KB retained after "
+             << useCount << " use(s)\n";
+}
+
+// =====================================================================================================================
+// Reports how much the concurrent fragment and pre-rasterization part-pipeline compiles of a pipeline overlapped.
+//
+// @param hash64 : Hash code of the pipeline
+// @param fragmentUs : Time taken by the fragment part-pipeline compile, in microseconds
+// @param preRasterUs : Time taken by the pre-rasterization part-pipeline compile, in microseconds
+// @param waitUs : Time the pre-rasterization compile waited for the FS input mappings, in microseconds
+// @param overlapUs : Time both compiles were running, in microseconds
+void TimerProfiler::reportPartPipelineOverlap(uint64_t hash64, uint64_t fragmentUs, uint64_t preRasterUs,
+                                              uint64_t waitUs, uint64_t overlapUs) {
+  if (!isReportEnabled())
+    return;
+
+  auto outStream = CreateInfoOutputFile();
+  *outStream << "LLPC Part pipelines " << format("0x%016" PRIX64, hash64) << ": fragment " << fragmentUs
+             << " us, pre-rasterization " << preRasterUs << " us (waited " << waitUs << " us), overlapped "
+             << overlapUs << " us\n";
+}
+
+// =====================================================================================================================
+// Reports how the part pipelines built by a compiler were handled.
+//
+// @param concurrentCompiles : Number of times the fragment and pre-rasterization part pipelines were compiled
+//                             concurrently
+// @param preRasterEarlyCacheHits : Number of pre-rasterization part pipelines found in the cache without being lowered
+// @param preRasterLateCacheHits : Number of pre-rasterization compiles cancelled by a cache hit at the hand-off
+void TimerProfiler::reportPartPipelineCounts(uint64_t concurrentCompiles, uint64_t preRasterEarlyCacheHits,
+                                             uint64_t preRasterLateCacheHits) {
+  if (!isReportEnabled())
+    return;
+
+  auto outStream = CreateInfoOutputFile();
+  *outStream << "LLPC Part pipelines: " << concurrentCompiles << " compiled concurrently, " << preRasterEarlyCacheHits
+             << " pre-rasterization cache hits before lowering, " << preRasterLateCacheHits
+             << " pre-rasterization compiles cancelled by a cache hit\n";
+}
+
+// =====================================================================================================================
+// Reports the cost of merging the cached fragment and non-fragment ELFs of a pipeline into a single ELF.
+//
+// @param hash64 : Hash code of the pipeline
+// @param nonFragmentBytes : Size of the non-fragment ELF, in bytes
+// @param fragmentBytes : Size of the fragment ELF, in bytes
+// @param mergedBytes : Size of the merged ELF, in bytes
+// @param mergeUs : Time taken to read and merge the ELFs, in microseconds
+void TimerProfiler::reportElfMerge(uint64_t hash64, size_t nonFragmentBytes, size_t fragmentBytes, size_t mergedBytes,
+                                   uint64_t mergeUs) {
+  if (!isReportEnabled())
+    return;
+
+  auto outStream = CreateInfoOutputFile();
+  *outStream << "LLPC ELF merge " << format("0x%016" PRIX64, hash64) << ": non-fragment " << nonFragmentBytes
+             << " bytes + fragment " << fragmentBytes << " bytes -> " << mergedBytes << " bytes in " << mergeUs
+             << " us\n";
+}
+
 } // namespace Llpc
@@ -72,6 +72,19 @@ public:
 
   static const llvm::StringMap<llvm::TimeRecord> &getDummyTimeRecords();
 
+  static void reportContextMemory(uint64_t hash64, size_t retainedBytes, unsigned useCount);
+
+  static void reportContextRecycle(size_t retainedBytes, unsigned useCount, const char *reason);
+
+  static void reportPartPipelineOverlap(uint64_t hash64, uint64_t fragmentUs, uint64_t preRasterUs, uint64_t waitUs,
+                                        uint64_t overlapUs);
+
+  static void reportPartPipelineCounts(uint64_t concurrentCompiles, uint64_t preRasterEarlyCacheHits,
+                                       uint64_t preRasterLateCacheHits);
+
+  static void reportElfMerge(uint64_t hash64, size_t nonFragmentBytes, size_t fragmentBytes, size_t mergedBytes,
+                             uint64_t mergeUs);
+
   static const unsigned PipelineTimerEnableMask = ((1 << TimerCount) - 1);
   static const unsigned ShaderModuleTimerEnableMask = ((1 << TimerTranslate) | (1 << TimerFeLowering));
 
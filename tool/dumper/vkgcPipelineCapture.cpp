@@ -0,0 +1,1077 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+***********************************************************************************************************************
+* @file  vkgcPipelineCapture.cpp
+* @brief VKGC source file: contains implementation of the VKGC binary pipeline capture format.
+***********************************************************************************************************************
+*/
+#include "vkgcPipelineCapture.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/ADT/bit.h"
+#include "llvm/Support/Alignment.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <string.h>
+#include <type_traits>
+
+using namespace llvm;
+
+namespace Vkgc {
+
+namespace {
+
+// Identifies a binary pipeline capture
+constexpr char PipelineCaptureMagic[8] = {'V', 'K', 'G', 'C', 'P', 'C', 'A', 'P'};
+
+// Version of the capture encoding. Must be bumped when a field is added to, removed from or reordered in the mapping
+// functions below.
+constexpr uint32_t PipelineCaptureFormatVersion = 2;
+
+// Alignment of binary blobs, such as SPIR-V, in a capture, so that they can be used in place
+constexpr uint64_t PipelineCaptureBlobAlignment = 8;
+
+// Enumerates the kinds of captured pipeline.
+enum class PipelineCaptureType : uint32_t {
+  Graphics,
+  Compute,
+  RayTracing,
+};
+
+// Gets the type through which a mapping function sees a structure: a reference to const when writing the capture, and
+// a mutable reference when reading it.
+template <class IO, class T> using FieldRef = std::conditional_t<IO::IsReading, T &, const T &>;
+
+template <class IO, class T> void mapElement(IO &io, T &element);
+
+// =====================================================================================================================
+// Represents the writing of a capture. Each field is appended in a fixed little-endian encoding. Pointed-to arrays and
+// binary blobs are preceded by a flag telling whether they are present; their sizes are fields of the structure that
+// points to them, so are not repeated.
+class PipelineCaptureWriter {
+public:
+  static constexpr bool IsReading = false;
+
+  PipelineCaptureWriter(std::string &out) : m_out(out) {}
+
+  Result write(PipelineBuildInfo pipelineInfo, ArrayRef<PipelineCaptureStage> stages);
+
+  // Gets the reason the build info cannot be captured.
+  const std::string &getError() const { return m_error; }
+
+  template <class T> void field(const T &value);
+  void field(const optional_bool &value) { field<uint8_t>(value.has_value() ? (*value ? 2 : 1) : 0); }
+  template <class P> void array(const P &data, uint64_t count);
+  template <class P> void bytes(const P &data, uint64_t size);
+  void string(const char *str);
+  void unsupported(const void *pointer, const Twine &what);
+  void fail(const Twine &message);
+
+private:
+  std::string &m_out;  // Capture being written
+  std::string m_error; // First reason the build info cannot be captured
+};
+
+// =====================================================================================================================
+// Appends a scalar field, or each element of an array field.
+//
+// @param value : Value of the field
+template <class T> void PipelineCaptureWriter::field(const T &value) {
+  auto append = [this](auto encoded) {
+    char buffer[sizeof(encoded)];
+    support::endian::write<decltype(encoded), endianness::little>(buffer, encoded);
+    m_out.append(buffer, sizeof(buffer));
+  };
+  if constexpr (std::is_array_v<T>) {
+    for (const auto &element : value)
+      field(element);
+  } else if constexpr (std::is_same_v<T, bool>) {
+    append(static_cast<uint8_t>(value));
+  } else if constexpr (std::is_same_v<T, float>) {
+    append(bit_cast<uint32_t>(value));
+  } else if constexpr (std::is_same_v<T, size_t>) {
+    append(static_cast<uint64_t>(value));
+  } else if constexpr (std::is_enum_v<T>) {
+    append(static_cast<std::make_unsigned_t<std::underlying_type_t<T>>>(value));
+  } else {
+    static_assert(std::is_integral_v<T>, "Structures must be mapped field by field");
+    append(static_cast<std::make_unsigned_t<T>>(value));
+  }
+}
+
+// =====================================================================================================================
+// Appends a pointed-to array of elements.
+//
+// @param data : Pointer to the array
+// @param count : Number of elements
+template <class P> void PipelineCaptureWriter::array(const P &data, uint64_t count) {
+  const bool present = data && count != 0;
+  field(present);
+  for (uint64_t i = 0; present && i < count; ++i)
+    mapElement(*this, data[i]);
+}
+
+// =====================================================================================================================
+// Appends a pointed-to binary blob, aligned so that it can be used in place once loaded.
+//
+// @param data : Pointer to the blob
+// @param size : Size of the blob in bytes
+template <class P> void PipelineCaptureWriter::bytes(const P &data, uint64_t size) {
+  const bool present = data && size != 0;
+  field(present);
+  if (!present)
+    return;
+  m_out.resize(alignTo(m_out.size(), Align(PipelineCaptureBlobAlignment)), '\0');
+  m_out.append(static_cast<const char *>(static_cast<const void *>(data)), size);
+}
+
+// =====================================================================================================================
+// Appends a pointed-to string.
+//
+// @param str : The string, or null
+void PipelineCaptureWriter::string(const char *str) {
+  field(str != nullptr);
+  if (!str)
+    return;
+  const uint32_t length = strlen(str);
+  field(length);
+  m_out.append(str, length);
+}
+
+// =====================================================================================================================
+// Fails the capture if a pointer the format cannot represent is set.
+//
+// @param pointer : The pointer
+// @param what : Description of what the pointer points to
+void PipelineCaptureWriter::unsupported(const void *pointer, const Twine &what) {
+  if (pointer)
+    fail(what + " cannot be captured");
+}
+
+// =====================================================================================================================
+// Records that the build info cannot be captured. Only the first reason is kept.
+//
+// @param message : The reason
+void PipelineCaptureWriter::fail(const Twine &message) {
+  if (m_error.empty())
+    m_error = message.str();
+}
+
+// =====================================================================================================================
+// Represents the reading of a capture. The structures are decoded into memory from the capture's allocator, and the
+// binary blobs are used in place in the mapped file.
+class PipelineCaptureReader {
+public:
+  static constexpr bool IsReading = true;
+
+  PipelineCaptureReader(StringRef data, size_t offset, BumpPtrAllocator &allocator)
+      : m_data(data), m_offset(offset), m_allocator(allocator) {}
+
+  // Checks whether the whole capture has been read without error.
+  bool atEnd() const { return m_error.empty() && m_offset == m_data.size(); }
+
+  // Gets the reason the capture cannot be read.
+  const std::string &getError() const { return m_error; }
+
+  template <class T> void field(T &value);
+  void field(optional_bool &value);
+  template <class P> void array(P &data, uint64_t count);
+  template <class P> void bytes(P &data, uint64_t size);
+  void string(const char *&str);
+  void unsupported(const void *pointer, const Twine &what) {}
+  void fail(const Twine &message);
+
+private:
+  template <class U> U read();
+
+  StringRef m_data;              // Whole capture
+  size_t m_offset;               // Offset of the next field
+  BumpPtrAllocator &m_allocator; // Allocator of the decoded structures
+  std::string m_error;           // First reason the capture cannot be read
+};
+
+// =====================================================================================================================
+// Reads the encoding of a scalar. Past the end of the capture, the read fails and gives 0.
+template <class U> U PipelineCaptureReader::read() {
+  if (m_data.size() - m_offset < sizeof(U)) {
+    fail("Pipeline capture is truncated");
+    return 0;
+  }
+  U encoded = support::endian::read<U, endianness::little>(m_data.data() + m_offset);
+  m_offset += sizeof(U);
+  return encoded;
+}
+
+// =====================================================================================================================
+// Reads a scalar field, or each element of an array field.
+//
+// @param [out] value : Value of the field
+template <class T> void PipelineCaptureReader::field(T &value) {
+  if constexpr (std::is_array_v<T>) {
+    for (auto &element : value)
+      field(element);
+  } else if constexpr (std::is_same_v<T, bool>) {
+    value = read<uint8_t>() != 0;
+  } else if constexpr (std::is_same_v<T, float>) {
+    value = bit_cast<float>(read<uint32_t>());
+  } else if constexpr (std::is_same_v<T, size_t>) {
+    value = static_cast<size_t>(read<uint64_t>());
+  } else if constexpr (std::is_enum_v<T>) {
+    value = static_cast<T>(read<std::make_unsigned_t<std::underlying_type_t<T>>>());
+  } else {
+    static_assert(std::is_integral_v<T>, "Structures must be mapped field by field");
+    value = static_cast<T>(read<std::make_unsigned_t<T>>());
+  }
+}
+
+// =====================================================================================================================
+// Reads an optional boolean field.
+//
+// @param [out] value : Value of the field
+void PipelineCaptureReader::field(optional_bool &value) {
+  const uint8_t encoded = read<uint8_t>();
+  if (encoded != 0)
+    value = encoded == 2;
+}
+
+// =====================================================================================================================
+// Reads a pointed-to array of elements.
+//
+// @param [out] data : Pointer to the array, or null if it is not present
+// @param count : Number of elements
+template <class P> void PipelineCaptureReader::array(P &data, uint64_t count) {
+  bool present = false;
+  field(present);
+  if (!present || !m_error.empty())
+    return;
+  // Every element takes at least a byte, which bounds the allocation by the size of the capture.
+  if (count > m_data.size() - m_offset) {
+    fail("Pipeline capture is truncated");
+    return;
+  }
+  using Element = std::remove_cv_t<std::remove_pointer_t<P>>;
+  Element *elements = m_allocator.Allocate<Element>(count);
+  std::uninitialized_value_construct_n(elements, count);
+  for (uint64_t i = 0; i < count; ++i)
+    mapElement(*this, elements[i]);
+  data = elements;
+}
+
+// =====================================================================================================================
+// Reads a pointed-to binary blob. It is used in place, unless the capture is not mapped at a sufficient alignment.
+//
+// @param [out] data : Pointer to the blob, or null if it is not present
+// @param size : Size of the blob in bytes
+template <class P> void PipelineCaptureReader::bytes(P &data, uint64_t size) {
+  bool present = false;
+  field(present);
+  if (!present || !m_error.empty())
+    return;
+  const size_t offset = alignTo(m_offset, Align(PipelineCaptureBlobAlignment));
+  if (offset > m_data.size() || size > m_data.size() - offset) {
+    fail("Pipeline capture is truncated");
+    return;
+  }
+  const char *blob = m_data.data() + offset;
+  if (!isAddrAligned(Align(PipelineCaptureBlobAlignment), blob)) {
+    char *copy = static_cast<char *>(m_allocator.Allocate(size, Align(PipelineCaptureBlobAlignment)));
+    memcpy(copy, blob, size);
+    blob = copy;
+  }
+  data = static_cast<P>(static_cast<const void *>(blob));
+  m_offset = offset + size;
+}
+
+// =====================================================================================================================
+// Reads a pointed-to string.
+//
+// @param [out] str : The string, or null if it is not present
+void PipelineCaptureReader::string(const char *&str) {
+  bool present = false;
+  field(present);
+  uint32_t length = 0;
+  if (present)
+    field(length);
+  if (!present || !m_error.empty())
+    return;
+  if (length > m_data.size() - m_offset) {
+    fail("Pipeline capture is truncated");
+    return;
+  }
+  char *copy = m_allocator.Allocate<char>(length + 1);
+  memcpy(copy, m_data.data() + m_offset, length);
+  copy[length] = '\0';
+  str = copy;
+  m_offset += length;
+}
+
+// =====================================================================================================================
+// Records that the capture cannot be read, and stops reading it. Only the first reason is kept.
+//
+// @param message : The reason
+void PipelineCaptureReader::fail(const Twine &message) {
+  if (m_error.empty())
+    m_error = message.str();
+  m_offset = m_data.size();
+}
+
+// =====================================================================================================================
+// The mapping functions below list, for each structure reachable from a pipeline build info, the fields that make up
+// the capture, in order. The same function writes and reads a structure. Pointers that only have meaning in the
+// process that built the structure (allocators, user data and the opaque shader module data, whose SPIR-V is captured
+// as a stage instead) are not captured, and read back as null.
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, ShaderHash> hash) {
+  io.field(hash.lower);
+  io.field(hash.upper);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, BinaryData> binary) {
+  io.field(binary.codeSize);
+  io.bytes(binary.pCode, binary.codeSize);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, CachePolicyLlc> cachePolicyLlc) {
+  io.field(cachePolicyLlc.resourceCount);
+  io.array(cachePolicyLlc.noAllocs, cachePolicyLlc.resourceCount);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, PipelineShaderOptions> options) {
+  mapFields(io, options.clientHash);
+  io.field(options.trapPresent);
+  io.field(options.debugMode);
+  io.field(options.enablePerformanceData);
+  io.field(options.allowReZ);
+  io.field(options.vgprLimit);
+  io.field(options.sgprLimit);
+  io.field(options.maxThreadGroupsPerComputeUnit);
+  io.field(options.subgroupSize);
+  io.field(options.waveSize);
+  io.field(options.wgpMode);
+  io.field(options.waveBreakSize);
+  io.field(options.forceLoopUnrollCount);
+  io.field(options.enableLoadScalarizer);
+  io.field(options.allowVaryWaveSize);
+  io.field(options.useSiScheduler);
+  io.field(options.disableCodeSinking);
+  io.field(options.favorLatencyHiding);
+  io.field(options.disableLicm);
+  io.field(options.unrollThreshold);
+  io.field(options.scalarThreshold);
+  io.field(options.disableLoopUnroll);
+  io.field(options.adjustDepthImportVrs);
+  io.field(options.fp32DenormalMode);
+  io.field(options.disableLicmThreshold);
+  io.field(options.unrollHintThreshold);
+  io.field(options.dontUnrollHintThreshold);
+  io.field(options.noContractOpDot);
+  io.field(options.fastMathFlags);
+  io.field(options.disableFastMathFlags);
+  io.field(options.ldsSpillLimitDwords);
+  io.field(options.scalarizeWaterfallLoads);
+  io.field(options.overrideForceThreadIdSwizzling);
+  io.field(options.overrideShaderThreadGroupSizeX);
+  io.field(options.overrideShaderThreadGroupSizeY);
+  io.field(options.overrideShaderThreadGroupSizeZ);
+  io.field(options.forceLateZ);
+  io.field(options.nsaThreshold);
+  io.field(options.aggressiveInvariantLoads);
+  io.field(options.workaroundStorageImageFormats);
+  io.field(options.disableFMA);
+  io.field(options.disableReadFirstLaneWorkaround);
+  io.field(options.backwardPropagateNoContract);
+  io.field(options.forwardPropagateNoContract);
+  io.field(options.workgroupRoundRobin);
+  io.field(options.constantBufferBindingOffset);
+  io.field(options.imageSampleDrefReturnsRgba);
+  io.field(options.disableGlPositionOpt);
+  io.field(options.viewIndexFromDeviceIndex);
+  mapFields(io, options.cachePolicyLlc);
+  io.field(options.temporalHintShaderControl);
+  io.field(options.enableTransformShader);
+  io.field(options.forceUnderflowPrevention);
+  io.field(options.forceMemoryBarrierScope);
+  io.field(options.scheduleStrategy);
+  io.field(options.promoteAllocaRegLimit);
+  io.field(options.promoteAllocaRegRatio);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkSpecializationMapEntry> mapEntry) {
+  io.field(mapEntry.constantID);
+  io.field(mapEntry.offset);
+  io.field(mapEntry.size);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkSpecializationInfo> specInfo) {
+  io.field(specInfo.mapEntryCount);
+  io.array(specInfo.pMapEntries, specInfo.mapEntryCount);
+  io.field(specInfo.dataSize);
+  io.bytes(specInfo.pData, specInfo.dataSize);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, PipelineShaderInfo> shaderInfo) {
+  io.array(shaderInfo.pSpecializationInfo, 1);
+  io.string(shaderInfo.pEntryTarget);
+  io.field(shaderInfo.entryStage);
+  mapFields(io, shaderInfo.options);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, ResourceMappingNode> node) {
+  io.field(node.type);
+  io.field(node.sizeInDwords);
+  io.field(node.offsetInDwords);
+  switch (node.type) {
+  case ResourceMappingNodeType::DescriptorTableVaPtr:
+    io.field(node.tablePtr.nodeCount);
+    io.array(node.tablePtr.pNext, node.tablePtr.nodeCount);
+    break;
+  case ResourceMappingNodeType::IndirectUserDataVaPtr:
+    io.field(node.userDataPtr.sizeInDwords);
+    break;
+  default:
+    io.field(node.srdRange.set);
+    io.field(node.srdRange.binding);
+    io.field(node.srdRange.strideInDwords);
+    break;
+  }
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, ResourceMappingRootNode> rootNode) {
+  mapFields(io, rootNode.node);
+  io.field(rootNode.visibility);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, StaticDescriptorValue> value) {
+  io.field(value.type);
+  io.field(value.set);
+  io.field(value.binding);
+  io.field(value.arraySize);
+  io.field(value.visibility);
+  // Each element is a sampler SRD, followed by the YCbCr metadata for a YCbCr sampler.
+  uint64_t descriptorSize = 16;
+  if (value.type == ResourceMappingNodeType::DescriptorYCbCrSampler)
+    descriptorSize += sizeof(SamplerYCbCrConversionMetaData);
+  io.bytes(value.pValue, value.arraySize * descriptorSize);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, ResourceMappingData> resourceMapping) {
+  io.field(resourceMapping.userDataNodeCount);
+  io.array(resourceMapping.pUserDataNodes, resourceMapping.userDataNodeCount);
+  io.field(resourceMapping.staticDescriptorValueCount);
+  io.array(resourceMapping.pStaticDescriptorValues, resourceMapping.staticDescriptorValueCount);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, CompileTimeConst> constant) {
+  io.field(constant.offset);
+  io.field(constant.set);
+  io.field(constant.binding);
+  io.field(constant.validBytes);
+  io.field(constant.values.u32);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, CompileConstInfo> constInfo) {
+  io.field(constInfo.numCompileTimeConstants);
+  io.array(constInfo.pCompileTimeConstants, constInfo.numCompileTimeConstants);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, PipelineOptions> options) {
+  io.field(options.includeDisassembly);
+  io.field(options.scalarBlockLayout);
+  io.field(options.reconfigWorkgroupLayout);
+  io.field(options.forceCsThreadIdSwizzling);
+  io.field(options.includeIr);
+  io.field(options.robustBufferAccess);
+  io.field(options.enableRobustUnboundVertex);
+  io.field(options.enableRelocatableShaderElf);
+  io.field(options.disableImageResourceCheck);
+  io.field(options.enableScratchAccessBoundsChecks);
+  io.field(options.enableImplicitInvariantExports);
+  io.field(options.shadowDescriptorTableUsage);
+  io.field(options.shadowDescriptorTablePtrHigh);
+  io.field(options.extendedRobustness.robustBufferAccess);
+  io.field(options.extendedRobustness.robustImageAccess);
+  io.field(options.extendedRobustness.nullDescriptor);
+  io.field(options.enableRayQuery);
+  io.field(options.optimizeTessFactor);
+  io.field(options.enableInterpModePatch);
+  io.field(options.pageMigrationEnabled);
+  io.field(options.optimizationLevel);
+  io.field(options.overrideThreadGroupSizeX);
+  io.field(options.overrideThreadGroupSizeY);
+  io.field(options.overrideThreadGroupSizeZ);
+  io.field(options.resourceLayoutScheme);
+  io.field(options.threadGroupSwizzleMode);
+  io.field(options.reverseThreadGroup);
+  io.field(options.internalRtShaders);
+  io.field(options.forceNonUniformResourceIndexStageMask);
+  io.field(options.expertSchedulingMode);
+  io.field(options.glState.replaceSetWithResourceType);
+  io.field(options.glState.disableSampleMask);
+  io.field(options.glState.buildResourcesDataForShaderModule);
+  io.field(options.glState.disableTruncCoordForGather);
+  io.field(options.glState.enableCombinedTexture);
+  io.field(options.glState.vertex64BitsAttribSingleLoc);
+  io.field(options.glState.enableFragColor);
+  io.field(options.glState.disableBaseVertex);
+  io.field(options.glState.bindlessTextureMode);
+  io.field(options.glState.bindlessImageMode);
+  io.field(options.glState.enablePolygonStipple);
+  io.field(options.glState.enableLineSmooth);
+  io.field(options.glState.emulateWideLineStipple);
+  io.field(options.glState.enablePointSmooth);
+  io.field(options.glState.enableRemapLocation);
+  io.field(options.glState.enableDepthCompareParam);
+  io.field(options.glState.enableDepthCompareFailValue);
+  io.field(options.cacheScopePolicyControl);
+  io.field(options.enablePrimGeneratedQuery);
+  io.field(options.disablePerCompFetch);
+  io.field(options.reserved21);
+  io.field(options.optimizePointSizeWrite);
+  io.array(options.compileConstInfo, 1);
+  io.field(options.temporalHintControl);
+  io.field(options.padBufferSizeToNextDword);
+  io.field(options.compileTimeBudgetMs);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, GpurtOption> option) {
+  io.field(option.nameHash);
+  io.field(option.value);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, RtState> rtState) {
+  io.field(rtState.nodeStrideShift);
+  io.field(rtState.bvhResDesc.descriptorData);
+  io.field(rtState.bvhResDesc.dataSizeInDwords);
+  io.field(rtState.staticPipelineFlags);
+  io.field(rtState.triCompressMode);
+  io.field(rtState.boxSortHeuristicMode);
+  io.field(rtState.pipelineFlags);
+  io.field(rtState.counterMode);
+  io.field(rtState.counterMask);
+  io.field(rtState.threadGroupSizeX);
+  io.field(rtState.threadGroupSizeY);
+  io.field(rtState.threadGroupSizeZ);
+  io.field(rtState.rayQueryCsSwizzle);
+  io.field(rtState.ldsStackSize);
+  io.field(rtState.dispatchRaysThreadGroupSize);
+  io.field(rtState.ldsSizePerThreadGroup);
+  io.field(rtState.outerTileSize);
+  io.field(rtState.dispatchDimSwizzleMode);
+  auto &exportConfig = rtState.exportConfig;
+  io.field(exportConfig.indirectCallingConvention);
+  io.field(exportConfig.indirectCalleeSavedRegs.raygen);
+  io.field(exportConfig.indirectCalleeSavedRegs.miss);
+  io.field(exportConfig.indirectCalleeSavedRegs.closestHit);
+  io.field(exportConfig.indirectCalleeSavedRegs.anyHit);
+  io.field(exportConfig.indirectCalleeSavedRegs.intersection);
+  io.field(exportConfig.indirectCalleeSavedRegs.callable);
+  io.field(exportConfig.indirectCalleeSavedRegs.traceRays);
+  io.field(exportConfig.enableUniformNoReturn);
+  io.field(exportConfig.enableTraceRayArgsInLds);
+  io.field(exportConfig.enableReducedLinkageOpt);
+  io.field(exportConfig.readsDispatchRaysIndex);
+  io.field(exportConfig.enableDynamicLaunch);
+  io.field(exportConfig.emitRaytracingShaderDataToken);
+  io.field(exportConfig.emitRaytracingShaderHashToken);
+  io.field(rtState.enableRayQueryCsSwizzle);
+  io.field(rtState.enableDispatchRaysInnerSwizzle);
+  io.field(rtState.enableDispatchRaysOuterSwizzle);
+  io.field(rtState.forceInvalidAccelStruct);
+  io.field(rtState.enableRayTracingCounters);
+  io.field(rtState.enableRayTracingHwTraversalStack);
+  io.field(rtState.enableOptimalLdsStackSizeForIndirect);
+  io.field(rtState.enableOptimalLdsStackSizeForUnified);
+  io.field(rtState.maxRayLength);
+  io.field(rtState.gpurtFeatureFlags);
+  mapFields(io, rtState.gpurtShaderLibrary);
+  io.field(rtState.gpurtFuncTable.pFunc);
+  io.field(rtState.rtIpVersion.major);
+  io.field(rtState.rtIpVersion.minor);
+  io.field(rtState.gpurtOverride);
+  io.field(rtState.rtIpOverride);
+  io.field(rtState.gpurtOptionCount);
+  io.array(rtState.pGpurtOptions, rtState.gpurtOptionCount);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, UniformConstantMapEntry> entry) {
+  io.field(entry.location);
+  io.field(entry.offset);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, UniformConstantMap> uniformMap) {
+  io.field(uniformMap.visibility);
+  io.field(uniformMap.numUniformConstants);
+  io.array(uniformMap.pUniforms, uniformMap.numUniformConstants);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, OutputLocationMap> locationMap) {
+  io.field(locationMap.count);
+  io.array(locationMap.oldLocation, locationMap.count);
+  io.array(locationMap.newLocation, locationMap.count);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, XfbOutInfo> xfbOutInfo) {
+  io.field(xfbOutInfo.isBuiltIn);
+  io.field(xfbOutInfo.location);
+  io.field(xfbOutInfo.component);
+  io.field(xfbOutInfo.xfbBuffer);
+  io.field(xfbOutInfo.xfbOffset);
+  io.field(xfbOutInfo.xfbStride);
+  io.field(xfbOutInfo.streamId);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkVertexInputBindingDescription> binding) {
+  io.field(binding.binding);
+  io.field(binding.stride);
+  io.field(binding.inputRate);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkVertexInputAttributeDescription> attribute) {
+  io.field(attribute.location);
+  io.field(attribute.binding);
+  io.field(attribute.format);
+  io.field(attribute.offset);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkVertexInputBindingDivisorDescriptionEXT> divisor) {
+  io.field(divisor.binding);
+  io.field(divisor.divisor);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkPipelineVertexInputDivisorStateCreateInfoEXT> divisorState) {
+  io.field(divisorState.sType);
+  io.unsupported(divisorState.pNext, "A structure chained to the vertex input divisor state");
+  io.field(divisorState.vertexBindingDivisorCount);
+  io.array(divisorState.pVertexBindingDivisors, divisorState.vertexBindingDivisorCount);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkPipelineVertexInputStateCreateInfo> vertexInput) {
+  io.field(vertexInput.sType);
+  io.field(vertexInput.flags);
+  io.field(vertexInput.vertexBindingDescriptionCount);
+  io.array(vertexInput.pVertexBindingDescriptions, vertexInput.vertexBindingDescriptionCount);
+  io.field(vertexInput.vertexAttributeDescriptionCount);
+  io.array(vertexInput.pVertexAttributeDescriptions, vertexInput.vertexAttributeDescriptionCount);
+
+  // Of the structures that can be chained to the vertex input state, LLPC only reads the vertex divisor state.
+  const VkPipelineVertexInputDivisorStateCreateInfoEXT *divisorState = nullptr;
+  if constexpr (!IO::IsReading) {
+    for (auto next = static_cast<const VkBaseInStructure *>(vertexInput.pNext); next; next = next->pNext) {
+      if (next->sType == VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT && !divisorState)
+        divisorState = reinterpret_cast<const VkPipelineVertexInputDivisorStateCreateInfoEXT *>(next);
+      else
+        io.fail(Twine("A structure of type ") + Twine(static_cast<unsigned>(next->sType)) +
+                " chained to the vertex input state cannot be captured");
+    }
+  }
+  io.array(divisorState, 1);
+  if constexpr (IO::IsReading)
+    vertexInput.pNext = divisorState;
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkStencilOpState> stencilOp) {
+  io.field(stencilOp.failOp);
+  io.field(stencilOp.passOp);
+  io.field(stencilOp.depthFailOp);
+  io.field(stencilOp.compareOp);
+  io.field(stencilOp.compareMask);
+  io.field(stencilOp.writeMask);
+  io.field(stencilOp.reference);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkPipelineDepthStencilStateCreateInfo> dsState) {
+  io.field(dsState.sType);
+  io.unsupported(dsState.pNext, "A structure chained to the depth/stencil state");
+  io.field(dsState.flags);
+  io.field(dsState.depthTestEnable);
+  io.field(dsState.depthWriteEnable);
+  io.field(dsState.depthCompareOp);
+  io.field(dsState.depthBoundsTestEnable);
+  io.field(dsState.stencilTestEnable);
+  mapFields(io, dsState.front);
+  mapFields(io, dsState.back);
+  io.field(dsState.minDepthBounds);
+  io.field(dsState.maxDepthBounds);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, TessellationLevel> tessLevel) {
+  io.field(tessLevel.inner);
+  io.field(tessLevel.outer);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, ColorTarget> target) {
+  io.field(target.blendEnable);
+  io.field(target.blendSrcAlphaToColor);
+  io.field(target.channelWriteMask);
+  io.field(target.format);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, NggState> nggState) {
+  io.field(nggState.enableNgg);
+  io.field(nggState.enableGsUse);
+  io.field(nggState.forceCullingMode);
+  io.field(nggState.compactVertex);
+  io.field(nggState.enableBackfaceCulling);
+  io.field(nggState.enableFrustumCulling);
+  io.field(nggState.enableBoxFilterCulling);
+  io.field(nggState.enableSphereCulling);
+  io.field(nggState.enableSmallPrimFilter);
+  io.field(nggState.enableCullDistanceCulling);
+  io.field(nggState.backfaceExponent);
+  io.field(nggState.subgroupSizing);
+  io.field(nggState.primsPerSubgroup);
+  io.field(nggState.vertsPerSubgroup);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, GraphicsPipelineBuildInfo> pipelineInfo) {
+  io.field(pipelineInfo.pipelineApiHash);
+  mapFields(io, pipelineInfo.task);
+  mapFields(io, pipelineInfo.vs);
+  mapFields(io, pipelineInfo.tcs);
+  mapFields(io, pipelineInfo.tes);
+  mapFields(io, pipelineInfo.gs);
+  mapFields(io, pipelineInfo.mesh);
+  mapFields(io, pipelineInfo.fs);
+  mapFields(io, pipelineInfo.resourceMapping);
+  io.field(pipelineInfo.pipelineLayoutApiHash);
+  io.array(pipelineInfo.pVertexInput, 1);
+  mapFields(io, pipelineInfo.dsState);
+
+  auto &iaState = pipelineInfo.iaState;
+  io.field(iaState.topology);
+  io.field(iaState.patchControlPoints);
+  io.field(iaState.deviceIndex);
+  io.field(iaState.disableVertexReuse);
+  io.field(iaState.switchWinding);
+  io.field(iaState.enableMultiView);
+  io.field(iaState.useVertexBufferDescArray);
+  io.array(iaState.tessLevel, 1);
+
+  io.field(pipelineInfo.vpState.depthClipEnable);
+
+  auto &rsState = pipelineInfo.rsState;
+  io.field(rsState.rasterizerDiscardEnable);
+  io.field(rsState.innerCoverage);
+  io.field(rsState.perSampleShading);
+  io.field(rsState.usrClipPlaneMask);
+  io.field(rsState.numSamples);
+  io.field(rsState.pixelShaderSamples);
+  io.field(rsState.samplePatternIdx);
+  io.field(rsState.dynamicSampleInfo);
+  io.field(rsState.rasterStream);
+  io.field(rsState.provokingVertexMode);
+
+  auto &cbState = pipelineInfo.cbState;
+  io.field(cbState.alphaToCoverageEnable);
+  io.field(cbState.dualSourceBlendEnable);
+  io.field(cbState.dualSourceBlendDynamic);
+  for (auto &target : cbState.target)
+    mapFields(io, target);
+
+  mapFields(io, pipelineInfo.nggState);
+  mapFields(io, pipelineInfo.options);
+  io.field(pipelineInfo.unlinked);
+  io.field(pipelineInfo.enableInitUndefZero);
+  io.field(pipelineInfo.dynamicVertexStride);
+  io.field(pipelineInfo.enableUberFetchShader);
+  io.field(pipelineInfo.enableColorExportShader);
+  io.field(pipelineInfo.enableEarlyCompile);
+  io.field(pipelineInfo.useSoftwareVertexBufferDescriptors);
+  io.field(pipelineInfo.dynamicTopology);
+  io.array(pipelineInfo.outLocationMaps, ShaderStageGfxCount);
+  mapFields(io, pipelineInfo.rtState);
+
+  auto &glState = pipelineInfo.glState;
+  io.field(glState.originUpperLeft);
+  io.field(glState.vbAddressLowBitsKnown);
+  io.field(glState.enableBitmap);
+  io.field(glState.enableBitmapLsb);
+  io.field(glState.enableTwoSideLighting);
+  io.field(glState.numUniformConstantMaps);
+  io.array(glState.ppUniformMaps, glState.numUniformConstantMaps);
+  io.field(glState.apiXfbOutData.numXfbOutInfo);
+  io.array(glState.apiXfbOutData.pXfbOutInfos, glState.apiXfbOutData.numXfbOutInfo);
+  io.field(glState.apiXfbOutData.forceDisableStreamOut);
+  io.field(glState.drawPixelsType);
+  io.field(glState.vbAddressLowBits);
+  io.field(glState.pixelTransferScale);
+  io.field(glState.pixelTransferBias);
+  io.field(glState.enableColorClampVs);
+  io.field(glState.enableColorClampFs);
+  io.field(glState.enableFlatShade);
+  io.field(glState.lineSmooth);
+  io.field(glState.pointSmooth);
+  io.field(glState.enableMapClipDistMask);
+  io.field(glState.disablePointCoord);
+  io.field(glState.alphaTestFunc);
+  io.field(glState.numTexPointSprite);
+  io.field(glState.texPointSpriteLocs);
+
+  io.field(pipelineInfo.clientMetadataSize);
+  io.bytes(pipelineInfo.pClientMetadata, pipelineInfo.clientMetadataSize);
+  io.field(pipelineInfo.advancedBlendInfo.enableAdvancedBlend);
+  io.field(pipelineInfo.advancedBlendInfo.enableRov);
+  io.field(pipelineInfo.advancedBlendInfo.binding);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, ComputePipelineBuildInfo> pipelineInfo) {
+  io.field(pipelineInfo.pipelineApiHash);
+  io.field(pipelineInfo.deviceIndex);
+  mapFields(io, pipelineInfo.cs);
+  mapFields(io, pipelineInfo.resourceMapping);
+  io.field(pipelineInfo.pipelineLayoutApiHash);
+  mapFields(io, pipelineInfo.options);
+  io.field(pipelineInfo.unlinked);
+  mapFields(io, pipelineInfo.rtState);
+  io.field(pipelineInfo.clientMetadataSize);
+  io.bytes(pipelineInfo.pClientMetadata, pipelineInfo.clientMetadataSize);
+  io.array(pipelineInfo.pUniformMap, 1);
+  io.array(pipelineInfo.transformGraphicsPipeline, 1);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, VkRayTracingShaderGroupCreateInfoKHR> group) {
+  io.field(group.sType);
+  io.unsupported(group.pNext, "A structure chained to a shader group");
+  io.field(group.type);
+  io.field(group.generalShader);
+  io.field(group.closestHitShader);
+  io.field(group.anyHitShader);
+  io.field(group.intersectionShader);
+  io.unsupported(group.pShaderGroupCaptureReplayHandle, "A shader group capture/replay handle");
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, RayTracingPipelineBuildInfo> pipelineInfo) {
+  io.field(pipelineInfo.pipelineApiHash);
+  io.field(pipelineInfo.deviceIndex);
+  io.field(pipelineInfo.deviceCount);
+  io.field(pipelineInfo.shaderCount);
+  io.array(pipelineInfo.pShaders, pipelineInfo.shaderCount);
+  mapFields(io, pipelineInfo.resourceMapping);
+  io.field(pipelineInfo.pipelineLayoutApiHash);
+  io.field(pipelineInfo.shaderGroupCount);
+  io.array(pipelineInfo.pShaderGroups, pipelineInfo.shaderGroupCount);
+  io.field(pipelineInfo.libraryMode);
+  io.field(pipelineInfo.libraryCount);
+  io.array(pipelineInfo.pLibrarySummaries, pipelineInfo.libraryCount);
+  mapFields(io, pipelineInfo.options);
+  io.field(pipelineInfo.maxRecursionDepth);
+  io.field(pipelineInfo.indirectStageMask);
+  io.field(pipelineInfo.mode);
+  mapFields(io, pipelineInfo.rtState);
+  io.field(pipelineInfo.hasPipelineLibrary);
+  io.field(pipelineInfo.pipelineLibStageMask);
+  io.field(pipelineInfo.payloadSizeMaxInLib);
+  io.field(pipelineInfo.attributeSizeMaxInLib);
+  io.field(pipelineInfo.isReplay);
+  io.field(pipelineInfo.clientMetadataSize);
+  io.bytes(pipelineInfo.pClientMetadata, pipelineInfo.clientMetadataSize);
+  io.field(pipelineInfo.cpsFlags);
+  io.field(pipelineInfo.disableDynamicVgpr);
+  io.field(pipelineInfo.dynamicVgprBlockSize);
+  io.field(pipelineInfo.rtIgnoreDeclaredPayloadSize);
+}
+
+// =====================================================================================================================
+template <class IO> void mapFields(IO &io, FieldRef<IO, PipelineCaptureStage> stage) {
+  io.field(stage.stage);
+  mapFields(io, stage.spirv);
+}
+
+// =====================================================================================================================
+// Maps one element of a pointed-to array: a pointer element is itself an optional single object.
+//
+// @param io : Writer or reader of the capture
+// @param element : The element
+template <class IO, class T> void mapElement(IO &io, T &element) {
+  if constexpr (std::is_pointer_v<std::remove_cv_t<T>>)
+    io.array(element, 1);
+  else if constexpr (std::is_class_v<T>)
+    mapFields(io, element);
+  else
+    io.field(element);
+}
+
+// =====================================================================================================================
+// Writes the capture of a pipeline.
+//
+// @param pipelineInfo : Build info of the pipeline
+// @param stages : SPIR-V of the shaders of the pipeline
+Result PipelineCaptureWriter::write(PipelineBuildInfo pipelineInfo, ArrayRef<PipelineCaptureStage> stages) {
+  m_out.assign(PipelineCaptureMagic, sizeof(PipelineCaptureMagic));
+  const uint32_t interfaceVersion = Version;
+  field(PipelineCaptureFormatVersion);
+  field(interfaceVersion);
+  if (pipelineInfo.pGraphicsInfo) {
+    field(PipelineCaptureType::Graphics);
+    array(pipelineInfo.pGraphicsInfo, 1);
+  } else if (pipelineInfo.pComputeInfo) {
+    field(PipelineCaptureType::Compute);
+    array(pipelineInfo.pComputeInfo, 1);
+  } else if (pipelineInfo.pRayTracingInfo) {
+    field(PipelineCaptureType::RayTracing);
+    array(pipelineInfo.pRayTracingInfo, 1);
+  } else {
+    fail("No pipeline build info to capture");
+    return Result::ErrorInvalidValue;
+  }
+
+  const uint64_t stageCount = stages.size();
+  field(stageCount);
+  array(stages.data(), stageCount);
+  return m_error.empty() ? Result::Success : Result::Unsupported;
+}
+
+} // anonymous namespace
+
+// =====================================================================================================================
+PipelineCapture::PipelineCapture(std::unique_ptr<MemoryBuffer> buffer)
+    : m_buffer(std::move(buffer)), m_pipelineInfo() {
+}
+
+// =====================================================================================================================
+PipelineCapture::~PipelineCapture() = default;
+
+// =====================================================================================================================
+// Serializes a pipeline build info, and the SPIR-V of the shaders of the pipeline, into a capture.
+//
+// @param pipelineInfo : Build info of the pipeline
+// @param stages : SPIR-V of the shaders of the pipeline
+// @param [out] out : The capture
+// @param [out] errorMsg : Why the pipeline cannot be captured, on failure
+Result PipelineCapture::write(PipelineBuildInfo pipelineInfo, ArrayRef<PipelineCaptureStage> stages, std::string &out,
+                              std::string &errorMsg) {
+  PipelineCaptureWriter writer(out);
+  Result result = writer.write(pipelineInfo, stages);
+  if (result != Result::Success) {
+    out.clear();
+    errorMsg = writer.getError();
+  }
+  return result;
+}
+
+// =====================================================================================================================
+// Loads a capture from a file. The file is mapped, and the build info decoded from it without any parsing.
+//
+// @param fileName : Name of the capture file
+// @param [out] capture : The loaded capture
+// @param [out] errorMsg : Why the capture cannot be loaded, on failure
+Result PipelineCapture::load(const char *fileName, std::unique_ptr<PipelineCapture> &capture, std::string &errorMsg) {
+  auto bufferOrErr = MemoryBuffer::getFile(fileName, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!bufferOrErr) {
+    errorMsg = bufferOrErr.getError().message();
+    return Result::NotFound;
+  }
+  std::unique_ptr<PipelineCapture> newCapture(new PipelineCapture(std::move(*bufferOrErr)));
+  const StringRef data = newCapture->m_buffer->getBuffer();
+  if (!data.starts_with(StringRef(PipelineCaptureMagic, sizeof(PipelineCaptureMagic)))) {
+    errorMsg = "Not a pipeline capture";
+    return Result::ErrorInvalidValue;
+  }
+
+  PipelineCaptureReader reader(data, sizeof(PipelineCaptureMagic), newCapture->m_allocator);
+  uint32_t formatVersion = 0;
+  uint32_t interfaceVersion = 0;
+  reader.field(formatVersion);
+  reader.field(interfaceVersion);
+  if (formatVersion != PipelineCaptureFormatVersion || interfaceVersion != Version) {
+    errorMsg = (Twine("Pipeline capture has format version ") + Twine(formatVersion) + " and interface version " +
+                Twine(interfaceVersion) + ", expected " + Twine(PipelineCaptureFormatVersion) + " and " +
+                Twine(Version))
+                   .str();
+    return Result::ErrorInvalidValue;
+  }
+
+  PipelineBuildInfo &pipelineInfo = newCapture->m_pipelineInfo;
+  PipelineCaptureType type = {};
+  reader.field(type);
+  switch (type) {
+  case PipelineCaptureType::Graphics:
+    reader.array(pipelineInfo.pGraphicsInfo, 1);
+    break;
+  case PipelineCaptureType::Compute:
+    reader.array(pipelineInfo.pComputeInfo, 1);
+    break;
+  case PipelineCaptureType::RayTracing:
+    reader.array(pipelineInfo.pRayTracingInfo, 1);
+    break;
+  default:
+    reader.fail("Unknown captured pipeline type");
+    break;
+  }
+
+  uint64_t stageCount = 0;
+  const PipelineCaptureStage *stages = nullptr;
+  reader.field(stageCount);
+  reader.array(stages, stageCount);
+  newCapture->m_stages = ArrayRef(stages, stages ? stageCount : 0);
+
+  if (!reader.atEnd()) {
+    errorMsg = reader.getError().empty() ? "Unexpected data at the end of the pipeline capture" : reader.getError();
+    return Result::ErrorInvalidValue;
+  }
+  if (!pipelineInfo.pGraphicsInfo && !pipelineInfo.pComputeInfo && !pipelineInfo.pRayTracingInfo) {
+    errorMsg = "Pipeline capture has no build info";
+    return Result::ErrorInvalidValue;
+  }
+  capture = std::move(newCapture);
+  return Result::Success;
+}
+
+} // namespace Vkgc
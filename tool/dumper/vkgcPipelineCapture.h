@@ -0,0 +1,91 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ *  deal in the Software without restriction, including without limitation the
+ *  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ *  sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  vkgcPipelineCapture.h
+ * @brief VKGC header file: contains definitions of the VKGC binary pipeline capture format
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "vkgcDefs.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Allocator.h"
+#include <memory>
+#include <string>
+
+namespace llvm {
+class MemoryBuffer;
+} // namespace llvm
+
+namespace Vkgc {
+
+// File extension of binary pipeline captures
+constexpr const char PipelineCaptureExt[] = ".pipecap";
+
+// Represents the SPIR-V of one shader of a captured pipeline. For a ray tracing pipeline, the i-th stage holds the
+// shader of pShaders[i]; otherwise a stage is identified by its shader stage.
+struct PipelineCaptureStage {
+  ShaderStage stage; // Shader stage
+  BinaryData spirv;  // SPIR-V binary
+};
+
+// =====================================================================================================================
+// Represents a binary pipeline capture: a pipeline build info, with everything it points to, and the SPIR-V of its
+// shaders.
+//
+// The build info is serialized field by field, in a fixed little-endian encoding, so the format does not depend on
+// how the compiler lays out the structures. Loading maps the file and decodes the fields straight into fresh
+// structures; the SPIR-V and other binary blobs are used in place. Nothing is parsed as text, but the field list must
+// be kept in step with vkgcDefs.h, and PipelineCaptureFormatVersion bumped when it changes. Anything the format cannot
+// represent, such as an unknown structure chained through a pNext or a shader group capture/replay handle, makes
+// writing the capture fail rather than being dropped. The .pipe text remains the portable format.
+class PipelineCapture {
+public:
+  ~PipelineCapture();
+
+  static Result write(PipelineBuildInfo pipelineInfo, llvm::ArrayRef<PipelineCaptureStage> stages, std::string &out,
+                      std::string &errorMsg);
+
+  static Result load(const char *fileName, std::unique_ptr<PipelineCapture> &capture, std::string &errorMsg);
+
+  // Gets the build info of the captured pipeline. It points into the capture, so is valid for its lifetime.
+  PipelineBuildInfo getPipelineInfo() const { return m_pipelineInfo; }
+
+  // Gets the shader stages of the captured pipeline. They point into the capture, so are valid for its lifetime.
+  llvm::ArrayRef<PipelineCaptureStage> getStages() const { return m_stages; }
+
+private:
+  PipelineCapture(std::unique_ptr<llvm::MemoryBuffer> buffer);
+  PipelineCapture(const PipelineCapture &) = delete;
+  PipelineCapture &operator=(const PipelineCapture &) = delete;
+
+  std::unique_ptr<llvm::MemoryBuffer> m_buffer;  // Mapped capture file
+  llvm::BumpPtrAllocator m_allocator;            // Allocator of the decoded structures
+  PipelineBuildInfo m_pipelineInfo;              // Build info of the captured pipeline
+  llvm::ArrayRef<PipelineCaptureStage> m_stages; // Shader stages of the captured pipeline
+};
+
+} // namespace Vkgc
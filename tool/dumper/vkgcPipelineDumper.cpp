@@ -30,13 +30,19 @@
 */
 #include "vkgcPipelineDumper.h"
 #include "vkgcElfReader.h"
+#include "vkgcPipelineCapture.h"
 #include "vkgcUtil.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <mutex>
 #include <sstream>
 #include <sys/stat.h>
+#include <thread>
 #include <unordered_set>
 
 #define DEBUG_TYPE "vkgc-pipeline-dumper"
@@ -91,16 +97,141 @@ private:
 // Mutex for pipeline dump
 static Mutex SDumpMutex;
 
+// =====================================================================================================================
+// Represents the background thread that runs the work of asynchronous pipeline dumps. Tasks run one at a time in the
+// order they were queued, so the writes to each dump file stay in order. The queue is bounded: once it is full, queuing
+// a task blocks until the background thread has caught up.
+//
+// The writer is created on first use and destroyed by shutdown(), which the compiler calls when its last instance is
+// destroyed. It is deliberately not a static object: joining its thread during static destruction could deadlock when
+// the compiler is loaded as a shared library.
+class AsyncDumpWriter {
+public:
+  // Gets the writer, creating it if there is none.
+  static AsyncDumpWriter &get() {
+    std::lock_guard<std::mutex> lock(s_instanceMutex);
+    if (!s_instance)
+      s_instance = new AsyncDumpWriter;
+    return *s_instance;
+  }
+
+  // Gets the writer if there is one, otherwise nullptr.
+  static AsyncDumpWriter *find() {
+    std::lock_guard<std::mutex> lock(s_instanceMutex);
+    return s_instance;
+  }
+
+  // Runs the queued tasks, then stops the background thread and destroys the writer. No dumps may be in progress.
+  static void shutdown() {
+    AsyncDumpWriter *writer = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(s_instanceMutex);
+      std::swap(writer, s_instance);
+    }
+    delete writer;
+  }
+
+  ~AsyncDumpWriter() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_shutdown = true;
+    }
+    m_taskQueued.notify_one();
+    if (m_thread.joinable())
+      m_thread.join();
+  }
+
+  // Queues a task to run on the background thread, starting the thread if this is the first task.
+  void enqueue(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_taskTaken.wait(lock, [this] { return m_tasks.size() < MaxQueuedTasks; });
+    m_tasks.push_back(std::move(task));
+    if (!m_thread.joinable())
+      m_thread = std::thread([this] { run(); });
+    lock.unlock();
+    m_taskQueued.notify_one();
+  }
+
+  // Waits until every queued task has finished.
+  void flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_taskTaken.wait(lock, [this] { return m_tasks.empty() && !m_busy; });
+  }
+
+private:
+  AsyncDumpWriter() = default;
+  AsyncDumpWriter(const AsyncDumpWriter &) = delete;
+  AsyncDumpWriter &operator=(const AsyncDumpWriter &) = delete;
+
+  // Runs queued tasks until shut down; tasks still queued at shutdown are run first.
+  void run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+      m_taskQueued.wait(lock, [this] { return !m_tasks.empty() || m_shutdown; });
+      if (m_tasks.empty())
+        return;
+      std::function<void()> task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+      m_busy = true;
+      lock.unlock();
+      m_taskTaken.notify_all();
+      task();
+      lock.lock();
+      m_busy = false;
+      m_taskTaken.notify_all();
+    }
+  }
+
+  static constexpr size_t MaxQueuedTasks = 64;
+
+  static std::mutex s_instanceMutex;  // Guards s_instance
+  static AsyncDumpWriter *s_instance; // The writer, or nullptr if there is none
+
+  std::mutex m_mutex;                        // Guards the fields below
+  std::condition_variable m_taskQueued;      // Signalled when a task is queued, or on shutdown
+  std::condition_variable m_taskTaken;       // Signalled when a task is taken from the queue or finishes
+  std::deque<std::function<void()>> m_tasks; // Queued tasks
+  bool m_busy = false;                       // Whether the background thread is running a task
+  bool m_shutdown = false;                   // Whether the background thread should exit once the queue is empty
+  std::thread m_thread;                      // The background thread
+};
+
+std::mutex AsyncDumpWriter::s_instanceMutex;
+AsyncDumpWriter *AsyncDumpWriter::s_instance = nullptr;
+
 // =====================================================================================================================
 // Represents the file objects for pipeline dump
+//
+// For an asynchronous dump, text is formatted into an in-memory buffer on the compiling thread, and the file writes
+// (and the disassembly of pipeline binaries) are done on the background dump writer. Once a dump file is asynchronous,
+// its file objects are only accessed by the background thread.
 struct PipelineDumpFile {
-  PipelineDumpFile(const char *dumpFileName, const char *binaryFileName)
-      : dumpFile(dumpFileName), binaryIndex(0), binaryFileName(binaryFileName) {}
-
-  std::ofstream dumpFile;     // File object for .pipe file
-  std::ofstream binaryFile;   // File object for ELF binary
-  unsigned binaryIndex;       // ELF Binary index
-  std::string binaryFileName; // File name of binary file
+  PipelineDumpFile(const char *dumpFileName, const char *binaryFileName, bool async)
+      : dumpFile(dumpFileName), binaryIndex(0), binaryFileName(binaryFileName), async(async) {}
+
+  // Gets the stream to format text for the .pipe file into.
+  std::ostream &stream() { return async ? pendingText : dumpFile; }
+
+  // Runs a task that writes to the dump files: for an asynchronous dump, queues it on the background dump writer after
+  // the text formatted so far; otherwise runs it now.
+  void run(std::function<void()> task) {
+    if (!async) {
+      task();
+      return;
+    }
+    std::string text = pendingText.str();
+    pendingText.str("");
+    if (!text.empty())
+      AsyncDumpWriter::get().enqueue([this, text = std::move(text)] { dumpFile << text; });
+    AsyncDumpWriter::get().enqueue(std::move(task));
+  }
+
+  std::ofstream dumpFile;         // File object for .pipe file
+  std::ofstream binaryFile;       // File object for ELF binary
+  unsigned binaryIndex;           // ELF Binary index
+  std::string binaryFileName;     // File name of binary file
+  bool async;                     // Whether the files are written by the background dump writer
+  std::ostringstream pendingText; // Text formatted for the .pipe file but not yet written (asynchronous dump only)
 };
 
 // =====================================================================================================================
@@ -181,16 +312,16 @@ void VKAPI_CALL IPipelineDumper::DumpGraphicsLibraryFileName(void *dumpFile, con
     return;
 
   PipelineDumpFile *pipelineDumper = reinterpret_cast<PipelineDumpFile *>(dumpFile);
-  pipelineDumper->dumpFile << "\n[GraphicsLibrary]\n";
+  pipelineDumper->stream() << "\n[GraphicsLibrary]\n";
   static const char *libTypeName[] = {"preRaster", "fragment", "colorExport"};
   static const char *pipelineExt = ".pipe";
   for (unsigned i = 0; i < 3; i++) {
     std::string tmpStr(libFileNames[i]);
     if (!tmpStr.empty()) {
-      pipelineDumper->dumpFile << libTypeName[i] << "=" << tmpStr << pipelineExt << "\n";
+      pipelineDumper->stream() << libTypeName[i] << "=" << tmpStr << pipelineExt << "\n";
     }
   }
-  pipelineDumper->dumpFile << "\n";
+  pipelineDumper->stream() << "\n";
 }
 
 // =====================================================================================================================
@@ -518,7 +649,7 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
 
     // Open dump file
     if (enableDump) {
-      dumpFile = new PipelineDumpFile(dumpPathName.c_str(), dumpBinaryName.c_str());
+      dumpFile = new PipelineDumpFile(dumpPathName.c_str(), dumpBinaryName.c_str(), dumpOptions->asyncDump);
       if (dumpFile->dumpFile.bad()) {
         delete dumpFile;
         dumpFile = nullptr;
@@ -530,13 +661,16 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
     // Dump pipeline input info
     if (dumpFile) {
       if (pipelineInfo.pComputeInfo)
-        dumpComputePipelineInfo(&dumpFile->dumpFile, dumpOptions->pDumpDir, pipelineInfo.pComputeInfo);
+        dumpComputePipelineInfo(&dumpFile->stream(), dumpOptions->pDumpDir, pipelineInfo.pComputeInfo);
 
       if (pipelineInfo.pGraphicsInfo)
-        dumpGraphicsPipelineInfo(&dumpFile->dumpFile, dumpOptions->pDumpDir, pipelineInfo.pGraphicsInfo);
+        dumpGraphicsPipelineInfo(&dumpFile->stream(), dumpOptions->pDumpDir, pipelineInfo.pGraphicsInfo);
 
       if (pipelineInfo.pRayTracingInfo)
-        dumpRayTracingPipelineInfo(&dumpFile->dumpFile, dumpOptions->pDumpDir, pipelineInfo.pRayTracingInfo);
+        dumpRayTracingPipelineInfo(&dumpFile->stream(), dumpOptions->pDumpDir, pipelineInfo.pRayTracingInfo);
+
+      if (dumpOptions->dumpCapture)
+        dumpPipelineCapture(dumpFile, pipelineInfo);
     }
   }
 
@@ -544,11 +678,79 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
 }
 
 // =====================================================================================================================
-// Ends to dump graphics/compute pipeline info.
+// Dumps the binary capture of a pipeline, next to its pipeline binary. The capture is serialized on the calling thread,
+// as the build info is only valid until the pipeline is built, but written out as part of the dump.
+//
+// @param dumpFile : Dump file
+// @param pipelineInfo : Info of the pipeline to be built
+void PipelineDumper::dumpPipelineCapture(PipelineDumpFile *dumpFile, PipelineBuildInfo pipelineInfo) {
+  auto getSpirv = [](const PipelineShaderInfo &shaderInfo) {
+    BinaryData spirv = {};
+    auto moduleData = reinterpret_cast<const ShaderModuleData *>(shaderInfo.pModuleData);
+    if (moduleData && moduleData->binType == BinaryType::Spirv)
+      spirv = moduleData->binCode;
+    return spirv;
+  };
+
+  std::vector<PipelineCaptureStage> stages;
+  if (auto graphicsInfo = pipelineInfo.pGraphicsInfo) {
+    const std::pair<ShaderStage, const PipelineShaderInfo *> shaderInfos[] = {
+        {ShaderStageTask, &graphicsInfo->task},      {ShaderStageVertex, &graphicsInfo->vs},
+        {ShaderStageTessControl, &graphicsInfo->tcs}, {ShaderStageTessEval, &graphicsInfo->tes},
+        {ShaderStageGeometry, &graphicsInfo->gs},     {ShaderStageMesh, &graphicsInfo->mesh},
+        {ShaderStageFragment, &graphicsInfo->fs}};
+    for (const auto &shaderInfo : shaderInfos) {
+      BinaryData spirv = getSpirv(*shaderInfo.second);
+      if (spirv.codeSize != 0)
+        stages.push_back({shaderInfo.first, spirv});
+    }
+  } else if (auto computeInfo = pipelineInfo.pComputeInfo) {
+    stages.push_back({ShaderStageCompute, getSpirv(computeInfo->cs)});
+  } else if (auto rayTracingInfo = pipelineInfo.pRayTracingInfo) {
+    for (unsigned i = 0; i < rayTracingInfo->shaderCount; ++i)
+      stages.push_back({rayTracingInfo->pShaders[i].entryStage, getSpirv(rayTracingInfo->pShaders[i])});
+  }
+
+  std::string capture;
+  std::string errorMsg;
+  if (PipelineCapture::write(pipelineInfo, stages, capture, errorMsg) != Result::Success) {
+    errs() << "Failed to dump pipeline capture for " << dumpFile->binaryFileName << ": " << errorMsg << "\n";
+    return;
+  }
+
+  auto extPos = dumpFile->binaryFileName.rfind('.');
+  assert(extPos != std::string::npos);
+  std::string captureFileName = dumpFile->binaryFileName.substr(0, extPos) + PipelineCaptureExt;
+
+  dumpFile->run([captureFileName, capture = std::move(capture)] {
+    std::ofstream captureFile(captureFileName.c_str(), std::ostream::out | std::ostream::binary);
+    if (!captureFile.bad())
+      captureFile.write(capture.data(), capture.size());
+  });
+}
+
+// =====================================================================================================================
+// Ends to dump graphics/compute pipeline info. For an asynchronous dump, the dump file is closed once the background
+// dump writer has finished writing it.
 //
 // @param dumpFile : Dump file
 void PipelineDumper::EndPipelineDump(PipelineDumpFile *dumpFile) {
-  delete dumpFile;
+  if (dumpFile)
+    dumpFile->run([dumpFile] { delete dumpFile; });
+}
+
+// =====================================================================================================================
+// Waits until the background dump writer has finished all the work of asynchronous pipeline dumps queued so far.
+void PipelineDumper::FlushAsyncDumps() {
+  if (AsyncDumpWriter *writer = AsyncDumpWriter::find())
+    writer->flush();
+}
+
+// =====================================================================================================================
+// Finishes the work of asynchronous pipeline dumps queued so far and stops the background dump writer. This must only
+// be called when no pipeline dumps are in progress; a later asynchronous dump starts a new writer.
+void PipelineDumper::ShutdownAsyncDumps() {
+  AsyncDumpWriter::shutdown();
 }
 
 // =====================================================================================================================
@@ -774,18 +976,27 @@ void PipelineDumper::dumpResourceMappingInfo(const ResourceMappingData *resource
 // @param dumpDir : Directory of pipeline dump
 // @param spirvBin : SPIR-V binary
 // @param hash : Pipeline hash code
-void PipelineDumper::DumpSpirvBinary(const char *dumpDir, const BinaryData *spirvBin, MetroHash::Hash *hash) {
-  std::string pathName = dumpDir;
-  pathName += "/";
-  pathName += getSpirvBinaryFileName(hash);
-
-  // Make sure directory exists
-  createDirectory(dumpDir);
+// @param async : Whether to write the file on the background dump writer, from a copy of the binary
+void PipelineDumper::DumpSpirvBinary(const char *dumpDir, const BinaryData *spirvBin, MetroHash::Hash *hash,
+                                     bool async) {
+  std::string dirName = dumpDir;
+  std::string pathName = dirName + "/" + getSpirvBinaryFileName(hash);
+  auto writeSpirv = [dirName, pathName](const char *code, size_t codeSize) {
+    // Make sure directory exists
+    createDirectory(dirName.c_str());
+
+    // Open dumpfile
+    std::ofstream dumpFile(pathName.c_str(), std::ios_base::binary | std::ios_base::out);
+    if (!dumpFile.bad())
+      dumpFile.write(code, codeSize);
+  };
 
-  // Open dumpfile
-  std::ofstream dumpFile(pathName.c_str(), std::ios_base::binary | std::ios_base::out);
-  if (!dumpFile.bad())
-    dumpFile.write(reinterpret_cast<const char *>(spirvBin->pCode), spirvBin->codeSize);
+  if (!async) {
+    writeSpirv(static_cast<const char *>(spirvBin->pCode), spirvBin->codeSize);
+    return;
+  }
+  std::string code(static_cast<const char *>(spirvBin->pCode), spirvBin->codeSize);
+  AsyncDumpWriter::get().enqueue([writeSpirv, code = std::move(code)] { writeSpirv(code.data(), code.size()); });
 }
 
 // =====================================================================================================================
@@ -801,29 +1012,39 @@ void PipelineDumper::DumpPipelineBinary(PipelineDumpFile *dumpFile, GfxIpVersion
   if (!pipelineBin->pCode || pipelineBin->codeSize == 0)
     return;
 
-  ElfReader<Elf64> reader(gfxIp);
-  size_t codeSize = pipelineBin->codeSize;
-
-  auto result = reader.ReadFromBuffer(pipelineBin->pCode, &codeSize);
-  assert(result == Result::Success);
-  (void(result)); // unused
-
-  dumpFile->dumpFile << "\n[CompileLog]\n";
-  dumpFile->dumpFile << reader;
-
   std::string binaryFileName = dumpFile->binaryFileName;
   if (dumpFile->binaryIndex > 0) {
     char suffixBuffer[32] = {};
     snprintf(suffixBuffer, sizeof(suffixBuffer), ".%u", dumpFile->binaryIndex);
     binaryFileName += suffixBuffer;
   }
-
   dumpFile->binaryIndex++;
-  dumpFile->binaryFile.open(binaryFileName.c_str(), std::ostream::out | std::ostream::binary);
-  if (!dumpFile->binaryFile.bad()) {
-    dumpFile->binaryFile.write(reinterpret_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize);
-    dumpFile->binaryFile.close();
+
+  // The disassembly is the expensive part of the dump, so it is done along with the file writes.
+  auto writeBinary = [dumpFile, gfxIp, binaryFileName](const char *code, size_t codeSize) {
+    ElfReader<Elf64> reader(gfxIp);
+    size_t readSize = codeSize;
+
+    auto result = reader.ReadFromBuffer(code, &readSize);
+    assert(result == Result::Success);
+    (void(result)); // unused
+
+    dumpFile->dumpFile << "\n[CompileLog]\n";
+    dumpFile->dumpFile << reader;
+
+    dumpFile->binaryFile.open(binaryFileName.c_str(), std::ostream::out | std::ostream::binary);
+    if (!dumpFile->binaryFile.bad()) {
+      dumpFile->binaryFile.write(code, codeSize);
+      dumpFile->binaryFile.close();
+    }
+  };
+
+  if (!dumpFile->async) {
+    writeBinary(static_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize);
+    return;
   }
+  std::string code(static_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize);
+  dumpFile->run([writeBinary, code = std::move(code)] { writeBinary(code.data(), code.size()); });
 }
 
 // =====================================================================================================================
@@ -833,7 +1054,7 @@ void PipelineDumper::DumpPipelineBinary(PipelineDumpFile *dumpFile, GfxIpVersion
 // @param str : Extra info string
 void PipelineDumper::DumpPipelineExtraInfo(PipelineDumpFile *dumpFile, const std::string *str) {
   if (dumpFile)
-    dumpFile->dumpFile << *str;
+    dumpFile->stream() << *str;
 }
 
 // =====================================================================================================================
@@ -849,12 +1070,12 @@ void PipelineDumper::DumpFragmentOutputs(PipelineDumpFile *dumpFile, const uint8
   assert(size % 4 == 0);
   const uint32_t *intData = reinterpret_cast<const uint32_t *>(data);
 
-  dumpFile->dumpFile << "\n[FsOutput]\n";
-  dumpFile->dumpFile << "data=";
+  dumpFile->stream() << "\n[FsOutput]\n";
+  dumpFile->stream() << "data=";
   for (unsigned idx = 0; idx < size / 4; idx++) {
-    dumpFile->dumpFile << intData[idx] << ", ";
+    dumpFile->stream() << intData[idx] << ", ";
   }
-  dumpFile->dumpFile << "\n\n";
+  dumpFile->stream() << "\n\n";
 }
 
 // =====================================================================================================================
@@ -870,9 +1091,9 @@ void PipelineDumper::DumpPm4Crc(PipelineDumpFile *dumpFile, GfxIpVersion gfxIp,
   size_t readSize = 0;
   if (reader.ReadFromBuffer(pipelineBin->pCode, &readSize) == Result::Success) {
     unsigned sectionCount = reader.getSectionCount();
-    bool sortSection = reader.getMap().size() == sectionCount;
+    bool sortSection = reader.getSectionNameIndex().size() == sectionCount;
     for (unsigned idx = 0; idx < sectionCount; ++idx) {
-      typename ElfReader<Elf64>::SectionBuffer *section = nullptr;
+      const typename ElfReader<Elf64>::SectionBuffer *section = nullptr;
       Result result = Result::Success;
       unsigned secIdx = idx;
       if (sortSection) {
@@ -885,7 +1106,7 @@ void PipelineDumper::DumpPm4Crc(PipelineDumpFile *dumpFile, GfxIpVersion gfxIp,
         // .text section
         std::vector<ElfSymbol> symbols;
         reader.GetSymbolsBySectionIndex(secIdx, symbols);
-        dumpFile->dumpFile << "\n";
+        dumpFile->stream() << "\n";
         for (auto sym : symbols) {
           // S_ENDPGM hardware opcode value
           static const uint32_t endPgm = (gfxIp.major == 11 || gfxIp.major == 12) ? 0xBFB00000 : 0xBF810000;
@@ -899,7 +1120,7 @@ void PipelineDumper::DumpPm4Crc(PipelineDumpFile *dumpFile, GfxIpVersion gfxIp,
             // nothing
           }
           auto crc = calculateCrc64(symCode, endPos * sizeof(uint32_t));
-          dumpFile->dumpFile << ";" << sym.pSymName << "_pm4Crc = " << std::hex << crc << "\n";
+          dumpFile->stream() << ";" << sym.pSymName << "_pm4Crc = " << std::hex << crc << "\n";
         }
       }
     }
@@ -1011,6 +1232,7 @@ void PipelineDumper::dumpPipelineOptions(const PipelineOptions *options, std::os
   dumpFile << "options.disablePerCompFetch = " << options->disablePerCompFetch << "\n";
   dumpFile << "options.optimizePointSizeWrite = " << options->optimizePointSizeWrite << "\n";
   dumpFile << "options.padBufferSizeToNextDword = " << options->padBufferSizeToNextDword << "\n";
+  dumpFile << "options.compileTimeBudgetMs = " << options->compileTimeBudgetMs << "\n";
 
   // Output compile time constant info
   if (options->compileConstInfo) {
@@ -1463,11 +1685,20 @@ void PipelineDumper::dumpRayTracingPipelineMetadata(PipelineDumpFile *dumpFile,
   assert(extPos != std::string::npos);
   std::string metaFileName = dumpFile->binaryFileName.substr(0, extPos) + ".meta";
 
-  dumpFile->binaryFile.open(metaFileName.c_str(), std::ostream::out | std::ostream::binary);
-  if (!dumpFile->binaryFile.bad()) {
-    dumpFile->binaryFile.write(reinterpret_cast<const char *>(pipelineMeta->pCode), pipelineMeta->codeSize);
-    dumpFile->binaryFile.close();
+  auto writeMeta = [dumpFile, metaFileName](const char *code, size_t codeSize) {
+    dumpFile->binaryFile.open(metaFileName.c_str(), std::ostream::out | std::ostream::binary);
+    if (!dumpFile->binaryFile.bad()) {
+      dumpFile->binaryFile.write(code, codeSize);
+      dumpFile->binaryFile.close();
+    }
+  };
+
+  if (!dumpFile->async) {
+    writeMeta(static_cast<const char *>(pipelineMeta->pCode), pipelineMeta->codeSize);
+    return;
   }
+  std::string code(static_cast<const char *>(pipelineMeta->pCode), pipelineMeta->codeSize);
+  dumpFile->run([writeMeta, code = std::move(code)] { writeMeta(code.data(), code.size()); });
 }
 
 // =====================================================================================================================
@@ -1488,13 +1719,22 @@ void PipelineDumper::dumpRayTracingLibrarySummary(PipelineDumpFile *dumpFile, co
   std::string metaFileName = dumpFile->binaryFileName.substr(0, extPos) + ".summary";
 
   // Write the summary as human-readable YAML if possible, using the YAML support in LLVM.
-  std::error_code ec;
-  raw_fd_ostream outfile(metaFileName, ec);
-  if (!ec) {
-    msgpack::Document doc;
-    doc.readFromBlob(StringRef(static_cast<const char *>(librarySummary->pCode), librarySummary->codeSize), false);
-    doc.toYAML(outfile);
+  auto writeSummary = [metaFileName](const char *code, size_t codeSize) {
+    std::error_code ec;
+    raw_fd_ostream outfile(metaFileName, ec);
+    if (!ec) {
+      msgpack::Document doc;
+      doc.readFromBlob(StringRef(code, codeSize), false);
+      doc.toYAML(outfile);
+    }
+  };
+
+  if (!dumpFile->async) {
+    writeSummary(static_cast<const char *>(librarySummary->pCode), librarySummary->codeSize);
+    return;
   }
+  std::string code(static_cast<const char *>(librarySummary->pCode), librarySummary->codeSize);
+  dumpFile->run([writeSummary, code = std::move(code)] { writeSummary(code.data(), code.size()); });
 }
 
 // =====================================================================================================================
@@ -2060,6 +2300,7 @@ void PipelineDumper::updateHashForPipelineOptions(const PipelineOptions *options
   // disablePerCompFetch has been handled in updateHashForNonFragmentState
   hasher->Update(options->optimizePointSizeWrite);
   hasher->Update(options->padBufferSizeToNextDword);
+  // compileTimeBudgetMs is not hashed: a pipeline built with reduced optimization is never added to the cache.
   hasher->Update(options->compileConstInfo != nullptr);
   if (options->compileConstInfo != nullptr) {
     hasher->Update(options->compileConstInfo->numCompileTimeConstants);
@@ -2375,11 +2616,11 @@ template <class OStream, class Elf>
 // @param reader : ELF object
 OStream &operator<<(OStream &out, ElfReader<Elf> &reader) {
   unsigned sectionCount = reader.getSectionCount();
-  bool sortSection = reader.getMap().size() == sectionCount;
+  bool sortSection = reader.getSectionNameIndex().size() == sectionCount;
   char formatBuf[256];
 
   for (unsigned idx = 0; idx < sectionCount; ++idx) {
-    typename ElfReader<Elf>::SectionBuffer *section = nullptr;
+    const typename ElfReader<Elf>::SectionBuffer *section = nullptr;
     Result result = Result::Success;
     unsigned secIdx = idx;
     if (sortSection) {
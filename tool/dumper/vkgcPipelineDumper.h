@@ -55,13 +55,18 @@ class PipelineDumper {
 public:
   typedef Util::MetroHash64 MetroHash64;
 
-  static void DumpSpirvBinary(const char *dumpDir, const BinaryData *spirvBin, MetroHash::Hash *hash);
+  static void DumpSpirvBinary(const char *dumpDir, const BinaryData *spirvBin, MetroHash::Hash *hash,
+                              bool async = false);
 
   static PipelineDumpFile *BeginPipelineDump(const PipelineDumpOptions *dumpOptions, PipelineBuildInfo pipelineInfo,
                                              const uint64_t hashCode64);
 
   static void EndPipelineDump(PipelineDumpFile *dumpFile);
 
+  static void FlushAsyncDumps();
+
+  static void ShutdownAsyncDumps();
+
   static void DumpPipelineBinary(PipelineDumpFile *binaryFile, GfxIpVersion gfxIp, const BinaryData *pipelineBin);
 
   static void DumpPipelineExtraInfo(PipelineDumpFile *binaryFile, const std::string *str);
@@ -141,6 +146,7 @@ private:
   static void dumpGraphicsStateInfo(const GraphicsPipelineBuildInfo *pipelineInfo, const char *dumpDir,
                                     std::ostream &dumpFile);
   static void dumpPipelineOptions(const PipelineOptions *options, std::ostream &dumpFile);
+  static void dumpPipelineCapture(PipelineDumpFile *dumpFile, PipelineBuildInfo pipelineInfo);
 
   static void updateHashForResourceMappingNode(const ResourceMappingNode *userDataNode, bool isRootNode,
                                                MetroHash64 *hasher);
@@ -31,6 +31,7 @@
 #include "vkgcElfReader.h"
 #include "llvm/Support/MathExtras.h"
 #include <algorithm>
+#include <iterator>
 #include <string.h>
 
 #define DEBUG_TYPE "vkgc-elf-reader"
@@ -45,14 +46,7 @@ namespace Vkgc {
 template <class Elf>
 ElfReader<Elf>::ElfReader(GfxIpVersion gfxIp)
     : m_gfxIp(gfxIp), m_header(), m_symSecIdx(InvalidValue), m_relocSecIdx(InvalidValue), m_strtabSecIdx(InvalidValue),
-      m_textSecIdx(InvalidValue) {
-}
-
-// =====================================================================================================================
-template <class Elf> ElfReader<Elf>::~ElfReader() {
-  for (auto section : m_sections)
-    delete section;
-  m_sections.clear();
+      m_textSecIdx(InvalidValue), m_noteSecIdx(InvalidValue) {
 }
 
 // =====================================================================================================================
@@ -103,6 +97,8 @@ template <class Elf> Result ElfReader<Elf>::ReadFromBuffer(const void *buffer, s
         reinterpret_cast<const typename Elf::SectionHeader *>(data + sectionStrTableHeaderOffset);
     const unsigned sectionStrTableOffset = static_cast<unsigned>(sectionStrTableHeader->sh_offset);
 
+    m_sections.reserve(sectionHeaderNum);
+    m_sectionNames.reserve(sectionHeaderNum);
     for (unsigned section = 0; section < sectionHeaderNum; section++) {
       // Where the header is located for this section
       const unsigned sectionOffset = sectionHeaderOffset + (section * sectionHeaderSize);
@@ -113,23 +109,30 @@ template <class Elf> Result ElfReader<Elf>::ReadFromBuffer(const void *buffer, s
       const unsigned sectionNameOffset = sectionStrTableOffset + sectionHeader->sh_name;
       const char *sectionName = reinterpret_cast<const char *>(data + sectionNameOffset);
 
-      // Where the data is located for this section
+      // Where the data is located for this section. The section refers to the input buffer in place.
       const unsigned sectionDataOffset = static_cast<unsigned>(sectionHeader->sh_offset);
-      auto buf = new SectionBuffer;
+      SectionBuffer buf = {};
+      buf.secHead = *sectionHeader;
+      buf.name = sectionName;
+      buf.data = (data + sectionDataOffset);
 
-      result = buf ? Result::Success : Result::ErrorOutOfMemory;
+      readSize += static_cast<size_t>(sectionHeader->sh_size);
 
-      if (result == Result::Success) {
-        buf->secHead = *sectionHeader;
-        buf->name = sectionName;
-        buf->data = (data + sectionDataOffset);
-
-        readSize += static_cast<size_t>(sectionHeader->sh_size);
+      m_sections.push_back(buf);
+      m_sectionNames.push_back({sectionName, section});
+    }
 
-        m_sections.push_back(buf);
-        m_map[sectionName] = section;
-      }
+    // Sort the name index for binary search. Where names are duplicated, keep only the last section of that name.
+    std::stable_sort(m_sectionNames.begin(), m_sectionNames.end(),
+                     [](const SectionNameEntry &lhs, const SectionNameEntry &rhs) { return lhs.first < rhs.first; });
+    auto uniqueEnd = m_sectionNames.begin();
+    for (auto it = m_sectionNames.begin(); it != m_sectionNames.end(); ++it) {
+      if (uniqueEnd != m_sectionNames.begin() && std::prev(uniqueEnd)->first == it->first)
+        std::prev(uniqueEnd)->second = it->second;
+      else
+        *uniqueEnd++ = *it;
     }
+    m_sectionNames.erase(uniqueEnd, m_sectionNames.end());
 
     *bufSize = readSize;
   }
@@ -141,10 +144,23 @@ template <class Elf> Result ElfReader<Elf>::ReadFromBuffer(const void *buffer, s
     m_relocSecIdx = GetSectionIndex(RelocAName);
   m_strtabSecIdx = GetSectionIndex(StrTabName);
   m_textSecIdx = GetSectionIndex(TextName);
+  m_noteSecIdx = GetSectionIndex(NoteName);
 
   return result;
 }
 
+// =====================================================================================================================
+// Gets the section index for the specified section name.
+//
+// @param name : Name of the section to look for
+// @returns : Index of the (last) section of that name, or InvalidValue if there is none
+template <class Elf> int32_t ElfReader<Elf>::GetSectionIndex(const char *name) const {
+  StringRef nameRef(name);
+  auto entry = std::lower_bound(m_sectionNames.begin(), m_sectionNames.end(), nameRef,
+                                [](const SectionNameEntry &lhs, StringRef rhs) { return lhs.first < rhs; });
+  return (entry != m_sectionNames.end() && entry->first == nameRef) ? entry->second : InvalidValue;
+}
+
 // =====================================================================================================================
 // Retrieves the section data for the specified section name, if it exists.
 //
@@ -155,11 +171,11 @@ template <class Elf>
 Result ElfReader<Elf>::GetSectionData(const char *name, const void **sectData, size_t *dataLength) const {
   Result result = Result::ErrorInvalidValue;
 
-  auto entry = m_map.find(name);
+  int32_t secIdx = GetSectionIndex(name);
 
-  if (entry != m_map.end()) {
-    *sectData = m_sections[entry->second]->data;
-    *dataLength = static_cast<size_t>(m_sections[entry->second]->secHead.sh_size);
+  if (secIdx >= 0) {
+    *sectData = m_sections[secIdx].data;
+    *dataLength = static_cast<size_t>(m_sections[secIdx].secHead.sh_size);
     result = Result::Success;
   }
 
@@ -172,7 +188,7 @@ template <class Elf> unsigned ElfReader<Elf>::getSymbolCount() const {
   unsigned symCount = 0;
   if (m_symSecIdx >= 0) {
     auto &section = m_sections[m_symSecIdx];
-    symCount = static_cast<unsigned>(section->secHead.sh_size / section->secHead.sh_entsize);
+    symCount = static_cast<unsigned>(section.secHead.sh_size / section.secHead.sh_entsize);
   }
   return symCount;
 }
@@ -184,11 +200,11 @@ template <class Elf> unsigned ElfReader<Elf>::getSymbolCount() const {
 // @param [out] symbol : Info of the symbol
 template <class Elf> void ElfReader<Elf>::getSymbol(unsigned idx, ElfSymbol *symbol) const {
   auto &section = m_sections[m_symSecIdx];
-  const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx]->data);
+  const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx].data);
 
-  auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section->data);
+  auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section.data);
   symbol->secIdx = symbols[idx].st_shndx;
-  symbol->secName = m_sections[symbol->secIdx]->name;
+  symbol->secName = m_sections[symbol->secIdx].name;
   symbol->pSymName = strTab + symbols[idx].st_name;
   symbol->size = symbols[idx].st_size;
   symbol->value = symbols[idx].st_value;
@@ -201,9 +217,9 @@ template <class Elf> void ElfReader<Elf>::getSymbol(unsigned idx, ElfSymbol *sym
 // @param symbolName : Symbol name
 template <class Elf> uint32_t ElfReader<Elf>::getSymbolIndexByName(const char *symbolName) const {
   auto &section = m_sections[m_symSecIdx];
-  const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx]->data);
+  const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx].data);
 
-  auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section->data);
+  auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section.data);
   unsigned symCount = getSymbolCount();
   for (unsigned idx = 0; idx < symCount; ++idx) {
     auto name = strTab + symbols[idx].st_name;
@@ -220,7 +236,7 @@ template <class Elf> unsigned ElfReader<Elf>::getRelocationCount() const {
   unsigned relocCount = 0;
   if (m_relocSecIdx >= 0) {
     auto &section = m_sections[m_relocSecIdx];
-    relocCount = static_cast<unsigned>(section->secHead.sh_size / section->secHead.sh_entsize);
+    relocCount = static_cast<unsigned>(section.secHead.sh_size / section.secHead.sh_entsize);
   }
   return relocCount;
 }
@@ -231,18 +247,18 @@ template <class Elf> unsigned ElfReader<Elf>::getRelocationCount() const {
 // @param idx : Relocation index
 // @param [out] reloc : Info of the relocation
 template <class Elf> void ElfReader<Elf>::getRelocation(unsigned idx, ElfReloc *reloc) const {
-  auto *section = m_sections[m_relocSecIdx];
+  auto &section = m_sections[m_relocSecIdx];
 
-  if (section->secHead.sh_type == SHT_REL) {
-    auto relocs = reinterpret_cast<const typename Elf::Reloc *>(section->data);
+  if (section.secHead.sh_type == SHT_REL) {
+    auto relocs = reinterpret_cast<const typename Elf::Reloc *>(section.data);
     reloc->offset = relocs[idx].r_offset;
     reloc->symIdx = relocs[idx].r_symbol;
     reloc->type = relocs[idx].r_type;
     reloc->addend = 0;
     reloc->useExplicitAddend = false;
   } else {
-    assert(section->secHead.sh_type == SHT_RELA);
-    auto relocs = reinterpret_cast<const typename Elf::RelocA *>(section->data);
+    assert(section.secHead.sh_type == SHT_RELA);
+    auto relocs = reinterpret_cast<const typename Elf::RelocA *>(section.data);
     reloc->offset = relocs[idx].r_offset;
     reloc->symIdx = relocs[idx].r_symbol;
     reloc->type = relocs[idx].r_type;
@@ -263,36 +279,55 @@ template <class Elf> unsigned ElfReader<Elf>::getSectionCount() {
 // @param secIdx : Section index
 // @param [out] ppSectionData : Section data
 template <class Elf>
-Result ElfReader<Elf>::getSectionDataBySectionIndex(unsigned secIdx, SectionBuffer **ppSectionData) const {
+Result ElfReader<Elf>::getSectionDataBySectionIndex(unsigned secIdx, const SectionBuffer **ppSectionData) const {
   Result result = Result::ErrorInvalidValue;
   if (secIdx < m_sections.size()) {
-    *ppSectionData = m_sections[secIdx];
+    *ppSectionData = &m_sections[secIdx];
     result = Result::Success;
   }
   return result;
 }
 
 // =====================================================================================================================
-// Gets section data by sorting index (ordered map).
+// Gets section data by sorting index (position in the name-sorted section index).
 //
 // @param sortIdx : Sorting index
 // @param [out] secIdx : Section index
 // @param [out] ppSectionData : Section data
 template <class Elf>
 Result ElfReader<Elf>::getSectionDataBySortingIndex(unsigned sortIdx, unsigned *secIdx,
-                                                    SectionBuffer **ppSectionData) const {
+                                                    const SectionBuffer **ppSectionData) const {
   Result result = Result::ErrorInvalidValue;
-  if (sortIdx < m_sections.size()) {
-    auto it = m_map.begin();
-    for (unsigned i = 0; i < sortIdx; ++i)
-      ++it;
-    *secIdx = it->second;
-    *ppSectionData = m_sections[it->second];
+  if (sortIdx < m_sectionNames.size()) {
+    *secIdx = m_sectionNames[sortIdx].second;
+    *ppSectionData = &m_sections[*secIdx];
     result = Result::Success;
   }
   return result;
 }
 
+// =====================================================================================================================
+// Gets the map between section name and section index, building it from the name index on first use.
+template <class Elf> const std::map<std::string, uint32_t> &ElfReader<Elf>::getMap() const {
+  if (m_map.empty()) {
+    for (const SectionNameEntry &nameEntry : m_sectionNames)
+      m_map.emplace(nameEntry.first.str(), nameEntry.second);
+  }
+  return m_map;
+}
+
+// =====================================================================================================================
+// Gets the list of section data and headers, building it on first use. The sections are owned by the reader.
+template <class Elf>
+const std::vector<typename ElfReader<Elf>::SectionBuffer *> &ElfReader<Elf>::getSections() const {
+  if (m_sectionPtrs.size() != m_sections.size()) {
+    m_sectionPtrs.clear();
+    for (const SectionBuffer &section : m_sections)
+      m_sectionPtrs.push_back(const_cast<SectionBuffer *>(&section));
+  }
+  return m_sectionPtrs;
+}
+
 // =====================================================================================================================
 // Gets all associated symbols by section index.
 //
@@ -302,16 +337,16 @@ template <class Elf>
 void ElfReader<Elf>::GetSymbolsBySectionIndex(unsigned secIdx, std::vector<ElfSymbol> &secSymbols) const {
   if (secIdx < m_sections.size() && m_symSecIdx >= 0) {
     auto &section = m_sections[m_symSecIdx];
-    const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx]->data);
+    const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx].data);
 
-    auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section->data);
+    auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section.data);
     unsigned symCount = getSymbolCount();
     ElfSymbol symbol = {};
 
     for (unsigned idx = 0; idx < symCount; ++idx) {
       if (symbols[idx].st_shndx == secIdx) {
         symbol.secIdx = symbols[idx].st_shndx;
-        symbol.secName = m_sections[symbol.secIdx]->name;
+        symbol.secName = m_sections[symbol.secIdx].name;
         symbol.pSymName = strTab + symbols[idx].st_name;
         symbol.size = symbols[idx].st_size;
         symbol.value = symbols[idx].st_value;
@@ -332,9 +367,9 @@ void ElfReader<Elf>::GetSymbolsBySectionIndex(unsigned secIdx, std::vector<ElfSy
 // @param symbolName : Symbol name
 template <class Elf> bool ElfReader<Elf>::isValidSymbol(const char *symbolName) {
   auto &section = m_sections[m_symSecIdx];
-  const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx]->data);
+  const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx].data);
 
-  auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section->data);
+  auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section.data);
   unsigned symCount = getSymbolCount();
   bool findSymbol = false;
   for (unsigned idx = 0; idx < symCount; ++idx) {
@@ -352,11 +387,11 @@ template <class Elf> bool ElfReader<Elf>::isValidSymbol(const char *symbolName)
 //
 // @param noteType : Note type
 template <class Elf> ElfNote ElfReader<Elf>::getNote(uint32_t noteType) const {
-  unsigned noteSecIdx = m_map.at(NoteName);
-  assert(noteSecIdx > 0);
-
-  auto noteSection = m_sections[noteSecIdx];
   ElfNote noteNode = {};
+  if (m_noteSecIdx <= 0)
+    return noteNode;
+
+  auto noteSection = &m_sections[m_noteSecIdx];
   const unsigned noteHeaderSize = sizeof(NoteHeader) - 8;
 
   size_t offset = 0;
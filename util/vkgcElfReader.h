@@ -33,6 +33,9 @@
 #include "g_palPipelineAbiMetadata.h"
 #include "palPipelineAbi.h"
 #include "vkgcUtil.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
 #include <functional>
 #include <map>
@@ -426,11 +429,16 @@ struct MsgPackIterator {
 //
 // The client should call "ReadFromBuffer()" to initialize the context with the contents of an ELF, then
 // "GetSectionData()" to retrieve the contents of a particular named section.
+//
+// The reader is a read-only view: section data and names point into the caller's buffer, which must outlive the
+// reader. Sections and the name index are held in flat arrays, so reading a typical ELF does not allocate, and note
+// and MsgPack contents are only parsed when asked for. The older accessors that expose a std::map of section names
+// and a vector of section pointers are kept for existing clients; they build those on first use.
 template <class Elf> class ElfReader {
 public:
   typedef ElfSectionBuffer<typename Elf::SectionHeader> SectionBuffer;
+  typedef std::pair<llvm::StringRef, uint32_t> SectionNameEntry;
   ElfReader(GfxIpVersion gfxIp);
-  ~ElfReader();
 
   // Gets architecture-specific flags
   uint32_t getFlags() const { return m_header.e_flags; }
@@ -449,14 +457,25 @@ public:
   Result GetSectionData(const char *name, const void **ppData, size_t *dataLength) const;
 
   uint32_t getSectionCount();
-  Result getSectionDataBySectionIndex(uint32_t secIdx, SectionBuffer **ppSectionData) const;
-  Result getSectionDataBySortingIndex(uint32_t sortIdx, uint32_t *secIdx, SectionBuffer **ppSectionData) const;
+  Result getSectionDataBySectionIndex(uint32_t secIdx, const SectionBuffer **ppSectionData) const;
+  Result getSectionDataBySortingIndex(uint32_t sortIdx, uint32_t *secIdx, const SectionBuffer **ppSectionData) const;
+  Result getTextSectionData(const SectionBuffer **ppSectionData) const {
+    return getSectionDataBySectionIndex(m_textSecIdx, ppSectionData);
+  }
+
+  // Older forms of the section accessors, for clients that take non-const section pointers.
+  Result getSectionDataBySectionIndex(uint32_t secIdx, SectionBuffer **ppSectionData) const {
+    return getSectionDataBySectionIndex(secIdx, const_cast<const SectionBuffer **>(ppSectionData));
+  }
+  Result getSectionDataBySortingIndex(uint32_t sortIdx, uint32_t *secIdx, SectionBuffer **ppSectionData) const {
+    return getSectionDataBySortingIndex(sortIdx, secIdx, const_cast<const SectionBuffer **>(ppSectionData));
+  }
   Result getTextSectionData(SectionBuffer **ppSectionData) const {
     return getSectionDataBySectionIndex(m_textSecIdx, ppSectionData);
   }
 
   // Determine if a section with the specified name is present in this ELF.
-  bool isSectionPresent(const char *name) const { return (m_map.find(name) != m_map.end()); }
+  bool isSectionPresent(const char *name) const { return GetSectionIndex(name) >= 0; }
 
   uint32_t getSymbolCount() const;
   void getSymbol(uint32_t idx, ElfSymbol *symbol) const;
@@ -464,6 +483,8 @@ public:
 
   bool isValidSymbol(const char *symbolName);
 
+  // Gets the note of the specified type. Returns an empty note (with null data) if the ELF has no note section or no
+  // note of that type.
   ElfNote getNote(uint32_t noteType) const;
 
   // Gets all associated symbols by section index.
@@ -477,10 +498,7 @@ public:
   // Gets the section index for the specified section name.
   // NOTE: Do not change the name or API of this method as it is used by AMD internal code and we need to
   // maintain compatibility.
-  int32_t GetSectionIndex(const char *name) const {
-    auto entry = m_map.find(name);
-    return (entry != m_map.end()) ? entry->second : InvalidValue;
-  }
+  int32_t GetSectionIndex(const char *name) const;
 
   void initMsgPackDocument(const void *buffer, uint32_t sizeInBytes);
 
@@ -494,9 +512,17 @@ public:
 
   const typename Elf::FormatHeader &getHeader() const { return m_header; }
 
-  const std::map<std::string, uint32_t> &getMap() const { return m_map; }
+  // Gets the section name index: one entry per distinct section name, sorted by name. Where several sections
+  // share a name, the entry refers to the last of them.
+  llvm::ArrayRef<SectionNameEntry> getSectionNameIndex() const { return m_sectionNames; }
+
+  llvm::ArrayRef<SectionBuffer> getSectionBuffers() const { return m_sections; }
 
-  const std::vector<SectionBuffer *> &getSections() const { return m_sections; }
+  // Gets the map between section name and section index.
+  const std::map<std::string, uint32_t> &getMap() const;
+
+  // Gets the list of section data and headers.
+  const std::vector<SectionBuffer *> &getSections() const;
 
   int32_t getSymSecIdx() const { return m_symSecIdx; }
 
@@ -512,18 +538,22 @@ private:
 
   GfxIpVersion m_gfxIp; // Graphics IP version info (used by ELF dump only)
 
-  typename Elf::FormatHeader m_header;     // ELF header
-  std::map<std::string, uint32_t> m_map;   // Map between section name and section index
-  std::vector<SectionBuffer *> m_sections; // List of section data and headers
+  typename Elf::FormatHeader m_header;                    // ELF header
+  llvm::SmallVector<SectionNameEntry, 16> m_sectionNames; // Section names and indices, sorted by name
+  llvm::SmallVector<SectionBuffer, 16> m_sections;        // List of section data and headers
 
   int32_t m_symSecIdx;    // Index of symbol section
   int32_t m_relocSecIdx;  // Index of relocation section
   int32_t m_strtabSecIdx; // Index of string table section
   int32_t m_textSecIdx;   // Index of string table section
+  int32_t m_noteSecIdx;   // Index of note section
 
   llvm::msgpack::Document m_document;           // MsgPack document
   std::vector<MsgPackIterator> m_iteratorStack; // MsgPack iterator stack
   uint32_t m_msgPackMapLevel;                   // The map level of current message item
+
+  mutable std::map<std::string, uint32_t> m_map;      // Map for getMap(), built on first use
+  mutable std::vector<SectionBuffer *> m_sectionPtrs; // Section pointers for getSections(), built on first use
 };
 
 // Dumps ELF package to out stream